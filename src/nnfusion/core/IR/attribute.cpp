@@ -3,10 +3,147 @@
 
 #include "attribute.hpp"
 
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <mutex>
+
+namespace
+{
+    // FNV-1a, names are short
+    size_t hash_name(const char* name, size_t size)
+    {
+        size_t h = 14695981039346656037ULL;
+        for (size_t i = 0; i < size; i++)
+        {
+            h ^= static_cast<unsigned char>(name[i]);
+            h *= 1099511628211ULL;
+        }
+        return h;
+    }
+
+    struct SymbolEntry
+    {
+        std::string name;
+        size_t hash;
+        uint32_t id;
+    };
+
+    // Open addressing over the entries, at most half full. A slot is written once and only
+    // under the mutex, so readers probe without locking.
+    struct SymbolSlots
+    {
+        explicit SymbolSlots(size_t capacity)
+            : mask(capacity - 1)
+            , slots(new std::atomic<const SymbolEntry*>[capacity])
+        {
+            for (size_t i = 0; i < capacity; i++)
+                slots[i].store(nullptr, std::memory_order_relaxed);
+        }
+
+        const SymbolEntry* find(const char* name, size_t size, size_t hash) const
+        {
+            for (size_t i = hash & mask;; i = (i + 1) & mask)
+            {
+                auto entry = slots[i].load(std::memory_order_acquire);
+                if (entry == nullptr)
+                    return nullptr;
+                if (entry->hash == hash && entry->name.size() == size &&
+                    std::memcmp(entry->name.data(), name, size) == 0)
+                    return entry;
+            }
+        }
+
+        void insert(const SymbolEntry* entry)
+        {
+            size_t i = entry->hash & mask;
+            while (slots[i].load(std::memory_order_relaxed) != nullptr)
+                i = (i + 1) & mask;
+            slots[i].store(entry, std::memory_order_release);
+        }
+
+        size_t mask;
+        std::unique_ptr<std::atomic<const SymbolEntry*>[]> slots;
+    };
+
+    // Names are interned under the mutex, looking up a name seen before takes no lock and
+    // does not allocate. The entries never move and outgrown slot tables are never freed,
+    // since a reader may still probe them. The empty name is always id 0.
+    struct SymbolTable
+    {
+        SymbolTable()
+            : slots(new SymbolSlots(64))
+        {
+            insert("", 0, hash_name("", 0));
+        }
+
+        const SymbolEntry* find(const char* name, size_t size, size_t hash) const
+        {
+            return slots.load(std::memory_order_acquire)->find(name, size, hash);
+        }
+
+        const SymbolEntry* insert(const char* name, size_t size, size_t hash)
+        {
+            entries.push_back(
+                SymbolEntry{std::string(name, size), hash, static_cast<uint32_t>(entries.size())});
+            auto current = slots.load(std::memory_order_relaxed);
+            if (entries.size() * 2 > current->mask + 1)
+            {
+                auto grown = new SymbolSlots((current->mask + 1) * 2);
+                for (auto& entry : entries)
+                    grown->insert(&entry);
+                slots.store(grown, std::memory_order_release);
+            }
+            else
+            {
+                current->insert(&entries.back());
+            }
+            return &entries.back();
+        }
+
+        std::mutex mutex;
+        std::deque<SymbolEntry> entries;
+        std::atomic<SymbolSlots*> slots;
+    };
+
+    SymbolTable& symbol_table()
+    {
+        // never destroyed, symbols may be used by other static destructors
+        static SymbolTable* table = new SymbolTable();
+        return *table;
+    }
+}
+
 namespace nnfusion
 {
     namespace ir
     {
+        Symbol::Symbol() { intern("", 0); }
+        Symbol::Symbol(const char* name) { intern(name, std::strlen(name)); }
+        Symbol::Symbol(const std::string& name) { intern(name.data(), name.size()); }
+        void Symbol::intern(const char* name, size_t size)
+        {
+            auto& table = symbol_table();
+            size_t hash = hash_name(name, size);
+            auto entry = table.find(name, size, hash);
+            if (entry == nullptr)
+            {
+                std::lock_guard<std::mutex> lock(table.mutex);
+                entry = table.find(name, size, hash);
+                if (entry == nullptr)
+                    entry = table.insert(name, size, hash);
+            }
+            m_id = entry->id;
+            m_name = &entry->name;
+        }
+
+        size_t Symbol::count()
+        {
+            auto& table = symbol_table();
+            std::lock_guard<std::mutex> lock(table.mutex);
+            return table.entries.size();
+        }
+
         TagProxy Tags::operator[](Symbol sym) { return TagProxy(this, sym); }
         template <>
         void TagProxy::operator=<char*>(char* str)
@@ -8,7 +8,9 @@
 #pragma once
 
 #include <algorithm>
+#include <cstdint>
 #include <memory>
+#include <ostream>
 #include <sstream>
 #include <string>
 #include <typeinfo>
@@ -21,34 +23,66 @@ namespace nnfusion
 {
     namespace ir
     {
-        using Symbol = std::string;
+        // An attribute name interned into a global table, so that symbols compare by id and a
+        // symbol built from a name already seen neither locks nor allocates. Ids are dense and
+        // only live in memory; names are what gets printed or serialized.
+        class Symbol
+        {
+        public:
+            Symbol();
+            Symbol(const char* name);
+            Symbol(const std::string& name);
+
+            uint32_t id() const { return m_id; }
+            const std::string& str() const { return *m_name; }
+            operator const std::string&() const { return *m_name; }
+            bool operator==(const Symbol& rhs) const { return m_id == rhs.m_id; }
+            bool operator!=(const Symbol& rhs) const { return m_id != rhs.m_id; }
+            bool operator<(const Symbol& rhs) const { return m_id < rhs.m_id; }
+            // number of symbols interned so far
+            static size_t count();
+
+        private:
+            void intern(const char* name, size_t size);
+
+            uint32_t m_id;
+            const std::string* m_name;
+        };
+
+        inline std::ostream& operator<<(std::ostream& out, const Symbol& sym)
+        {
+            return out << sym.str();
+        }
 
         struct AttributeValue
         {
             AttributeValue(Symbol name)
                 : name(name)
-                , type_hash(0)
+                , type(nullptr)
             {
             }
-            AttributeValue(Symbol name, size_t type_hash)
+            AttributeValue(Symbol name, const std::type_info* type)
                 : name(name)
-                , type_hash(type_hash)
+                , type(type)
             {
             }
             using Ptr = std::unique_ptr<AttributeValue>;
             Symbol name;
-            size_t type_hash;
+            // compared by identity first, which avoids hashing the mangled name per access
+            const std::type_info* type;
             virtual Ptr clone() const = 0;
             virtual ~AttributeValue() = default;
 
             template <typename T>
             bool is_a() const
             {
-                if (type_hash == 0)
-                    NNFUSION_LOG(NNFUSION_WARNING)
-                        << "Attribute value type hash code was set to zero,"
-                           " this will ignore type check.";
-                return (type_hash == 0) || (typeid(T).hash_code() == type_hash);
+                if (type == nullptr)
+                {
+                    NNFUSION_LOG(NNFUSION_WARNING) << "Attribute value type was not set,"
+                                                      " this will ignore type check.";
+                    return true;
+                }
+                return type == &typeid(T) || *type == typeid(T);
             }
         };
 
@@ -61,8 +95,7 @@ namespace nnfusion
                 : AttributeValue(name)
                 , value_(value_)
             {
-                // RTTI binding of type hash code, is there any better solution?
-                type_hash = typeid(T).hash_code();
+                type = &typeid(T);
             }
             ValueType& value() { return value_; }
             virtual Ptr clone() const override
@@ -84,7 +117,7 @@ namespace nnfusion
                 : AttributeValue(name)
                 , value_(std::move(value_))
             {
-                type_hash = typeid(T).hash_code();
+                type = &typeid(T);
             }
             ValueType& value() { return value_; }
             virtual std::unique_ptr<AttributeValue> clone() const override
@@ -191,9 +224,9 @@ namespace nnfusion
                 return child->value();
             }
             using AVPtr = AttributeValue::Ptr;
-            // NB: For determinism, we use a vector rather than a hash map.  This does
-            // mean that lookups are O(n), so you shouldn't use Attributes to store
-            // a big pile of messages.
+            // NB: For determinism, we use a vector rather than a hash map. Lookups are a
+            // linear scan comparing interned ids, which is cheap for the handful of tags a
+            // node carries, but you shouldn't use Attributes to store a big pile of messages.
             std::vector<AVPtr> values_;
             using iterator = std::vector<AVPtr>::iterator;
             iterator find(Symbol name, bool required)
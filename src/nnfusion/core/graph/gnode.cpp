@@ -1,6 +1,7 @@
 // Copyright (c) Microsoft Corporation.
 // Licensed under the MIT License.
 
+#include <algorithm>
 #include <memory>
 #include <sstream>
 #include <typeindex>
@@ -17,6 +18,7 @@ using namespace nnfusion::graph;
 using namespace nnfusion::op;
 
 atomic<size_t> GNode::m_next_instance_id(0);
+atomic<size_t> GNode::m_edge_version(0);
 
 GNode::GNode()
     : m_id(Graph::freeGnodeId)
@@ -188,9 +190,7 @@ bool GNode::has_same_type(std::shared_ptr<const GNode> gnode) const
 
 std::vector<std::shared_ptr<nnfusion::graph::Edge>> GNode::get_in_edges() const
 {
-    std::vector<std::shared_ptr<nnfusion::graph::Edge>> ret(m_in_edges.begin(), m_in_edges.end());
-    std::sort(ret.begin(), ret.end(), EdgeComparatorDstIndex());
-    return ret;
+    return m_in_edges;
 };
 
 const std::shared_ptr<nnfusion::graph::Edge> GNode::get_in_edge(size_t i) const
@@ -213,23 +213,32 @@ const std::shared_ptr<nnfusion::graph::Edge> GNode::get_in_edge(size_t i) const
 
 void GNode::clear_in_edges() {
     m_in_edges.clear();
+    ++m_edge_version;
 }
 
 void GNode::add_in_edge(std::shared_ptr<Edge> edge)
 {
-    m_in_edges.insert(edge);
+    if (std::find(m_in_edges.begin(), m_in_edges.end(), edge) != m_in_edges.end())
+        return;
+    m_in_edges.insert(
+        std::upper_bound(m_in_edges.begin(), m_in_edges.end(), edge, EdgeComparatorDstIndex()),
+        edge);
+    ++m_edge_version;
 }
 
 void GNode::remove_in_edge(std::shared_ptr<nnfusion::graph::Edge> edge)
 {
-    m_in_edges.erase(edge);
+    auto it = std::find(m_in_edges.begin(), m_in_edges.end(), edge);
+    if (it != m_in_edges.end())
+    {
+        m_in_edges.erase(it);
+        ++m_edge_version;
+    }
 }
 
 std::vector<std::shared_ptr<nnfusion::graph::Edge>> GNode::get_out_edges() const
 {
-    std::vector<std::shared_ptr<nnfusion::graph::Edge>> ret(m_out_edges.begin(), m_out_edges.end());
-    std::sort(ret.begin(), ret.end(), EdgeComparatorSrcIndex());
-    return ret;
+    return m_out_edges;
 };
 
 std::vector<std::shared_ptr<nnfusion::graph::Edge>> GNode::get_output_users(size_t i)
@@ -239,8 +248,7 @@ std::vector<std::shared_ptr<nnfusion::graph::Edge>> GNode::get_output_users(size
                                          << " outputs.";
     std::vector<std::shared_ptr<nnfusion::graph::Edge>> output_users;
 
-    auto edges = this->get_out_edges();
-    for (auto edge : edges)
+    for (auto& edge : m_out_edges)
     {
         if (edge->get_src_output() == i)
         {
@@ -252,12 +260,22 @@ std::vector<std::shared_ptr<nnfusion::graph::Edge>> GNode::get_output_users(size
 
 void GNode::add_out_edge(std::shared_ptr<nnfusion::graph::Edge> edge)
 {
-    m_out_edges.insert(edge);
+    if (std::find(m_out_edges.begin(), m_out_edges.end(), edge) != m_out_edges.end())
+        return;
+    m_out_edges.insert(
+        std::upper_bound(m_out_edges.begin(), m_out_edges.end(), edge, EdgeComparatorSrcIndex()),
+        edge);
+    ++m_edge_version;
 }
 
 void GNode::remove_out_edge(std::shared_ptr<nnfusion::graph::Edge> edge)
 {
-    m_out_edges.erase(edge);
+    auto it = std::find(m_out_edges.begin(), m_out_edges.end(), edge);
+    if (it != m_out_edges.end())
+    {
+        m_out_edges.erase(it);
+        ++m_edge_version;
+    }
 }
 
 nnfusion::descriptor::Tensor& GNode::get_input_tensor(size_t i) const
@@ -367,6 +385,7 @@ void GNode::Clear()
 {
     m_in_edges.clear();
     m_out_edges.clear();
+    ++m_edge_version;
     m_inputs.clear();
     m_outputs.clear();
     m_op_ptr = nullptr;
@@ -107,6 +107,10 @@ namespace nnfusion
             void add_out_edge(std::shared_ptr<nnfusion::graph::Edge> edge);
             void remove_out_edge(std::shared_ptr<nnfusion::graph::Edge> edge);
 
+            /// Increased by every change of the edges of any node, so that graphs notice edges
+            /// changed directly on a GNode.
+            static size_t get_edge_version() { return m_edge_version; }
+
             /// inputs
             std::vector<std::shared_ptr<Input>>& get_inputs() { return m_inputs; }
             const std::vector<std::shared_ptr<Input>>& get_inputs() const { return m_inputs; }
@@ -177,6 +181,7 @@ namespace nnfusion
             int64_t m_id; // m_id is for graph, the index in graph m_nodes
             size_t m_instance_id;
             static std::atomic<size_t> m_next_instance_id;
+            static std::atomic<size_t> m_edge_version;
             std::string m_name;
             const std::string m_unique_name;
             std::string m_implementation;
@@ -184,8 +189,9 @@ namespace nnfusion
             std::string m_op_type;
             std::shared_ptr<op::Op> m_op_ptr;
 
-            std::set<std::shared_ptr<Edge>> m_in_edges;
-            std::set<std::shared_ptr<Edge>> m_out_edges;
+            // kept sorted by dst input / src output, so getters do not sort on every call
+            std::vector<std::shared_ptr<Edge>> m_in_edges;
+            std::vector<std::shared_ptr<Edge>> m_out_edges;
 
             std::vector<std::shared_ptr<Input>> m_inputs;
             std::vector<std::shared_ptr<Output>> m_outputs;
@@ -4,11 +4,13 @@
 #include <sstream>
 
 #include "graph.hpp"
+#include "graph_serialization.hpp"
 #include "graph_util.hpp"
 #include "nnfusion/common/serialize/nnf_attr_value.pb.h"
 #include "nnfusion/common/serialize/nnf_graph_def.pb.h"
 #include "nnfusion/common/serialize/nnf_pbtypes.pb.h"
 #include "nnfusion/common/serialize/nnf_tensor_shape.pb.h"
+#include "nnfusion/core/operators/op_define/constant.hpp"
 #include "nnfusion/util/util.hpp"
 
 using namespace nnfusion::graph;
@@ -62,6 +64,7 @@ void Graph::add_node(std::shared_ptr<GNode> node)
     node->set_id(id);
     m_nodes.push_back(node);
     ++m_node_size;
+    ++m_version;
 }
 
 std::shared_ptr<GNode> Graph::add_node_and_edge(const std::shared_ptr<nnfusion::op::Op> op,
@@ -132,6 +135,7 @@ void Graph::remove_node(std::shared_ptr<GNode> node)
     node->Clear();
     m_free_nodes.push_back(node);
     --m_node_size;
+    ++m_version;
 }
 
 void Graph::replace_node(std::shared_ptr<GNode> old_node,
@@ -186,20 +190,22 @@ GNodeVector Graph::get_nodes() const
 
 GNodeVector Graph::get_ordered_ops()
 {
-    // todo: stored ops instead of calculate each time
-    GNodeVector nodes;
-    ReverseDFS(this,
-               get_outputs(),
-               nullptr,
-               [&](std::shared_ptr<GNode> node) { nodes.push_back(node); },
-               nullptr);
-
-    return nodes;
+    if (m_ordered_ops_version != get_version())
+    {
+        m_ordered_ops.clear();
+        ReverseDFS(this,
+                   get_outputs(),
+                   nullptr,
+                   [&](std::shared_ptr<GNode> node) { m_ordered_ops.push_back(node); },
+                   nullptr);
+        m_ordered_ops_version = get_version();
+    }
+    return m_ordered_ops;
 }
 
 GNodeVector Graph::get_bfs_ordered_ops()
 {
-    if (!m_bfs_ordered_ops_is_valid)
+    if (m_bfs_ordered_ops_version != get_version())
     {
         m_bfs_ordered_ops.clear();
         GNodeVector start;
@@ -219,12 +225,44 @@ GNodeVector Graph::get_bfs_ordered_ops()
             },
             nullptr,
             NodeComparatorName());
-        m_bfs_ordered_ops_is_valid = true;
+        m_bfs_ordered_ops_version = get_version();
         NNFUSION_CHECK(m_bfs_ordered_ops.size() == m_nodes.size());
     }
     return m_bfs_ordered_ops;
 }
 
+GraphAdjacency::Pointer Graph::get_adjacency() const
+{
+    if (!m_adjacency || m_adjacency->get_version() != get_version())
+        m_adjacency = std::make_shared<GraphAdjacency>(*this);
+    return m_adjacency;
+}
+
+GraphAdjacency::GraphAdjacency(const Graph& graph)
+    : m_graph(graph)
+    , m_edges(graph.get_max_node_id())
+    , m_filled(graph.get_max_node_id(), false)
+    , m_version(graph.get_version())
+{
+}
+
+const GraphAdjacency::NodeEdges& GraphAdjacency::fill(size_t node_id) const
+{
+    NNFUSION_CHECK(node_id < m_edges.size());
+    auto& edges = m_edges[node_id];
+    if (!m_filled[node_id])
+    {
+        auto node = m_graph.find_node_id(node_id);
+        if (node)
+        {
+            edges.first = node->get_in_edges();
+            edges.second = node->get_out_edges();
+        }
+        m_filled[node_id] = true;
+    }
+    return edges;
+}
+
 GNodeVector Graph::get_const_nodes()
 {
     GNodeVector const_nodes;
@@ -294,6 +332,7 @@ const std::shared_ptr<nnfusion::graph::Edge>
     m_edges.push_back(edge);
 
     ++m_edge_size;
+    ++m_version;
     return edge;
 }
 
@@ -351,10 +390,12 @@ void Graph::remove_edge(std::shared_ptr<Edge> edge)
     edge->m_dst_input = kControlSlot - 1;
     m_free_edges.push_back(edge);
     --m_edge_size;
+    ++m_version;
 }
 
 void Graph::set_default_outputs()
 {
+    ++m_version;
     m_output_nodes.clear();
     for (auto node : m_nodes)
     {
@@ -367,11 +408,13 @@ void Graph::set_default_outputs()
 
 void Graph::set_outputs(const GNodeIndexVector& outputs)
 {
+    ++m_version;
     m_output_nodes = outputs;
 }
 
 void Graph::set_outputs(const GNodeVector& outputs)
 {
+    ++m_version;
     m_output_nodes.clear();
     for (auto node : outputs)
         m_output_nodes.push_back(GNodeIndex{node});
@@ -381,6 +424,7 @@ void Graph::set_output(const GNodeIndex& output, size_t i)
 {
     NNFUSION_CHECK(i < m_output_nodes.size());
     m_output_nodes[i] = output;
+    ++m_version;
 }
 
 GNodeVector Graph::get_outputs()
@@ -440,32 +484,54 @@ void Graph::set_temporary_pool_size(size_t size)
 bool Graph::serialize_to_file(const std::string& file_path)
 {
     nnfusion::serialize::GraphDef graphdef;
+    bool restorable = true;
     auto nnfusion_nodes = get_ordered_ops();
     for (auto& nnfusion_node : nnfusion_nodes)
     {
-        NNFUSION_CHECK(
-            !nnfusion_node->hasAttributes() ||
-            (nnfusion_node->attributeNames().size() == 1 && nnfusion_node->hasAttribute("Alias")))
-            << nnfusion_node->get_name() << " has " << nnfusion_node->attributeNames().size()
-            << " tags including \"Alias\" which cannot be serialized now.";
         nnfusion::serialize::NodeDef* node = graphdef.add_node();
-        // name
-        node->set_name(nnfusion_node->get_name());
+        // name, the unique name is used to reference nodes
+        node->set_name(nnfusion_node->get_unique_name());
+        (*node->mutable_attr())["_name"].set_s(nnfusion_node->get_name());
         // op
         node->set_op(nnfusion_node->get_op_type());
-        // input
-        for (auto nnfusion_edge : nnfusion_node->get_in_edges())
+        // input, data inputs in order and then control inputs
+        for (size_t i = 0; i < nnfusion_node->get_input_size(); i++)
         {
-            if (nnfusion_edge->get_src_output() == kControlSlot)
+            auto nnfusion_edge = nnfusion_node->get_in_edge(i);
+            if (nnfusion_edge == nullptr)
             {
-                node->add_input("^" + nnfusion_edge->get_src()->get_name());
-            }
-            else
-            {
-                node->add_input(nnfusion_edge->get_src()->get_name() + ":" +
-                                std::to_string(nnfusion_edge->get_src_output()));
+                restorable = false;
+                continue;
             }
+            node->add_input(nnfusion_edge->get_src()->get_unique_name() + ":" +
+                            std::to_string(nnfusion_edge->get_src_output()));
         }
+        for (auto nnfusion_edge : nnfusion_node->get_in_edges())
+        {
+            if (nnfusion_edge->is_control_edge())
+                node->add_input("^" + nnfusion_edge->get_src()->get_unique_name());
+        }
+        // attrs of the op
+        nnfusion::json attrs;
+        if (typeid(*nnfusion_node) != typeid(GNode) ||
+            !serialization::serialize_op(nnfusion_node->get_op_ptr(), attrs))
+        {
+            NNFUSION_LOG(INFO) << nnfusion_node->get_name() << " with op "
+                               << nnfusion_node->get_op_type() << " cannot be serialized.";
+            restorable = false;
+        }
+        (*node->mutable_attr())["_attrs"].set_s(attrs.dump());
+        if (nnfusion_node->is_constant())
+        {
+            auto constant =
+                std::static_pointer_cast<nnfusion::op::Constant>(nnfusion_node->get_op_ptr());
+            (*node->mutable_attr())["_value"].set_s(constant->get_data_ptr(),
+                                                   constant->get_data_size());
+        }
+        // tags
+        nnfusion::json tags;
+        restorable &= serialization::serialize_tags(nnfusion_node, tags);
+        (*node->mutable_attr())["_tags"].set_s(tags.dump());
         // TODO(gbxu): support all nnfusion ops
         if (nnfusion_node->get_op_type() == "AllReduce")
         {
@@ -484,24 +550,16 @@ bool Graph::serialize_to_file(const std::string& file_path)
             data_type.set_type(dt);
             (*node->mutable_attr())["T"] = data_type;
         }
-#if 0
-        // Plan_gen can't parse this now. So just skip it for now.
-        else
+        // _element_types, all types including f16 and bf16 by name
+        auto _element_types_list = (*node->mutable_attr())["_element_types"].mutable_list();
+        for (auto nnfusion_output : nnfusion_node->get_outputs())
         {
-            nnfusion::serialize::AttrValue_ListValue* _data_types_list =
-                new nnfusion::serialize::AttrValue_ListValue();
-            for (auto nnfusion_output : nnfusion_node->get_outputs())
-            {
-                nnfusion::serialize::PBType dt;
-                nnfusion::element::Type::nnfusion_element_type_to_pbtype(
-                    nnfusion_output->get_element_type(), dt);
-                _data_types_list->add_type(dt);
-            }
-            nnfusion::serialize::AttrValue _data_types;
-            _data_types.set_allocated_list(_data_types_list);
-            (*node->mutable_attr())["T"] = _data_types;
+            std::string type_name;
+            if (!serialization::serialize_element_type(nnfusion_output->get_element_type(),
+                                                       type_name))
+                restorable = false;
+            _element_types_list->add_s(type_name);
         }
-#endif
         // _output_shapes
         nnfusion::serialize::AttrValue_ListValue* _output_shapes_list =
             new nnfusion::serialize::AttrValue_ListValue();
@@ -518,10 +576,142 @@ bool Graph::serialize_to_file(const std::string& file_path)
         _output_shapes.set_allocated_list(_output_shapes_list);
         (*node->mutable_attr())["_output_shapes"] = _output_shapes;
     }
-    graphdef.set_version(1);
+    for (auto& output : m_output_nodes)
+    {
+        graphdef.add_output(output.gnode->get_unique_name() + ":" +
+                            std::to_string(output.index));
+    }
+    for (auto& parameter : get_parameters())
+    {
+        graphdef.add_parameter(parameter->get_unique_name());
+    }
+    graphdef.set_name(m_name);
+    graphdef.set_version(2);
     std::fstream fs(file_path, std::ios::out | std::ios::trunc | std::ios::binary);
     graphdef.SerializeToOstream(&fs);
-    return true;
+    return restorable;
+}
+
+std::shared_ptr<Graph> Graph::deserialize_from_file(const std::string& file_path)
+{
+    nnfusion::serialize::GraphDef graphdef;
+    std::fstream fs(file_path, std::ios::in | std::ios::binary);
+    if (!fs || !graphdef.ParseFromIstream(&fs) || graphdef.version() != 2)
+    {
+        NNFUSION_LOG(NNFUSION_WARNING) << "Failed to parse graph from " << file_path;
+        return nullptr;
+    }
+
+    auto graph = std::make_shared<Graph>(graphdef.name());
+    std::unordered_map<std::string, std::shared_ptr<GNode>> gnodes;
+    auto parse_index = [&](const std::string& input) -> GNodeIndex {
+        auto pos = input.rfind(':');
+        auto it = gnodes.find(input.substr(0, pos));
+        if (pos == std::string::npos || it == gnodes.end())
+            return GNodeIndex();
+        return GNodeIndex(it->second, std::stoi(input.substr(pos + 1)));
+    };
+    auto restore_node = [&](const nnfusion::serialize::NodeDef& node) -> bool {
+        auto& attr = node.attr();
+        auto attrs = nnfusion::json::parse(attr.at("_attrs").s());
+        std::shared_ptr<nnfusion::op::Op> op;
+        if (node.op() == "Constant")
+        {
+            nnfusion::element::Type type;
+            if (!serialization::deserialize_element_type(attrs["type"], type))
+                return false;
+            nnfusion::Shape shape(attrs["shape"].get<std::vector<size_t>>());
+            auto& value = attr.at("_value").s();
+            if (value.size() != nnfusion::shape_size(shape) * type.size())
+                return false;
+            op = std::make_shared<nnfusion::op::Constant>(type, shape, value.data());
+        }
+        else
+        {
+            op = serialization::deserialize_op(node.op(), attrs);
+        }
+        if (op == nullptr)
+            return false;
+        op->set_name(attr.at("_name").s());
+
+        GNodeIndexVector inputs;
+        std::vector<std::shared_ptr<GNode>> control_inputs;
+        for (auto& input : node.input())
+        {
+            if (input[0] == '^')
+            {
+                auto it = gnodes.find(input.substr(1));
+                if (it == gnodes.end())
+                    return false;
+                control_inputs.push_back(it->second);
+                continue;
+            }
+            inputs.push_back(parse_index(input));
+            if (inputs.back().gnode == nullptr)
+                return false;
+        }
+
+        auto& types = attr.at("_element_types").list().s();
+        auto& shapes = attr.at("_output_shapes").list().shape();
+        size_t num_outputs = types.size();
+        auto gnode = graph->add_node_and_edge(op, inputs, num_outputs);
+        if (gnode->get_output_size() != num_outputs || size_t(shapes.size()) != num_outputs)
+            return false;
+        for (size_t i = 0; i < num_outputs; i++)
+        {
+            nnfusion::element::Type type;
+            nnfusion::Shape shape;
+            for (auto& dim : shapes.Get(i).dim())
+                shape.push_back(dim.size());
+            if (!serialization::deserialize_element_type(types.Get(i), type) ||
+                gnode->get_output_element_type(i) != type || gnode->get_output_shape(i) != shape)
+                return false;
+        }
+        for (auto& src : control_inputs)
+            graph->add_control_edge(src, gnode);
+
+        gnode->set_name(attr.at("_name").s());
+        if (!serialization::deserialize_tags(nnfusion::json::parse(attr.at("_tags").s()), gnode))
+            return false;
+        gnodes[node.name()] = gnode;
+        return true;
+    };
+
+    try
+    {
+        // parameters are created first to keep their order in the graph
+        std::unordered_map<std::string, const nnfusion::serialize::NodeDef*> node_defs;
+        for (auto& node : graphdef.node())
+            node_defs[node.name()] = &node;
+        for (auto& parameter : graphdef.parameter())
+        {
+            auto it = node_defs.find(parameter);
+            if (it == node_defs.end() || !restore_node(*it->second))
+                throw std::runtime_error("failed to restore parameter " + parameter);
+        }
+        // nodes are stored in topological order
+        for (auto& node : graphdef.node())
+        {
+            if (gnodes.find(node.name()) == gnodes.end() && !restore_node(node))
+                throw std::runtime_error("failed to restore " + node.name() + " (" + node.op() +
+                                         ")");
+        }
+        GNodeIndexVector outputs;
+        for (auto& output : graphdef.output())
+        {
+            outputs.push_back(parse_index(output));
+            if (outputs.back().gnode == nullptr)
+                throw std::runtime_error("failed to restore output " + output);
+        }
+        graph->set_outputs(outputs);
+    }
+    catch (const std::exception& e)
+    {
+        NNFUSION_LOG(NNFUSION_WARNING) << "Failed to restore graph from " << file_path << ": "
+                                       << e.what();
+        return nullptr;
+    }
+    return graph;
 }
 
 size_t Graph::get_memory_io()
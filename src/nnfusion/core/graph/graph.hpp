@@ -13,6 +13,62 @@ namespace nnfusion
 {
     namespace graph
     {
+        class Graph;
+
+        // Read-only view of the edges of a graph, indexed by node id. Edges of a node are
+        // ordered as GNode::get_in_edges() / get_out_edges() return them. The edges of a node
+        // are copied the first time they are queried, so a traversal only pays for the nodes
+        // it visits. Queried nodes are a snapshot and are not updated when the graph is
+        // mutated.
+        class GraphAdjacency
+        {
+        public:
+            using Pointer = std::shared_ptr<const GraphAdjacency>;
+
+            class EdgeRange
+            {
+            public:
+                EdgeRange(const std::shared_ptr<Edge>* begin, const std::shared_ptr<Edge>* end)
+                    : m_begin(begin)
+                    , m_end(end)
+                {
+                }
+                const std::shared_ptr<Edge>* begin() const { return m_begin; }
+                const std::shared_ptr<Edge>* end() const { return m_end; }
+                size_t size() const { return m_end - m_begin; }
+                bool empty() const { return m_begin == m_end; }
+            private:
+                const std::shared_ptr<Edge>* m_begin;
+                const std::shared_ptr<Edge>* m_end;
+            };
+
+            GraphAdjacency(const Graph& graph);
+
+            EdgeRange get_in_edges(size_t node_id) const
+            {
+                auto& edges = fill(node_id).first;
+                return EdgeRange(edges.data(), edges.data() + edges.size());
+            }
+            EdgeRange get_out_edges(size_t node_id) const
+            {
+                auto& edges = fill(node_id).second;
+                return EdgeRange(edges.data(), edges.data() + edges.size());
+            }
+            size_t get_max_node_id() const { return m_edges.size(); }
+            // version of the graph this view was built from
+            size_t get_version() const { return m_version; }
+        private:
+            using NodeEdges =
+                std::pair<std::vector<std::shared_ptr<Edge>>, std::vector<std::shared_ptr<Edge>>>;
+            const NodeEdges& fill(size_t node_id) const;
+
+            const Graph& m_graph;
+            // in and out edges of each node, valid once m_filled is set
+            mutable std::vector<NodeEdges> m_edges;
+            mutable std::vector<bool> m_filled;
+            size_t m_version;
+        };
+
         // Thread compatible but not thread safe.
         class Graph
         {
@@ -72,8 +128,14 @@ namespace nnfusion
             // REQUIRES: 0 <= id < get_max_node_id().
 
             GNodeVector get_nodes() const;
+            // Orders are cached until the graph is mutated.
             GNodeVector get_ordered_ops();
             GNodeVector get_bfs_ordered_ops();
+            GraphAdjacency::Pointer get_adjacency() const;
+
+            // Increased by every mutation of nodes, edges or outputs through this graph, and
+            // by edges changed directly on any GNode.
+            size_t get_version() const { return m_version + GNode::get_edge_version(); }
 
             GNodeVector get_const_nodes();
 
@@ -129,16 +191,23 @@ namespace nnfusion
             void set_temporary_pool_size(size_t);
 
             size_t get_memory_io();
+            // Returns false if the written graph cannot be restored by deserialize_from_file
             bool serialize_to_file(const std::string& file_path);
+            // Returns nullptr if the file is not a restorable graph
+            static std::shared_ptr<Graph> deserialize_from_file(const std::string& file_path);
 
         private:
             // Map from node ids to allocated nodes.  nodes_[id] may be nullptr if
             // the node with that id was removed from the graph.
             GNodeVector m_nodes;
 
-            //ordered ops from bfs
+            size_t m_version = 0;
+            //ordered ops from reverse dfs and bfs, valid while their version is get_version()
+            GNodeVector m_ordered_ops;
+            size_t m_ordered_ops_version = SIZE_MAX;
             GNodeVector m_bfs_ordered_ops;
-            bool m_bfs_ordered_ops_is_valid = false;
+            size_t m_bfs_ordered_ops_version = SIZE_MAX;
+            mutable GraphAdjacency::Pointer m_adjacency;
 
             // Number of nodes alive.
             size_t m_node_size = 0;
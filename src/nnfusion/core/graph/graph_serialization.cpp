@@ -0,0 +1,601 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "graph_serialization.hpp"
+#include "nnfusion/common/common.hpp"
+#include "nnfusion/core/operators/generic_op/generic_op.hpp"
+
+using namespace nnfusion;
+using namespace nnfusion::graph;
+
+namespace
+{
+    using Serializer = std::function<void(const std::shared_ptr<op::Op>&, nnfusion::json&)>;
+    using Deserializer = std::function<std::shared_ptr<op::Op>(const nnfusion::json&)>;
+
+    struct OpCodec
+    {
+        Serializer to_json;
+        Deserializer from_json;
+    };
+
+    const std::vector<std::pair<std::string, const element::Type*>>& element_type_names()
+    {
+        static const std::vector<std::pair<std::string, const element::Type*>> names = {
+            {"boolean", &element::boolean},
+            {"char", &element::character},
+            {"bf16", &element::bf16},
+            {"f16", &element::f16},
+            {"f32", &element::f32},
+            {"f64", &element::f64},
+            {"i8", &element::i8},
+            {"i16", &element::i16},
+            {"i32", &element::i32},
+            {"i64", &element::i64},
+            {"u8", &element::u8},
+            {"u16", &element::u16},
+            {"u32", &element::u32},
+            {"u64", &element::u64}};
+        return names;
+    }
+
+    element::Type to_element_type(const nnfusion::json& j)
+    {
+        element::Type type;
+        NNFUSION_CHECK(serialization::deserialize_element_type(j.get<std::string>(), type))
+            << "Unknown element type: " << j;
+        return type;
+    }
+
+    std::string from_element_type(const element::Type& type)
+    {
+        std::string name;
+        NNFUSION_CHECK(serialization::serialize_element_type(type, name))
+            << "Unknown element type: " << type;
+        return name;
+    }
+
+    template <typename T>
+    std::vector<T> to_vector(const nnfusion::json& j)
+    {
+        return j.get<std::vector<T>>();
+    }
+
+    template <typename T>
+    void add_default(std::unordered_map<std::string, OpCodec>& codecs)
+    {
+        auto probe = std::make_shared<T>();
+        codecs[probe->get_op_type()] = {
+            [](const std::shared_ptr<op::Op>&, nnfusion::json&) {},
+            [](const nnfusion::json&) -> std::shared_ptr<op::Op> { return std::make_shared<T>(); }};
+    }
+
+    template <typename T>
+    void add_reduction(std::unordered_map<std::string, OpCodec>& codecs, const std::string& op_type)
+    {
+        codecs[op_type] = {
+            [](const std::shared_ptr<op::Op>& op, nnfusion::json& j) {
+                j["reduction_axes"] =
+                    std::static_pointer_cast<op::ArithmeticReduction>(op)->get_reduction_axes();
+            },
+            [](const nnfusion::json& j) -> std::shared_ptr<op::Op> {
+                return std::make_shared<T>(AxisSet(to_vector<size_t>(j["reduction_axes"])));
+            }};
+    }
+
+    template <typename T>
+    void add_index_reduction(std::unordered_map<std::string, OpCodec>& codecs,
+                             const std::string& op_type)
+    {
+        codecs[op_type] = {[](const std::shared_ptr<op::Op>& op, nnfusion::json& j) {
+                               auto reduction = std::static_pointer_cast<op::IndexReduction>(op);
+                               j["axis"] = reduction->get_reduction_axis();
+                               j["index_type"] =
+                                   from_element_type(reduction->get_index_element_type());
+                           },
+                           [](const nnfusion::json& j) -> std::shared_ptr<op::Op> {
+                               return std::make_shared<T>(j["axis"].get<size_t>(),
+                                                          to_element_type(j["index_type"]));
+                           }};
+    }
+
+    template <typename T>
+    void add_batch_norm(std::unordered_map<std::string, OpCodec>& codecs,
+                        const std::string& op_type)
+    {
+        codecs[op_type] = {[](const std::shared_ptr<op::Op>& op, nnfusion::json& j) {
+                               j["eps"] = std::static_pointer_cast<T>(op)->get_eps_value();
+                           },
+                           [](const nnfusion::json& j) -> std::shared_ptr<op::Op> {
+                               return std::make_shared<T>(j["eps"].get<double>());
+                           }};
+    }
+
+    template <typename T>
+    void add_slice(std::unordered_map<std::string, OpCodec>& codecs, const std::string& op_type)
+    {
+        codecs[op_type] = {[](const std::shared_ptr<op::Op>& op, nnfusion::json& j) {
+                               auto slice = std::static_pointer_cast<T>(op);
+                               j["lower_bounds"] = slice->get_lower_bounds();
+                               j["upper_bounds"] = slice->get_upper_bounds();
+                               j["strides"] = slice->get_strides();
+                           },
+                           [](const nnfusion::json& j) -> std::shared_ptr<op::Op> {
+                               return std::make_shared<T>(
+                                   Coordinate(to_vector<size_t>(j["lower_bounds"])),
+                                   Coordinate(to_vector<size_t>(j["upper_bounds"])),
+                                   Strides(to_vector<size_t>(j["strides"])));
+                           }};
+    }
+
+    template <typename T>
+    void add_softmax(std::unordered_map<std::string, OpCodec>& codecs, const std::string& op_type)
+    {
+        codecs[op_type] = {[](const std::shared_ptr<op::Op>& op, nnfusion::json& j) {
+                               auto softmax = std::static_pointer_cast<T>(op);
+                               j["axes"] = softmax->get_axes();
+                               j["in_log_space"] = softmax->is_in_log_space();
+                           },
+                           [](const nnfusion::json& j) -> std::shared_ptr<op::Op> {
+                               return std::make_shared<T>(AxisSet(to_vector<size_t>(j["axes"])),
+                                                          j["in_log_space"].get<bool>());
+                           }};
+    }
+
+    std::unordered_map<std::string, OpCodec> build_op_codecs()
+    {
+        std::unordered_map<std::string, OpCodec> codecs;
+
+        add_default<op::Abs>(codecs);
+        add_default<op::Acos>(codecs);
+        add_default<op::Add>(codecs);
+        add_default<op::AllReduce>(codecs);
+        add_default<op::And>(codecs);
+        add_default<op::Asin>(codecs);
+        add_default<op::Atan>(codecs);
+        add_default<op::Ceiling>(codecs);
+        add_default<op::Cos>(codecs);
+        add_default<op::Cosh>(codecs);
+        add_default<op::D2H>(codecs);
+        add_default<op::DivNoNan>(codecs);
+        add_default<op::Divide>(codecs);
+        add_default<op::Equal>(codecs);
+        add_default<op::Erf>(codecs);
+        add_default<op::Exp>(codecs);
+        add_default<op::Floor>(codecs);
+        add_default<op::Gelu>(codecs);
+        add_default<op::GeluGrad>(codecs);
+        add_default<op::Greater>(codecs);
+        add_default<op::GreaterEq>(codecs);
+        add_default<op::H2D>(codecs);
+        add_default<op::Identity>(codecs);
+        add_default<op::IdentityBackprop>(codecs);
+        add_default<op::Less>(codecs);
+        add_default<op::LessEq>(codecs);
+        add_default<op::Log>(codecs);
+        add_default<op::Maximum>(codecs);
+        add_default<op::Minimum>(codecs);
+        add_default<op::Mod>(codecs);
+        add_default<op::Multiply>(codecs);
+        add_default<op::Negative>(codecs);
+        add_default<op::Not>(codecs);
+        add_default<op::NotEqual>(codecs);
+        add_default<op::Or>(codecs);
+        add_default<op::Power>(codecs);
+        add_default<op::Relu>(codecs);
+        add_default<op::Relu6>(codecs);
+        add_default<op::Relu6Backprop>(codecs);
+        add_default<op::ReluBackprop>(codecs);
+        add_default<op::Rsqrt>(codecs);
+        add_default<op::Select>(codecs);
+        add_default<op::Sigmoid>(codecs);
+        add_default<op::SigmoidBackprop>(codecs);
+        add_default<op::Sign>(codecs);
+        add_default<op::Sin>(codecs);
+        add_default<op::Sinh>(codecs);
+        add_default<op::Sqrt>(codecs);
+        add_default<op::Square>(codecs);
+        add_default<op::StopGradient>(codecs);
+        add_default<op::Subtract>(codecs);
+        add_default<op::Tan>(codecs);
+        add_default<op::Tanh>(codecs);
+
+        add_reduction<op::Max>(codecs, "Max");
+        add_reduction<op::Min>(codecs, "Min");
+        add_reduction<op::Product>(codecs, "Product");
+        add_reduction<op::Sum>(codecs, "Sum");
+        add_reduction<op::ReduceAny>(codecs, "ReduceAny");
+        add_index_reduction<op::ArgMax>(codecs, "ArgMax");
+        add_index_reduction<op::ArgMin>(codecs, "ArgMin");
+        add_batch_norm<op::BatchNormInference>(codecs, "BatchNormInference");
+        add_batch_norm<op::BatchNormTraining>(codecs, "BatchNormTraining");
+        add_batch_norm<op::BatchNormTrainingBackprop>(codecs, "BatchNormTrainingBackprop");
+        add_slice<op::Slice>(codecs, "Slice");
+        add_slice<op::ReplaceSlice>(codecs, "ReplaceSlice");
+        add_softmax<op::Softmax>(codecs, "Softmax");
+        add_softmax<op::SoftmaxGrad>(codecs, "SoftmaxGrad");
+
+        codecs["Result"] = {[](const std::shared_ptr<op::Op>& op, nnfusion::json& j) {
+                                auto result = std::static_pointer_cast<op::Result>(op);
+                                j["needs_copy_to_host"] = result->needs_copy_to_host();
+                                j["needs_default_layout"] = result->needs_default_layout();
+                            },
+                            [](const nnfusion::json& j) -> std::shared_ptr<op::Op> {
+                                auto result = std::make_shared<op::Result>();
+                                result->set_needs_copy_to_host(j["needs_copy_to_host"]);
+                                result->set_needs_default_layout(j["needs_default_layout"]);
+                                return result;
+                            }};
+
+        codecs["Parameter"] = {[](const std::shared_ptr<op::Op>& op, nnfusion::json& j) {
+                                   auto parameter = std::static_pointer_cast<op::Parameter>(op);
+                                   j["type"] = from_element_type(parameter->get_element_type());
+                                   j["shape"] = parameter->get_shape();
+                                   j["cacheable"] = parameter->get_cacheable();
+                                   j["require_grad"] = parameter->require_grad();
+                               },
+                               [](const nnfusion::json& j) -> std::shared_ptr<op::Op> {
+                                   return std::make_shared<op::Parameter>(
+                                       to_element_type(j["type"]),
+                                       Shape(to_vector<size_t>(j["shape"])),
+                                       j["cacheable"].get<bool>(),
+                                       j["require_grad"].get<bool>());
+                               }};
+
+        codecs["Variable"] = {[](const std::shared_ptr<op::Op>& op, nnfusion::json& j) {
+                                  auto variable = std::static_pointer_cast<op::Variable>(op);
+                                  j["type"] = from_element_type(variable->get_element_type());
+                                  j["shape"] = variable->get_shape();
+                              },
+                              [](const nnfusion::json& j) -> std::shared_ptr<op::Op> {
+                                  return std::make_shared<op::Variable>(
+                                      to_element_type(j["type"]),
+                                      Shape(to_vector<size_t>(j["shape"])));
+                              }};
+
+        codecs["Broadcast"] = {[](const std::shared_ptr<op::Op>& op, nnfusion::json& j) {
+                                   auto broadcast = std::static_pointer_cast<op::Broadcast>(op);
+                                   j["shape"] = broadcast->get_broadcast_shape();
+                                   j["axes"] = broadcast->get_broadcast_axes();
+                               },
+                               [](const nnfusion::json& j) -> std::shared_ptr<op::Op> {
+                                   return std::make_shared<op::Broadcast>(
+                                       Shape(to_vector<size_t>(j["shape"])),
+                                       AxisSet(to_vector<size_t>(j["axes"])));
+                               }};
+
+        codecs["Concat"] = {[](const std::shared_ptr<op::Op>& op, nnfusion::json& j) {
+                                auto concat = std::static_pointer_cast<op::Concat>(op);
+                                j["axis"] = concat->get_concatenation_axis();
+                            },
+                            [](const nnfusion::json& j) -> std::shared_ptr<op::Op> {
+                                return std::make_shared<op::Concat>(j["axis"].get<size_t>());
+                            }};
+
+        codecs["Convert"] = {
+            [](const std::shared_ptr<op::Op>& op, nnfusion::json& j) {
+                j["type"] = from_element_type(
+                    std::static_pointer_cast<op::Convert>(op)->get_convert_element_type());
+            },
+            [](const nnfusion::json& j) -> std::shared_ptr<op::Op> {
+                return std::make_shared<op::Convert>(to_element_type(j["type"]));
+            }};
+
+        codecs["Convolution"] = {
+            [](const std::shared_ptr<op::Op>& op, nnfusion::json& j) {
+                auto conv = std::static_pointer_cast<op::Convolution>(op);
+                j["window_movement_strides"] = conv->get_window_movement_strides();
+                j["window_dilation_strides"] = conv->get_window_dilation_strides();
+                j["padding_below"] = conv->get_padding_below();
+                j["padding_above"] = conv->get_padding_above();
+                j["data_dilation_strides"] = conv->get_data_dilation_strides();
+                j["data_format"] = conv->get_data_format();
+                j["activation"] = conv->get_activation();
+            },
+            [](const nnfusion::json& j) -> std::shared_ptr<op::Op> {
+                auto conv = std::make_shared<op::Convolution>(
+                    Strides(to_vector<size_t>(j["window_movement_strides"])),
+                    Strides(to_vector<size_t>(j["window_dilation_strides"])),
+                    CoordinateDiff(to_vector<std::ptrdiff_t>(j["padding_below"])),
+                    CoordinateDiff(to_vector<std::ptrdiff_t>(j["padding_above"])),
+                    Strides(to_vector<size_t>(j["data_dilation_strides"])),
+                    j["data_format"].get<std::string>());
+                conv->set_activation(j["activation"]);
+                return conv;
+            }};
+
+        codecs["Dot"] = {[](const std::shared_ptr<op::Op>& op, nnfusion::json& j) {
+                             auto dot = std::static_pointer_cast<op::Dot>(op);
+                             j["reduction_axes_count"] = dot->get_reduction_axes_count();
+                             j["transpose_A"] = dot->get_transpose_A();
+                             j["transpose_B"] = dot->get_transpose_B();
+                         },
+                         [](const nnfusion::json& j) -> std::shared_ptr<op::Op> {
+                             return std::make_shared<op::Dot>(
+                                 j["reduction_axes_count"].get<size_t>(),
+                                 true,
+                                 j["transpose_A"].get<bool>(),
+                                 j["transpose_B"].get<bool>());
+                         }};
+
+        codecs["LRN"] = {[](const std::shared_ptr<op::Op>& op, nnfusion::json& j) {
+                             auto lrn = std::static_pointer_cast<op::LRN>(op);
+                             j["alpha"] = lrn->get_alpha();
+                             j["beta"] = lrn->get_beta();
+                             j["bias"] = lrn->get_bias();
+                             j["size"] = lrn->get_nsize();
+                         },
+                         [](const nnfusion::json& j) -> std::shared_ptr<op::Op> {
+                             return std::make_shared<op::LRN>(j["alpha"].get<double>(),
+                                                              j["beta"].get<double>(),
+                                                              j["bias"].get<double>(),
+                                                              j["size"].get<size_t>());
+                         }};
+
+        codecs["MaxPool"] = {[](const std::shared_ptr<op::Op>& op, nnfusion::json& j) {
+                                 auto pool = std::static_pointer_cast<op::MaxPool>(op);
+                                 j["window_shape"] = pool->get_window_shape();
+                                 j["window_movement_strides"] = pool->get_window_movement_strides();
+                                 j["padding_below"] = pool->get_padding_below();
+                                 j["padding_above"] = pool->get_padding_above();
+                                 j["data_format"] = pool->get_data_format();
+                             },
+                             [](const nnfusion::json& j) -> std::shared_ptr<op::Op> {
+                                 return std::make_shared<op::MaxPool>(
+                                     Shape(to_vector<size_t>(j["window_shape"])),
+                                     Strides(to_vector<size_t>(j["window_movement_strides"])),
+                                     Shape(to_vector<size_t>(j["padding_below"])),
+                                     Shape(to_vector<size_t>(j["padding_above"])),
+                                     j["data_format"].get<std::string>());
+                             }};
+
+        codecs["AvgPool"] = {
+            [](const std::shared_ptr<op::Op>& op, nnfusion::json& j) {
+                auto pool = std::static_pointer_cast<op::AvgPool>(op);
+                j["window_shape"] = pool->get_window_shape();
+                j["window_movement_strides"] = pool->get_window_movement_strides();
+                j["padding_below"] = pool->get_padding_below();
+                j["padding_above"] = pool->get_padding_above();
+                j["include_padding"] = pool->get_include_padding_in_avg_computation();
+            },
+            [](const nnfusion::json& j) -> std::shared_ptr<op::Op> {
+                return std::make_shared<op::AvgPool>(
+                    Shape(to_vector<size_t>(j["window_shape"])),
+                    Strides(to_vector<size_t>(j["window_movement_strides"])),
+                    Shape(to_vector<size_t>(j["padding_below"])),
+                    Shape(to_vector<size_t>(j["padding_above"])),
+                    j["include_padding"].get<bool>());
+            }};
+
+        codecs["Pad"] = {[](const std::shared_ptr<op::Op>& op, nnfusion::json& j) {
+                             auto pad = std::static_pointer_cast<op::Pad>(op);
+                             j["padding_below"] = pad->get_padding_below();
+                             j["padding_above"] = pad->get_padding_above();
+                             j["padding_interior"] = pad->get_padding_interior();
+                         },
+                         [](const nnfusion::json& j) -> std::shared_ptr<op::Op> {
+                             return std::make_shared<op::Pad>(
+                                 Shape(to_vector<size_t>(j["padding_below"])),
+                                 Shape(to_vector<size_t>(j["padding_above"])),
+                                 Shape(to_vector<size_t>(j["padding_interior"])));
+                         }};
+
+        codecs["Reshape"] = {[](const std::shared_ptr<op::Op>& op, nnfusion::json& j) {
+                                 auto reshape = std::static_pointer_cast<op::Reshape>(op);
+                                 j["input_order"] = reshape->get_input_order();
+                                 j["output_shape"] = reshape->get_output_shape();
+                             },
+                             [](const nnfusion::json& j) -> std::shared_ptr<op::Op> {
+                                 return std::make_shared<op::Reshape>(
+                                     AxisVector(to_vector<size_t>(j["input_order"])),
+                                     Shape(to_vector<size_t>(j["output_shape"])));
+                             }};
+
+        codecs["Reverse"] = {[](const std::shared_ptr<op::Op>& op, nnfusion::json& j) {
+                                 j["axes"] = std::static_pointer_cast<op::Reverse>(op)
+                                                 ->get_reversed_axes();
+                             },
+                             [](const nnfusion::json& j) -> std::shared_ptr<op::Op> {
+                                 return std::make_shared<op::Reverse>(
+                                     AxisSet(to_vector<size_t>(j["axes"])));
+                             }};
+
+        codecs["ReverseSequence"] = {
+            [](const std::shared_ptr<op::Op>& op, nnfusion::json& j) {
+                auto reverse = std::static_pointer_cast<op::ReverseSequence>(op);
+                j["batch_axis"] = reverse->get_batch_axis();
+                j["sequence_axis"] = reverse->get_sequence_axis();
+            },
+            [](const nnfusion::json& j) -> std::shared_ptr<op::Op> {
+                return std::make_shared<op::ReverseSequence>(j["batch_axis"].get<size_t>(),
+                                                             j["sequence_axis"].get<size_t>());
+            }};
+
+        codecs["TopK"] = {[](const std::shared_ptr<op::Op>& op, nnfusion::json& j) {
+                              auto topk = std::static_pointer_cast<op::TopK>(op);
+                              j["axis"] = topk->get_top_k_axis();
+                              j["index_type"] = from_element_type(topk->get_index_element_type());
+                              j["k"] = topk->get_k();
+                              j["compute_max"] = topk->get_compute_max();
+                          },
+                          [](const nnfusion::json& j) -> std::shared_ptr<op::Op> {
+                              return std::make_shared<op::TopK>(j["axis"].get<size_t>(),
+                                                                to_element_type(j["index_type"]),
+                                                                j["k"].get<size_t>(),
+                                                                j["compute_max"].get<bool>());
+                          }};
+
+        return codecs;
+    }
+
+    const std::unordered_map<std::string, OpCodec>& op_codecs()
+    {
+        static const std::unordered_map<std::string, OpCodec> codecs = build_op_codecs();
+        return codecs;
+    }
+
+    template <typename T>
+    bool serialize_tag(const std::shared_ptr<GNode>& gnode,
+                       const std::string& name,
+                       const std::string& type,
+                       nnfusion::json& tags)
+    {
+        if (!gnode->CheckType<T>(name))
+            return false;
+        tags[name] = {{"type", type}, {"value", gnode->Get<T>(name)}};
+        return true;
+    }
+}
+
+bool serialization::serialize_element_type(const element::Type& type, std::string& name)
+{
+    for (auto& item : element_type_names())
+    {
+        if (*item.second == type)
+        {
+            name = item.first;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool serialization::deserialize_element_type(const std::string& name, element::Type& type)
+{
+    for (auto& item : element_type_names())
+    {
+        if (item.first == name)
+        {
+            type = *item.second;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool serialization::serialize_op(const std::shared_ptr<op::Op>& op, nnfusion::json& attrs)
+{
+    attrs = nnfusion::json::object();
+    if (auto generic_op = std::dynamic_pointer_cast<op::GenericOp>(op))
+    {
+        attrs["generic_config"] = generic_op->serialize();
+    }
+    else if (op->is_constant())
+    {
+        auto constant = std::static_pointer_cast<op::Constant>(op);
+        attrs["type"] = from_element_type(constant->get_type());
+        attrs["shape"] = constant->get_shape();
+    }
+    else
+    {
+        auto it = op_codecs().find(op->get_op_type());
+        // ops carrying subgraphs or forward ops (If, Loop, Fused, MaxPoolBackprop, ...) are
+        // not supported
+        if (it == op_codecs().end())
+            return false;
+        it->second.to_json(op, attrs);
+    }
+
+    if (auto annotations = op->get_op_annotations())
+    {
+        for (auto& oi : annotations->get_in_place_oi_pairs())
+        {
+            attrs["in_place_oi_pairs"].push_back(
+                {oi.output, oi.input, oi.destructive, oi.input_offset, oi.force_inplace});
+        }
+    }
+    return true;
+}
+
+std::shared_ptr<op::Op> serialization::deserialize_op(const std::string& op_type,
+                                                      const nnfusion::json& attrs)
+{
+    std::shared_ptr<op::Op> op;
+    if (attrs.contains("generic_config"))
+    {
+        op = std::make_shared<op::GenericOp>("", op_type, attrs["generic_config"]);
+    }
+    else if (op_type == "Constant")
+    {
+        // the data is filled in by the caller
+        return nullptr;
+    }
+    else
+    {
+        auto it = op_codecs().find(op_type);
+        if (it == op_codecs().end())
+            return nullptr;
+        op = it->second.from_json(attrs);
+    }
+
+    if (attrs.contains("in_place_oi_pairs"))
+    {
+        auto annotations = std::make_shared<Annotations>();
+        for (auto& oi : attrs["in_place_oi_pairs"])
+        {
+            annotations->add_in_place_oi_pair(oi_pair(oi[0].get<size_t>(),
+                                                      oi[1].get<size_t>(),
+                                                      oi[2].get<bool>(),
+                                                      oi[3].get<size_t>(),
+                                                      oi[4].get<bool>()));
+        }
+        op->set_op_annotations(annotations);
+    }
+    return op;
+}
+
+bool serialization::serialize_tags(const std::shared_ptr<GNode>& gnode, nnfusion::json& tags)
+{
+    tags = nnfusion::json::object();
+    bool restorable = true;
+    for (auto& name : gnode->attributeNames())
+    {
+        if (serialize_tag<bool>(gnode, name, "bool", tags) ||
+            serialize_tag<int>(gnode, name, "int", tags) ||
+            serialize_tag<int64_t>(gnode, name, "int64", tags) ||
+            serialize_tag<size_t>(gnode, name, "size_t", tags) ||
+            serialize_tag<float>(gnode, name, "float", tags) ||
+            serialize_tag<double>(gnode, name, "double", tags) ||
+            serialize_tag<std::string>(gnode, name, "string", tags))
+            continue;
+        if (gnode->CheckType<NNFusion_DeviceType>(name))
+        {
+            tags[name] = {{"type", "device_type"},
+                          {"value", (int)gnode->Get<NNFusion_DeviceType>(name)}};
+            continue;
+        }
+        NNFUSION_LOG(INFO) << gnode->get_name() << " has tag \"" << name
+                           << "\" which cannot be serialized.";
+        restorable = false;
+    }
+    return restorable;
+}
+
+bool serialization::deserialize_tags(const nnfusion::json& tags,
+                                     const std::shared_ptr<GNode>& gnode)
+{
+    for (auto& item : tags.items())
+    {
+        auto& type = item.value()["type"];
+        auto& value = item.value()["value"];
+        if (type == "bool")
+            gnode->Set<bool>(item.key(), value.get<bool>());
+        else if (type == "int")
+            gnode->Set<int>(item.key(), value.get<int>());
+        else if (type == "int64")
+            gnode->Set<int64_t>(item.key(), value.get<int64_t>());
+        else if (type == "size_t")
+            gnode->Set<size_t>(item.key(), value.get<size_t>());
+        else if (type == "float")
+            gnode->Set<float>(item.key(), value.get<float>());
+        else if (type == "double")
+            gnode->Set<double>(item.key(), value.get<double>());
+        else if (type == "string")
+            gnode->Set<std::string>(item.key(), value.get<std::string>());
+        else if (type == "device_type")
+            gnode->Set<NNFusion_DeviceType>(item.key(), (NNFusion_DeviceType)value.get<int>());
+        else
+            return false;
+    }
+    return true;
+}
@@ -0,0 +1,30 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "gnode.hpp"
+#include "nnfusion/common/common.hpp"
+
+namespace nnfusion
+{
+    namespace graph
+    {
+        ///\brief Codec between the ops, element types and tags of a graph and the json attributes
+        /// stored in the serialized GraphDef. Every serialize_* returns false when the value
+        /// cannot be restored by the matching deserialize_*.
+        namespace serialization
+        {
+            bool serialize_element_type(const nnfusion::element::Type& type, std::string& name);
+            bool deserialize_element_type(const std::string& name, nnfusion::element::Type& type);
+
+            // Constants keep their data out of attrs, see Graph::serialize_to_file
+            bool serialize_op(const std::shared_ptr<nnfusion::op::Op>& op, nnfusion::json& attrs);
+            std::shared_ptr<nnfusion::op::Op> deserialize_op(const std::string& op_type,
+                                                             const nnfusion::json& attrs);
+
+            bool serialize_tags(const std::shared_ptr<GNode>& gnode, nnfusion::json& tags);
+            bool deserialize_tags(const nnfusion::json& tags, const std::shared_ptr<GNode>& gnode);
+        } // namespace serialization
+    }     // namespace graph
+} // namespace nnfusion
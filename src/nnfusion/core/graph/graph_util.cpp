@@ -23,6 +23,7 @@ void nnfusion::graph::ReverseDFS(const Graph* graph,
     }
 
     std::vector<bool> visited(graph->get_max_node_id(), false);
+    auto adjacency = graph->get_adjacency();
     while (!stack.empty())
     {
         Work w = stack.back();
@@ -51,7 +52,7 @@ void nnfusion::graph::ReverseDFS(const Graph* graph,
             stack.push_back(Work{node, true});
         }
 
-        auto add_work = [&visited, &stack](std::shared_ptr<GNode> in_node) {
+        auto add_work = [&visited, &stack](const std::shared_ptr<GNode>& in_node) {
             if (!visited[in_node->get_id()])
             {
                 // Note; we must not mark as visited until we actually process it.
@@ -62,7 +63,7 @@ void nnfusion::graph::ReverseDFS(const Graph* graph,
         if (stable_comparator)
         {
             GNodeVector in_nodes_sorted;
-            for (auto in_edge : node->get_in_edges())
+            for (auto& in_edge : adjacency->get_in_edges(node->get_id()))
             {
                 in_nodes_sorted.emplace_back(in_edge->get_src());
             }
@@ -74,7 +75,7 @@ void nnfusion::graph::ReverseDFS(const Graph* graph,
         }
         else
         {
-            for (auto in_edge : node->get_in_edges())
+            for (auto& in_edge : adjacency->get_in_edges(node->get_id()))
             {
                 add_work(in_edge->get_src());
             }
@@ -101,6 +102,7 @@ void nnfusion::graph::BFS(const Graph* graph,
     }
 
     std::vector<bool> visited(graph->get_max_node_id(), false);
+    auto adjacency = graph->get_adjacency();
     while (!queue.empty())
     {
         Work w = queue.front();
@@ -128,12 +130,12 @@ void nnfusion::graph::BFS(const Graph* graph,
             queue.push(Work{node, true});
         }
 
-        auto add_work = [&visited, &queue](std::shared_ptr<GNode> out_node) {
+        auto add_work = [&visited, &queue, &adjacency](const std::shared_ptr<GNode>& out_node) {
             if (!visited[out_node->get_id()])
             {
                 // Note; we must not mark as visited until we actually process it.
                 bool all_input_visited = true;
-                for (auto& edge : out_node->get_in_edges())
+                for (auto& edge : adjacency->get_in_edges(out_node->get_id()))
                 {
                     auto input_node = edge->get_src();
                     if (!visited[input_node->get_id()])
@@ -150,7 +152,7 @@ void nnfusion::graph::BFS(const Graph* graph,
         if (stable_comparator)
         {
             GNodeVector out_nodes_sorted;
-            for (auto out_edge : node->get_out_edges())
+            for (auto& out_edge : adjacency->get_out_edges(node->get_id()))
             {
                 out_nodes_sorted.emplace_back(out_edge->get_dst());
             }
@@ -162,7 +164,7 @@ void nnfusion::graph::BFS(const Graph* graph,
         }
         else
         {
-            for (auto out_edge : node->get_out_edges())
+            for (auto& out_edge : adjacency->get_out_edges(node->get_id()))
             {
                 add_work(out_edge->get_dst());
             }
@@ -0,0 +1,229 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "controlflow_emitter.hpp"
+
+using namespace nnfusion;
+using namespace nnfusion::kernels;
+
+namespace
+{
+    // offset of each memory pool of tu in the workspace
+    std::unordered_map<std::string, size_t> get_pool_offset(TranslationUnit::Pointer tu,
+                                                            size_t& workspace_size)
+    {
+        std::unordered_map<std::string, size_t> pool_offset;
+        workspace_size = 0;
+        for (auto& pair : tu->memory_allocator_factory->get_allocator_list())
+        {
+            pool_offset[pair.second->get_name()] = workspace_size;
+            workspace_size += (pair.second->max_allocated() + 63) / 64 * 64;
+        }
+        return pool_offset;
+    }
+}
+
+cpu::ControlFlowEmitter::ControlFlowEmitter(shared_ptr<KernelContext> ctx)
+    : CpuKernelEmitter(ctx)
+{
+    // the kernels of the subgraphs run on the thread pool of this kernel
+    m_intra_op_parallelism = true;
+}
+
+size_t cpu::ControlFlowEmitter::get_workspace_size(TranslationUnit::Pointer tu)
+{
+    size_t workspace_size;
+    get_pool_offset(tu, workspace_size);
+    return workspace_size;
+}
+
+void cpu::ControlFlowEmitter::allocate_workspace(size_t size)
+{
+    m_workspace = allocate_tensor(Shape{std::max<size_t>(size, 1)}, element::character);
+}
+
+void cpu::ControlFlowEmitter::emit_subgraph(
+    LanguageUnit& lu,
+    TranslationUnit::Pointer tu,
+    const std::map<int, std::string>& input_args,
+    const std::unordered_map<std::string, std::string>& output_args,
+    const std::string& workspace)
+{
+    size_t workspace_size;
+    auto pool_offset = get_pool_offset(tu, workspace_size);
+
+    // tensor name -> argument, the parameters of the subgraph must not be written
+    std::unordered_map<std::string, std::string> args;
+    std::unordered_map<std::string, descriptor::Tensor::Pointer> tensors;
+    std::unordered_set<std::string> read_only;
+    auto get_arg = [&](descriptor::Tensor::Pointer tensor) {
+        auto& name = tensor->get_name(false);
+        tensors[name] = tensor;
+        if (args.find(name) == args.end())
+        {
+            auto output = output_args.find(name);
+            if (output != output_args.end())
+            {
+                args[name] = output->second;
+            }
+            else
+            {
+                NNFUSION_CHECK(tensor->get_pool_offset() != SIZE_MAX) << name;
+                NNFUSION_CHECK(pool_offset.count(tensor->get_pool())) << tensor->get_pool();
+                size_t offset = pool_offset[tensor->get_pool()] + tensor->get_pool_offset();
+                args[name] = "(" + tensor->get_element_type().c_type_string() + "*)(" +
+                             workspace + " + " + std::to_string(offset) + ")";
+            }
+        }
+        return args[name];
+    };
+
+    for (auto block : tu->program)
+    {
+        for (auto ins : *block)
+        {
+            auto gnode = ins->getGNode();
+            auto type = gnode->get_op_type();
+            if (type == "Parameter" || type == "Constant")
+            {
+                auto mapping = (*gnode)["subgraph_input_map"];
+                NNFUSION_CHECK(mapping.is_valid()) << "Subgraph input " << gnode->get_name()
+                                                   << " is not mapped to the kernel inputs.";
+                int index = mapping.as<int>();
+                auto& name = ins->get_outputs()[0]->get_name(false);
+                auto input = input_args.find(index);
+                args[name] =
+                    input != input_args.end() ? input->second : "input" + std::to_string(index);
+                tensors[name] = ins->get_outputs()[0];
+                read_only.insert(name);
+                continue;
+            }
+            auto kernel = ins->getKernel();
+            if (kernel == nullptr || type == "Result")
+                continue;
+            NNFUSION_CHECK(std::dynamic_pointer_cast<CpuKernelEmitter>(kernel) != nullptr &&
+                           kernel->get_or_emit_source() != nullptr)
+                << "No CPU kernel is emitted for " << gnode->get_name() << " in the subgraph.";
+
+            std::vector<std::string> inputs, outputs(ins->get_outputs().size());
+            for (auto tensor : ins->get_inputs())
+                inputs.push_back(get_arg(tensor));
+            if (auto annotations = kernel->m_context->annotations)
+            {
+                for (auto& pair : annotations->get_in_place_oi_pairs())
+                {
+                    if (!pair.force_inplace)
+                        continue;
+                    auto input = ins->get_inputs()[pair.input];
+                    auto output = ins->get_outputs()[pair.output];
+                    if (read_only.count(input->get_name(false)))
+                    {
+                        // the kernel updates a copy instead of the input of this kernel
+                        outputs[pair.output] = get_arg(output);
+                        lu << "memcpy(" << outputs[pair.output] << ", " << inputs[pair.input]
+                           << ", " << input->size() << ");\n";
+                        inputs[pair.input] = outputs[pair.output];
+                    }
+                    else
+                    {
+                        outputs[pair.output] = inputs[pair.input];
+                    }
+                    args[output->get_name(false)] = outputs[pair.output];
+                    tensors[output->get_name(false)] = output;
+                }
+            }
+            for (size_t i = 0; i < outputs.size(); i++)
+            {
+                if (outputs[i].empty())
+                    outputs[i] = get_arg(ins->get_outputs()[i]);
+            }
+
+            std::vector<std::string> params;
+            if (kernel->is_parallelism())
+                params.push_back("thread_pool");
+            params.insert(params.end(), inputs.begin(), inputs.end());
+            params.insert(params.end(), outputs.begin(), outputs.end());
+            for (auto tensor : kernel->m_context->tensors)
+                params.push_back(get_arg(tensor));
+            lu << kernel->get_function_name() << "(" << join(params, ", ") << ");\n";
+        }
+    }
+
+    // the outputs aliasing a parameter or an in-place input are copied out, the output map
+    // may name the outputs of other subgraphs, which are skipped
+    for (auto& output : output_args)
+    {
+        auto arg = args.find(output.first);
+        if (arg == args.end() || arg->second == output.second)
+            continue;
+        lu << "memcpy(" << output.second << ", " << arg->second << ", "
+           << tensors[output.first]->size() << ");\n";
+    }
+}
+
+LanguageUnit_p cpu::ControlFlowEmitter::emit_subgraph_functions()
+{
+    LanguageUnit_p _lu(new LanguageUnit(get_function_name() + "_subgraph_kernels"));
+    auto& lu = *_lu;
+    std::unordered_set<std::string> emitted;
+    for (auto tu : get_subgraphs())
+    {
+        for (auto block : tu->program)
+        {
+            for (auto ins : *block)
+            {
+                auto kernel = ins->getKernel();
+                auto type = ins->getGNode()->get_op_type();
+                if (kernel == nullptr || type == "Parameter" || type == "Constant" ||
+                    type == "Result")
+                    continue;
+                auto fu = kernel->get_or_emit_source();
+                if (fu == nullptr || !emitted.insert(fu->name_unit->get_code()).second)
+                    continue;
+                lu << fu->comment_unit->get_code();
+                lu << "static " << fu->get_specialized_signature() << "\n";
+                lu.block_begin();
+                lu << fu->body_unit->get_code() << "\n";
+                lu.block_end();
+                lu << "\n";
+            }
+        }
+    }
+    return _lu;
+}
+
+LanguageUnit_p cpu::ControlFlowEmitter::emit_dependency()
+{
+    LanguageUnit_p _lu(new LanguageUnit(get_function_name() + "_dep"));
+    _lu->require(header::cstring);
+    _lu->require(header::threadpool);
+
+    // keep the dependency of each kernel in the subgraphs
+    for (auto tu : get_subgraphs())
+    {
+        for (auto block : tu->program)
+        {
+            for (auto ins : *block)
+            {
+                auto kernel = ins->getKernel();
+                auto type = ins->getGNode()->get_op_type();
+                if (kernel == nullptr || type == "Parameter" || type == "Constant" ||
+                    type == "Result" || kernel->get_or_emit_source() == nullptr)
+                    continue;
+                for (auto& it : kernel->get_or_emit_source()->dep_unit->local_symbol)
+                    _lu->require(it.second);
+            }
+        }
+    }
+    return _lu;
+}
+
+LanguageUnit_p cpu::ControlFlowEmitter::emit_comments()
+{
+    auto _lu = KernelEmitter::emit_comments();
+    auto& lu = *_lu;
+    lu << "\n";
+    // the subgraph kernels are defined ahead of the function of this kernel
+    lu << emit_subgraph_functions()->get_code();
+    return _lu;
+}
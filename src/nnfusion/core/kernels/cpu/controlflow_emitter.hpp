@@ -0,0 +1,51 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+#include "cpu_kernel_emitter.hpp"
+#include "nnfusion/engine/interpreter.hpp"
+
+namespace nnfusion
+{
+    namespace kernels
+    {
+        namespace cpu
+        {
+            // Base of the host control-flow kernels. The kernels of the compiled subgraphs are
+            // defined as static functions in front of the control-flow kernel and called
+            // inline, and all the tensors of a subgraph live in one workspace tensor planned
+            // at compile time, so running a branch or an iteration allocates nothing.
+            class ControlFlowEmitter : public CpuKernelEmitter
+            {
+            public:
+                ControlFlowEmitter(shared_ptr<KernelContext> ctx);
+
+                LanguageUnit_p emit_dependency() override;
+                LanguageUnit_p emit_comments() override;
+
+            protected:
+                // the translation units whose kernels are called by this kernel
+                virtual std::vector<TranslationUnit::Pointer> get_subgraphs() = 0;
+
+                // bytes of the workspace that holds all the tensors of tu
+                static size_t get_workspace_size(TranslationUnit::Pointer tu);
+                void allocate_workspace(size_t size);
+
+                // Emits the calls of the kernels of tu. The parameter mapped to input k of this
+                // kernel reads input_args[k] if given and "input<k>" otherwise, the tensors named
+                // in output_args are written to the given pointers and the other tensors are
+                // placed in workspace.
+                void emit_subgraph(LanguageUnit& lu,
+                                   TranslationUnit::Pointer tu,
+                                   const std::map<int, std::string>& input_args,
+                                   const std::unordered_map<std::string, std::string>& output_args,
+                                   const std::string& workspace);
+
+                // definitions of the kernels of the subgraphs, emitted ahead of this kernel
+                virtual LanguageUnit_p emit_subgraph_functions();
+
+                descriptor::Tensor::Pointer m_workspace;
+            };
+        } // namespace cpu
+    }     // namespace kernels
+} // namespace nnfusion
@@ -75,10 +75,13 @@ LanguageUnit_p cpu::get_eigen_math_kernel(const std::string& name,
 LanguageUnit_p cpu::get_simd_math_kernel(const std::string& name,
                                          const std::string& math_kernel,
                                          size_t data_size,
-                                         const std::vector<std::string>& data_types)
+                                         const std::vector<std::string>& data_types,
+                                         const SimdIsa& isa)
 {
     NNFUSION_CHECK(std::count(name.begin(), name.end(), '-') == 0);
     std::string mangled_name = "declaration::function_def_inline_" + name;
+    if (!isa.is_native())
+        mangled_name += "_" + isa.name;
     // TODO: handle data_types containing underline, like long_long
     // Output type should be ignore
     for (size_t i = 0; i < data_types.size() - 1; i++)
@@ -90,20 +93,142 @@ LanguageUnit_p cpu::get_simd_math_kernel(const std::string& name,
     if (math_kernel.size())
     {
         auto num_inputs = data_types.size() - 1;
-        writer << "inline __m256 " << name << "(";
+        std::string func_name = isa.get_op(name, true);
+        // versions of different kernels may share one translation unit
+        if (!isa.is_native())
+        {
+            writer << "#ifndef NNFUSION_SIMD_" << func_name << "\n";
+            writer << "#define NNFUSION_SIMD_" << func_name << "\n";
+        }
+        writer << "inline " << isa.vec_type << " " << func_name << "(";
         for (size_t i = 0; i < num_inputs - 1; ++i)
         {
-            writer << "__m256 in" << i << ", ";
+            writer << isa.vec_type << " in" << i << ", ";
         }
-        writer << "__m256 in" << num_inputs - 1;
+        writer << isa.vec_type << " in" << num_inputs - 1;
         writer << ")\n";
         writer << "{\n";
         writer.indent++;
         {
-            writer << "return " << math_kernel << ";\n";
+            writer << "return " << isa.translate(math_kernel) << ";\n";
         }
         writer.indent--;
         writer << "}\n";
+        if (!isa.is_native())
+            writer << "#endif\n";
     }
     return cw;
 }
+
+std::string cpu::SimdIsa::translate(const std::string& code) const
+{
+    std::string translated = code;
+    auto replace_all = [&translated](const std::string& from, const std::string& to) {
+        if (from == to)
+            return;
+        for (size_t pos = translated.find(from); pos != std::string::npos;
+             pos = translated.find(from, pos + to.size()))
+        {
+            translated.replace(pos, from.size(), to);
+        }
+    };
+    for (auto& rename : renames)
+        replace_all(rename.first, rename.second);
+    replace_all("__m256", vec_type);
+    replace_all("_mm256_", prefix);
+    return translated;
+}
+
+std::string cpu::SimdIsa::get_op(const std::string& simd_op, bool has_math_kernel) const
+{
+    if (is_native())
+        return simd_op;
+    // helper names may clash with real intrinsics once translated, e.g. _mm_cmpeq_ps
+    return has_math_kernel ? simd_op + "_" + name : translate(simd_op);
+}
+
+std::string cpu::SimdIsa::load(const std::string& ptr, const std::string& dtype) const
+{
+    if (dtype == "bfloat16")
+        return "nnfusion::cpu::load_bf16_" + name + "(" + ptr + ")";
+    if (dtype == "int8_t")
+        return "nnfusion::cpu::load_s8_" + name + "(" + ptr + ")";
+    NNFUSION_CHECK(dtype == "float") << "No vector load of " << dtype;
+    return prefix + "loadu_ps(" + ptr + ")";
+}
+
+std::string cpu::SimdIsa::store(const std::string& ptr,
+                                const std::string& vec,
+                                const std::string& dtype) const
+{
+    if (dtype == "bfloat16")
+        return "nnfusion::cpu::store_bf16_" + name + "(" + ptr + ", " + vec + ")";
+    if (dtype == "int8_t")
+        return "nnfusion::cpu::store_s8_" + name + "(" + ptr + ", " + vec + ")";
+    NNFUSION_CHECK(dtype == "float") << "No vector store of " << dtype;
+    return prefix + "storeu_ps(" + ptr + ", " + vec + ")";
+}
+
+std::string cpu::SimdIsa::set1(const std::string& value) const
+{
+    return prefix + "set1_ps(" + value + ")";
+}
+
+std::string cpu::SimdIsa::extract(const std::string& vec, const std::string& dtype) const
+{
+    std::string lane = "_mm_cvtss_f32(" + vec + ")";
+    if (vec_type != "__m128")
+    {
+        std::string width = vec_type.substr(3);
+        lane = "_mm_cvtss_f32(" + prefix + "castps" + width + "_ps128(" + vec + "))";
+    }
+    // a plain float to int8_t conversion is undefined out of range
+    if (dtype == "int8_t")
+        return "nnfusion::cpu::f32_to_s8(" + lane + ")";
+    return lane;
+}
+
+bool cpu::has_simd_convert(const std::string& dtype)
+{
+    return dtype == "float" || is_reduced_precision(dtype);
+}
+
+bool cpu::is_reduced_precision(const std::string& dtype)
+{
+    return dtype == "bfloat16" || dtype == "int8_t";
+}
+
+const cpu::SimdIsa& cpu::get_native_simd_isa()
+{
+    static SimdIsa native{
+        "avx2", "", "nnfusion::cpu::SIMD_ISA_AVX2", "__m256", "_mm256_", 8, {}};
+    return native;
+}
+
+const std::vector<cpu::SimdIsa>& cpu::get_dispatch_simd_isas()
+{
+    // ordered by preference, the last one runs on any x86-64 host; renames are keyed on the
+    // bare intrinsic, as get_op() translates op names without their arguments
+    static std::vector<SimdIsa> isas{
+        {"avx512",
+         "avx512f,avx512dq",
+         "nnfusion::cpu::SIMD_ISA_AVX512",
+         "__m512",
+         "_mm512_",
+         16,
+         {{"_mm256_cmp_ps", "NNFUSION_MM512_CMP_PS"},
+          {"_mm256_ceil_ps", "NNFUSION_MM512_CEIL_PS"},
+          {"_mm256_floor_ps", "NNFUSION_MM512_FLOOR_PS"},
+          {"_mm256_rsqrt_ps", "_mm512_rsqrt14_ps"}}},
+        {"avx2", "avx2,fma", "nnfusion::cpu::SIMD_ISA_AVX2", "__m256", "_mm256_", 8, {}},
+        {"sse2",
+         "sse2",
+         "nnfusion::cpu::SIMD_ISA_SSE2",
+         "__m128",
+         "_mm_",
+         4,
+         {{"_mm256_cmp_ps", "NNFUSION_MM_CMP_PS"},
+          {"_mm256_ceil_ps", "NNFUSION_MM_CEIL_PS"},
+          {"_mm256_floor_ps", "NNFUSION_MM_FLOOR_PS"}}}};
+    return isas;
+}
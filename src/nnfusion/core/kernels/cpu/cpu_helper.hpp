@@ -9,12 +9,55 @@
 
 #include "cpu_kernelops.hpp"
 
+DECLARE_bool(fcpu_simd_dispatch);
+
 namespace nnfusion
 {
     namespace kernels
     {
         namespace cpu
         {
+            ///\brief Vector ISA the simd kernels are emitted for. The simd ops of CpuOpMap are
+            /// written with AVX2 intrinsics and translated to the other ISAs.
+            struct SimdIsa
+            {
+                std::string name;
+                // #pragma GCC target of the kernel version, empty for the native build
+                std::string target;
+                // SimdIsaLevel of simd_dispatch.h
+                std::string level;
+                std::string vec_type;
+                std::string prefix;
+                uint32_t block_size;
+                // AVX2 intrinsics without a same-named counterpart in this ISA
+                std::vector<std::pair<std::string, std::string>> renames;
+
+                bool is_native() const { return target.empty(); }
+                std::string translate(const std::string& code) const;
+                // ops defined by a math kernel get a helper function per ISA
+                std::string get_op(const std::string& simd_op, bool has_math_kernel) const;
+                // bfloat16 and int8_t elements are converted from and to float vectors,
+                // see has_simd_convert()
+                std::string load(const std::string& ptr, const std::string& dtype = "float") const;
+                std::string store(const std::string& ptr,
+                                  const std::string& vec,
+                                  const std::string& dtype = "float") const;
+                std::string set1(const std::string& value) const;
+                // lane 0 of vec, converted to dtype like store() does
+                std::string extract(const std::string& vec,
+                                    const std::string& dtype = "float") const;
+            };
+
+            // element types a SimdIsa loads and stores without a scalar copy loop
+            bool has_simd_convert(const std::string& dtype);
+            // types whose kernels need the reduced_precision.h runtime header
+            bool is_reduced_precision(const std::string& dtype);
+
+            // AVX2, compiled with -march=native
+            const SimdIsa& get_native_simd_isa();
+            // AVX-512, AVX2 and SSE2 versions selected in cpu_init(), see -fcpu_simd_dispatch
+            const std::vector<SimdIsa>& get_dispatch_simd_isas();
+
             shared_ptr<LanguageUnit>
                 get_eigen_math_kernel(const std::string& name,
                                       const std::string& math_kernel,
@@ -25,7 +68,8 @@ namespace nnfusion
                 get_simd_math_kernel(const std::string& name,
                                      const std::string& math_kernel,
                                      size_t data_size,
-                                     const std::vector<std::string>& data_types);
+                                     const std::vector<std::string>& data_types,
+                                     const SimdIsa& isa = get_native_simd_isa());
         }
     }
 }
@@ -10,6 +10,10 @@
 using namespace nnfusion;
 using namespace nnfusion::kernels;
 
+DEFINE_bool(fcpu_prepack_weights,
+            false,
+            "Pack the constant weights of f32 MLAS gemms once in cpu_init().");
+
 LanguageUnit_p cpu::EigenKernelEmitter::emit_eigen_utils()
 {
     LanguageUnit_p _lu(new LanguageUnit("eigen_utils.hpp"));
@@ -244,3 +248,270 @@ LanguageUnit_p cpu::CpuKernelEmitter::emit_function_signature()
     lu << join(params, ", ") << ")";
     return _lu;
 }
+
+LanguageUnit_p cpu::SimdKernelEmitter::emit_simd_function_body()
+{
+    LanguageUnit_p _lu(new LanguageUnit(get_function_name()));
+    auto& lu = *_lu;
+    if (!FLAGS_fcpu_simd_dispatch)
+    {
+        emit_simd_loop(lu, get_native_simd_isa());
+        return _lu;
+    }
+
+    vector<string> args;
+    if (this->is_parallelism())
+        args.push_back("thread_pool");
+    for (size_t i = 0; i < m_context->inputs.size(); i++)
+        args.push_back("input" + to_string(i));
+    for (size_t i = 0; i < m_context->outputs.size(); i++)
+        args.push_back("output" + to_string(i));
+    for (size_t i = 0; i < m_context->tensors.size(); i++)
+        args.push_back(m_context->tensors[i]->get_name());
+
+    // the versions are compiled for their ISA whatever the flags of the project
+    LanguageUnit_p _versions(
+        new LanguageUnit("declaration::" + get_function_name() + "_simd_versions"));
+    auto& versions = *_versions;
+    string sig = emit_function_signature()->get_code();
+    auto& isas = get_dispatch_simd_isas();
+    lu << "switch (nnfusion::cpu::simd_isa())\n";
+    lu.block_begin();
+    for (size_t i = 0; i < isas.size(); i++)
+    {
+        auto& isa = isas[i];
+        string version_name = get_function_name() + "_" + isa.name;
+        LanguageUnit loop(version_name);
+        emit_simd_loop(loop, isa);
+
+        versions << "#pragma GCC push_options\n";
+        versions << "#pragma GCC target(\"" << isa.target << "\")\n";
+        // math helpers must be compiled for the ISA as well
+        for (auto& it : loop.local_symbol)
+        {
+            if (it.second->symbol.find("declaration::") != string::npos)
+                versions << it.second->get_code();
+            else
+                lu.require(it.second);
+        }
+        string version_sig = sig;
+        version_sig.insert(version_sig.find("("), version_name);
+        versions << "static " << version_sig << "\n";
+        versions.block_begin();
+        versions << loop.get_code();
+        versions.block_end();
+        versions << "#pragma GCC pop_options\n";
+
+        lu << (i + 1 < isas.size() ? "case " + isa.level + ":\n" : "default:\n");
+        lu << version_name << "(" << join(args, ", ") << ");\n";
+        lu << "break;\n";
+    }
+    lu.block_end();
+    lu.require(_versions);
+    return _lu;
+}
+
+std::string cpu::MlasKernelEmitter::get_kernel_dtype()
+{
+    std::string dtype = m_context->outputs[0]->get_element_type().c_type_string();
+    for (auto& tensor : m_context->inputs)
+    {
+        if (tensor->get_element_type().c_type_string() != dtype)
+            return "";
+    }
+    return dtype;
+}
+
+namespace
+{
+    // a panel of B stays in L2 while its bf16 source is streamed once from memory
+    size_t get_bf16_panel_n(size_t N, size_t K)
+    {
+        const size_t panel_size = 1 << 16;
+        size_t panel_n = K * N <= panel_size ? N : std::max<size_t>(16, panel_size / K / 16 * 16);
+        return std::min(panel_n, N);
+    }
+
+    size_t align_workspace(size_t size) { return (size + 63) / 64 * 64; }
+}
+
+void cpu::MlasKernelEmitter::allocate_gemm_workspace(const std::string& dtype,
+                                                     bool trans_A,
+                                                     bool trans_B,
+                                                     size_t M,
+                                                     size_t N,
+                                                     size_t K,
+                                                     size_t lda,
+                                                     size_t ldb,
+                                                     size_t slots)
+{
+    if (dtype == "bfloat16")
+    {
+        size_t panel_n = get_bf16_panel_n(N, K);
+        m_gemm_offsets = {0,
+                          align_workspace(sizeof(float) * (trans_A ? K : M) * lda),
+                          align_workspace(sizeof(float) * K * panel_n),
+                          align_workspace(sizeof(float) * M * panel_n)};
+    }
+    else if (dtype == "int8_t" && !trans_A && !trans_B)
+    {
+        m_gemm_offsets = {0,
+                          align_workspace(M * lda),
+                          align_workspace(K * ldb),
+                          align_workspace(sizeof(int32_t) * M * N)};
+    }
+    else
+    {
+        return;
+    }
+    // the offsets of the staged A, B and C in a slot, and the slot size last
+    for (size_t i = 1; i < m_gemm_offsets.size(); i++)
+        m_gemm_offsets[i] += m_gemm_offsets[i - 1];
+    m_gemm_workspace = allocate_tensor(Shape{slots * m_gemm_offsets.back()}, element::character);
+}
+
+std::string cpu::MlasKernelEmitter::emit_gemm(const std::string& dtype,
+                                              bool trans_A,
+                                              bool trans_B,
+                                              size_t M,
+                                              size_t N,
+                                              size_t K,
+                                              const std::string& A,
+                                              size_t lda,
+                                              const std::string& B,
+                                              size_t ldb,
+                                              const std::string& C,
+                                              size_t ldc,
+                                              const std::string& slot)
+{
+    std::string trans_A_str = trans_A ? "CblasTrans" : "CblasNoTrans";
+    std::string trans_B_str = trans_B ? "CblasTrans" : "CblasNoTrans";
+    std::stringstream ss;
+    if (dtype == "float")
+    {
+        ss << "MlasGemm(" << trans_A_str << ", " << trans_B_str << ", " << M << ", " << N << ", "
+           << K << ", 1.0, " << A << ", " << lda << ", " << B << ", " << ldb << ", 0.0, " << C
+           << ", " << ldc << ", thread_pool);\n";
+        return ss.str();
+    }
+    if (dtype != "bfloat16" && !(dtype == "int8_t" && !trans_A && !trans_B))
+        return "";
+
+    NNFUSION_CHECK_NOT_NULLPTR(m_gemm_workspace)
+        << "allocate_gemm_workspace() must be called for " << dtype << " gemms";
+    std::string workspace =
+        m_gemm_workspace->get_name() + " + (" + slot + ") * " + std::to_string(m_gemm_offsets[3]);
+    if (dtype == "bfloat16")
+    {
+        size_t panel_n = get_bf16_panel_n(N, K);
+        ss << op::create_code_from_template(
+            R"({
+float* a_f32 = (float*)(@workspace@);
+float* b_f32 = (float*)(@workspace@ + @b_offset@);
+float* c_f32 = (float*)(@workspace@ + @c_offset@);
+nnfusion::cpu::bf16_to_f32(@A@, a_f32, @a_size@);
+for (size_t n0 = 0; n0 < @N@; n0 += @panel_n@)
+{
+    size_t cols = std::min<size_t>(@panel_n@, @N@ - n0);
+    size_t ldb = @ldb_panel@;
+    nnfusion::cpu::bf16_to_f32(@B_panel@, @ldb@, b_f32, ldb, @b_rows@, @b_cols@);
+    MlasGemm(@trans_A@, @trans_B@, @M@, cols, @K@, 1.0, a_f32, @lda@, b_f32, ldb, 0.0, c_f32, cols, thread_pool);
+    nnfusion::cpu::f32_to_bf16(c_f32, cols, @C@ + n0, @ldc@, @M@, cols);
+}
+}
+)",
+            {{"A", A},
+             {"C", C},
+             {"M", M},
+             {"N", N},
+             {"K", K},
+             {"lda", lda},
+             {"ldb", ldb},
+             {"ldc", ldc},
+             {"trans_A", trans_A_str},
+             {"trans_B", trans_B_str},
+             {"panel_n", panel_n},
+             {"workspace", workspace},
+             {"b_offset", m_gemm_offsets[1]},
+             {"c_offset", m_gemm_offsets[2]},
+             {"a_size", (trans_A ? K : M) * lda},
+             {"ldb_panel", trans_B ? std::to_string(K) : std::string("cols")},
+             {"B_panel", trans_B ? B + " + n0 * " + std::to_string(ldb) : B + " + n0"},
+             {"b_rows", trans_B ? std::string("cols") : std::to_string(K)},
+             {"b_cols", trans_B ? std::to_string(K) : std::string("cols")}});
+    }
+    else
+    {
+        // Both operands are shifted to unsigned with a zero point of 128. The u8s8 kernels
+        // would saturate their 16-bit pair sums, the u8u8 ones are exact.
+        ss << op::create_code_from_template(
+            R"({
+uint8_t* a_u8 = (uint8_t*)(@workspace@);
+uint8_t* b_u8 = (uint8_t*)(@workspace@ + @b_offset@);
+int32_t* c_s32 = (int32_t*)(@workspace@ + @c_offset@);
+nnfusion::cpu::s8_to_u8(@A@, a_u8, @a_size@);
+nnfusion::cpu::s8_to_u8(@B@, b_u8, @b_size@);
+MlasGemm(@M@, @N@, @K@, a_u8, @lda@, 128, b_u8, @ldb@, 128, c_s32, @N@, thread_pool);
+for (size_t m = 0; m < @M@; m++)
+{
+    nnfusion::cpu::s32_to_s8(c_s32 + m * @N@, @C@ + m * @ldc@, @N@);
+}
+}
+)",
+            {{"A", A},
+             {"B", B},
+             {"C", C},
+             {"M", M},
+             {"N", N},
+             {"K", K},
+             {"lda", lda},
+             {"ldb", ldb},
+             {"ldc", ldc},
+             {"workspace", workspace},
+             {"b_offset", m_gemm_offsets[1]},
+             {"c_offset", m_gemm_offsets[2]},
+             {"a_size", M * lda},
+             {"b_size", K * ldb}});
+    }
+    return ss.str();
+}
+
+shared_ptr<nnfusion::descriptor::Tensor> cpu::MlasKernelEmitter::allocate_packed_weight(
+    size_t B_index, bool trans_B, size_t N, size_t K, size_t tile_n)
+{
+    auto B = m_context->inputs[B_index];
+    if (!FLAGS_fcpu_prepack_weights || B->get_element_type() != element::f32 ||
+        !m_context->gnode->get_in_edge(B_index)->get_src()->is_constant())
+        return nullptr;
+
+    // tiles are multiples of 16 columns, so they pack to (N + 15) / 16 * 16 columns as a whole
+    NNFUSION_CHECK(tile_n == N || tile_n % 16 == 0);
+    auto packed = allocate_tensor(Shape{(N + 15) / 16 * 16 * K}, element::f32);
+    packed->set_persistent();
+
+    size_t ldb = trans_B ? K : N;
+    m_pack_code = op::create_code_from_template(
+        R"(for (size_t n0 = 0; n0 < @N@; n0 += @tile_n@)
+    MlasGemmPackB(@trans_B@, std::min<size_t>(@tile_n@, @N@ - n0), @K@,
+                  @B@ + n0 * @b_stride@, @ldb@, @packed@ + n0 * @K@);
+)",
+        {{"N", N},
+         {"K", K},
+         {"tile_n", tile_n},
+         {"trans_B", trans_B ? "CblasTrans" : "CblasNoTrans"},
+         {"B", B->get_name()},
+         {"b_stride", trans_B ? ldb : 1},
+         {"ldb", ldb},
+         {"packed", packed->get_name()}});
+    return packed;
+}
+
+LanguageUnit_p cpu::MlasKernelEmitter::emit_init_code()
+{
+    if (m_pack_code.empty())
+        return nullptr;
+    LanguageUnit_p _lu(new LanguageUnit(get_function_name() + "_init"));
+    _lu->require(header::mlas);
+    *_lu << m_pack_code;
+    return _lu;
+}
@@ -5,6 +5,7 @@
 #include "nnfusion/common/descriptor/layout/tensor_layout.hpp"
 #include "nnfusion/common/descriptor/tensor.hpp"
 #include "nnfusion/core/kernels/antares_ke_imp.hpp"
+#include "nnfusion/core/kernels/cpu/cpu_helper.hpp"
 #include "nnfusion/core/kernels/cpu/cpu_langunit.hpp"
 #include "nnfusion/core/kernels/kernel_emitter.hpp"
 #include "nnfusion/core/kernels/kernel_registration.hpp"
@@ -26,6 +27,8 @@ namespace nnfusion
                 {
                 }
                 LanguageUnit_p emit_function_signature() override;
+                // code run by cpu_init() after the constants are loaded and before the kernel
+                virtual LanguageUnit_p emit_init_code() { return nullptr; }
             };
 
             class MklKernelEmitter : public CpuKernelEmitter
@@ -63,6 +66,53 @@ namespace nnfusion
                 {
                     m_intra_op_parallelism = true;
                 }
+
+            protected:
+                // c_type_string() shared by all the inputs and outputs, empty if they differ
+                std::string get_kernel_dtype();
+                // The temp buffer the bf16 and int8 gemms stage their operands in, slots copies
+                // of it for gemms running concurrently. Called from the constructor, as temp
+                // tensors are part of the signature. Nothing is allocated for f32.
+                void allocate_gemm_workspace(const std::string& dtype,
+                                             bool trans_A,
+                                             bool trans_B,
+                                             size_t M,
+                                             size_t N,
+                                             size_t K,
+                                             size_t lda,
+                                             size_t ldb,
+                                             size_t slots = 1);
+                // C = A * B of row-major matrices of dtype. f32 calls MlasGemm directly, bf16
+                // widens A and panels of B to f32 and int8 uses the u8u8 gemm with int32
+                // accumulation, wrapping the result like int8 arithmetic does, both in the
+                // workspace slot given. Returns an empty string for other types and for
+                // transposed int8 operands.
+                std::string emit_gemm(const std::string& dtype,
+                                      bool trans_A,
+                                      bool trans_B,
+                                      size_t M,
+                                      size_t N,
+                                      size_t K,
+                                      const std::string& A,
+                                      size_t lda,
+                                      const std::string& B,
+                                      size_t ldb,
+                                      const std::string& C,
+                                      size_t ldc,
+                                      const std::string& slot = "0");
+                // With -fcpu_prepack_weights, a persistent buffer holding the constant f32 input
+                // B_index packed by MlasGemmPackB in cpu_init(), one pack per tile of tile_n
+                // columns starting at column n0 * K of the buffer. nullptr if B is not packed.
+                shared_ptr<nnfusion::descriptor::Tensor> allocate_packed_weight(
+                    size_t B_index, bool trans_B, size_t N, size_t K, size_t tile_n);
+
+            public:
+                LanguageUnit_p emit_init_code() override;
+
+            private:
+                std::string m_pack_code;
+                shared_ptr<nnfusion::descriptor::Tensor> m_gemm_workspace;
+                std::vector<size_t> m_gemm_offsets;
             };
 
             class AntaresCpuKernelEmitter : public CpuKernelEmitter
@@ -165,13 +215,17 @@ namespace nnfusion
                     m_intra_op_parallelism = true;
                 }
 
-                virtual std::pair<std::string, shared_ptr<LanguageUnit>> get_op_kernel()
+                virtual std::pair<std::string, shared_ptr<LanguageUnit>>
+                    get_op_kernel(const SimdIsa& isa)
                 {
                     return std::make_pair("", nullptr);
                 }
 
             protected:
-                const uint32_t m_simd_block_size = 8;
+                // emit_simd_loop() for the native ISA, or one static version per ISA of
+                // -fcpu_simd_dispatch and a body calling the one selected in cpu_init().
+                LanguageUnit_p emit_simd_function_body();
+                virtual void emit_simd_loop(LanguageUnit& lu, const SimdIsa& isa) {}
             };
         } // namespace cpu
     }     // namespace kernels
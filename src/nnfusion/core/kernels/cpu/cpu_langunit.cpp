@@ -15,7 +15,11 @@ LU_DEFINE(header::cblas, "#include \"mkl_cblas.h\"\n#define CBLAS_ENUM_DEFINED_H
 LU_DEFINE(header::mlas, "#include \"mlas.h\"\n");
 LU_DEFINE(header::threadpool, "#include \"numa_aware_threadpool.h\"\n");
 LU_DEFINE(header::barrier, "#include \"barrier.h\"\n");
+LU_DEFINE(header::dag_executor, "#include \"dag_executor.h\"\n");
 LU_DEFINE(header::simd, "#include <immintrin.h>\n");
+LU_DEFINE(header::simd_dispatch, "#include \"simd_dispatch.h\"\n");
+LU_DEFINE(header::reduced_precision, "#include \"reduced_precision.h\"\n");
+LU_DEFINE(header::atomic, "#include <atomic>\n");
 
 // Macro
 
@@ -28,4 +32,46 @@ LU_DEFINE(declaration::worker_thread_pool,
 LU_DEFINE(declaration::schedule_thread_pool,
           "concurrency::NumaAwareThreadPool *schedule_thread_pool;\n")
 LU_DEFINE(declaration::superscaler_schedule_thread,
-          "concurrency::NumaAwareThreadPool *superscaler_schedule_thread;\n")
\ No newline at end of file
+          "concurrency::NumaAwareThreadPool *superscaler_schedule_thread;\n")
+
+// y = (x - mean) * inv_std * gamma + beta over a row of n floats, y may alias x. The partial
+// sums are kept in 16 lanes so that the reductions vectorize without -ffast-math.
+LU_DEFINE(declaration::layer_norm_row, R"(
+static inline void layer_norm_row(const float* x, const float* gamma, const float* beta, float* y,
+                                  int n, float epsilon, float* mean_out, float* inv_std_out)
+{
+    // two passes, as the variance of E[x^2] - E[x]^2 cancels for rows with a large mean
+    float sum[16] = {0};
+    int i = 0;
+    for (; i + 16 <= n; i += 16)
+        for (int j = 0; j < 16; j++)
+            sum[j] += x[i + j];
+    float s = 0;
+    for (int j = 0; j < 16; j++)
+        s += sum[j];
+    for (; i < n; i++)
+        s += x[i];
+    float mean = s / n;
+
+    float square_sum[16] = {0};
+    for (i = 0; i + 16 <= n; i += 16)
+        for (int j = 0; j < 16; j++)
+        {
+            float d = x[i + j] - mean;
+            square_sum[j] += d * d;
+        }
+    float s2 = 0;
+    for (int j = 0; j < 16; j++)
+        s2 += square_sum[j];
+    for (; i < n; i++)
+        s2 += (x[i] - mean) * (x[i] - mean);
+    float var = s2 / n;
+    float inv_std = 1.0f / std::sqrt((var > 0 ? var : 0) + epsilon);
+    for (i = 0; i < n; i++)
+        y[i] = (x[i] - mean) * inv_std * gamma[i] + beta[i];
+    if (mean_out)
+        *mean_out = mean;
+    if (inv_std_out)
+        *inv_std_out = inv_std;
+}
+)")
@@ -18,7 +18,11 @@ namespace nnfusion
             LU_DECLARE(mlas);
             LU_DECLARE(threadpool);
             LU_DECLARE(barrier);
+            LU_DECLARE(dag_executor);
             LU_DECLARE(simd);
+            LU_DECLARE(simd_dispatch);
+            LU_DECLARE(reduced_precision);
+            LU_DECLARE(atomic);
         }
 
         namespace macro
@@ -32,6 +36,7 @@ namespace nnfusion
             LU_DECLARE(worker_thread_pool);
             LU_DECLARE(schedule_thread_pool);
             LU_DECLARE(superscaler_schedule_thread);
+            LU_DECLARE(layer_norm_row);
         }
     } // namespace kernels
 } // namespace nnfusion
@@ -0,0 +1,120 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "dag_executor.hpp"
+
+namespace nnfusion
+{
+    namespace kernels
+    {
+        LanguageUnit_p dag_executor_header = LanguageUnit_p(new LanguageUnit("dag_executor.h",
+                                                                             R"(
+
+#pragma once
+
+#include <assert.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "barrier.h"
+#include "numa_aware_threadpool.h"
+
+namespace nnfusion
+{
+    namespace cpu
+    {
+        // DagExecutor runs a fixed set of tasks on a thread pool, a task is scheduled
+        // as soon as all of its predecessors have finished. The underlying Eigen pool
+        // keeps one queue per worker and idle workers steal from the others, so ready
+        // tasks are picked up by whichever core is free. The tasks are added once,
+        // each Run only resets the dependency counters.
+        class DagExecutor
+        {
+        public:
+            DagExecutor(concurrency::NumaAwareThreadPool* pool)
+            : pool_(pool)
+            {
+            }
+
+            // Add a task depending on the tasks with the given ids, which must have
+            // been added before. Returns the id of the new task.
+            int AddTask(std::function<void()> fn, const std::vector<int>& deps)
+            {
+                int id = tasks_.size();
+                tasks_.push_back(Task{std::move(fn), {}, (int)deps.size()});
+                for (int dep : deps)
+                {
+                    assert(dep >= 0 && dep < id);
+                    tasks_[dep].successors.push_back(id);
+                }
+                return id;
+            }
+
+            // Run all tasks and wait for them to finish.
+            void Run()
+            {
+                if (tasks_.empty())
+                    return;
+                if (num_pending_ != tasks_.size())
+                {
+                    pending_.reset(new std::atomic<int>[tasks_.size()]);
+                    num_pending_ = tasks_.size();
+                }
+                for (size_t i = 0; i < tasks_.size(); i++)
+                    pending_[i].store(tasks_[i].num_deps, std::memory_order_relaxed);
+                Barrier done(tasks_.size());
+                for (size_t i = 0; i < tasks_.size(); i++)
+                {
+                    if (tasks_[i].num_deps == 0)
+                        Schedule(i, &done);
+                }
+                done.Wait();
+            }
+
+        private:
+            struct Task
+            {
+                std::function<void()> fn;
+                std::vector<int> successors;
+                int num_deps;
+            };
+
+            void Schedule(int id, Barrier* done)
+            {
+                pool_->Schedule([this, id, done]() { Execute(id, done); });
+            }
+
+            // The first successor made ready is run on the current worker, the others
+            // are pushed to its queue where idle workers can steal them.
+            void Execute(int id, Barrier* done)
+            {
+                while (id >= 0)
+                {
+                    tasks_[id].fn();
+                    int next = -1;
+                    for (int succ : tasks_[id].successors)
+                    {
+                        if (pending_[succ].fetch_sub(1, std::memory_order_acq_rel) != 1)
+                            continue;
+                        if (next < 0)
+                            next = succ;
+                        else
+                            Schedule(succ, done);
+                    }
+                    done->Notify();
+                    id = next;
+                }
+            }
+
+            concurrency::NumaAwareThreadPool* pool_;
+            std::vector<Task> tasks_;
+            std::unique_ptr<std::atomic<int>[]> pending_;
+            size_t num_pending_ = 0;
+        };
+    }
+}
+)"));
+    }
+}
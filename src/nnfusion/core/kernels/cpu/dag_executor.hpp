@@ -0,0 +1,13 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+#include "nnfusion/common/languageunit.hpp"
+
+namespace nnfusion
+{
+    namespace kernels
+    {
+        extern LanguageUnit_p dag_executor_header;
+    }
+}
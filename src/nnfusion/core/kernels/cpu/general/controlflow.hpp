@@ -0,0 +1,105 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+#include "../controlflow_emitter.hpp"
+
+namespace nnfusion
+{
+    namespace kernels
+    {
+        namespace cpu
+        {
+            // Runs the branch selected by *input0, both branches share the workspace.
+            class If : public ControlFlowEmitter
+            {
+            public:
+                If(shared_ptr<KernelContext> ctx);
+
+                LanguageUnit_p emit_function_body() override;
+
+            protected:
+                std::vector<TranslationUnit::Pointer> get_subgraphs() override;
+
+            private:
+                TranslationUnit::Pointer m_then_branch_tu;
+                TranslationUnit::Pointer m_else_branch_tu;
+                std::unordered_map<std::string, int> m_output_map;
+            };
+
+            // Runs the body *input0 times or until its condition output is false. The loop
+            // carried states ping-pong between the outputs and a copy in the workspace, so an
+            // iteration never reads a state written by itself.
+            class Loop : public ControlFlowEmitter
+            {
+            public:
+                Loop(shared_ptr<KernelContext> ctx);
+
+                LanguageUnit_p emit_function_body() override;
+
+            protected:
+                Loop(shared_ptr<KernelContext> ctx, int state_input_bias);
+                std::vector<TranslationUnit::Pointer> get_subgraphs() override;
+                // the loop statement, the body is emitted after it
+                virtual void emit_loop_begin(LanguageUnit& lu);
+
+                // the states are the inputs starting from this index, preceded by the input of
+                // the initial condition
+                int m_state_input_bias;
+                int m_cond_input;
+
+            private:
+                TranslationUnit::Pointer m_loop_body_tu;
+                std::unordered_map<std::string, int> m_output_map;
+                std::vector<size_t> m_state_offset;
+                size_t m_body_workspace_size;
+            };
+
+            // Runs the body while its condition is true, input0 is the initial condition.
+            class While : public Loop
+            {
+            public:
+                While(shared_ptr<KernelContext> ctx);
+
+            protected:
+                void emit_loop_begin(LanguageUnit& lu) override;
+            };
+
+            // Calls the body function recursively, each call takes a frame of the workspace
+            // for the tensors of the body.
+            class Recursion : public ControlFlowEmitter
+            {
+            public:
+                Recursion(shared_ptr<KernelContext> ctx);
+
+                LanguageUnit_p emit_function_body() override;
+
+                // the function of the body of the Recursion op named op_name
+                static std::string get_body_function_name(const std::string& op_name);
+
+            protected:
+                std::vector<TranslationUnit::Pointer> get_subgraphs() override;
+                LanguageUnit_p emit_subgraph_functions() override;
+
+            private:
+                TranslationUnit::Pointer m_body_tu;
+                std::unordered_map<std::string, int> m_output_map;
+                std::string m_body_function;
+                size_t m_frame_size;
+            };
+
+            // Recursive call of the body of the enclosing Recursion op, which is named by the
+            // "recursion_op" attribute of the node.
+            class FuncForward : public CpuKernelEmitter
+            {
+            public:
+                FuncForward(shared_ptr<KernelContext> ctx);
+
+                LanguageUnit_p emit_function_body() override;
+                LanguageUnit_p emit_dependency() override;
+
+                void update_context_from_gnode(std::shared_ptr<nnfusion::graph::GNode> gnode);
+            };
+        } // namespace cpu
+    }     // namespace kernels
+} // namespace nnfusion
@@ -0,0 +1,106 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "../cpu_kernel_emitter.hpp"
+#include "../cpu_langunit.hpp"
+
+namespace nnfusion
+{
+    namespace kernels
+    {
+        namespace cpu
+        {
+            // Copies a slice of input0 per index, the copies are split into one shard per thread.
+            class GatherV2 : public CpuKernelEmitter
+            {
+            public:
+                GatherV2(shared_ptr<KernelContext> ctx)
+                    : CpuKernelEmitter(ctx)
+                {
+                    m_intra_op_parallelism = true;
+                    auto generic_op =
+                        static_pointer_cast<nnfusion::op::GenericOp>(ctx->gnode->get_op_ptr());
+                    auto input_shape = ctx->inputs[0]->get_shape();
+                    int axis = generic_op->localOpConfig.getRoot()["axis"];
+                    axis += axis < 0 ? input_shape.size() : 0;
+                    NNFUSION_CHECK(axis < input_shape.size());
+
+                    outer_size = 1;
+                    slice_size = 1;
+                    for (int i = 0; i < axis; i++)
+                        outer_size *= input_shape[i];
+                    for (int i = axis + 1; i < input_shape.size(); i++)
+                        slice_size *= input_shape[i];
+                    gather_dim_size = input_shape[axis];
+                    indices_size = shape_size(ctx->inputs[1]->get_shape());
+                }
+
+                LanguageUnit_p emit_function_body() override
+                {
+                    LanguageUnit_p _lu(new LanguageUnit(get_function_name()));
+                    auto& lu = *_lu;
+
+                    // out-of-range indices give zeros like the CUDA kernel
+                    size_t min_slices =
+                        std::max<size_t>(1, 16384 / std::max<size_t>(1, slice_size));
+                    auto code = nnfusion::op::create_code_from_template(
+                        R"(
+const int64_t slices = @outer_size@ * @indices_size@;
+const int64_t min_slices_per_shard = @min_slices@;
+int num_shards = std::max(std::min(static_cast<int64_t>(thread_pool->NumThreads()),
+                                   slices / min_slices_per_shard),
+                          static_cast<int64_t>(1));
+const int64_t block_size = (slices + num_shards - 1) / num_shards;
+
+auto func = [&](int __rank__)
+{
+    const int64_t start = block_size * __rank__;
+    const int64_t end = std::min(start + block_size, slices);
+    for (int64_t i = start; i < end; ++i)
+    {
+        const int64_t outer = i / @indices_size@;
+        int64_t index = static_cast<int64_t>(input1[i % @indices_size@]);
+        index += index < 0 ? @gather_dim_size@ : 0;
+        @ElementType@* out = output0 + i * @slice_size@;
+        if (index < 0 || index >= @gather_dim_size@)
+            memset(out, 0, @slice_size@ * sizeof(@ElementType@));
+        else
+            memcpy(out,
+                   input0 + (outer * @gather_dim_size@ + index) * @slice_size@,
+                   @slice_size@ * sizeof(@ElementType@));
+    }
+};
+
+thread_pool->ParallelFor(num_shards, func);
+)",
+                        {{"outer_size", outer_size},
+                         {"indices_size", indices_size},
+                         {"gather_dim_size", gather_dim_size},
+                         {"slice_size", slice_size},
+                         {"min_slices", min_slices},
+                         {"ElementType", m_context->dtypes[0]}});
+                    lu << code;
+                    return _lu;
+                }
+
+                LanguageUnit_p emit_dependency() override
+                {
+                    LanguageUnit_p _lu(new LanguageUnit(get_function_name() + "_dep"));
+                    _lu->require(header::cstring);
+                    _lu->require(header::threadpool);
+                    return _lu;
+                }
+
+            private:
+                size_t outer_size, slice_size, gather_dim_size, indices_size;
+            };
+        } // namespace cpu
+    }     // namespace kernels
+} // namespace nnfusion
+
+using namespace nnfusion;
+using namespace nnfusion::kernels;
+
+REGISTER_KERNEL_EMITTER("GatherV2",                                                   // op_name
+                        Device(GENERIC_CPU).TypeConstraint(element::f32).Priority(2), // attrs
+                        cpu::GatherV2)
@@ -0,0 +1,52 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "controlflow.hpp"
+#include "nnfusion/core/operators/op_define/if.hpp"
+
+using namespace nnfusion;
+using namespace nnfusion::kernels;
+
+cpu::If::If(shared_ptr<KernelContext> ctx)
+    : ControlFlowEmitter(ctx)
+{
+    auto op = static_pointer_cast<op::If>(ctx->gnode->get_op_ptr());
+    NNFUSION_CHECK_NOT_NULLPTR(op);
+    m_then_branch_tu = op->get_then_branch_tu();
+    m_else_branch_tu = op->get_else_branch_tu();
+    NNFUSION_CHECK(m_then_branch_tu != nullptr && m_else_branch_tu != nullptr)
+        << "The branches of " << ctx->gnode->get_name() << " are not compiled.";
+    m_output_map = op->get_output_map();
+    allocate_workspace(
+        std::max(get_workspace_size(m_then_branch_tu), get_workspace_size(m_else_branch_tu)));
+}
+
+std::vector<TranslationUnit::Pointer> cpu::If::get_subgraphs()
+{
+    return {m_then_branch_tu, m_else_branch_tu};
+}
+
+LanguageUnit_p cpu::If::emit_function_body()
+{
+    LanguageUnit_p _lu(new LanguageUnit(get_function_name()));
+    auto& lu = *_lu;
+
+    // the output map holds the outputs of both branches
+    std::unordered_map<std::string, std::string> output_args;
+    for (auto& item : m_output_map)
+        output_args[item.first] = "output" + std::to_string(item.second);
+
+    lu << "if (*input0)\n";
+    lu.block_begin();
+    emit_subgraph(lu, m_then_branch_tu, {}, output_args, m_workspace->get_name());
+    lu.block_end();
+    lu << "else\n";
+    lu.block_begin();
+    emit_subgraph(lu, m_else_branch_tu, {}, output_args, m_workspace->get_name());
+    lu.block_end();
+    return _lu;
+}
+
+REGISTER_KERNEL_EMITTER("If",                                                         // op_name
+                        Device(GENERIC_CPU).TypeConstraint(element::f32).Priority(2), // attrs
+                        cpu::If)
@@ -0,0 +1,188 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "layer_norm.hpp"
+
+using namespace nnfusion;
+using namespace nnfusion::kernels;
+
+cpu::LayerNormBase::LayerNormBase(shared_ptr<KernelContext> ctx)
+    : CpuKernelEmitter(ctx)
+{
+    m_intra_op_parallelism = true;
+    auto generic_op = static_pointer_cast<nnfusion::op::GenericOp>(ctx->gnode->get_op_ptr());
+    m_epsilon = generic_op->localOpConfig.getRoot()["epsilon"];
+    m_rows = 0;
+    m_hidden_size = 0;
+}
+
+void cpu::LayerNormBase::emit_parallel_rows(LanguageUnit& lu, const std::string& body)
+{
+    // a shard takes at least 16k elements so that small inputs are not scattered
+    auto code = op::create_code_from_template(
+        R"(
+const int64_t rows = @rows@;
+const int64_t min_rows_per_shard = @min_rows@;
+int num_shards = std::max(std::min(static_cast<int64_t>(thread_pool->NumThreads()),
+                                   rows / min_rows_per_shard),
+                          static_cast<int64_t>(1));
+const int64_t block_size = (rows + num_shards - 1) / num_shards;
+
+auto func = [&](int __rank__)
+{
+    const int64_t start = block_size * __rank__;
+    const int64_t end = std::min(start + block_size, rows);
+    for (int64_t r = start; r < end; ++r)
+    {
+@body@
+    }
+};
+
+thread_pool->ParallelFor(num_shards, func);
+)",
+        {{"rows", m_rows},
+         {"min_rows", std::max<size_t>(1, 16384 / std::max<size_t>(1, m_hidden_size))},
+         {"body", body}});
+    lu << code;
+}
+
+LanguageUnit_p cpu::LayerNormBase::emit_dependency()
+{
+    LanguageUnit_p _lu(new LanguageUnit(get_function_name() + "_dep"));
+    _lu->require(header::cmath);
+    _lu->require(header::threadpool);
+    _lu->require(declaration::layer_norm_row);
+    return _lu;
+}
+
+cpu::LayerNorm::LayerNorm(shared_ptr<KernelContext> ctx)
+    : LayerNormBase(ctx)
+{
+    auto generic_op = static_pointer_cast<nnfusion::op::GenericOp>(ctx->gnode->get_op_ptr());
+    auto input_shape = ctx->inputs[0]->get_shape();
+    int axis = generic_op->localOpConfig.getRoot()["axis"];
+    axis += axis < 0 ? input_shape.size() : 0;
+    m_rows = 1;
+    m_hidden_size = 1;
+    for (int i = 0; i < axis; i++)
+        m_rows *= input_shape[i];
+    for (int i = axis; i < input_shape.size(); i++)
+        m_hidden_size *= input_shape[i];
+}
+
+LanguageUnit_p cpu::LayerNorm::emit_function_body()
+{
+    if (m_context->inputs[0]->get_element_type() != element::f32)
+        return nullptr;
+
+    LanguageUnit_p _lu(new LanguageUnit(get_function_name()));
+    auto& lu = *_lu;
+    auto output_mean = m_context->outputs.size() > 1 ? "output1 + r" : "nullptr";
+    auto output_inv_std = m_context->outputs.size() > 2 ? "output2 + r" : "nullptr";
+
+    emit_parallel_rows(
+        lu,
+        op::create_code_from_template(
+            "layer_norm_row(input0 + r * @n@, input1, input2, output0 + r * @n@, @n@, @epsilon@, "
+            "@mean@, @inv_std@);",
+            {{"n", m_hidden_size},
+             {"epsilon", m_epsilon},
+             {"mean", output_mean},
+             {"inv_std", output_inv_std}}));
+    return _lu;
+}
+
+cpu::SkipLayerNorm::SkipLayerNorm(shared_ptr<KernelContext> ctx)
+    : LayerNormBase(ctx)
+{
+    auto input_shape = ctx->inputs[0]->get_shape();
+    m_hidden_size = input_shape.back();
+    m_rows = shape_size(input_shape) / m_hidden_size;
+}
+
+LanguageUnit_p cpu::SkipLayerNorm::emit_function_body()
+{
+    if (m_context->inputs[0]->get_element_type() != element::f32)
+        return nullptr;
+
+    LanguageUnit_p _lu(new LanguageUnit(get_function_name()));
+    auto& lu = *_lu;
+    bool has_bias = m_context->inputs.size() > 4;
+
+    emit_parallel_rows(
+        lu,
+        op::create_code_from_template(
+            R"(const float* x = input0 + r * @n@;
+const float* skip = input1 + r * @n@;
+float* y = output0 + r * @n@;
+for (int i = 0; i < @n@; i++)
+    y[i] = x[i] + skip[i]@bias@;
+layer_norm_row(y, input2, input3, y, @n@, @epsilon@, nullptr, nullptr);)",
+            {{"n", m_hidden_size},
+             {"epsilon", m_epsilon},
+             {"bias", has_bias ? " + input4[i]" : ""}}));
+    return _lu;
+}
+
+cpu::EmbedLayerNorm::EmbedLayerNorm(shared_ptr<KernelContext> ctx)
+    : LayerNormBase(ctx)
+{
+    auto input_ids_shape = ctx->inputs[0]->get_shape();
+    m_batch_size = input_ids_shape[0];
+    m_sequence_length = input_ids_shape[1];
+    m_hidden_size = ctx->inputs[2]->get_shape()[1];
+    m_rows = m_batch_size * m_sequence_length;
+}
+
+LanguageUnit_p cpu::EmbedLayerNorm::emit_function_body()
+{
+    if (m_context->inputs[2]->get_element_type() != element::f32)
+        return nullptr;
+
+    LanguageUnit_p _lu(new LanguageUnit(get_function_name()));
+    auto& lu = *_lu;
+
+    // the mask index is the length of the leading non-zero mask of a sequence
+    if (m_context->inputs.size() > 7)
+    {
+        lu << op::create_code_from_template(
+            R"(for (int b = 0; b < @batch@; b++)
+{
+    int index = @seq@;
+    for (int s = 0; s < @seq@; s++)
+    {
+        if (input7[b * @seq@ + s] == 0)
+        {
+            index = s;
+            break;
+        }
+    }
+    output1[b] = index;
+}
+)",
+            {{"batch", m_batch_size}, {"seq", m_sequence_length}});
+    }
+
+    emit_parallel_rows(
+        lu,
+        op::create_code_from_template(
+            R"(const float* word = input2 + static_cast<int64_t>(input0[r]) * @n@;
+const float* position = input3 + (r % @seq@) * @n@;
+const float* segment = input4 + static_cast<int64_t>(input1[r]) * @n@;
+float* y = output0 + r * @n@;
+for (int i = 0; i < @n@; i++)
+    y[i] = word[i] + position[i] + segment[i];
+layer_norm_row(y, input5, input6, y, @n@, @epsilon@, nullptr, nullptr);)",
+            {{"n", m_hidden_size}, {"seq", m_sequence_length}, {"epsilon", m_epsilon}}));
+    return _lu;
+}
+
+REGISTER_KERNEL_EMITTER("LayerNorm",                                                  // op_name
+                        Device(GENERIC_CPU).TypeConstraint(element::f32).Priority(2), // attrs
+                        cpu::LayerNorm)
+REGISTER_KERNEL_EMITTER("SkipLayerNorm",                                              // op_name
+                        Device(GENERIC_CPU).TypeConstraint(element::f32).Priority(2), // attrs
+                        cpu::SkipLayerNorm)
+REGISTER_KERNEL_EMITTER("EmbedLayerNorm",                                             // op_name
+                        Device(GENERIC_CPU).TypeConstraint(element::f32).Priority(2), // attrs
+                        cpu::EmbedLayerNorm)
@@ -0,0 +1,63 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+#include "../cpu_kernel_emitter.hpp"
+#include "../cpu_langunit.hpp"
+
+namespace nnfusion
+{
+    namespace kernels
+    {
+        namespace cpu
+        {
+            // The rows are normalized by layer_norm_row(), split into one shard per thread.
+            class LayerNormBase : public CpuKernelEmitter
+            {
+            public:
+                LayerNormBase(shared_ptr<KernelContext> ctx);
+
+                LanguageUnit_p emit_dependency() override;
+
+            protected:
+                // body computes row r, it is run for the rows of a shard
+                void emit_parallel_rows(LanguageUnit& lu, const std::string& body);
+
+                size_t m_rows;
+                size_t m_hidden_size;
+                float m_epsilon;
+            };
+
+            class LayerNorm : public LayerNormBase
+            {
+            public:
+                LayerNorm(shared_ptr<KernelContext> ctx);
+
+                LanguageUnit_p emit_function_body() override;
+            };
+
+            // output0 = LayerNorm(input0 + input1 + bias), the optional bias is input4
+            class SkipLayerNorm : public LayerNormBase
+            {
+            public:
+                SkipLayerNorm(shared_ptr<KernelContext> ctx);
+
+                LanguageUnit_p emit_function_body() override;
+            };
+
+            // output0 = LayerNorm(word_embedding[input_ids] + position_embedding[position] +
+            // segment_embedding[segment_ids]), output1 is the mask index computed from input7
+            class EmbedLayerNorm : public LayerNormBase
+            {
+            public:
+                EmbedLayerNorm(shared_ptr<KernelContext> ctx);
+
+                LanguageUnit_p emit_function_body() override;
+
+            private:
+                size_t m_batch_size;
+                size_t m_sequence_length;
+            };
+        } // namespace cpu
+    }     // namespace kernels
+} // namespace nnfusion
@@ -0,0 +1,97 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "controlflow.hpp"
+#include "nnfusion/core/operators/op_define/loop.hpp"
+
+using namespace nnfusion;
+using namespace nnfusion::kernels;
+
+cpu::Loop::Loop(shared_ptr<KernelContext> ctx)
+    : Loop(ctx, 2)
+{
+}
+
+cpu::Loop::Loop(shared_ptr<KernelContext> ctx, int state_input_bias)
+    : ControlFlowEmitter(ctx)
+    , m_state_input_bias(state_input_bias)
+    , m_cond_input(state_input_bias - 1)
+{
+    auto op = static_pointer_cast<op::Loop>(ctx->gnode->get_op_ptr());
+    NNFUSION_CHECK_NOT_NULLPTR(op);
+    m_loop_body_tu = op->get_loop_body_tu();
+    NNFUSION_CHECK_NOT_NULLPTR(m_loop_body_tu) << "The body of " << ctx->gnode->get_name()
+                                               << " is not compiled.";
+    m_output_map = op->get_loop_output_map();
+
+    // the workspace of the body is followed by a buffer of each state
+    m_body_workspace_size = get_workspace_size(m_loop_body_tu);
+    size_t workspace_size = m_body_workspace_size;
+    for (auto output : m_context->outputs)
+    {
+        m_state_offset.push_back(workspace_size);
+        workspace_size += (output->size() + 63) / 64 * 64;
+    }
+    allocate_workspace(workspace_size);
+}
+
+std::vector<TranslationUnit::Pointer> cpu::Loop::get_subgraphs()
+{
+    return {m_loop_body_tu};
+}
+
+void cpu::Loop::emit_loop_begin(LanguageUnit& lu)
+{
+    lu << "for (int64_t i = 0; i < *input0 && cond; i++)\n";
+}
+
+LanguageUnit_p cpu::Loop::emit_function_body()
+{
+    LanguageUnit_p _lu(new LanguageUnit(get_function_name()));
+    auto& lu = *_lu;
+    auto workspace = m_workspace->get_name();
+
+    // iteration i reads state<k> and writes next<k>, which is output<k> or its buffer
+    std::map<int, std::string> input_args{{-1, "&i"}, {m_cond_input, "&cond"}};
+    lu << "char cond = *input" << m_cond_input << ";\n";
+    for (size_t k = 0; k < m_context->outputs.size(); k++)
+    {
+        auto type = m_context->outputs[k]->get_element_type().c_type_string();
+        lu << type << "* state" << k << " = input" << m_state_input_bias + k << ";\n";
+        lu << type << "* next" << k << " = output" << k << ";\n";
+        lu << type << "* buffer" << k << " = (" << type << "*)(" << workspace << " + "
+           << m_state_offset[k] << ");\n";
+        input_args[m_state_input_bias + k] = "state" + std::to_string(k);
+    }
+
+    // the first output of the body is the condition
+    std::unordered_map<std::string, std::string> output_args;
+    for (auto& item : m_output_map)
+    {
+        int index = item.second - 1;
+        output_args[item.first] = index == -1 ? "&cond" : "next" + std::to_string(index);
+    }
+
+    emit_loop_begin(lu);
+    lu.block_begin();
+    emit_subgraph(lu, m_loop_body_tu, input_args, output_args, workspace);
+    for (size_t k = 0; k < m_context->outputs.size(); k++)
+    {
+        lu << "state" << k << " = next" << k << ";\n";
+        lu << "next" << k << " = next" << k << " == output" << k << " ? buffer" << k
+           << " : output" << k << ";\n";
+    }
+    lu.block_end();
+
+    for (size_t k = 0; k < m_context->outputs.size(); k++)
+    {
+        lu << "if (state" << k << " != output" << k << ")\n";
+        lu << "    memcpy(output" << k << ", state" << k << ", "
+           << m_context->outputs[k]->size() << ");\n";
+    }
+    return _lu;
+}
+
+REGISTER_KERNEL_EMITTER("Loop",                                                       // op_name
+                        Device(GENERIC_CPU).TypeConstraint(element::f32).Priority(2), // attrs
+                        cpu::Loop)
@@ -0,0 +1,150 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "controlflow.hpp"
+#include "nnfusion/core/operators/op_define/recursion.hpp"
+
+using namespace nnfusion;
+using namespace nnfusion::kernels;
+
+DECLARE_int32(frecursive_max_depth);
+
+cpu::Recursion::Recursion(shared_ptr<KernelContext> ctx)
+    : ControlFlowEmitter(ctx)
+{
+    auto op = static_pointer_cast<op::Recursion>(ctx->gnode->get_op_ptr());
+    NNFUSION_CHECK_NOT_NULLPTR(op);
+    m_body_tu = op->get_body_tu();
+    NNFUSION_CHECK_NOT_NULLPTR(m_body_tu) << "The body of " << ctx->gnode->get_name()
+                                          << " is not compiled.";
+    m_output_map = op->get_output_map();
+    m_body_function = get_body_function_name(op->get_unique_name());
+
+    // a recursive call only forwards its own inputs
+    for (auto block : m_body_tu->program)
+    {
+        for (auto ins : *block)
+        {
+            if (ins->getGNode()->get_op_type() == "FuncForward")
+                NNFUSION_CHECK(ins->getGNode()->get_input_size() == m_context->inputs.size())
+                    << "The recursive call " << ins->getGNode()->get_name() << " of "
+                    << ctx->gnode->get_name() << " does not forward all the inputs.";
+        }
+    }
+
+    m_frame_size = get_workspace_size(m_body_tu);
+    allocate_workspace(m_frame_size * FLAGS_frecursive_max_depth);
+}
+
+std::string cpu::Recursion::get_body_function_name(const std::string& op_name)
+{
+    return "Recursion_" + op_name + "_body";
+}
+
+std::vector<TranslationUnit::Pointer> cpu::Recursion::get_subgraphs()
+{
+    return {m_body_tu};
+}
+
+LanguageUnit_p cpu::Recursion::emit_subgraph_functions()
+{
+    LanguageUnit_p _lu(new LanguageUnit(get_function_name() + "_subgraph_kernels"));
+    auto& lu = *_lu;
+
+    std::vector<std::string> params{"concurrency::ThreadPool* thread_pool"};
+    for (size_t i = 0; i < m_context->inputs.size(); i++)
+        params.push_back(m_context->inputs[i]->get_element_type().c_type_string() + "* input" +
+                         std::to_string(i));
+    for (size_t i = 0; i < m_context->outputs.size(); i++)
+        params.push_back(m_context->outputs[i]->get_element_type().c_type_string() + "* output" +
+                         std::to_string(i));
+    std::string signature = "static void " + m_body_function + "(" + join(params, ", ") + ")";
+
+    // the frames of the calls on a thread are stacked in the workspace
+    lu << "static thread_local char* " << m_body_function << "_frame = nullptr;\n";
+    lu << "static thread_local char* " << m_body_function << "_frame_end = nullptr;\n";
+    lu << signature << ";\n\n";
+    lu << ControlFlowEmitter::emit_subgraph_functions()->get_code();
+
+    std::unordered_map<std::string, std::string> output_args;
+    for (auto& item : m_output_map)
+        output_args[item.first] = "output" + std::to_string(item.second);
+
+    lu << signature << "\n";
+    lu.block_begin();
+    lu << "char* frame = " << m_body_function << "_frame;\n";
+    lu << "if (frame + " << m_frame_size << " > " << m_body_function << "_frame_end)\n";
+    lu << "    throw std::runtime_error(\"" << m_context->gnode->get_name()
+       << " recurses deeper than -frecursive_max_depth.\");\n";
+    lu << m_body_function << "_frame = frame + " << m_frame_size << ";\n";
+    emit_subgraph(lu, m_body_tu, {}, output_args, "frame");
+    lu << m_body_function << "_frame = frame;\n";
+    lu.block_end();
+    lu << "\n";
+    return _lu;
+}
+
+LanguageUnit_p cpu::Recursion::emit_function_body()
+{
+    LanguageUnit_p _lu(new LanguageUnit(get_function_name()));
+    auto& lu = *_lu;
+    auto workspace = m_workspace->get_name();
+
+    std::vector<std::string> args{"thread_pool"};
+    for (size_t i = 0; i < m_context->inputs.size(); i++)
+        args.push_back("input" + std::to_string(i));
+    for (size_t i = 0; i < m_context->outputs.size(); i++)
+        args.push_back("output" + std::to_string(i));
+
+    lu << m_body_function << "_frame = " << workspace << ";\n";
+    lu << m_body_function << "_frame_end = " << workspace << " + "
+       << m_frame_size * FLAGS_frecursive_max_depth << ";\n";
+    lu << m_body_function << "(" << join(args, ", ") << ");\n";
+    _lu->require(header::stdexcept);
+    return _lu;
+}
+
+cpu::FuncForward::FuncForward(shared_ptr<KernelContext> ctx)
+    : CpuKernelEmitter(ctx)
+{
+    m_intra_op_parallelism = true;
+}
+
+void cpu::FuncForward::update_context_from_gnode(std::shared_ptr<nnfusion::graph::GNode> gnode)
+{
+    // the inputs hoisted from the body are forwarded as well
+    m_context = std::make_shared<KernelContext>(gnode);
+    m_is_emitted = false;
+}
+
+LanguageUnit_p cpu::FuncForward::emit_function_body()
+{
+    LanguageUnit_p _lu(new LanguageUnit(get_function_name()));
+    auto& lu = *_lu;
+    auto recursion_op = (*m_context->gnode)["recursion_op"];
+    NNFUSION_CHECK(recursion_op.is_valid())
+        << m_context->gnode->get_name() << " is not in the body of a Recursion op.";
+
+    std::vector<std::string> args{"thread_pool"};
+    for (size_t i = 0; i < m_context->inputs.size(); i++)
+        args.push_back("input" + std::to_string(i));
+    for (size_t i = 0; i < m_context->outputs.size(); i++)
+        args.push_back("output" + std::to_string(i));
+    lu << Recursion::get_body_function_name(recursion_op.as<std::string>()) << "("
+       << join(args, ", ") << ");\n";
+    return _lu;
+}
+
+LanguageUnit_p cpu::FuncForward::emit_dependency()
+{
+    // the body function is declared ahead of the kernels of the body
+    LanguageUnit_p _lu(new LanguageUnit(get_function_name() + "_dep"));
+    return _lu;
+}
+
+REGISTER_KERNEL_EMITTER("Recursion",                                                  // op_name
+                        Device(GENERIC_CPU).TypeConstraint(element::f32).Priority(2), // attrs
+                        cpu::Recursion)
+REGISTER_KERNEL_EMITTER("FuncForward",                                                // op_name
+                        Device(GENERIC_CPU).TypeConstraint(element::f32).Priority(2), // attrs
+                        cpu::FuncForward)
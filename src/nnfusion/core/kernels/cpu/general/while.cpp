@@ -0,0 +1,21 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "controlflow.hpp"
+
+using namespace nnfusion;
+using namespace nnfusion::kernels;
+
+cpu::While::While(shared_ptr<KernelContext> ctx)
+    : Loop(ctx, 1)
+{
+}
+
+void cpu::While::emit_loop_begin(LanguageUnit& lu)
+{
+    lu << "for (int64_t i = 0; cond; i++)\n";
+}
+
+REGISTER_KERNEL_EMITTER("While",                                                      // op_name
+                        Device(GENERIC_CPU).TypeConstraint(element::f32).Priority(2), // attrs
+                        cpu::While)
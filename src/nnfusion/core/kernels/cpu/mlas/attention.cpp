@@ -0,0 +1,220 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "attention.hpp"
+#include "nnfusion/core/operators/generic_op/generic_op.hpp"
+
+using namespace nnfusion;
+using namespace nnfusion::kernels;
+
+cpu::AttentionMlas::AttentionMlas(shared_ptr<KernelContext> ctx)
+    : MlasKernelEmitter(ctx)
+{
+    auto generic_op = static_pointer_cast<nnfusion::op::GenericOp>(ctx->gnode->get_op_ptr());
+    auto& cfg = generic_op->localOpConfig.getRoot();
+    num_heads = cfg["num_heads"];
+    batch_size = cfg["batch_size"];
+    sequence_length = cfg["sequence_length"];
+    past_sequence_length = cfg["past_sequence_length"];
+    head_size = cfg["head_size"];
+    unidirectional = cfg["unidirectional"];
+
+    // the past keys and values only take part through the present output
+    NNFUSION_CHECK(past_sequence_length == 0 ||
+                   (m_context->inputs.size() > 2 && m_context->outputs.size() > 1))
+        << "Attention with past_sequence_length > 0 needs the past input and present output.";
+
+    size_t all_sequence_length = sequence_length + past_sequence_length;
+    scores_tensor = allocate_tensor(
+        Shape{batch_size * num_heads * sequence_length * all_sequence_length}, element::f32);
+
+    std::stringstream tag;
+    tag << "Mlas_attention"
+        << "_b" << batch_size << "_s" << sequence_length << "_p" << past_sequence_length << "_n"
+        << num_heads << "_h" << head_size << "_u" << unidirectional << "_i"
+        << m_context->inputs.size();
+    custom_tag = tag.str();
+}
+
+LanguageUnit_p cpu::AttentionMlas::emit_function_body()
+{
+    if (m_context->inputs[0]->get_element_type() != element::f32)
+        return nullptr;
+
+    LanguageUnit_p _lu(new LanguageUnit(get_function_name()));
+    auto& lu = *_lu;
+
+    size_t hidden_size = num_heads * head_size;
+    size_t all_sequence_length = sequence_length + past_sequence_length;
+    bool has_mask = m_context->inputs.size() > 1;
+    bool use_2d_mask = has_mask && m_context->inputs[1]->get_shape().size() == 2;
+    bool has_mask_start = has_mask && !use_2d_mask &&
+                          m_context->inputs[1]->get_shape()[0] > batch_size;
+    bool has_present = m_context->outputs.size() > 1;
+    bool has_past = m_context->inputs.size() > 2 && past_sequence_length > 0;
+
+    // K and V are gathered into the present output when it exists
+    std::string present;
+    if (has_present)
+    {
+        present = op::create_code_from_template(
+            R"(
+        float* present_k = output1 + bn * @present_size@;
+        float* present_v = output1 + @batches@ * @present_size@ + bn * @present_size@;@past@
+        for (int s = 0; s < @seq@; s++)
+        {
+            memcpy(present_k + @past_size@ + s * @H@, k + s * @ld_qkv@, @H@ * sizeof(float));
+            memcpy(present_v + @past_size@ + s * @H@, v + s * @ld_qkv@, @H@ * sizeof(float));
+        }
+        k = present_k;
+        v = present_v;
+        ld_kv = @H@;)",
+            {{"present_size", all_sequence_length * head_size},
+             {"past_size", past_sequence_length * head_size},
+             {"batches", batch_size * num_heads},
+             {"past",
+              has_past ? op::create_code_from_template(
+                             R"(
+        memcpy(present_k, input2 + bn * @past_size@, @past_size@ * sizeof(float));
+        memcpy(present_v,
+               input2 + @batches@ * @past_size@ + bn * @past_size@,
+               @past_size@ * sizeof(float));)",
+                             {{"past_size", past_sequence_length * head_size},
+                              {"batches", batch_size * num_heads}})
+                       : ""},
+             {"seq", sequence_length},
+             {"H", head_size},
+             {"ld_qkv", 3 * hidden_size}});
+    }
+
+    // masked scores are set to -inf, or get -10000 added for the 2D mask like the CUDA kernel
+    std::string mask_row;
+    if (use_2d_mask)
+    {
+        mask_row = op::create_code_from_template(
+            R"(
+            const int* mask = input1 + b * @all_seq@;
+            for (int j = 0; j < @all_seq@; j++)
+                p[j] += (mask[j] > 0 ? 0.0f : -10000.0f)@unidirectional@;)",
+            {{"all_seq", all_sequence_length},
+             {"unidirectional",
+              unidirectional ? " + (j > " + std::to_string(past_sequence_length) +
+                                   " + s ? -10000.0f : 0.0f)"
+                             : ""}});
+    }
+    else if (has_mask || unidirectional)
+    {
+        mask_row = op::create_code_from_template(
+            R"(
+            int row_end = end, head_end = 0;
+            if (@unidirectional@)
+            {
+                int end_unidirectional = @past_seq@ + s + 1;
+                if (end_unidirectional <= start)
+                    head_end = end_unidirectional;
+                else
+                    row_end = std::min(end, end_unidirectional);
+            }
+            for (int j = 0; j < @all_seq@; j++)
+                if (j >= head_end && (j < start || j >= row_end))
+                    p[j] = -INFINITY;)",
+            {{"all_seq", all_sequence_length},
+             {"past_seq", past_sequence_length},
+             {"unidirectional", unidirectional ? "true" : "false"}});
+    }
+
+    // a 1D mask holds the end, and optionally the start, of the attended positions
+    std::string mask_range;
+    if (has_mask && !use_2d_mask)
+    {
+        mask_range = op::create_code_from_template(
+            R"(
+        int start = @mask_start@;
+        int end = std::min(@all_seq@, input1[b]);
+        if (start >= end)
+        {
+            start = 0;
+            end = @all_seq@;
+        })",
+            {{"all_seq", all_sequence_length},
+             {"mask_start",
+              has_mask_start ? "std::max(0, input1[" + std::to_string(batch_size) + " + b])"
+                             : "0"}});
+    }
+    else if (unidirectional && !use_2d_mask)
+    {
+        mask_range = "\n        int start = 0, end = " + std::to_string(all_sequence_length) + ";";
+    }
+
+    auto code = op::create_code_from_template(
+        R"(
+const int64_t batches = @batches@;
+int num_shards = std::min(static_cast<int64_t>(thread_pool->NumThreads()), batches);
+const int64_t block_size = (batches + num_shards - 1) / num_shards;
+
+auto func = [&](int __rank__)
+{
+    const int64_t bn_end = std::min(block_size * (__rank__ + 1), batches);
+    for (int64_t bn = block_size * __rank__; bn < bn_end; ++bn)
+    {
+        const int64_t b = bn / @N@, n = bn % @N@;
+        const float* q = input0 + b * @seq@ * @ld_qkv@ + n * @H@;
+        const float* k = q + @hidden@;
+        const float* v = q + 2 * @hidden@;
+        int64_t ld_kv = @ld_qkv@;@present@@mask_range@
+        float* scores = @scores@ + bn * @seq@ * @all_seq@;
+        MlasGemm(CblasNoTrans, CblasTrans, @seq@, @all_seq@, @H@, @alpha@, q, @ld_qkv@, k, ld_kv,
+                 0.0f, scores, @all_seq@, nullptr);
+        for (int s = 0; s < @seq@; s++)
+        {
+            float* p = scores + s * @all_seq@;@mask_row@
+            float max_value = p[0];
+            for (int j = 1; j < @all_seq@; j++)
+                max_value = std::max(max_value, p[j]);
+            float sum = 0;
+            for (int j = 0; j < @all_seq@; j++)
+            {
+                p[j] = std::exp(p[j] - max_value);
+                sum += p[j];
+            }
+            const float inv_sum = 1.0f / sum;
+            for (int j = 0; j < @all_seq@; j++)
+                p[j] *= inv_sum;
+        }
+        MlasGemm(CblasNoTrans, CblasNoTrans, @seq@, @H@, @all_seq@, 1.0f, scores, @all_seq@, v,
+                 ld_kv, 0.0f, output0 + b * @seq@ * @hidden@ + n * @H@, @hidden@, nullptr);
+    }
+};
+
+thread_pool->ParallelFor(num_shards, func);
+)",
+        {{"batches", batch_size * num_heads},
+         {"N", num_heads},
+         {"H", head_size},
+         {"seq", sequence_length},
+         {"all_seq", all_sequence_length},
+         {"hidden", hidden_size},
+         {"ld_qkv", 3 * hidden_size},
+         {"alpha", 1.0f / std::sqrt(static_cast<float>(head_size))},
+         {"scores", scores_tensor->get_name()},
+         {"present", present},
+         {"mask_range", mask_range},
+         {"mask_row", mask_row}});
+
+    lu << code;
+    return _lu;
+}
+
+LanguageUnit_p cpu::AttentionMlas::emit_dependency()
+{
+    LanguageUnit_p _lu(new LanguageUnit(get_function_name() + "_dep"));
+    _lu->require(header::mlas);
+    _lu->require(header::cmath);
+    _lu->require(header::cstring);
+    return _lu;
+}
+
+REGISTER_KERNEL_EMITTER(
+    "Attention",                                                              // op_name
+    Device(GENERIC_CPU).TypeConstraint(element::f32).Tag("mlas").Priority(6), // attrs
+    cpu::AttentionMlas)
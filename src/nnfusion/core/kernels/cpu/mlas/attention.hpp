@@ -0,0 +1,31 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+#include "../cpu_kernel_emitter.hpp"
+
+namespace nnfusion
+{
+    namespace kernels
+    {
+        namespace cpu
+        {
+            // softmax(Q * K' / sqrt(head_size) + mask) * V of each batch and head, where Q, K and
+            // V are read in place from the BxSx3xNxH input. The heads are split into one shard
+            // per thread and each shard runs single-threaded MlasGemm.
+            class AttentionMlas : public MlasKernelEmitter
+            {
+            public:
+                AttentionMlas(shared_ptr<KernelContext> ctx);
+
+                LanguageUnit_p emit_function_body() override;
+                LanguageUnit_p emit_dependency() override;
+
+            private:
+                size_t num_heads, batch_size, sequence_length, past_sequence_length, head_size;
+                bool unidirectional;
+                shared_ptr<nnfusion::descriptor::Tensor> scores_tensor;
+            };
+        } // namespace cpu
+    }     // namespace kernels
+} // namespace nnfusion
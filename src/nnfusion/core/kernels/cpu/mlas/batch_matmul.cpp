@@ -13,28 +13,16 @@ cpu::BatchMatMulMlas::BatchMatMulMlas(shared_ptr<KernelContext> ctx)
     arg0_shape = nnfusion::Shape(ctx->inputs[0]->get_shape());
     arg1_shape = nnfusion::Shape(ctx->inputs[1]->get_shape());
 
-    std::stringstream tag;
-    tag << "Mlas_batch_matmul"
-        << "_i_" << join(arg0_shape, "_") << "_i_" << join(arg1_shape, "_");
-    custom_tag = tag.str();
-}
-
-LanguageUnit_p cpu::BatchMatMulMlas::emit_function_body()
-{
-    LanguageUnit_p _lu(new LanguageUnit(get_function_name()));
-    auto& lu = *_lu;
-
-    auto generic_op = static_pointer_cast<nnfusion::op::GenericOp>(m_context->gnode->get_op_ptr());
-
-    const nnfusion::Shape& input_shape_0 = m_context->inputs[0]->get_shape();
-    const nnfusion::Shape& input_shape_1 = m_context->inputs[1]->get_shape();
+    auto generic_op = static_pointer_cast<nnfusion::op::GenericOp>(ctx->gnode->get_op_ptr());
+    const nnfusion::Shape& input_shape_0 = arg0_shape;
+    const nnfusion::Shape& input_shape_1 = arg1_shape;
 
-    bool transA = generic_op->localOpConfig.getRoot()["adj_x"]["b"];
-    bool transB = generic_op->localOpConfig.getRoot()["adj_y"]["b"];
-    size_t A1 = 1LU;
+    transA = generic_op->localOpConfig.getRoot()["adj_x"]["b"];
+    transB = generic_op->localOpConfig.getRoot()["adj_y"]["b"];
+    batch = 1LU;
     for (int i = input_shape_0.size() - 3; i >= 0; --i)
-        A1 *= input_shape_0[i];
-    int A2, A3, A4, m, n, k, lda, stride_a, ldb, stride_b, ldc, stride_c;
+        batch *= input_shape_0[i];
+    int A2, A3, A4;
 
     if (!transA && !transB)
     {
@@ -64,6 +52,41 @@ LanguageUnit_p cpu::BatchMatMulMlas::emit_function_body()
         A4 = input_shape_1[input_shape_1.size() - 2];
         m = A2, n = A4, k = A3, lda = A2, ldb = input_shape_1[input_shape_1.size() - 1], ldc = A4;
     }
+    // a shard runs at most one gemm at a time and there are no more shards than batches
+    allocate_gemm_workspace(get_kernel_dtype(), transA, transB, m, n, k, lda, ldb, batch);
+
+    std::stringstream tag;
+    tag << "Mlas_batch_matmul"
+        << "_i_" << join(arg0_shape, "_") << "_i_" << join(arg1_shape, "_");
+    custom_tag = tag.str();
+}
+
+LanguageUnit_p cpu::BatchMatMulMlas::emit_function_body()
+{
+    LanguageUnit_p _lu(new LanguageUnit(get_function_name()));
+    auto& lu = *_lu;
+
+    const nnfusion::Shape& input_shape_0 = m_context->inputs[0]->get_shape();
+    const nnfusion::Shape& input_shape_1 = m_context->inputs[1]->get_shape();
+
+    // the batch offsets are only known inside the parallel loop
+    auto gemm = emit_gemm(get_kernel_dtype(),
+                          transA,
+                          transB,
+                          m,
+                          n,
+                          k,
+                          "a_batch",
+                          lda,
+                          "b_batch",
+                          ldb,
+                          "c_batch",
+                          ldc,
+                          "__rank__");
+    if (gemm.empty())
+    {
+        return nullptr;
+    }
     auto code = op::create_code_from_template(
         R"(
 int num_shards = static_cast<int64_t>(thread_pool->NumThreads());
@@ -77,7 +100,10 @@ if (block_size > batch)
 auto func = [&](int __rank__){
     for (int b_inner = 0; b_inner < block_size; ++b_inner){
         if (((((int)__rank__) * block_size) + b_inner) < batch){
-            MlasGemm(@transA@, @transB@, @m@, @n@, @k@, 1.0, input0+block_size*((int)__rank__)*@index0@+b_inner*@index0@, @lda@, input1+block_size*((int)__rank__)*@index1@+b_inner*@index1@, @ldb@, 0.0, output0+block_size*((int)__rank__)*@index2@+b_inner*@index2@, @ldc@, thread_pool);
+            auto a_batch = input0+block_size*((int)__rank__)*@index0@+b_inner*@index0@;
+            auto b_batch = input1+block_size*((int)__rank__)*@index1@+b_inner*@index1@;
+            auto c_batch = output0+block_size*((int)__rank__)*@index2@+b_inner*@index2@;
+            @gemm@
         }
     }
 };
@@ -85,20 +111,13 @@ auto func = [&](int __rank__){
 thread_pool->ParallelFor(num_shards, func);
          
 )",
-        {{"m", m},
-         {"n", n},
-         {"k", k},
-         {"lda", lda},
-         {"ldb", ldb},
-         {"ldc", ldc},
-         {"transA", transA ? "CblasTrans" : "CblasNoTrans"},
-         {"transB", transB ? "CblasTrans" : "CblasNoTrans"},
+        {{"gemm", gemm},
          {"index0",
           input_shape_0[input_shape_0.size() - 1] * input_shape_0[input_shape_0.size() - 2]},
          {"index1",
           input_shape_1[input_shape_1.size() - 1] * input_shape_1[input_shape_1.size() - 2]},
          {"index2", m * n},
-         {"batch", A1}});
+         {"batch", batch}});
 
     lu << code;
 
@@ -109,6 +128,8 @@ LanguageUnit_p cpu::BatchMatMulMlas::emit_dependency()
 {
     LanguageUnit_p _lu(new LanguageUnit(get_function_name() + "_dep"));
     _lu->require(header::mlas);
+    if (is_reduced_precision(get_kernel_dtype()))
+        _lu->require(header::reduced_precision);
 
     return _lu;
 }
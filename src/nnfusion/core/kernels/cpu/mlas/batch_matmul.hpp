@@ -21,6 +21,9 @@ namespace nnfusion
             private:
                 size_t reduction_axes;
                 nnfusion::Shape arg0_shape, arg1_shape;
+                bool transA, transB;
+                size_t batch;
+                int m, n, k, lda, ldb, ldc;
             };
         } // namespace cpu
     }     // namespace kernels
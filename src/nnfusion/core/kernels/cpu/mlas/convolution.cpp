@@ -23,6 +23,11 @@ cpu::ConvolutionMlas::ConvolutionMlas(shared_ptr<KernelContext> ctx)
     padding_above_diff = conv->get_padding_above();
     data_format = conv->get_data_format();
     dtype = ctx->outputs[0]->get_element_type().c_type_string();
+    // the f32 copies of the bf16 tensors MlasConv runs on
+    if (get_kernel_dtype() == "bfloat16")
+        staging = allocate_tensor(
+            Shape{shape_size(input_shape) + shape_size(filter_shape) + shape_size(output_shape)},
+            element::f32);
 
     std::stringstream tag;
     tag << "mlas_convolution_op_" << dtype << "_i" << join(input_shape, "_") << "_w"
@@ -38,6 +43,12 @@ LanguageUnit_p cpu::ConvolutionMlas::emit_function_body()
     {
         return nullptr;
     }
+    // bf16 tensors are widened to f32 around MlasConv, there is no int8 convolution in MLAS
+    auto conv_dtype = get_kernel_dtype();
+    if (conv_dtype != "float" && conv_dtype != "bfloat16")
+    {
+        return nullptr;
+    }
 
     bool is_deconvolution = false;
     for (auto a : data_dilation_strides)
@@ -89,6 +100,31 @@ LanguageUnit_p cpu::ConvolutionMlas::emit_function_body()
     size_t output_height = output_shape[2];
     size_t output_width = output_shape[3];
 
+    std::string input = "input0", filter = "input1", output = "output0", widen, narrow;
+    if (conv_dtype == "bfloat16")
+    {
+        size_t input_size = shape_size(input_shape);
+        size_t filter_size = shape_size(filter_shape);
+        size_t output_size = shape_size(output_shape);
+        input = "input_f32";
+        filter = "filter_f32";
+        output = "output_f32";
+        widen = op::create_code_from_template(
+            R"(float* input_f32 = @staging@;
+float* filter_f32 = @staging@ + @input_size@;
+float* output_f32 = @staging@ + @input_size@ + @filter_size@;
+nnfusion::cpu::bf16_to_f32(input0, input_f32, @input_size@);
+nnfusion::cpu::bf16_to_f32(input1, filter_f32, @filter_size@);
+)",
+            {{"staging", staging->get_name()},
+             {"input_size", input_size},
+             {"filter_size", filter_size}});
+        narrow = op::create_code_from_template(
+            R"(nnfusion::cpu::f32_to_bf16(output_f32, output0, @output_size@);
+)",
+            {{"output_size", output_size}});
+    }
+
     auto code = op::create_code_from_template(
         R"(
 int64_t batch_count = @batch_count@;
@@ -140,17 +176,17 @@ MlasConvPrepare(&parameters,
                 thread_pool);
 
 float* working_buffer = new float[working_buffer_size];
-
+@widen@
 MlasConv(&parameters,
-         input0,
-         input1,
+         @input@,
+         @filter@,
          nullptr,
          working_buffer,
-         output0,
+         @output@,
          thread_pool);
 
 delete[] working_buffer;
-
+@narrow@
 )",
         {{"batch_count", batch_count},
          {"input_channels", input_channels},
@@ -168,7 +204,12 @@ delete[] working_buffer;
          {"stride_height", stride_height},
          {"stride_width", stride_width},
          {"output_height", output_height},
-         {"output_width", output_width}});
+         {"output_width", output_width},
+         {"input", input},
+         {"filter", filter},
+         {"output", output},
+         {"widen", widen},
+         {"narrow", narrow}});
 
     lu << code;
 
@@ -179,6 +220,8 @@ LanguageUnit_p cpu::ConvolutionMlas::emit_dependency()
 {
     LanguageUnit_p _lu(new LanguageUnit(get_function_name() + "_dep"));
     _lu->require(header::mlas);
+    if (is_reduced_precision(get_kernel_dtype()))
+        _lu->require(header::reduced_precision);
 
     return _lu;
 }
@@ -24,6 +24,7 @@ namespace nnfusion
                     data_dilation_strides;
                 nnfusion::CoordinateDiff padding_below_diff, padding_above_diff;
                 string dtype, data_format;
+                shared_ptr<nnfusion::descriptor::Tensor> staging;
             };
         } // namespace cpu
     }     // namespace kernels
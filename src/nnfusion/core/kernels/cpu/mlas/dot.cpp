@@ -15,27 +15,37 @@ cpu::DotMlas::DotMlas(shared_ptr<KernelContext> ctx)
     arg0_shape = nnfusion::Shape(ctx->inputs[0]->get_shape());
     arg1_shape = nnfusion::Shape(ctx->inputs[1]->get_shape());
 
+    if (arg0_shape.size() == 2 && arg1_shape.size() == 2 && reduction_axes == 1 &&
+        get_kernel_dtype() == "float")
+    {
+        bool trans_B = dot_op->get_transpose_B();
+        size_t K = dot_op->get_transpose_A() ? arg0_shape[0] : arg0_shape[1];
+        size_t N = trans_B ? arg1_shape[0] : arg1_shape[1];
+        packed_weight = allocate_packed_weight(1, trans_B, N, K, N);
+    }
+
+    // the bf16 and int8 gemms stage their operands in a temp buffer
+    size_t M, N, K;
+    if (get_kernel_dtype() != "float" && get_gemm_size(M, N, K))
+    {
+        bool trans_A = dot_op->get_transpose_A(), trans_B = dot_op->get_transpose_B();
+        allocate_gemm_workspace(
+            get_kernel_dtype(), trans_A, trans_B, M, N, K, trans_A ? M : K, trans_B ? K : N);
+    }
+
     std::stringstream tag;
     tag << "Mlas"
         << "_r_" << reduction_axes << "_i_" << join(arg0_shape, "_") << "_i_"
-        << join(arg1_shape, "_");
+        << join(arg1_shape, "_") << (packed_weight ? "_packed" : "");
     custom_tag = tag.str();
 }
 
-LanguageUnit_p cpu::DotMlas::emit_function_body()
+bool cpu::DotMlas::get_gemm_size(size_t& M, size_t& N, size_t& K)
 {
-    LanguageUnit_p _lu(new LanguageUnit(get_function_name()));
-    auto& lu = *_lu;
-
     auto gemm = static_pointer_cast<nnfusion::op::Dot>(m_context->gnode->get_op_ptr());
     auto trans_A = gemm->get_transpose_A();
     auto trans_B = gemm->get_transpose_B();
 
-    std::string trans_A_str = (trans_A) ? "CblasTrans" : "CblasNoTrans";
-    std::string trans_B_str = (trans_B) ? "CblasTrans" : "CblasNoTrans";
-
-    size_t M, K, N;
-
     if (arg0_shape.empty() || arg1_shape.empty())
     {
         M = (arg0_shape.empty()) ? 1 : nnfusion::shape_size(arg0_shape);
@@ -77,11 +87,31 @@ LanguageUnit_p cpu::DotMlas::emit_function_body()
             NNFUSION_CHECK_FAIL() << nnfusion::join(arg_vec) << " with "
                                   << nnfusion::join(shape_vec) << " respectively, at Node "
                                   << m_context->gnode->get_name() << ", do not match for dot op."
-                                  << "transpose_A: " << trans_A_str
-                                  << ", transpose_B: " << trans_B_str;
+                                  << "transpose_A: " << (trans_A ? "CblasTrans" : "CblasNoTrans")
+                                  << ", transpose_B: " << (trans_B ? "CblasTrans" : "CblasNoTrans");
         }
     }
     else
+    {
+        return false;
+    }
+    return true;
+}
+
+LanguageUnit_p cpu::DotMlas::emit_function_body()
+{
+    LanguageUnit_p _lu(new LanguageUnit(get_function_name()));
+    auto& lu = *_lu;
+
+    auto dtype = get_kernel_dtype();
+    auto gemm = static_pointer_cast<nnfusion::op::Dot>(m_context->gnode->get_op_ptr());
+    auto trans_A = gemm->get_transpose_A();
+    auto trans_B = gemm->get_transpose_B();
+
+    std::string trans_A_str = (trans_A) ? "CblasTrans" : "CblasNoTrans";
+
+    size_t M, K, N;
+    if (!get_gemm_size(M, N, K))
     {
         return nullptr;
     }
@@ -90,14 +120,30 @@ LanguageUnit_p cpu::DotMlas::emit_function_body()
     size_t ldb = (trans_B) ? K : N;
     size_t ldc = N;
 
-    lu << "MlasGemm(" << ((trans_A) ? "CblasTrans, " : "CblasNoTrans, ")
-       << ((trans_B) ? "CblasTrans, " : "CblasNoTrans, ") << M << ", " << N << ", " << K << ", "
-       << "1.0, "
-       << "input0, " << lda << ", "
-       << "input1, " << ldb << ", "
-       << "0.0, "
-       << "output0, " << ldc << ", "
-       << "thread_pool);";
+    std::string code;
+    if (packed_weight)
+    {
+        code = op::create_code_from_template(
+            "MlasGemm(@trans_A@, @M@, @N@, @K@, 1.0, input0, @lda@, @packed@, 0.0, output0, "
+            "@ldc@, thread_pool);\n",
+            {{"trans_A", trans_A_str},
+             {"M", M},
+             {"N", N},
+             {"K", K},
+             {"lda", lda},
+             {"packed", packed_weight->get_name()},
+             {"ldc", ldc}});
+    }
+    else
+    {
+        code = emit_gemm(
+            dtype, trans_A, trans_B, M, N, K, "input0", lda, "input1", ldb, "output0", ldc);
+    }
+    if (code.empty())
+    {
+        return nullptr;
+    }
+    lu << code;
 
     return _lu;
 }
@@ -106,6 +152,8 @@ LanguageUnit_p cpu::DotMlas::emit_dependency()
 {
     LanguageUnit_p _lu(new LanguageUnit(get_function_name() + "_dep"));
     _lu->require(header::mlas);
+    if (is_reduced_precision(get_kernel_dtype()))
+        _lu->require(header::reduced_precision);
 
     return _lu;
 }
@@ -19,8 +19,12 @@ namespace nnfusion
                 LanguageUnit_p emit_dependency() override;
 
             private:
+                // the gemm computing the dot, false if MLAS does not support it
+                bool get_gemm_size(size_t& M, size_t& N, size_t& K);
+
                 size_t reduction_axes;
                 nnfusion::Shape arg0_shape, arg1_shape;
+                shared_ptr<nnfusion::descriptor::Tensor> packed_weight;
             };
         } // namespace cpu
     }     // namespace kernels
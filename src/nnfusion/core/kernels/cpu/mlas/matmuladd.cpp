@@ -0,0 +1,147 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "matmuladd.hpp"
+#include "nnfusion/core/operators/generic_op/generic_op.hpp"
+
+using namespace nnfusion;
+using namespace nnfusion::kernels;
+
+cpu::MatMulAddMlas::MatMulAddMlas(shared_ptr<KernelContext> ctx)
+    : MlasKernelEmitter(ctx)
+{
+    auto generic_op = static_pointer_cast<nnfusion::op::GenericOp>(ctx->gnode->get_op_ptr());
+    auto& cfg = generic_op->localOpConfig.getRoot();
+    trans_A = cfg["trans_A"];
+    trans_B = cfg["trans_B"];
+    if (cfg.find("activation") != cfg.end())
+        activation = cfg["activation"];
+
+    A_shape = nnfusion::Shape(ctx->inputs[0]->get_shape());
+    B_shape = nnfusion::Shape(ctx->inputs[1]->get_shape());
+    C_shape = nnfusion::Shape(ctx->inputs[2]->get_shape());
+    M = trans_A ? A_shape[1] : A_shape[0];
+    K = trans_A ? A_shape[0] : A_shape[1];
+    N = trans_B ? B_shape[0] : B_shape[1];
+
+    // a tile of 32 x 128 floats stays in L1/L2 between the gemm and the epilogue
+    tile_m = std::min<size_t>(M, 32);
+    tile_n = std::min<size_t>(N, 128);
+    if (get_kernel_dtype() == "float")
+        packed_weight = allocate_packed_weight(1, trans_B, N, K, tile_n);
+
+    std::stringstream tag;
+    tag << "Mlas_matmuladd"
+        << "_t" << trans_A << trans_B << "_i_" << join(A_shape, "_") << "_i_"
+        << join(B_shape, "_") << "_i_" << join(C_shape, "_") << "_" << activation
+        << (packed_weight ? "_packed" : "");
+    custom_tag = tag.str();
+}
+
+LanguageUnit_p cpu::MatMulAddMlas::emit_function_body()
+{
+    if (get_kernel_dtype() != "float")
+        return nullptr;
+
+    std::string activation_code;
+    if (activation.empty())
+        activation_code = "x";
+    else if (activation == "relu")
+        activation_code = "std::max(x, 0.0f)";
+    else if (activation == "gelu")
+        activation_code = "0.5f * x * (1.0f + std::erf(x * 0.70710678f))";
+    else
+        return nullptr;
+
+    LanguageUnit_p _lu(new LanguageUnit(get_function_name()));
+    auto& lu = *_lu;
+
+    std::string gemm;
+    if (packed_weight)
+    {
+        gemm = op::create_code_from_template(
+            R"(MlasGemm(@trans_A@, rows, cols, @K@, 1.0f, input0 + @a_offset@, @lda@,
+                 @packed@ + n0 * @K@, 0.0f, c, @N@, nullptr);)",
+            {{"trans_A", trans_A ? "CblasTrans" : "CblasNoTrans"},
+             {"K", K},
+             {"N", N},
+             {"a_offset", trans_A ? "m0" : "m0 * " + std::to_string(K)},
+             {"lda", trans_A ? M : K},
+             {"packed", packed_weight->get_name()}});
+    }
+    else
+    {
+        gemm = op::create_code_from_template(
+            R"(MlasGemm(@trans_A@, @trans_B@, rows, cols, @K@, 1.0f, input0 + @a_offset@, @lda@,
+                 input1 + @b_offset@, @ldb@, 0.0f, c, @N@, nullptr);)",
+            {{"trans_A", trans_A ? "CblasTrans" : "CblasNoTrans"},
+             {"trans_B", trans_B ? "CblasTrans" : "CblasNoTrans"},
+             {"K", K},
+             {"N", N},
+             {"a_offset", trans_A ? "m0" : "m0 * " + std::to_string(K)},
+             {"b_offset", trans_B ? "n0 * " + std::to_string(K) : "n0"},
+             {"lda", trans_A ? M : K},
+             {"ldb", trans_B ? K : N}});
+    }
+
+    auto code = op::create_code_from_template(
+        R"(
+const int64_t tiles_n = @tiles_n@;
+const int64_t tiles = @tiles_m@ * tiles_n;
+int num_shards = std::min(static_cast<int64_t>(thread_pool->NumThreads()), tiles);
+const int64_t block_size = (tiles + num_shards - 1) / num_shards;
+
+auto func = [&](int __rank__)
+{
+    const int64_t tile_end = std::min(block_size * (__rank__ + 1), tiles);
+    for (int64_t tile = block_size * __rank__; tile < tile_end; ++tile)
+    {
+        const int64_t m0 = tile / tiles_n * @tile_m@;
+        const int64_t n0 = tile % tiles_n * @tile_n@;
+        const int64_t rows = std::min<int64_t>(@tile_m@, @M@ - m0);
+        const int64_t cols = std::min<int64_t>(@tile_n@, @N@ - n0);
+        float* c = output0 + m0 * @N@ + n0;
+        @gemm@
+        for (int64_t i = 0; i < rows; i++)
+        {
+            float* y = c + i * @N@;
+            const float* bias = @bias@;
+            for (int64_t j = 0; j < cols; j++)
+            {
+                const float x = y[j] + bias[j];
+                y[j] = @activation@;
+            }
+        }
+    }
+};
+
+thread_pool->ParallelFor(num_shards, func);
+)",
+        {{"tiles_m", (M + tile_m - 1) / tile_m},
+         {"tiles_n", (N + tile_n - 1) / tile_n},
+         {"tile_m", tile_m},
+         {"tile_n", tile_n},
+         {"M", M},
+         {"N", N},
+         {"gemm", gemm},
+         {"bias",
+          C_shape.size() == 1 ? "input2 + n0"
+                              : "input2 + (m0 + i) * " + std::to_string(N) + " + n0"},
+         {"activation", activation_code}});
+
+    lu << code;
+    return _lu;
+}
+
+LanguageUnit_p cpu::MatMulAddMlas::emit_dependency()
+{
+    LanguageUnit_p _lu(new LanguageUnit(get_function_name() + "_dep"));
+    _lu->require(header::mlas);
+    _lu->require(header::cmath);
+    return _lu;
+}
+
+REGISTER_KERNEL_EMITTER(
+    "MatMulAdd",                                                              // op_name
+    Device(GENERIC_CPU).TypeConstraint(element::f32).Tag("mlas").Priority(6), // attrs
+    cpu::MatMulAddMlas)
@@ -0,0 +1,32 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+#include "../cpu_kernel_emitter.hpp"
+
+namespace nnfusion
+{
+    namespace kernels
+    {
+        namespace cpu
+        {
+            // act(A * B + C) computed tile by tile, each tile adds C and applies the activation
+            // right after its MlasGemm while it is still in cache. C is a matrix or a row bias.
+            class MatMulAddMlas : public MlasKernelEmitter
+            {
+            public:
+                MatMulAddMlas(shared_ptr<KernelContext> ctx);
+
+                LanguageUnit_p emit_function_body() override;
+                LanguageUnit_p emit_dependency() override;
+
+            private:
+                bool trans_A, trans_B;
+                size_t M, N, K, tile_m, tile_n;
+                std::string activation;
+                nnfusion::Shape A_shape, B_shape, C_shape;
+                shared_ptr<nnfusion::descriptor::Tensor> packed_weight;
+            };
+        } // namespace cpu
+    }     // namespace kernels
+} // namespace nnfusion
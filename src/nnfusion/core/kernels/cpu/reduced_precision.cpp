@@ -0,0 +1,229 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "reduced_precision.hpp"
+
+namespace nnfusion
+{
+    namespace kernels
+    {
+        LanguageUnit_p reduced_precision_header = LanguageUnit_p(new LanguageUnit(
+            "reduced_precision.h",
+            R"(
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <immintrin.h>
+
+namespace nnfusion
+{
+    namespace cpu
+    {
+        // round to nearest even, nan stays a quiet nan
+        inline uint16_t f32_to_bf16_bits(float f)
+        {
+            uint32_t x;
+            memcpy(&x, &f, sizeof(x));
+            if ((x & 0x7fffffff) > 0x7f800000)
+                return 0x7fc0;
+            return (x + 0x7fff + ((x >> 16) & 1)) >> 16;
+        }
+
+        inline float bf16_bits_to_f32(uint16_t b)
+        {
+            uint32_t x = uint32_t(b) << 16;
+            float f;
+            memcpy(&f, &x, sizeof(f));
+            return f;
+        }
+    }
+}
+
+// storage type of element::bf16, arithmetic is done in float
+struct bfloat16
+{
+    uint16_t value;
+
+    bfloat16() = default;
+    bfloat16(float f)
+        : value(nnfusion::cpu::f32_to_bf16_bits(f))
+    {
+    }
+    operator float() const { return nnfusion::cpu::bf16_bits_to_f32(value); }
+};
+
+namespace nnfusion
+{
+    namespace cpu
+    {
+        // Bulk converts of the gemm operands, written to be vectorized by the compiler.
+        inline void bf16_to_f32(const bfloat16* src, float* dst, size_t n)
+        {
+            const uint16_t* s = reinterpret_cast<const uint16_t*>(src);
+            uint32_t* d = reinterpret_cast<uint32_t*>(dst);
+            for (size_t i = 0; i < n; i++)
+                d[i] = uint32_t(s[i]) << 16;
+        }
+
+        inline void f32_to_bf16(const float* src, bfloat16* dst, size_t n)
+        {
+            const uint32_t* s = reinterpret_cast<const uint32_t*>(src);
+            uint16_t* d = reinterpret_cast<uint16_t*>(dst);
+            for (size_t i = 0; i < n; i++)
+            {
+                uint32_t x = s[i];
+                uint32_t r = (x + 0x7fff + ((x >> 16) & 1)) >> 16;
+                d[i] = (x & 0x7fffffff) > 0x7f800000 ? 0x7fc0 : r;
+            }
+        }
+
+        inline void bf16_to_f32(const bfloat16* src,
+                                size_t ld_src,
+                                float* dst,
+                                size_t ld_dst,
+                                size_t rows,
+                                size_t cols)
+        {
+            for (size_t r = 0; r < rows; r++)
+                bf16_to_f32(src + r * ld_src, dst + r * ld_dst, cols);
+        }
+
+        inline void f32_to_bf16(const float* src,
+                                size_t ld_src,
+                                bfloat16* dst,
+                                size_t ld_dst,
+                                size_t rows,
+                                size_t cols)
+        {
+            for (size_t r = 0; r < rows; r++)
+                f32_to_bf16(src + r * ld_src, dst + r * ld_dst, cols);
+        }
+
+        // the operands of the u8u8 gemm, used with a zero point of 128
+        inline void s8_to_u8(const int8_t* src, uint8_t* dst, size_t n)
+        {
+            for (size_t i = 0; i < n; i++)
+                dst[i] = uint8_t(src[i]) ^ 0x80;
+        }
+
+        // wraps around like int8 arithmetic does
+        inline void s32_to_s8(const int32_t* src, int8_t* dst, size_t n)
+        {
+            for (size_t i = 0; i < n; i++)
+                dst[i] = int8_t(uint32_t(src[i]) & 0xff);
+        }
+
+        // the scalar of store_s8_*, truncated toward zero and wrapped around like the vectors,
+        // so the tail of a simd loop gets the same elements as the vector body
+        inline int8_t f32_to_s8(float f)
+        {
+            return int8_t(uint32_t(_mm_cvttss_si32(_mm_set_ss(f))) & 0xff);
+        }
+
+        // Vector loads and stores of the simd elementwise kernels, one set per ISA.
+        inline __m128 load_bf16_sse2(const bfloat16* p)
+        {
+            __m128i x = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+            return _mm_castsi128_ps(_mm_unpacklo_epi16(_mm_setzero_si128(), x));
+        }
+
+        inline void store_bf16_sse2(bfloat16* p, __m128 v)
+        {
+            __m128i x = _mm_castps_si128(v);
+            __m128i lsb = _mm_and_si128(_mm_srli_epi32(x, 16), _mm_set1_epi32(1));
+            __m128i r = _mm_add_epi32(_mm_add_epi32(x, _mm_set1_epi32(0x7fff)), lsb);
+            r = _mm_srli_epi32(r, 16);
+            __m128i nan = _mm_castps_si128(_mm_cmpunord_ps(v, v));
+            r = _mm_or_si128(_mm_and_si128(nan, _mm_set1_epi32(0x7fc0)), _mm_andnot_si128(nan, r));
+            // sign extend so that the saturating pack keeps the 16 bits
+            r = _mm_srai_epi32(_mm_slli_epi32(r, 16), 16);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_packs_epi32(r, r));
+        }
+
+        inline __m128 load_s8_sse2(const int8_t* p)
+        {
+            int32_t bytes;
+            memcpy(&bytes, p, sizeof(bytes));
+            __m128i x = _mm_cvtsi32_si128(bytes);
+            x = _mm_unpacklo_epi16(_mm_unpacklo_epi8(x, x), _mm_unpacklo_epi8(x, x));
+            return _mm_cvtepi32_ps(_mm_srai_epi32(x, 24));
+        }
+
+        inline void store_s8_sse2(int8_t* p, __m128 v)
+        {
+            __m128i x = _mm_and_si128(_mm_cvttps_epi32(v), _mm_set1_epi32(0xff));
+            x = _mm_packs_epi32(x, x);
+            int32_t bytes = _mm_cvtsi128_si32(_mm_packus_epi16(x, x));
+            memcpy(p, &bytes, sizeof(bytes));
+        }
+
+        __attribute__((target("avx2"))) inline __m256 load_bf16_avx2(const bfloat16* p)
+        {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_cvtepu16_epi32(x), 16));
+        }
+
+        __attribute__((target("avx2"))) inline void store_bf16_avx2(bfloat16* p, __m256 v)
+        {
+            __m256i x = _mm256_castps_si256(v);
+            __m256i lsb = _mm256_and_si256(_mm256_srli_epi32(x, 16), _mm256_set1_epi32(1));
+            __m256i r = _mm256_add_epi32(_mm256_add_epi32(x, _mm256_set1_epi32(0x7fff)), lsb);
+            r = _mm256_srli_epi32(r, 16);
+            __m256i nan = _mm256_castps_si256(_mm256_cmp_ps(v, v, _CMP_UNORD_Q));
+            r = _mm256_blendv_epi8(r, _mm256_set1_epi32(0x7fc0), nan);
+            __m128i packed =
+                _mm_packus_epi32(_mm256_castsi256_si128(r), _mm256_extracti128_si256(r, 1));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(p), packed);
+        }
+
+        __attribute__((target("avx2"))) inline __m256 load_s8_avx2(const int8_t* p)
+        {
+            __m128i x = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+            return _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(x));
+        }
+
+        __attribute__((target("avx2"))) inline void store_s8_avx2(int8_t* p, __m256 v)
+        {
+            __m256i x = _mm256_and_si256(_mm256_cvttps_epi32(v), _mm256_set1_epi32(0xff));
+            x = _mm256_packus_epi16(_mm256_packs_epi32(x, x), _mm256_packs_epi32(x, x));
+            __m128i packed =
+                _mm_unpacklo_epi32(_mm256_castsi256_si128(x), _mm256_extracti128_si256(x, 1));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(p), packed);
+        }
+
+        __attribute__((target("avx512f"))) inline __m512 load_bf16_avx512(const bfloat16* p)
+        {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            return _mm512_castsi512_ps(_mm512_slli_epi32(_mm512_cvtepu16_epi32(x), 16));
+        }
+
+        __attribute__((target("avx512f"))) inline void store_bf16_avx512(bfloat16* p, __m512 v)
+        {
+            __m512i x = _mm512_castps_si512(v);
+            __m512i lsb = _mm512_and_si512(_mm512_srli_epi32(x, 16), _mm512_set1_epi32(1));
+            __m512i r = _mm512_add_epi32(_mm512_add_epi32(x, _mm512_set1_epi32(0x7fff)), lsb);
+            r = _mm512_srli_epi32(r, 16);
+            r = _mm512_mask_mov_epi32(
+                r, _mm512_cmp_ps_mask(v, v, _CMP_UNORD_Q), _mm512_set1_epi32(0x7fc0));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), _mm512_cvtepi32_epi16(r));
+        }
+
+        __attribute__((target("avx512f"))) inline __m512 load_s8_avx512(const int8_t* p)
+        {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            return _mm512_cvtepi32_ps(_mm512_cvtepi8_epi32(x));
+        }
+
+        __attribute__((target("avx512f"))) inline void store_s8_avx512(int8_t* p, __m512 v)
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(p),
+                             _mm512_cvtepi32_epi8(_mm512_cvttps_epi32(v)));
+        }
+    }
+}
+)"));
+    }
+}
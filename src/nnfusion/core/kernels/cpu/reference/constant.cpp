@@ -9,6 +9,8 @@
 #include "nnfusion/core/kernels/kernel_registration.hpp"
 #include "nnfusion/core/operators/generic_op/generic_op.hpp"
 
+DECLARE_bool(fcpu_constant_mmap);
+
 namespace nnfusion
 {
     namespace kernels
@@ -31,16 +33,30 @@ namespace nnfusion
                     custom_tag = tag.str();
                 }
 
+                // the data is packed into the mmap-ed constant blob by the memory allocator
+                bool is_eliminative() override
+                {
+                    return FLAGS_fcpu_constant_mmap &&
+                           m_context->outputs[0]->get_group() == "constant";
+                }
+
                 LanguageUnit_p emit_function_body() override
                 {
-                    nnfusion::codegen::create_folder(folder);
                     const_name = m_context->outputs[0]->get_name();
+                    LanguageUnit_p _lu(new LanguageUnit(get_function_name()));
+                    auto& writer = *_lu;
+                    // only tensors placed into the blob are loaded by cpu_init()
+                    if (m_context->outputs[0]->get_group() == "constant")
+                    {
+                        writer << "// " << const_name << " is mapped from the constant blob\n";
+                        return _lu;
+                    }
+
+                    nnfusion::codegen::create_folder(folder);
                     ofstream bin_file(folder + const_name + ".bin", ios::out | ios::binary);
                     bin_file.write((const char*)op->get_data_ptr(), op->get_data_size());
                     bin_file.close();
 
-                    LanguageUnit_p _lu(new LanguageUnit(get_function_name()));
-                    auto& writer = *_lu;
                     writer << "std::ifstream bin_file(\"" << folder + const_name
                            << ".bin\" , std::ios::in | std::ios::binary);\n"
                            << "bin_file.read((char*)output0, " << op->get_data_size() << ");\n"
@@ -36,22 +36,21 @@ namespace nnfusion
                     {
                         return nullptr;
                     }
+                    return emit_simd_function_body();
+                }
 
-                    size_t remainder_count = m_data_size % m_simd_block_size;
+                void emit_simd_loop(LanguageUnit& lu, const SimdIsa& isa) override
+                {
+                    size_t block_size = isa.block_size;
+                    size_t remainder_count = m_data_size % block_size;
                     size_t loop_count = m_data_size - remainder_count;
-                    size_t shard_data_count = m_data_size / m_simd_block_size;
-
-                    auto op = CpuOpMap<T>::simd_op;
-
-                    LanguageUnit_p _lu(new LanguageUnit(get_function_name()));
-                    auto& lu = *_lu;
+                    size_t shard_data_count = m_data_size / block_size;
 
-                    if (CpuOpMap<T>::simd_math_kernel != nullptr)
+                    auto op_kernel = get_op_kernel(isa);
+                    auto op = op_kernel.first;
+                    if (op_kernel.second != nullptr)
                     {
-                        auto math_kernel = get_simd_math_kernel(
-                            op, CpuOpMap<T>::simd_math_kernel, m_data_size, m_data_types);
-                        NNFUSION_CHECK_NOT_NULLPTR(math_kernel);
-                        lu.require(math_kernel);
+                        lu.require(op_kernel.second);
                     }
                     auto num_inputs = m_data_types.size() - 1;
                     NNFUSION_CHECK(num_inputs > 0)
@@ -73,53 +72,56 @@ namespace nnfusion
 
                         lu << "auto func = [&](int __rank__)\n";
                         lu << "{\n";
-                        lu << "int64_t start = block_size * __rank__ * " << m_simd_block_size
-                           << ";\n";
+                        lu << "int64_t start = block_size * __rank__ * " << block_size << ";\n";
                         lu << "int64_t end = std::min(block_size * (__rank__ + 1), "
                               "static_cast<int64_t>("
-                           << shard_data_count << ")) * " << m_simd_block_size << ";\n";
+                           << shard_data_count << ")) * " << block_size << ";\n";
 
                         for (size_t i = 0; i < num_inputs + 1; i++)
                         {
-                            if (m_data_types[i] != "float")
+                            if (!has_simd_convert(m_data_types[i]))
                             {
-                                lu << "float tmp_buffer[" << m_simd_block_size << "];\n";
+                                lu << "float tmp_buffer[" << block_size << "];\n";
                                 break;
                             }
                         }
 
-                        lu << "for (size_t i = start; i < end; i+=" << m_simd_block_size << ")\n";
+                        lu << "for (size_t i = start; i < end; i+=" << block_size << ")\n";
                         lu.block_begin();
                         for (size_t i = 0; i < num_inputs; ++i)
                         {
-                            if (m_data_types[i] != "float")
+                            if (!has_simd_convert(m_data_types[i]))
                             {
-                                lu << "for (int j = 0; j < " << m_simd_block_size << "; ++j)\n{\n";
+                                lu << "for (int j = 0; j < " << block_size << "; ++j)\n{\n";
                                 lu << "tmp_buffer[j] = (float)input" << i << "[i + j];\n}\n";
-                                lu << "__m256 in" << i << " = _mm256_loadu_ps(tmp_buffer);\n";
+                                lu << isa.vec_type << " in" << i << " = "
+                                   << isa.load("tmp_buffer") << ";\n";
                             }
                             else
                             {
-                                lu << "__m256 in" << i << " = _mm256_loadu_ps(input" << i
-                                   << " + i);\n";
+                                lu << isa.vec_type << " in" << i << " = "
+                                   << isa.load("input" + std::to_string(i) + " + i",
+                                               m_data_types[i])
+                                   << ";\n";
                             }
                         }
-                        lu << "__m256 out = " << op << "(";
+                        lu << isa.vec_type << " out = " << op << "(";
                         for (size_t i = 0; i < num_inputs - 1; ++i)
                         {
                             lu << "in" << i << ", ";
                         }
                         lu << "in" << num_inputs - 1 << ");\n";
-                        if (m_data_types[num_inputs] != "float")
+                        if (!has_simd_convert(m_data_types[num_inputs]))
                         {
-                            lu << "_mm256_storeu_ps(tmp_buffer, out);\n";
-                            lu << "for (int j = 0; j < " << m_simd_block_size << "; ++j)\n{\n";
+                            lu << isa.store("tmp_buffer", "out") << ";\n";
+                            lu << "for (int j = 0; j < " << block_size << "; ++j)\n{\n";
                             lu << "output0[i + j] = (" << m_data_types[num_inputs]
                                << ")tmp_buffer[j];\n}\n";
                         }
                         else
                         {
-                            lu << "_mm256_storeu_ps(output0 + i, out);\n";
+                            lu << isa.store("output0 + i", "out", m_data_types[num_inputs])
+                               << ";\n";
                         }
                         lu.block_end();
                         lu << "};\n";
@@ -133,32 +135,41 @@ namespace nnfusion
                         lu << "{\n";
                         for (size_t i = 0; i < num_inputs; ++i)
                         {
-                            lu << "__m256 in" << i
-                               << " = _mm256_insertf128_ps(_mm256_setzero_ps(), _mm_set_ss(input"
-                               << i << "[i]), 0);\n";
+                            lu << isa.vec_type << " in" << i << " = "
+                               << isa.set1("input" + std::to_string(i) + "[i]") << ";\n";
                         }
-                        lu << "__m256 out = " << op << "(";
+                        lu << isa.vec_type << " out = " << op << "(";
                         for (size_t i = 0; i < num_inputs - 1; ++i)
                         {
                             lu << "in" << i << ", ";
                         }
                         lu << "in" << num_inputs - 1 << ");\n";
-                        lu << "output0[i] = _mm_cvtss_f32(_mm256_extractf128_ps(out, 0));\n";
+                        lu << "output0[i] = " << isa.extract("out", m_data_types[num_inputs])
+                           << ";\n";
                         lu << "}\n";
                     }
-
-                    return _lu;
                 }
 
                 LanguageUnit_p emit_dependency() override
                 {
                     LanguageUnit_p _lu(new LanguageUnit(get_function_name() + "_dep"));
                     _lu->require(header::simd);
+                    if (FLAGS_fcpu_simd_dispatch)
+                        _lu->require(header::simd_dispatch);
+                    for (auto& dtype : m_data_types)
+                    {
+                        if (is_reduced_precision(dtype))
+                        {
+                            _lu->require(header::reduced_precision);
+                            break;
+                        }
+                    }
 
                     return _lu;
                 }
 
-                virtual std::pair<std::string, shared_ptr<LanguageUnit>> get_op_kernel() override
+                virtual std::pair<std::string, shared_ptr<LanguageUnit>>
+                    get_op_kernel(const SimdIsa& isa) override
                 {
                     std::string op = CpuOpMap<T>::simd_op;
                     shared_ptr<LanguageUnit> kernel = nullptr;
@@ -166,10 +177,11 @@ namespace nnfusion
                     if (CpuOpMap<T>::simd_math_kernel != nullptr)
                     {
                         kernel = get_simd_math_kernel(
-                            op, CpuOpMap<T>::simd_math_kernel, m_data_size, m_data_types);
+                            op, CpuOpMap<T>::simd_math_kernel, m_data_size, m_data_types, isa);
                         NNFUSION_CHECK_NOT_NULLPTR(kernel);
                     }
-                    return std::make_pair(op, kernel);
+                    return std::make_pair(
+                        isa.get_op(op, CpuOpMap<T>::simd_math_kernel != nullptr), kernel);
                 }
 
             protected:
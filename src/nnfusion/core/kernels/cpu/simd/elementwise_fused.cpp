@@ -82,17 +82,24 @@ std::shared_ptr<KernelContext> ElementwiseFused::FuseContext()
 
 LanguageUnit_p ElementwiseFused::emit_function_body()
 {
-    create_ptr(LanguageUnit, lu_, get_function_name());
-    LanguageUnit& lu = *lu_;
+    return emit_simd_function_body();
+}
 
+void ElementwiseFused::emit_simd_loop(LanguageUnit& lu, const SimdIsa& isa)
+{
+    size_t block_size = isa.block_size;
     bool has_not_float_elements = false;
+    in_args.clear();
+    out_args.clear();
+    out_types.clear();
+    local_tensors.clear();
 
     std::unordered_map<std::string, std::string> in_multi_data, in_single_data;
     for (int i = 0; i < m_context->inputs.size(); i++)
     {
         auto& tensor = m_context->inputs[i];
         in_args[tensor->get_name()] = "input" + std::to_string(i);
-        if (tensor->get_element_type().c_type_string() != "float")
+        if (!has_simd_convert(tensor->get_element_type().c_type_string()))
             has_not_float_elements = true;
     }
     for (int i = 0; i < m_context->outputs.size(); i++)
@@ -100,7 +107,7 @@ LanguageUnit_p ElementwiseFused::emit_function_body()
         auto& tensor = m_context->outputs[i];
         out_args[tensor->get_name()] = "output" + std::to_string(i);
         out_types[tensor->get_name()] = tensor->get_element_type().c_type_string();
-        if (tensor->get_element_type().c_type_string() != "float")
+        if (!has_simd_convert(tensor->get_element_type().c_type_string()))
             has_not_float_elements = true;
     }
 
@@ -122,23 +129,20 @@ LanguageUnit_p ElementwiseFused::emit_function_body()
             }
             auto& in_tw = kernel_emitter->m_context->inputs[0];
             NNFUSION_CHECK(in_args.count(in_tw->get_name()) > 0);
+            std::vector<std::string> lanes;
+            for (size_t j = block_size; j > 0; j--)
+            {
+                lanes.push_back(in_args[in_tw->get_name()] + "[(i + " + std::to_string(j - 1) +
+                                ")" + op + "]");
+            }
             std::stringstream multi_data;
-            multi_data << "__m256 simd_" << in_args[in_tw->get_name()] << " = _mm256_set_ps("
-                       << in_args[in_tw->get_name()] << "[(i + 7)" << op << "], "
-                       << in_args[in_tw->get_name()] << "[(i + 6)" << op << "], "
-                       << in_args[in_tw->get_name()] << "[(i + 5)" << op << "], "
-                       << in_args[in_tw->get_name()] << "[(i + 4)" << op << "], "
-                       << in_args[in_tw->get_name()] << "[(i + 3)" << op << "], "
-                       << in_args[in_tw->get_name()] << "[(i + 2)" << op << "], "
-                       << in_args[in_tw->get_name()] << "[(i + 1)" << op << "], "
-                       << in_args[in_tw->get_name()] << "[(i + 0)" << op << "]);";
+            multi_data << isa.vec_type << " simd_" << in_args[in_tw->get_name()] << " = "
+                       << isa.prefix << "set_ps(" << join(lanes, ", ") << ");";
             in_multi_data[in_args[in_tw->get_name()]] = multi_data.str();
 
             std::stringstream single_data;
-            single_data << "__m256 simd_" << in_args[in_tw->get_name()]
-                        << " = _mm256_insertf128_ps("
-                        << "_mm256_setzero_ps(), _mm_set_ss(" << in_args[in_tw->get_name()] << "[i"
-                        << op << "]), 0);";
+            single_data << isa.vec_type << " simd_" << in_args[in_tw->get_name()] << " = "
+                        << isa.set1(in_args[in_tw->get_name()] + "[i" + op + "]") << ";";
             in_single_data[in_args[in_tw->get_name()]] = single_data.str();
         }
         else if (auto rs = std::dynamic_pointer_cast<nnfusion::op::Reshape>(gnode->get_op_ptr()))
@@ -148,26 +152,25 @@ LanguageUnit_p ElementwiseFused::emit_function_body()
             if (in_args.count(in_tw->get_name()) > 0)
             {
                 std::stringstream multi_data;
-                if (in_tw->get_element_type().c_type_string() == "float")
+                auto dtype = in_tw->get_element_type().c_type_string();
+                if (has_simd_convert(dtype))
                 {
-                    multi_data << "__m256 simd_" << in_args[in_tw->get_name()]
-                               << " = _mm256_loadu_ps(" << in_args[in_tw->get_name()] << " + i);\n";
+                    multi_data << isa.vec_type << " simd_" << in_args[in_tw->get_name()] << " = "
+                               << isa.load(in_args[in_tw->get_name()] + " + i", dtype) << ";\n";
                 }
                 else
                 {
-                    multi_data << "for (int j = 0; j < " << m_simd_block_size << "; ++j)\n{\n";
+                    multi_data << "for (int j = 0; j < " << block_size << "; ++j)\n{\n";
                     multi_data << "tmp_buffer[j] = (float)(" << in_args[in_tw->get_name()]
                                << "[i + j]);\n}\n";
-                    multi_data << "__m256 simd_" << in_args[in_tw->get_name()]
-                               << " = _mm256_loadu_ps(tmp_buffer);\n";
+                    multi_data << isa.vec_type << " simd_" << in_args[in_tw->get_name()] << " = "
+                               << isa.load("tmp_buffer") << ";\n";
                 }
                 in_multi_data[in_args[in_tw->get_name()]] = multi_data.str();
 
                 std::stringstream single_data;
-                single_data << "__m256 simd_" << in_args[in_tw->get_name()]
-                            << " = _mm256_insertf128_ps("
-                            << "_mm256_setzero_ps(), _mm_set_ss(" << in_args[in_tw->get_name()]
-                            << "[i]), 0);";
+                single_data << isa.vec_type << " simd_" << in_args[in_tw->get_name()] << " = "
+                            << isa.set1(in_args[in_tw->get_name()] + "[i]") << ";";
                 in_single_data[in_args[in_tw->get_name()]] = single_data.str();
 
                 in_args[out_tw->get_name()] = in_args[in_tw->get_name()];
@@ -185,27 +188,26 @@ LanguageUnit_p ElementwiseFused::emit_function_body()
                 if (in_args.count(in_tw->get_name()) > 0)
                 {
                     std::stringstream multi_data;
-                    if (in_tw->get_element_type().c_type_string() == "float")
+                    auto dtype = in_tw->get_element_type().c_type_string();
+                    if (has_simd_convert(dtype))
                     {
-                        multi_data << "__m256 simd_" << in_args[in_tw->get_name()]
-                                   << " = _mm256_loadu_ps(" << in_args[in_tw->get_name()]
-                                   << " + i);";
+                        multi_data << isa.vec_type << " simd_" << in_args[in_tw->get_name()]
+                                   << " = " << isa.load(in_args[in_tw->get_name()] + " + i", dtype)
+                                   << ";";
                     }
                     else
                     {
-                        multi_data << "for (int j = 0; j < " << m_simd_block_size << "; ++j)\n{\n";
+                        multi_data << "for (int j = 0; j < " << block_size << "; ++j)\n{\n";
                         multi_data << "tmp_buffer[j] = (float)(" << in_args[in_tw->get_name()]
                                    << "[i + j]);\n}\n";
-                        multi_data << "__m256 simd_" << in_args[in_tw->get_name()]
-                                   << " = _mm256_loadu_ps(tmp_buffer);";
+                        multi_data << isa.vec_type << " simd_" << in_args[in_tw->get_name()]
+                                   << " = " << isa.load("tmp_buffer") << ";";
                     }
                     in_multi_data[in_args[in_tw->get_name()]] = multi_data.str();
 
                     std::stringstream single_data;
-                    single_data << "__m256 simd_" << in_args[in_tw->get_name()]
-                                << " = _mm256_insertf128_ps("
-                                << "_mm256_setzero_ps(), _mm_set_ss(" << in_args[in_tw->get_name()]
-                                << "[i]), 0);";
+                    single_data << isa.vec_type << " simd_" << in_args[in_tw->get_name()] << " = "
+                                << isa.set1(in_args[in_tw->get_name()] + "[i]") << ";";
                     in_single_data[in_args[in_tw->get_name()]] = single_data.str();
                 }
             }
@@ -219,9 +221,9 @@ LanguageUnit_p ElementwiseFused::emit_function_body()
         if (size > data_size)
             data_size = size;
     }
-    size_t remainder_count = data_size % m_simd_block_size;
+    size_t remainder_count = data_size % block_size;
     size_t loop_count = data_size - remainder_count;
-    size_t shard_data_count = data_size / m_simd_block_size;
+    size_t shard_data_count = data_size / block_size;
 
     if (loop_count > 0)
     {
@@ -239,22 +241,22 @@ LanguageUnit_p ElementwiseFused::emit_function_body()
 
         if (has_not_float_elements)
         {
-            lu << "float tmp_buffer[" << m_simd_block_size << "];\n";
+            lu << "float tmp_buffer[" << block_size << "];\n";
         }
 
         lu << "auto func = [&](int __rank__)\n";
         lu << "{\n";
-        lu << "int64_t start = block_size * __rank__ * " << m_simd_block_size << ";\n";
+        lu << "int64_t start = block_size * __rank__ * " << block_size << ";\n";
         lu << "int64_t end = std::min(block_size * (__rank__ + 1), static_cast<int64_t>("
-           << shard_data_count << ")) * " << m_simd_block_size << ";\n";
+           << shard_data_count << ")) * " << block_size << ";\n";
 
-        lu << "for (size_t i = start; i < end; i+=" << m_simd_block_size << ")\n";
+        lu << "for (size_t i = start; i < end; i+=" << block_size << ")\n";
         lu.block_begin();
         for (const auto& simd_init : in_multi_data)
         {
             lu << simd_init.second << "\n";
         }
-        FuseFunctionBody(lu);
+        FuseFunctionBody(lu, isa);
 
         for (auto& pair : out_args)
         {
@@ -268,15 +270,14 @@ LanguageUnit_p ElementwiseFused::emit_function_body()
                 NNFUSION_CHECK(in_args.count(pair.first) > 0);
                 out_string = "simd_" + in_args[pair.first];
             }
-            if (out_types[pair.first] == "float")
+            if (has_simd_convert(out_types[pair.first]))
             {
-                lu << "_mm256_storeu_ps(" << pair.second << " + i, ";
-                lu << out_string << ");\n";
+                lu << isa.store(pair.second + " + i", out_string, out_types[pair.first]) << ";\n";
             }
             else
             {
-                lu << "_mm256_storeu_ps(tmp_buffer, " << out_string << ");\n";
-                lu << "for (int j = 0; j < " << m_simd_block_size << "; ++j)\n{\n";
+                lu << isa.store("tmp_buffer", out_string) << ";\n";
+                lu << "for (int j = 0; j < " << block_size << "; ++j)\n{\n";
                 lu << pair.second << "[i + j] = (" << out_types[pair.first]
                    << ")tmp_buffer[j];\n}\n";
             }
@@ -295,28 +296,27 @@ LanguageUnit_p ElementwiseFused::emit_function_body()
         {
             lu << simd_init.second << "\n";
         }
-        FuseFunctionBody(lu);
+        FuseFunctionBody(lu, isa);
 
         for (auto& pair : out_args)
         {
-            lu << pair.second << "[i] = _mm_cvtss_f32(_mm256_extractf128_ps(";
             if (local_tensors.count(pair.first) > 0)
             {
-                lu << local_tensors[pair.first] << ", 0));\n";
+                lu << pair.second << "[i] = "
+                   << isa.extract(local_tensors[pair.first], out_types[pair.first]) << ";\n";
             }
             else
             {
                 NNFUSION_CHECK(in_args.count(pair.first) > 0);
-                lu << "simd_" << in_args[pair.first] << ", 0));\n";
+                lu << pair.second << "[i] = "
+                   << isa.extract("simd_" + in_args[pair.first], out_types[pair.first]) << ";\n";
             }
         }
         lu << "}\n";
     }
-
-    return lu_;
 }
 
-void ElementwiseFused::FuseFunctionBody(LanguageUnit& lu)
+void ElementwiseFused::FuseFunctionBody(LanguageUnit& lu, const SimdIsa& isa)
 {
     size_t temp_tensor_id = 0;
     for (auto kernel_emitter : m_context->kernels)
@@ -329,7 +329,7 @@ void ElementwiseFused::FuseFunctionBody(LanguageUnit& lu)
             auto& in_tw = kernel_emitter->m_context->inputs[0];
             NNFUSION_CHECK(in_args.count(in_tw->get_name()) > 0);
 
-            lu << "__m256 " << local_tensors[out_tw->get_name()] << " = simd_"
+            lu << isa.vec_type << " " << local_tensors[out_tw->get_name()] << " = simd_"
                << in_args[in_tw->get_name()] << ";\n";
         }
         else if (auto rs = std::dynamic_pointer_cast<nnfusion::op::Reshape>(gnode->get_op_ptr()))
@@ -351,7 +351,7 @@ void ElementwiseFused::FuseFunctionBody(LanguageUnit& lu)
             auto simd_kernel = std::dynamic_pointer_cast<SimdKernelEmitter>(kernel_emitter);
             NNFUSION_CHECK_NOT_NULLPTR(simd_kernel)
                 << "kernel type:" << kernel_emitter->m_context->gnode->get_op_type();
-            auto op_kernel = simd_kernel->get_op_kernel();
+            auto op_kernel = simd_kernel->get_op_kernel(isa);
             if (op_kernel.second != nullptr)
             {
                 lu.require(op_kernel.second);
@@ -371,8 +371,8 @@ void ElementwiseFused::FuseFunctionBody(LanguageUnit& lu)
                     input_args.push_back(local_tensors[in_tw->get_name()]);
                 }
             }
-            lu << "__m256 " << local_tensors[out_tw->get_name()] << " = " << op_kernel.first << "("
-               << join(input_args, ", ") << ");\n";
+            lu << isa.vec_type << " " << local_tensors[out_tw->get_name()] << " = "
+               << op_kernel.first << "(" << join(input_args, ", ") << ");\n";
         }
     }
 }
@@ -381,6 +381,16 @@ LanguageUnit_p ElementwiseFused::emit_dependency()
 {
     LanguageUnit_p _lu(new LanguageUnit(get_function_name() + "_dep"));
     _lu->require(header::simd);
+    if (FLAGS_fcpu_simd_dispatch)
+        _lu->require(header::simd_dispatch);
+    for (auto& dtype : m_context->dtypes)
+    {
+        if (is_reduced_precision(dtype))
+        {
+            _lu->require(header::reduced_precision);
+            break;
+        }
+    }
 
     return _lu;
 }
@@ -22,9 +22,12 @@ namespace nnfusion
                 LanguageUnit_p emit_comments() override;
                 static int unique_func_id;
 
+            protected:
+                void emit_simd_loop(LanguageUnit& lu, const SimdIsa& isa) override;
+
             private:
                 std::shared_ptr<KernelContext> FuseContext();
-                void FuseFunctionBody(LanguageUnit& lu);
+                void FuseFunctionBody(LanguageUnit& lu, const SimdIsa& isa);
                 std::unordered_map<std::string, std::string> in_args, out_args, out_types,
                     local_tensors;
             };
@@ -0,0 +1,101 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "simd_dispatch.hpp"
+
+namespace nnfusion
+{
+    namespace kernels
+    {
+        LanguageUnit_p simd_dispatch_header = LanguageUnit_p(new LanguageUnit("simd_dispatch.h",
+                                                                              R"(
+
+#pragma once
+
+#include <cstdlib>
+#include <cstring>
+#include <immintrin.h>
+
+namespace nnfusion
+{
+    namespace cpu
+    {
+        enum SimdIsaLevel
+        {
+            SIMD_ISA_SSE2 = 0,
+            SIMD_ISA_AVX2 = 1,
+            SIMD_ISA_AVX512 = 2
+        };
+
+        // The level every simd kernel dispatches on, SSE2 until init_simd_isa() is called.
+        inline int& simd_isa()
+        {
+            static int isa = SIMD_ISA_SSE2;
+            return isa;
+        }
+
+        // Detect the host ISA once, NNFUSION_SIMD_ISA=sse2|avx2|avx512 caps it.
+        inline void init_simd_isa()
+        {
+            __builtin_cpu_init();
+            int isa = SIMD_ISA_SSE2;
+            if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq"))
+                isa = SIMD_ISA_AVX512;
+            else if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+                isa = SIMD_ISA_AVX2;
+
+            const char* cap = getenv("NNFUSION_SIMD_ISA");
+            if (cap != nullptr)
+            {
+                int level = strcmp(cap, "avx512") == 0
+                                ? SIMD_ISA_AVX512
+                                : (strcmp(cap, "avx2") == 0 ? SIMD_ISA_AVX2 : SIMD_ISA_SSE2);
+                if (level < isa)
+                    isa = level;
+            }
+            simd_isa() = isa;
+        }
+
+        // SSE2 counterparts of the AVX intrinsics used by the simd kernels
+        inline __m128 mm_cmp_ps(__m128 a, __m128 b, const int imm)
+        {
+            switch (imm)
+            {
+            case _CMP_EQ_OQ:
+            case _CMP_EQ_OS: return _mm_cmpeq_ps(a, b);
+            case _CMP_NEQ_UQ:
+            case _CMP_NEQ_OS: return _mm_cmpneq_ps(a, b);
+            case _CMP_GT_OQ:
+            case _CMP_GT_OS: return _mm_cmpgt_ps(a, b);
+            case _CMP_GE_OQ:
+            case _CMP_GE_OS: return _mm_cmpge_ps(a, b);
+            case _CMP_LT_OQ:
+            case _CMP_LT_OS: return _mm_cmplt_ps(a, b);
+            default: return _mm_cmple_ps(a, b);
+            }
+        }
+
+        inline __m128 mm_round_ps(__m128 a, bool up)
+        {
+            // values beyond 2^23 and nan are integral already
+            __m128 abs = _mm_andnot_ps(_mm_set1_ps(-0.0f), a);
+            __m128 keep = _mm_cmpnlt_ps(abs, _mm_set1_ps(8388608.0f));
+            __m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(a));
+            __m128 fix = up ? _mm_and_ps(_mm_cmplt_ps(t, a), _mm_set1_ps(1.0f))
+                            : _mm_and_ps(_mm_cmpgt_ps(t, a), _mm_set1_ps(-1.0f));
+            t = _mm_add_ps(t, fix);
+            return _mm_or_ps(_mm_and_ps(keep, a), _mm_andnot_ps(keep, t));
+        }
+    }
+}
+
+#define NNFUSION_MM_CMP_PS(a, b, imm) nnfusion::cpu::mm_cmp_ps(a, b, imm)
+#define NNFUSION_MM_CEIL_PS(a) nnfusion::cpu::mm_round_ps(a, true)
+#define NNFUSION_MM_FLOOR_PS(a) nnfusion::cpu::mm_round_ps(a, false)
+#define NNFUSION_MM512_CMP_PS(a, b, imm)                                                           \
+    _mm512_maskz_mov_ps(_mm512_cmp_ps_mask(a, b, imm), _mm512_castsi512_ps(_mm512_set1_epi32(-1)))
+#define NNFUSION_MM512_CEIL_PS(a) _mm512_roundscale_ps(a, _MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC)
+#define NNFUSION_MM512_FLOOR_PS(a) _mm512_roundscale_ps(a, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC)
+)"));
+    }
+}
@@ -245,6 +245,14 @@ FunctionUnit_p KernelEmitter::get_or_emit_source(bool emit_func_call)
     return m_function_unit;
 }
 
+void KernelEmitter::prepare_function_name()
+{
+    if (m_is_emitted || !this->m_kernel_name.empty())
+        return;
+    m_function_name_unit = emit_function_name();
+    this->m_kernel_name = m_function_name_unit->get_code();
+}
+
 FunctionUnit_p KernelEmitter::emit_source()
 {
     FunctionUnit_p fu(new FunctionUnit());
@@ -254,6 +262,11 @@ FunctionUnit_p KernelEmitter::emit_source()
         fu->name_unit = emit_function_name();
         this->m_kernel_name = fu->name_unit->get_code();
     }
+    else if (m_function_name_unit)
+    {
+        fu->name_unit = m_function_name_unit;
+        m_function_name_unit = nullptr;
+    }
 
     if (kernel_definitions.find(this->m_kernel_name) != kernel_definitions.end())
     {
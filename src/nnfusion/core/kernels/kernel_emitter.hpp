@@ -83,6 +83,9 @@ namespace nnfusion
 
             string get_kernel_type() { return m_kernel_type; }
             string get_function_name() { return this->m_kernel_name; }
+            // Generate the function name ahead of emit_source(). Some emitters number their
+            // names, so this keeps names stable when the sources are emitted concurrently.
+            void prepare_function_name();
             bool is_emitted() { return m_is_emitted; }
             // function declaration will be deduplicated only if the kernel function is
             // not static
@@ -145,6 +148,9 @@ namespace nnfusion
             // kernel name.
             string m_kernel_name;
 
+            // function name generated by prepare_function_name(), consumed by emit_source()
+            LanguageUnit_p m_function_name_unit;
+
             // custom kernel tag
             string custom_tag;
 
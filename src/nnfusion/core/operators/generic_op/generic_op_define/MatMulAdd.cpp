@@ -6,6 +6,7 @@
 REGISTER_OP(MatMulAdd)
     .attr<bool>("trans_A", false)
     .attr<bool>("trans_B", false)
+    .attr<std::string>("activation", "") // "relu" or "gelu" applied to AB + C, CPU only
     .infershape([](std::shared_ptr<graph::GNode> gnode) -> void {
         //AB + C
         auto generic_op = static_pointer_cast<nnfusion::op::GenericOp>(gnode->get_op_ptr());
@@ -16,7 +17,8 @@ REGISTER_OP(MatMulAdd)
         auto A_shape = gnode->get_input_shape(0);
         auto B_shape = gnode->get_input_shape(1);
         auto C_shape = gnode->get_input_shape(2);
-        NNFUSION_CHECK(A_shape.size() == 2 && B_shape.size() == 2 && C_shape.size() == 2)
+        NNFUSION_CHECK(A_shape.size() == 2 && B_shape.size() == 2 &&
+                       (C_shape.size() == 2 || C_shape.size() == 1))
             << "MatMulAdd only support Matrix";
 
         auto& cfg = generic_op->localOpConfig.getRoot();
@@ -28,8 +30,12 @@ REGISTER_OP(MatMulAdd)
         size_t n = trans_B ? B_shape[0] : B_shape[1];
         size_t k2 = trans_B ? B_shape[1] : B_shape[0];
         NNFUSION_CHECK(k1 == k2);
-        NNFUSION_CHECK(C_shape[0] == m && C_shape[1] == n);
+        // a 1D C is a bias added to every row
+        if (C_shape.size() == 1)
+            NNFUSION_CHECK(C_shape[0] == n);
+        else
+            NNFUSION_CHECK(C_shape[0] == m && C_shape[1] == n);
 
         gnode->set_output_type_and_shape(
-            0, gnode->get_input_element_type(2), gnode->get_input_shape(2));
+            0, gnode->get_input_element_type(2), nnfusion::Shape{m, n});
     });
@@ -41,6 +41,7 @@ namespace nnfusion
             void validate_and_infer_types(std::shared_ptr<graph::GNode> gnode) override;
             nnfusion::Shape get_shape() const { return m_shape; }
             void set_shape(nnfusion::Shape shape) { m_shape = shape; }
+            const nnfusion::element::Type& get_element_type() const { return m_element_type; }
 
             bool is_tensor_op() const override { return true; }
         protected:
@@ -22,12 +22,22 @@ DEFINE_string(fproduct_name,
               "Device product name, like 'GeForce GTX 1080 Ti', 'Tesla V100-PCIE-16GB'");
 DEFINE_bool(fcodegen_unexist_kernel, false, "Generate a kernel with roller and insert to db if not found");
 DEFINE_string(flog_kerneldb_request, "#", "Save request to a file");
+DEFINE_bool(fkernel_cache_front,
+            true,
+            "Serve kernel DB lookups from memory, loaded with one query per device type");
 
 using namespace nnfusion::cache;
 
 std::unordered_set<std::string> KernelCacheManager::SupportOpList;
 std::unordered_set<std::string> KernelCacheManager::CodegenOpList;
 
+KernelCacheManager::FrontCacheShard
+    KernelCacheManager::front_cache[KernelCacheManager::front_cache_shards];
+std::mutex KernelCacheManager::prefill_mutex;
+std::unordered_set<std::string> KernelCacheManager::prefilled_devices;
+std::atomic<size_t> KernelCacheManager::front_cache_hits(0);
+std::atomic<size_t> KernelCacheManager::front_cache_misses(0);
+
 sqlite3* KernelCacheManager::kernel_cache = nullptr;
 KernelCacheManager::KernelCacheManager()
 {
@@ -112,8 +122,22 @@ CREATE TABLE IF NOT EXISTS KernelCache(
 
 KernelCacheManager::~KernelCacheManager()
 {
+    if (FLAGS_fkernel_cache_front && front_cache_hits + front_cache_misses > 0)
+    {
+        NNFUSION_LOG(INFO) << "Kernel cache front: " << front_cache_hits << " hits, "
+                           << front_cache_misses << " misses";
+    }
     NNFUSION_CHECK(SQLITE_OK == sqlite3_close(kernel_cache));
     kernel_cache = NULL;
+
+    // the database might be changed by other tools once it is closed
+    std::lock_guard<std::mutex> lock(prefill_mutex);
+    for (auto& shard : front_cache)
+    {
+        std::lock_guard<std::mutex> shard_lock(shard.mutex);
+        shard.entries.clear();
+    }
+    prefilled_devices.clear();
 }
 
 std::vector<KernelEntry_p> KernelCacheManager::fetch_all(std::string identifier,
@@ -135,75 +159,7 @@ std::vector<KernelEntry_p> KernelCacheManager::fetch_all(std::string identifier,
             log_file.close();
         }
     }
-    // NNFUSION_LOG(INFO) << "Trying to fetch kernel " << identifier
-    //                     << " on DeviceType: " << device_type;
-    sqlite3_stmt* pStmt;
-    const char* fetch = R"(
-SELECT Key, Identifier, OpType, Attributes, Source, DeviceType, Function, Tags, Miscs FROM KernelCache WHERE (Identifier = ?) AND (DeviceType = ?);
-    )";
-    NNFUSION_CHECK(SQLITE_OK == sqlite3_prepare(kernel_cache, fetch, -1, &pStmt, 0));
-    sqlite3_bind_text(pStmt, 1, identifier.data(), identifier.size(), SQLITE_STATIC);
-    sqlite3_bind_text(pStmt, 2, device_type.data(), device_type.size(), SQLITE_STATIC);
-
-    std::vector<KernelEntry_p> fetched;
-    while (SQLITE_ROW == sqlite3_step(pStmt))
-    {
-        KernelEntry_p fetched_kernel = std::make_shared<KernelEntry>();
-
-        fetched_kernel->key = std::string((char*)sqlite3_column_text(pStmt, 0));
-        fetched_kernel->identifier = std::string((char*)sqlite3_column_text(pStmt, 1));
-        fetched_kernel->op_type = std::string((char*)sqlite3_column_text(pStmt, 2));
-        fetched_kernel->attributes =
-            nlohmann::json::parse(std::string((char*)sqlite3_column_text(pStmt, 3)));
-        fetched_kernel->source = std::string((char*)sqlite3_column_text(pStmt, 4));
-        fetched_kernel->device_type = std::string((char*)sqlite3_column_text(pStmt, 5));
-        fetched_kernel->function =
-            nlohmann::json::parse(std::string((char*)sqlite3_column_text(pStmt, 6)));
-        fetched_kernel->miscs =
-            nlohmann::json::parse(std::string((char*)sqlite3_column_text(pStmt, 8)));
-
-        if (SupportOpList.find(fetched_kernel->op_type) == SupportOpList.end())
-        {
-            NNFUSION_LOG(INFO) << "Unsupported op_type: " << fetched_kernel->op_type
-                                << ", ingore this fetch";
-            fetched.clear();
-            break;
-        }
-
-        // parse input tags
-        size_t pos = 0;
-        std::string fetched_tags = std::string((char*)sqlite3_column_text(pStmt, 7));
-        while ((pos = fetched_tags.find(",")) != std::string::npos)
-        {
-            fetched_kernel->tags.insert(fetched_tags.substr(0, pos));
-            fetched_tags.erase(0, pos + 1);
-        }
-        if (fetched_tags != "")
-        {
-            fetched_kernel->tags.insert(fetched_tags);
-        }
-
-        // parse profiling information
-        size_t subpos = 0;
-        auto miscs = fetched_kernel->miscs;
-        if (miscs.find("external_profile") != miscs.end())
-        {
-            std::string fetched_profile = miscs["external_profile"]["time"];
-            while ((pos = fetched_profile.find(";")) != std::string::npos)
-            {
-                subpos = fetched_profile.find(":");
-                fetched_kernel->profile[fetched_profile.substr(0, subpos)] =
-                    stof(fetched_profile.substr(subpos + 1, pos));
-                fetched_profile.erase(0, pos + 1);
-            }
-
-            fetched_kernel->resource = miscs["external_profile"]["resource"];
-        }
-
-        fetched.push_back(fetched_kernel);
-    }
-
-    NNFUSION_CHECK(SQLITE_OK == sqlite3_finalize(pStmt));
+    auto fetched = lookup(identifier, device_type);
     if (fetched.size() > 0)
     {
         NNFUSION_LOG(INFO) << fetched.size() << " cached kernel fetched " << identifier
@@ -253,6 +209,7 @@ SELECT Key, Identifier, OpType, Attributes, Source, DeviceType, Function, Tags,
             exit(1);
         }
         NNFUSION_CHECK(SQLITE_OK == sqlite3_open(m_path.c_str(), &kernel_cache));
+        refresh(identifier, device_type);
         fetched = fetch_all(identifier, device_type, true);
 #else
         NNFUSION_LOG(ERROR) << "python interpreter not found, skip codegen unexist kernel: " << identifier;
@@ -263,6 +220,181 @@ SELECT Key, Identifier, OpType, Attributes, Source, DeviceType, Function, Tags,
     return fetched;
 }
 
+KernelEntry_p KernelCacheManager::parse_kernel_entry(sqlite3_stmt* pStmt)
+{
+    KernelEntry_p fetched_kernel = std::make_shared<KernelEntry>();
+
+    fetched_kernel->key = std::string((char*)sqlite3_column_text(pStmt, 0));
+    fetched_kernel->identifier = std::string((char*)sqlite3_column_text(pStmt, 1));
+    fetched_kernel->op_type = std::string((char*)sqlite3_column_text(pStmt, 2));
+    fetched_kernel->attributes =
+        nlohmann::json::parse(std::string((char*)sqlite3_column_text(pStmt, 3)));
+    fetched_kernel->source = std::string((char*)sqlite3_column_text(pStmt, 4));
+    fetched_kernel->device_type = std::string((char*)sqlite3_column_text(pStmt, 5));
+    fetched_kernel->function =
+        nlohmann::json::parse(std::string((char*)sqlite3_column_text(pStmt, 6)));
+    fetched_kernel->miscs =
+        nlohmann::json::parse(std::string((char*)sqlite3_column_text(pStmt, 8)));
+
+    // parse input tags
+    size_t pos = 0;
+    std::string fetched_tags = std::string((char*)sqlite3_column_text(pStmt, 7));
+    while ((pos = fetched_tags.find(",")) != std::string::npos)
+    {
+        fetched_kernel->tags.insert(fetched_tags.substr(0, pos));
+        fetched_tags.erase(0, pos + 1);
+    }
+    if (fetched_tags != "")
+    {
+        fetched_kernel->tags.insert(fetched_tags);
+    }
+
+    // parse profiling information
+    size_t subpos = 0;
+    auto miscs = fetched_kernel->miscs;
+    if (miscs.find("external_profile") != miscs.end())
+    {
+        std::string fetched_profile = miscs["external_profile"]["time"];
+        while ((pos = fetched_profile.find(";")) != std::string::npos)
+        {
+            subpos = fetched_profile.find(":");
+            fetched_kernel->profile[fetched_profile.substr(0, subpos)] =
+                stof(fetched_profile.substr(subpos + 1, pos));
+            fetched_profile.erase(0, pos + 1);
+        }
+
+        fetched_kernel->resource = miscs["external_profile"]["resource"];
+    }
+
+    return fetched_kernel;
+}
+
+std::vector<KernelEntry_p> KernelCacheManager::query(const std::string& identifier,
+                                                     const std::string& device_type)
+{
+    // NNFUSION_LOG(INFO) << "Trying to fetch kernel " << identifier
+    //                     << " on DeviceType: " << device_type;
+    sqlite3_stmt* pStmt;
+    const char* fetch = R"(
+SELECT Key, Identifier, OpType, Attributes, Source, DeviceType, Function, Tags, Miscs FROM KernelCache WHERE (Identifier = ?) AND (DeviceType = ?);
+    )";
+    NNFUSION_CHECK(SQLITE_OK == sqlite3_prepare(kernel_cache, fetch, -1, &pStmt, 0));
+    sqlite3_bind_text(pStmt, 1, identifier.data(), identifier.size(), SQLITE_STATIC);
+    sqlite3_bind_text(pStmt, 2, device_type.data(), device_type.size(), SQLITE_STATIC);
+
+    std::vector<KernelEntry_p> fetched;
+    while (SQLITE_ROW == sqlite3_step(pStmt))
+    {
+        auto fetched_kernel = parse_kernel_entry(pStmt);
+        if (SupportOpList.find(fetched_kernel->op_type) == SupportOpList.end())
+        {
+            NNFUSION_LOG(INFO) << "Unsupported op_type: " << fetched_kernel->op_type
+                               << ", ingore this fetch";
+            fetched.clear();
+            break;
+        }
+        fetched.push_back(fetched_kernel);
+    }
+
+    NNFUSION_CHECK(SQLITE_OK == sqlite3_finalize(pStmt));
+    return fetched;
+}
+
+void KernelCacheManager::prefill(const std::string& device_type)
+{
+    std::lock_guard<std::mutex> lock(prefill_mutex);
+    if (prefilled_devices.count(device_type) > 0)
+        return;
+
+    sqlite3_stmt* pStmt;
+    const char* fetch = R"(
+SELECT Key, Identifier, OpType, Attributes, Source, DeviceType, Function, Tags, Miscs FROM KernelCache WHERE (DeviceType = ?);
+    )";
+    NNFUSION_CHECK(SQLITE_OK == sqlite3_prepare(kernel_cache, fetch, -1, &pStmt, 0));
+    sqlite3_bind_text(pStmt, 1, device_type.data(), device_type.size(), SQLITE_STATIC);
+
+    std::unordered_map<std::string, std::vector<KernelEntry_p>> fetched;
+    std::unordered_set<std::string> unsupported;
+    while (SQLITE_ROW == sqlite3_step(pStmt))
+    {
+        auto fetched_kernel = parse_kernel_entry(pStmt);
+        // keep the behavior of query(): one unsupported entry invalidates the identifier
+        if (SupportOpList.find(fetched_kernel->op_type) == SupportOpList.end())
+            unsupported.insert(fetched_kernel->identifier);
+        fetched[fetched_kernel->identifier].push_back(fetched_kernel);
+    }
+    NNFUSION_CHECK(SQLITE_OK == sqlite3_finalize(pStmt));
+
+    for (auto& it : fetched)
+    {
+        if (unsupported.count(it.first) > 0)
+            it.second.clear();
+        auto key = front_cache_key(it.first, device_type);
+        auto& shard = get_shard(key);
+        std::lock_guard<std::mutex> shard_lock(shard.mutex);
+        shard.entries[key] = it.second;
+    }
+    prefilled_devices.insert(device_type);
+    NNFUSION_LOG(INFO) << "Kernel cache front: " << fetched.size() << " identifiers prefilled on "
+                       << device_type;
+}
+
+std::vector<KernelEntry_p> KernelCacheManager::lookup(const std::string& identifier,
+                                                      const std::string& device_type)
+{
+    if (!FLAGS_fkernel_cache_front)
+        return query(identifier, device_type);
+
+    auto key = front_cache_key(identifier, device_type);
+    auto& shard = get_shard(key);
+    auto copy_out = [](const std::vector<KernelEntry_p>& entries) {
+        std::vector<KernelEntry_p> copied;
+        for (auto entry : entries)
+            copied.push_back(std::make_shared<KernelEntry>(*entry));
+        return copied;
+    };
+
+    {
+        std::lock_guard<std::mutex> shard_lock(shard.mutex);
+        auto it = shard.entries.find(key);
+        if (it != shard.entries.end())
+        {
+            front_cache_hits++;
+            return copy_out(it->second);
+        }
+    }
+
+    front_cache_misses++;
+    prefill(device_type);
+    std::lock_guard<std::mutex> shard_lock(shard.mutex);
+    // the device type is fully loaded, so an absent identifier has no kernel
+    auto& entries = shard.entries[key];
+    return copy_out(entries);
+}
+
+void KernelCacheManager::refresh(const std::string& identifier, const std::string& device_type)
+{
+    if (!FLAGS_fkernel_cache_front)
+        return;
+
+    auto fetched = query(identifier, device_type);
+    auto key = front_cache_key(identifier, device_type);
+    auto& shard = get_shard(key);
+    std::lock_guard<std::mutex> shard_lock(shard.mutex);
+    shard.entries[key] = fetched;
+}
+
+std::string KernelCacheManager::front_cache_key(const std::string& identifier,
+                                                const std::string& device_type)
+{
+    return device_type + ":::" + identifier;
+}
+
+KernelCacheManager::FrontCacheShard& KernelCacheManager::get_shard(const std::string& key)
+{
+    return front_cache[std::hash<std::string>()(key) % front_cache_shards];
+}
+
 KernelEntry_p KernelCacheManager::fetch_with_tags(std::string identifier,
                                                   std::string device_type,
                                                   std::set<std::string> tags,
@@ -410,6 +542,7 @@ INSERT INTO KernelCache (Key,Identifier,OpType,Attributes,Source,DeviceType,Func
     sqlite3_bind_text(pStmt, 9, miscs.data(), miscs.size(), SQLITE_STATIC);
     NNFUSION_CHECK(SQLITE_DONE == sqlite3_step(pStmt));
     NNFUSION_CHECK(SQLITE_OK == sqlite3_finalize(pStmt));
+    refresh(identifier, device_type);
 
     return true;
 }
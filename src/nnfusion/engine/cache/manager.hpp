@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include <atomic>
+#include <mutex>
 #include <set>
 #include <sqlite3.h>
 #include "nnfusion/common/common.hpp"
@@ -60,12 +62,42 @@ namespace nnfusion
                                                          std::string source);
             bool insert_kernel_entry(const KernelEntry_p kernel_entry, bool overwrite = false);
             bool is_valid() { return kernel_cache != nullptr; }
+            // load all kernels of device_type into the front cache with one query
+            void prefill(const std::string& device_type);
+            static size_t get_front_cache_hits() { return front_cache_hits; }
+            static size_t get_front_cache_misses() { return front_cache_misses; }
         public:
             // TODO(lingm): SupportOpList depends on the correctness of the KernelContext identifier
             static std::unordered_set<std::string> SupportOpList;
             static std::unordered_set<std::string> CodegenOpList;
 
         private:
+            // entries are copied out of the front cache, callers are free to modify them
+            std::vector<KernelEntry_p> lookup(const std::string& identifier,
+                                              const std::string& device_type);
+            std::vector<KernelEntry_p> query(const std::string& identifier,
+                                             const std::string& device_type);
+            // reload the entries of identifier after the database is changed
+            void refresh(const std::string& identifier, const std::string& device_type);
+            static KernelEntry_p parse_kernel_entry(sqlite3_stmt* pStmt);
+            static std::string front_cache_key(const std::string& identifier,
+                                               const std::string& device_type);
+
+            // process-wide cache of (identifier, device_type) -> entries in front of the
+            // database, sharded to keep lookups from parallel passes apart.
+            struct FrontCacheShard
+            {
+                std::mutex mutex;
+                std::unordered_map<std::string, std::vector<KernelEntry_p>> entries;
+            };
+            static const size_t front_cache_shards = 16;
+            static FrontCacheShard front_cache[front_cache_shards];
+            static FrontCacheShard& get_shard(const std::string& key);
+            static std::mutex prefill_mutex;
+            static std::unordered_set<std::string> prefilled_devices;
+            static std::atomic<size_t> front_cache_hits;
+            static std::atomic<size_t> front_cache_misses;
+
             std::string m_path;
             static sqlite3* kernel_cache;
         };
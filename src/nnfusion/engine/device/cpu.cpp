@@ -11,10 +11,12 @@
 #include "nnfusion/engine/pass/graph/batchnorm_inference_folding_pass.hpp"
 #include "nnfusion/engine/pass/graph/blockfusion_pass.hpp"
 #include "nnfusion/engine/pass/graph/common_subexpression_elimination_pass.hpp"
+#include "nnfusion/engine/pass/graph/control_flow_pass.hpp"
 #include "nnfusion/engine/pass/graph/dot_transpose_pass.hpp"
 #include "nnfusion/engine/pass/graph/gemm_fusion_pass.hpp"
 #include "nnfusion/engine/pass/graph/gnode_device_dispatcher.hpp"
 #include "nnfusion/engine/pass/graph/gradient_weight_mapping_pass.hpp"
+#include "nnfusion/engine/pass/graph/graph_snapshot_pass.hpp"
 #include "nnfusion/engine/pass/graph/ir_based_fusion_pass.hpp"
 #include "nnfusion/engine/pass/graph/kernel_fusion_pass.hpp"
 #include "nnfusion/engine/pass/graph/kernel_profiling_pass.hpp"
@@ -24,6 +26,7 @@
 #include "nnfusion/engine/pass/graph/op_inplace_pass.hpp"
 #include "nnfusion/engine/pass/graph/pattern_substitution.hpp"
 #include "nnfusion/engine/pass/graph/runtime_const_folding_pass.hpp"
+#include "nnfusion/engine/pass/graph/subgraph_fusion_pass.hpp"
 #include "nnfusion/engine/pass/graph/vector_dot_transpose_pass.hpp"
 #include "nnfusion/engine/pass/tensor/inplace_tensor_analysis.hpp"
 #include "nnfusion/engine/pass/tensor/liveness_analysis.hpp"
@@ -40,6 +43,7 @@ using namespace nnfusion::pass;
 CpuEngine::CpuEngine()
     : Engine()
 {
+    g_passes->push_back(make_shared<ControlFlowPass>());
     g_passes->push_back(make_shared<CSEPass>());
     g_passes->push_back(make_shared<AutodiffPass>());
     g_passes->push_back(make_shared<GradientWeightMappingPass>());
@@ -48,12 +52,16 @@ CpuEngine::CpuEngine()
     g_passes->push_back(make_shared<VectorDotTransposePass>());
     g_passes->push_back(make_shared<GemmFusionPass>());
     g_passes->push_back(make_shared<BatchNormInferenceFoldingPass>());
+    g_passes->push_back(make_shared<SubGraphFusionPass>());
     g_passes->push_back(make_shared<AssignLayoutPass>());
     g_passes->push_back(make_shared<OpInplacePass>());
 
     g_passes->push_back(make_shared<IRBasedFusionPass>());
     g_passes->push_back(make_shared<PatternSubstitutionPass>());
 
+    // Graph passes above are cached by the snapshot
+    g_passes->push_back(make_shared<GraphSnapshotPass>());
+
     // Kernel selection
     g_passes->push_back(make_shared<DefaultGNodeDeviceDispatcher>());
     g_passes->push_back(make_shared<KernelTuning>());
@@ -68,6 +76,8 @@ CpuEngine::CpuEngine()
     // Specific opt for dot
     g_passes->push_back(make_shared<DotTransposePass>());
 
+    g_passes->push_back(make_shared<BlockFusionPass>());
+
     // Assign stream passes
     g_passes->push_back(make_shared<AssignAsyncInfoPass>());
 
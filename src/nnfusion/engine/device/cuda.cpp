@@ -17,6 +17,7 @@
 #include "nnfusion/engine/pass/graph/gnode_device_dispatcher.hpp"
 #include "nnfusion/engine/pass/graph/gradient_weight_mapping_pass.hpp"
 #include "nnfusion/engine/pass/graph/graph_serialization_pass.hpp"
+#include "nnfusion/engine/pass/graph/graph_snapshot_pass.hpp"
 #include "nnfusion/engine/pass/graph/ir_based_fusion_pass.hpp"
 #include "nnfusion/engine/pass/graph/kernel_fusion_pass.hpp"
 #include "nnfusion/engine/pass/graph/kernel_profiling_pass.hpp"
@@ -77,6 +78,9 @@ CudaEngine::CudaEngine()
     g_passes->push_back(make_shared<PatternSubstitutionPass>());
     g_passes->push_back(make_shared<ToCPUPass>());
 
+    // Graph passes above are cached by the snapshot
+    g_passes->push_back(make_shared<GraphSnapshotPass>());
+
     // Kernel selection
     g_passes->push_back(make_shared<DefaultGNodeDeviceDispatcher>());
     g_passes->push_back(make_shared<KernelFusionPass>());
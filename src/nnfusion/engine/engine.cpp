@@ -43,7 +43,8 @@ bool Engine::run_on_graph(graph::Graph::Pointer graph, EngineContext::Pointer co
                        << (m_passes != nullptr ? m_passes->size() : 0);
 
     bool result = true;
-    if (t_passes != nullptr)
+    // tranverse passes are part of a restored graph snapshot
+    if (t_passes != nullptr && !pass::graph::GraphSnapshotPass::is_restored(context))
         result = t_passes->run_on_graph(graph, context);
 
     NNFUSION_CHECK(result) << "Engine failed after finished tranverse passes.";
@@ -55,7 +56,11 @@ bool Engine::run_on_graph(graph::Graph::Pointer graph, EngineContext::Pointer co
 
     ir::Program::Pointer p = nullptr;
     if (g_visitor != nullptr)
+    {
+        PassTracer::Scope trace(
+            PassTracer::get(), PassTracer::get_pass_name(*g_visitor), "graph_visitor", graph);
         p = g_visitor->run_on_graph(graph, context);
+    }
     else
         return result;
 
@@ -80,7 +85,11 @@ nnfusion::TranslationUnit::Pointer Engine::convert_graph_to_program(graph::Graph
         result = g_passes->run_on_graph(graph, context);
     NNFUSION_CHECK(result) << "Engine failed after finished graph passes.";
     ir::Program::Pointer p = nullptr;
-    p = g_visitor->run_on_graph(graph, context);
+    {
+        PassTracer::Scope trace(
+            PassTracer::get(), PassTracer::get_pass_name(*g_visitor), "graph_visitor", graph);
+        p = g_visitor->run_on_graph(graph, context);
+    }
 
     shared_ptr<TranslationUnit> tu(new TranslationUnit());
     shared_ptr<InterpreterContext> ctx(new InterpreterContext());
@@ -96,6 +105,10 @@ nnfusion::TranslationUnit::Pointer Engine::convert_graph_to_program(graph::Graph
     // neglect the codegen pass and inplace analysis
     for (size_t i = 0; i < m_passes->size() - 1; i++)
     {
+        PassTracer::Scope trace(PassTracer::get(),
+                                PassTracer::get_pass_name(*(*m_passes)[i]),
+                                "interpreter_pass",
+                                tu->m_graph);
         result = (*m_passes)[i]->run(ctx, tu);
         if (!result)
             break;
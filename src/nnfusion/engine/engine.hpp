@@ -8,6 +8,8 @@
 #include "nnfusion/engine/interpreter.hpp"
 #include "nnfusion/engine/memory_allocator.hpp"
 #include "nnfusion/engine/pass/graph/graph_pass_base.hpp"
+#include "nnfusion/engine/pass/graph/graph_snapshot_pass.hpp"
+#include "nnfusion/engine/pass_tracer.hpp"
 #include <cxxabi.h>
 
 /*
@@ -68,6 +70,10 @@ namespace nnfusion
 
             for (auto& pass : *this)
             {
+                PassTracer::Scope trace(PassTracer::get(),
+                                        PassTracer::get_pass_name(*pass),
+                                        "interpreter_pass",
+                                        _tu->m_graph);
                 // \todo(wenxh): make this interface fit (prog, context);
                 status = pass->run(ctx, _tu);
                 if (!status)
@@ -88,11 +94,25 @@ namespace nnfusion
             if (context != nullptr)
                 context->m_legacy_graph = graph;
 
-            for (auto& pass : *this)
+            size_t first_pass = 0;
+            // the passes before the snapshot are already applied to a restored graph
+            if (nnfusion::pass::graph::GraphSnapshotPass::is_restored(context))
+            {
+                while (first_pass < size() &&
+                       !dynamic_pointer_cast<nnfusion::pass::graph::GraphSnapshotPass>(
+                           (*this)[first_pass]))
+                    first_pass++;
+                NNFUSION_CHECK(first_pass < size()) << "Restored graph without a snapshot pass.";
+            }
+
+            for (size_t i = first_pass; i < size(); i++)
             {
+                auto& pass = (*this)[i];
                 int demangle_status;
                 NNFUSION_LOG(INFO) << "Pass " << abi::__cxa_demangle(typeid(*(pass.get())).name(), 0, 0, &demangle_status) << " starts";
                 pass->set_context(context);
+                PassTracer::Scope trace(
+                    PassTracer::get(), PassTracer::get_pass_name(*pass), "graph_pass", graph);
                 status = pass->run_on_graph(graph);
                 if (!status) {
                     int demangle_status;
@@ -2,23 +2,47 @@
 // Licensed under the MIT License.
 
 #include "memory_allocator.hpp"
+
+#include <algorithm>
+
 DECLARE_string(fhlsl_codegen_type);
 DECLARE_bool(fcustomized_mem_imp);
 DECLARE_bool(fenable_cpu);
 
+namespace
+{
+    LanguageUnit_p mman_header()
+    {
+        return LanguageUnit_p(new LanguageUnit("header::mman",
+                                               "#include <fcntl.h>\n#include <stdexcept>\n"
+                                               "#include <sys/mman.h>\n#include <sys/stat.h>\n"
+                                               "#include <unistd.h>\n"));
+    }
+}
+
 nnfusion::MemoryAllocator::node::node(size_t size, block_state state)
     : m_size{size}
     , m_state{state}
 {
 }
 
+nnfusion::MemoryAllocator::live_interval::live_interval(size_t size, size_t first_def)
+    : m_size{size}
+    , m_first_def{first_def}
+    , m_last_use{numeric_limits<size_t>::max()}
+    , m_offset{0}
+    , m_live_tensors{1}
+{
+}
+
 nnfusion::MemoryAllocator::MemoryAllocator(size_t alignment,
                                            bool disable_memory_reuse,
                                            NNFusion_DeviceType device_type,
                                            size_t device_id,
                                            const std::string& symbol)
     : m_alignment{alignment}
-    , m_scheme{disable_memory_reuse ? allocation_scheme::NO_REUSE : allocation_scheme::FIRST_FIT}
+    , m_scheme{disable_memory_reuse ? allocation_scheme::NO_REUSE
+                                    : get_alloc_scheme_by_name(FLAGS_fmem_alloc_scheme)}
     , m_device_type(device_type)
     , m_device_id(device_id)
     , m_max_allocated{0}
@@ -45,11 +69,32 @@ void nnfusion::MemoryAllocator::allocate(std::vector<shared_ptr<descriptor::Tens
         total_size += tensor->size();
     }
 
+    if (is_interval_scheme())
+    {
+        size_t id = new_interval(total_size);
+        m_intervals[id].m_live_tensors = tensors.size();
+        size_t delta = 0;
+        for (auto tensor : tensors)
+        {
+            tensor->set_pool_offset(delta);
+            tensor->set_pool(this->get_name());
+            m_tensor_interval[tensor] = std::make_pair(id, delta);
+            m_allocated_tensors.push_back(tensor);
+            delta += tensor->size();
+            if (record_trace)
+            {
+                this->record("[allocate]", tensor);
+            }
+        }
+        return;
+    }
+
     switch (m_scheme)
     {
     case allocation_scheme::FIRST_FIT: rc = first_fit(total_size); break;
     case allocation_scheme::BEST_FIT: rc = best_fit(total_size); break;
     case allocation_scheme::NO_REUSE: rc = no_reuse_allocator(total_size); break;
+    default: NNFUSION_CHECK_FAIL() << "Unsupported allocation scheme";
     }
     for (auto tensor : tensors)
     {
@@ -68,11 +113,26 @@ void nnfusion::MemoryAllocator::allocate(shared_ptr<descriptor::Tensor> tensor)
 {
     size_t rc;
     size_t size = tensor->size();
+    if (is_interval_scheme())
+    {
+        // the real offset is assigned in plan()
+        m_tensor_interval[tensor] = std::make_pair(new_interval(size), 0);
+        tensor->set_pool_offset(0);
+        tensor->set_pool(this->get_name());
+        m_allocated_tensors.push_back(tensor);
+        if (record_trace)
+        {
+            this->record("[allocate]", tensor);
+        }
+        return;
+    }
+
     switch (m_scheme)
     {
     case allocation_scheme::FIRST_FIT: rc = first_fit(size); break;
     case allocation_scheme::BEST_FIT: rc = best_fit(size); break;
     case allocation_scheme::NO_REUSE: rc = no_reuse_allocator(size); break;
+    default: NNFUSION_CHECK_FAIL() << "Unsupported allocation scheme";
     }
     tensor->set_pool_offset(rc);
     tensor->set_pool(this->get_name());
@@ -96,11 +156,18 @@ void nnfusion::MemoryAllocator::allocate(shared_ptr<descriptor::Tensor> tensor,
     size_t ref_count = root->ref();
     NNFUSION_CHECK(ref_count > 1);
     m_allocated_tensors.push_back(tensor);
-
     if (record_trace)
     {
         this->record("[allocate]", tensor);
     }
+
+    if (is_interval_scheme())
+    {
+        // offset is relative to the interval of root tensor, it is fixed up in plan()
+        auto it = m_tensor_interval.find(root);
+        if (it != m_tensor_interval.end())
+            m_tensor_interval[tensor] = std::make_pair(it->second.first, offset);
+    }
 }
 
 size_t nnfusion::MemoryAllocator::no_reuse_allocator(size_t size)
@@ -202,6 +269,24 @@ void nnfusion::MemoryAllocator::free(shared_ptr<descriptor::Tensor> tensor)
     if (tensor->deref() > 0)
         return;
 
+    if (is_interval_scheme())
+    {
+        auto it = m_tensor_interval.find(tensor);
+        NNFUSION_CHECK(it != m_tensor_interval.end())
+            << "bad free" << tensor->get_name() << " " << tensor->get_name(false);
+        // the interval of a set of tensors ends with the last of them
+        auto& interval = m_intervals[it->second.first];
+        NNFUSION_CHECK(interval.m_live_tensors > 0) << "double free" << tensor->get_name();
+        if (--interval.m_live_tensors == 0)
+            interval.m_last_use = m_timestep;
+        m_timestep++;
+        if (record_trace)
+        {
+            this->record("[free]", tensor);
+        }
+        return;
+    }
+
     size_t offset = tensor->get_pool_offset();
     size_t search_offset = 0;
     bool found = false;
@@ -244,6 +329,84 @@ void nnfusion::MemoryAllocator::free(shared_ptr<descriptor::Tensor> tensor)
     NNFUSION_CHECK(found) << "bad free" << tensor->get_name() << " " << tensor->get_name(false);
 }
 
+size_t nnfusion::MemoryAllocator::new_interval(size_t size)
+{
+    m_intervals.emplace_back(align(size, m_alignment), m_timestep++);
+    return m_intervals.size() - 1;
+}
+
+void nnfusion::MemoryAllocator::plan()
+{
+    if (!is_interval_scheme())
+        return;
+
+    switch (m_scheme)
+    {
+    case allocation_scheme::GREEDY_BY_SIZE: greedy_by_size(); break;
+    default: NNFUSION_CHECK_FAIL() << "Unsupported allocation scheme";
+    }
+
+    for (auto tensor : m_allocated_tensors)
+    {
+        auto it = m_tensor_interval.find(tensor);
+        // ref tensors of an external root keep their original offset
+        if (it == m_tensor_interval.end())
+            continue;
+        tensor->set_pool_offset(m_intervals[it->second.first].m_offset + it->second.second);
+        if (record_trace)
+        {
+            this->record("[allocate]", tensor);
+        }
+    }
+}
+
+void nnfusion::MemoryAllocator::greedy_by_size()
+{
+    // place the largest intervals first, each one goes to the smallest gap among
+    // the already placed intervals which are alive at the same time.
+    std::vector<size_t> order(m_intervals.size());
+    for (size_t i = 0; i < order.size(); i++)
+        order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return m_intervals[a].m_size > m_intervals[b].m_size;
+    });
+
+    // placed intervals sorted by offset
+    std::vector<size_t> placed;
+    size_t peak = 0;
+    for (auto id : order)
+    {
+        auto& cur = m_intervals[id];
+        size_t prev_end = 0;
+        size_t best_offset = numeric_limits<size_t>::max();
+        size_t min_gap = numeric_limits<size_t>::max();
+        for (auto other_id : placed)
+        {
+            auto& other = m_intervals[other_id];
+            if (!cur.overlaps(other))
+                continue;
+            if (other.m_offset >= prev_end)
+            {
+                size_t gap = other.m_offset - prev_end;
+                if (gap >= cur.m_size && gap < min_gap)
+                {
+                    min_gap = gap;
+                    best_offset = prev_end;
+                }
+            }
+            prev_end = max(prev_end, other.m_offset + other.m_size);
+        }
+        cur.m_offset = best_offset == numeric_limits<size_t>::max() ? prev_end : best_offset;
+        auto pos = std::upper_bound(
+            placed.begin(), placed.end(), cur.m_offset, [&](size_t offset, size_t i) {
+                return offset < m_intervals[i].m_offset;
+            });
+        placed.insert(pos, id);
+        peak = max(peak, cur.m_offset + cur.m_size);
+    }
+    m_max_allocated = peak;
+}
+
 void nnfusion::MemoryAllocator::dump(ostream& out)
 {
     out << m_trace.str();
@@ -366,6 +529,33 @@ size_t nnfusion::MemoryAllocator::align(size_t size, size_t alignment)
     return size;
 }
 
+nnfusion::MemoryAllocator::allocation_scheme
+    nnfusion::MemoryAllocator::get_alloc_scheme_by_name(const std::string& name)
+{
+    if (name == "first_fit")
+        return allocation_scheme::FIRST_FIT;
+    if (name == "best_fit")
+        return allocation_scheme::BEST_FIT;
+    if (name == "no_reuse")
+        return allocation_scheme::NO_REUSE;
+    if (name == "greedy_by_size")
+        return allocation_scheme::GREEDY_BY_SIZE;
+    NNFUSION_CHECK_FAIL() << "Unknown memory allocation scheme: " << name;
+    return allocation_scheme::FIRST_FIT;
+}
+
+std::string nnfusion::MemoryAllocator::get_alloc_scheme_name(allocation_scheme scheme)
+{
+    switch (scheme)
+    {
+    case allocation_scheme::FIRST_FIT: return "first_fit";
+    case allocation_scheme::BEST_FIT: return "best_fit";
+    case allocation_scheme::NO_REUSE: return "no_reuse";
+    case allocation_scheme::GREEDY_BY_SIZE: return "greedy_by_size";
+    }
+    return "";
+}
+
 size_t nnfusion::MemoryAllocator::cur_allocated() const
 {
     return (prev(m_node_list.end())->m_state == block_state::FREE)
@@ -383,6 +573,14 @@ size_t nnfusion::MemoryAllocator::memory_in_use() const
     }
     return allocated;
 }
+LanguageUnit_p nnfusion::HostMemoryAllocator::emit_memory_init()
+{
+    auto _lu = MemoryAllocator::emit_memory_init();
+    if (m_max_allocated > 0 && m_numa_node >= 0)
+        _lu->require(mman_header());
+    return _lu;
+}
+
 LanguageUnit_p nnfusion::HostMemoryAllocator::emit_memory_alloc()
 {
     LanguageUnit_p _lu(new LanguageUnit(this->get_name() + "_alloc"));
@@ -390,9 +588,31 @@ LanguageUnit_p nnfusion::HostMemoryAllocator::emit_memory_alloc()
         return _lu;
 
     auto& lu = *_lu;
-    if (m_max_allocated > 0)
+    if (m_max_allocated > 0 && in_workspace())
+    {
+        NNFUSION_CHECK(m_numa_node < 0) << "A NUMA-placed pool can not live in a workspace.";
+        lu << this->get_name() << "_memory_pool = " << m_workspace << " + " << m_workspace_offset
+           << ";\n";
+    }
+    else if (m_max_allocated > 0 && m_numa_node >= 0)
+    {
+        // fresh anonymous pages are placed on the node of the thread touching them first,
+        // so the pool is zeroed by a worker of its node before cpu_init writes any data.
+        auto pool = this->get_name() + "_memory_pool";
+        auto pool_size = align(m_max_allocated, 4096);
+        lu << pool << " = (char*)mmap(NULL, " << pool_size
+           << ", PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);\n";
+        lu << "if ((void*)" << pool << " == MAP_FAILED)\n";
+        lu << "    throw std::runtime_error(\"Failed to allocate " << pool << "\");\n";
+        lu << "worker_thread_pool->ScheduleSync([]() { memset(" << pool << ", 0, " << pool_size
+           << "); }, " << m_numa_node << ");\n";
+    }
+    else if (m_max_allocated > 0)
     {
         lu << this->get_name() << "_memory_pool = (char *)malloc(" << m_max_allocated << ");\n";
+    }
+    if (m_max_allocated > 0)
+    {
         for (auto tensor : m_allocated_tensors)
         {
             NNFUSION_CHECK(tensor->get_pool() == this->get_name());
@@ -414,11 +634,15 @@ LanguageUnit_p nnfusion::HostMemoryAllocator::emit_memory_alloc()
 LanguageUnit_p nnfusion::HostMemoryAllocator::emit_memory_free()
 {
     LanguageUnit_p _lu(new LanguageUnit(this->get_name() + "_free"));
-    if (FLAGS_fcustomized_mem_imp)
+    if (FLAGS_fcustomized_mem_imp || in_workspace())
         return _lu;
 
     auto& lu = *_lu;
-    lu << "free(" << this->get_name() + "_memory_pool);\n";
+    if (m_max_allocated > 0 && m_numa_node >= 0)
+        lu << "munmap(" << this->get_name() + "_memory_pool, " << align(m_max_allocated, 4096)
+           << ");\n";
+    else
+        lu << "free(" << this->get_name() + "_memory_pool);\n";
     return _lu;
 }
 
@@ -431,6 +655,145 @@ LanguageUnit_p nnfusion::HostMemoryAllocator::emit_memory_set(int value)
     return _lu;
 }
 
+void nnfusion::HostConstantMemoryAllocator::bind_data(shared_ptr<descriptor::Tensor> tensor,
+                                                     const void* data)
+{
+    NNFUSION_CHECK(tensor->get_pool() == this->get_name());
+    NNFUSION_CHECK_NOT_NULLPTR(data);
+    m_tensor_data[tensor] = data;
+}
+
+std::vector<shared_ptr<nnfusion::descriptor::Tensor>>
+    nnfusion::HostConstantMemoryAllocator::get_root_tensors()
+{
+    std::vector<shared_ptr<descriptor::Tensor>> roots;
+    for (auto tensor : m_allocated_tensors)
+    {
+        if (!tensor->get_root_tensor())
+            roots.push_back(tensor);
+    }
+    return roots;
+}
+
+void nnfusion::HostConstantMemoryAllocator::dump_blob()
+{
+    if (m_max_allocated == 0)
+        return;
+
+    // inplace views share the data of their root tensor
+    std::vector<char> blob(align(m_max_allocated, 4096), 0);
+    nlohmann::json manifest;
+    manifest["blob"] = get_name() + ".bin";
+    manifest["constants"] = nlohmann::json::array();
+    for (auto tensor : get_root_tensors())
+    {
+        NNFUSION_CHECK(m_tensor_data.count(tensor) > 0) << "No data bound to constant tensor "
+                                                        << tensor->get_name();
+        NNFUSION_CHECK(tensor->get_pool_offset() + tensor->size() <= m_max_allocated);
+        memcpy(blob.data() + tensor->get_pool_offset(), m_tensor_data[tensor], tensor->size());
+        manifest["constants"].push_back({{"name", tensor->get_name()},
+                                         {"offset", tensor->get_pool_offset()},
+                                         {"size", tensor->size()}});
+    }
+
+    nnfusion::codegen::create_folder("./Constant/");
+    ofstream bin_file(m_blob_path, ios::out | ios::binary);
+    NNFUSION_CHECK(bin_file.is_open()) << "Failed to open " << m_blob_path;
+    bin_file.write(blob.data(), blob.size());
+    bin_file.close();
+
+    ofstream manifest_file(m_manifest_path);
+    NNFUSION_CHECK(manifest_file.is_open()) << "Failed to open " << m_manifest_path;
+    manifest_file << manifest.dump(4);
+    manifest_file.close();
+}
+
+LanguageUnit_p nnfusion::HostConstantMemoryAllocator::emit_memory_init()
+{
+    auto _lu = MemoryAllocator::emit_memory_init();
+    if (m_max_allocated > 0)
+    {
+        _lu->require(mman_header());
+    }
+    return _lu;
+}
+
+LanguageUnit_p nnfusion::HostConstantMemoryAllocator::emit_memory_alloc()
+{
+    LanguageUnit_p _lu(new LanguageUnit(this->get_name() + "_alloc"));
+    if (FLAGS_fcustomized_mem_imp)
+        return _lu;
+
+    auto& lu = *_lu;
+    if (m_max_allocated == 0)
+        return _lu;
+
+    auto pool = this->get_name() + "_memory_pool";
+    auto emit_tensors = [&](bool external) {
+        auto roots = get_root_tensors();
+        for (auto tensor : m_allocated_tensors)
+        {
+            NNFUSION_CHECK(tensor->get_pool() == this->get_name());
+            lu << tensor->get_name() << " = (" << tensor->get_element_type().c_type_string()
+               << "*)(";
+            if (!external)
+            {
+                lu << pool << "+" << tensor->get_pool_offset() << ");\n";
+                continue;
+            }
+            auto root = tensor->get_root_tensor() ? tensor->get_root_tensor() : tensor;
+            size_t index = std::find(roots.begin(), roots.end(), root) - roots.begin();
+            NNFUSION_CHECK(index < roots.size()) << "The root of " << tensor->get_name()
+                                                 << " is not a constant of " << get_name();
+            lu << m_external_table << "[" << index << "]+"
+               << tensor->get_pool_offset() - root->get_pool_offset() << ");\n";
+        }
+    };
+
+    if (!m_external_table.empty())
+    {
+        lu << "if (" << m_external_table << ")\n{\n";
+        emit_tensors(true);
+        lu << "}\nelse\n";
+    }
+    // the blob is mapped read-only, its pages are shared by all processes loading it.
+    auto blob_size = align(m_max_allocated, 4096);
+    lu << "{\n";
+    lu << "int fd = open(\"" << m_blob_path << "\", O_RDONLY);\n";
+    lu << "struct stat st;\n";
+    lu << "if (fd < 0 || fstat(fd, &st) != 0 || st.st_size != " << blob_size << ")\n";
+    lu << "    throw std::runtime_error(\"Invalid constant blob: " << m_blob_path << "\");\n";
+    lu << pool << " = (char*)mmap(NULL, " << blob_size << ", PROT_READ, MAP_PRIVATE, fd, 0);\n";
+    lu << "close(fd);\n";
+    lu << "if ((void*)" << pool << " == MAP_FAILED)\n";
+    lu << "    throw std::runtime_error(\"Failed to mmap " << m_blob_path << "\");\n";
+    emit_tensors(false);
+    lu << "}\n";
+    return _lu;
+}
+
+LanguageUnit_p nnfusion::HostConstantMemoryAllocator::emit_memory_free()
+{
+    LanguageUnit_p _lu(new LanguageUnit(this->get_name() + "_free"));
+    if (FLAGS_fcustomized_mem_imp || m_max_allocated == 0)
+        return _lu;
+
+    // the pool stays unmapped when the constants are handed over by the external table
+    auto& lu = *_lu;
+    auto pool = this->get_name() + "_memory_pool";
+    lu << "if (" << pool << ")\n{\n";
+    lu << "munmap(" << pool << ", " << align(m_max_allocated, 4096) << ");\n";
+    lu << pool << " = NULL;\n}\n";
+    return _lu;
+}
+
+LanguageUnit_p nnfusion::HostConstantMemoryAllocator::emit_memory_set(int value)
+{
+    // constants are read-only
+    LanguageUnit_p _lu(new LanguageUnit(this->get_name() + "_memset"));
+    return _lu;
+}
+
 LanguageUnit_p nnfusion::HLSLMemoryAllocator::emit_memory_init()
 {
     LanguageUnit_p _lu(new LanguageUnit("declaration::" + this->get_name() + "_init"));
@@ -522,6 +885,18 @@ nnfusion::MemoryAllocatorFactory::MemoryAllocatorFactory(size_t alignment, bool
         << "Memory alignment must be > 0";
 }
 
+int nnfusion::MemoryAllocatorFactory::get_numa_node(const std::string& group) const
+{
+    if (m_numa_node_num <= 1)
+        return -1;
+    const std::string persist_prefix = "persist_numa";
+    if (group.compare(0, persist_prefix.size(), persist_prefix) == 0)
+        return std::stoi(group.substr(persist_prefix.size())) % m_numa_node_num;
+    if (!group.empty() && std::all_of(group.begin(), group.end(), ::isdigit))
+        return std::stoi(group) % m_numa_node_num;
+    return -1;
+}
+
 MemoryAllocator*
     nnfusion::MemoryAllocatorFactory::get_allocator(shared_ptr<descriptor::Tensor> tensor)
 {
@@ -579,11 +954,13 @@ MemoryAllocator*
                 }
                 case GENERIC_CPU:
                 {
-                    allocator = new HostMemoryAllocator(m_alignment,
-                                                        m_disable_reuse,
-                                                        GENERIC_CPU,
-                                                        tensor->get_device_id(),
-                                                        "group_" + group + "_memset0");
+                    auto host_allocator = new HostMemoryAllocator(m_alignment,
+                                                                  m_disable_reuse,
+                                                                  GENERIC_CPU,
+                                                                  tensor->get_device_id(),
+                                                                  "group_" + group + "_memset0");
+                    host_allocator->set_numa_node(get_numa_node(group));
+                    allocator = host_allocator;
                     break;
                 }
                 default: NNFUSION_LOG(ERROR) << "No valid allocator found: " << search_name; break;
@@ -595,7 +972,14 @@ MemoryAllocator*
         }
         else
         {
-            if (tensor->is_RDMA_tensor())
+            if (group == "constant" && tensor->get_device_type() == GENERIC_CPU)
+            {
+                auto allocator = new HostConstantMemoryAllocator(
+                    m_alignment, GENERIC_CPU, tensor->get_device_id(), "group_" + group);
+                m_allocator_list[search_name] = allocator;
+                return allocator;
+            }
+            else if (tensor->is_RDMA_tensor())
             {
                 auto device_type = tensor->get_device_type();
                 RDMAMemoryAllocator* allocator =
@@ -632,11 +1016,13 @@ MemoryAllocator*
                 }
                 case GENERIC_CPU:
                 {
-                    allocator = new HostMemoryAllocator(m_alignment,
-                                                        m_disable_reuse,
-                                                        GENERIC_CPU,
-                                                        tensor->get_device_id(),
-                                                        "group_" + group);
+                    auto host_allocator = new HostMemoryAllocator(m_alignment,
+                                                                  m_disable_reuse,
+                                                                  GENERIC_CPU,
+                                                                  tensor->get_device_id(),
+                                                                  "group_" + group);
+                    host_allocator->set_numa_node(get_numa_node(group));
+                    allocator = host_allocator;
                     break;
                 }
                 case HLSL:
@@ -10,6 +10,7 @@
 #include <list>
 
 DECLARE_bool(fmem_trace);
+DECLARE_string(fmem_alloc_scheme);
 
 namespace nnfusion
 {
@@ -28,7 +29,10 @@ namespace nnfusion
         {
             FIRST_FIT,
             BEST_FIT,
-            NO_REUSE
+            NO_REUSE,
+            // Record the [first-def, last-use] interval of every tensor and assign
+            // offsets globally in plan(), largest tensor first.
+            GREEDY_BY_SIZE
         };
 
         class node
@@ -41,6 +45,23 @@ namespace nnfusion
             block_state m_state;
         };
 
+        class live_interval
+        {
+        public:
+            live_interval(size_t size, size_t first_def);
+
+            bool overlaps(const live_interval& other) const
+            {
+                return !(m_last_use < other.m_first_def || other.m_last_use < m_first_def);
+            }
+            size_t m_size;
+            size_t m_first_def;
+            size_t m_last_use;
+            size_t m_offset;
+            // the tensors placed in the interval which are not freed yet
+            size_t m_live_tensors;
+        };
+
         // allocate a set of tensors.
         virtual void allocate(std::vector<shared_ptr<descriptor::Tensor>>& tensors);
         // allocate one tensor.
@@ -50,6 +71,8 @@ namespace nnfusion
                               shared_ptr<descriptor::Tensor> root_tensor,
                               size_t offset = 0);
         virtual void free(shared_ptr<descriptor::Tensor> tensor);
+        // assign the final offsets for interval-based schemes, no-op for the others.
+        virtual void plan();
 
         void dump(std::ostream&);
         void record(string symbol, shared_ptr<descriptor::Tensor> tensor);
@@ -59,6 +82,8 @@ namespace nnfusion
         virtual LanguageUnit_p emit_memory_set(int value = 0);
 
         static size_t align(size_t x, size_t alignment);
+        static allocation_scheme get_alloc_scheme_by_name(const std::string& name);
+        static std::string get_alloc_scheme_name(allocation_scheme scheme);
 
         std::list<node>::iterator begin() { return m_node_list.begin(); }
         std::list<node>::iterator end() { return m_node_list.end(); }
@@ -80,8 +105,17 @@ namespace nnfusion
         size_t first_fit(size_t size);
         size_t best_fit(size_t size);
         size_t no_reuse_allocator(size_t size);
+        bool is_interval_scheme() const { return m_scheme == allocation_scheme::GREEDY_BY_SIZE; }
+        size_t new_interval(size_t size);
+        void greedy_by_size();
 
         std::list<node> m_node_list;
+        // used by interval-based schemes, offsets of tensors are relative to the
+        // base of their interval until plan() is called.
+        std::vector<live_interval> m_intervals;
+        std::unordered_map<shared_ptr<descriptor::Tensor>, std::pair<size_t, size_t>>
+            m_tensor_interval;
+        size_t m_timestep = 0;
         size_t m_alignment;
         allocation_scheme m_scheme;
         NNFusion_DeviceType m_device_type;
@@ -119,10 +153,22 @@ namespace nnfusion
         friend class MemoryAllocatorFactory;
 
     public:
+        LanguageUnit_p emit_memory_init() override;
         LanguageUnit_p emit_memory_alloc() override;
         LanguageUnit_p emit_memory_free() override;
         LanguageUnit_p emit_memory_set(int value = 0) override;
 
+        // the pool is first touched by a thread of the NUMA node, -1 for no placement.
+        void set_numa_node(int numa_node) { m_numa_node = numa_node; }
+        int get_numa_node() const { return m_numa_node; }
+        // the pool is carved out of the external buffer named workspace at offset instead of
+        // being allocated, and is neither freed nor owned by the runtime.
+        void set_workspace(const std::string& workspace, size_t offset)
+        {
+            m_workspace = workspace;
+            m_workspace_offset = offset;
+        }
+        bool in_workspace() const { return !m_workspace.empty(); }
     private:
         HostMemoryAllocator(size_t alignment = 1,
                             bool disable_reuse = false,
@@ -132,6 +178,51 @@ namespace nnfusion
             : MemoryAllocator(alignment, disable_reuse, device_type, device_id, symbol)
         {
         }
+
+        int m_numa_node = -1;
+        std::string m_workspace;
+        size_t m_workspace_offset = 0;
+    };
+
+    ///\brief Packs all constant tensors into one blob file, which is mmap-ed read-only
+    /// in the init function, so the weights are neither copied nor duplicated across
+    /// processes loading the same model.
+    class HostConstantMemoryAllocator : public MemoryAllocator
+    {
+        friend class MemoryAllocatorFactory;
+
+    public:
+        LanguageUnit_p emit_memory_init() override;
+        LanguageUnit_p emit_memory_alloc() override;
+        LanguageUnit_p emit_memory_free() override;
+        LanguageUnit_p emit_memory_set(int value = 0) override;
+
+        void bind_data(shared_ptr<descriptor::Tensor> tensor, const void* data);
+        // write the blob with every bound tensor at its pool offset, and a manifest listing
+        // the root tensors in the order of their entries in the external table.
+        void dump_blob();
+        const std::string& get_blob_path() const { return m_blob_path; }
+        // let the table, a char** set before the init function, hand over the root tensors
+        // in place of the blob.
+        void set_external_table(const std::string& table) { m_external_table = table; }
+    private:
+        HostConstantMemoryAllocator(size_t alignment = 1,
+                                    NNFusion_DeviceType device_type = GENERIC_CPU,
+                                    size_t device_id = 0,
+                                    const std::string& symbol = "")
+            : MemoryAllocator(alignment, true, device_type, device_id, symbol)
+            , m_blob_path("./Constant/" + get_name() + ".bin")
+            , m_manifest_path("./Constant/" + get_name() + ".json")
+        {
+        }
+
+        // the tensors without a root tensor, i.e. those owning their data
+        std::vector<shared_ptr<descriptor::Tensor>> get_root_tensors();
+
+        std::string m_blob_path;
+        std::string m_manifest_path;
+        std::string m_external_table;
+        std::unordered_map<shared_ptr<descriptor::Tensor>, const void*> m_tensor_data;
     };
 
     class RocmMemoryAllocator : public MemoryAllocator
@@ -191,6 +282,9 @@ namespace nnfusion
         MemoryAllocatorFactory(size_t alignment = 1, bool disable_reuse = false);
         MemoryAllocator* get_allocator(shared_ptr<descriptor::Tensor> tensor);
         size_t get_alignment() const { return m_alignment; }
+        // bind host pools to NUMA nodes: stream groups round-robin, "persist_numa<k>" to k.
+        void set_numa_node_num(int numa_node_num) { m_numa_node_num = numa_node_num; }
+        int get_numa_node(const std::string& group) const;
         const std::unordered_map<std::string, MemoryAllocator*>& get_allocator_list()
         {
             return m_allocator_list;
@@ -199,6 +293,7 @@ namespace nnfusion
     private:
         size_t m_alignment;
         bool m_disable_reuse;
+        int m_numa_node_num = 1;
         // map from names to allocators
         std::unordered_map<std::string, MemoryAllocator*> m_allocator_list;
     };
@@ -2,6 +2,10 @@
 // Licensed under the MIT License.
 
 #include "base_codegen_pass.hpp"
+#include <dirent.h>
+#include <atomic>
+#include <exception>
+#include <thread>
 #include "nnfusion/core/kernels/kernel_emitter.hpp"
 
 using namespace nnfusion;
@@ -13,6 +17,29 @@ DECLARE_bool(fkernels_as_files);
 DECLARE_int64(fkernels_files_number);
 DECLARE_bool(fcustomized_mem_imp);
 DECLARE_string(fantares_perf_file);
+DEFINE_bool(fincremental_codegen,
+            false,
+            "Name kernel files by content hash and drop stale ones, so rebuilds only compile "
+            "changed kernels. Objects are only reused across build folders when ccache is "
+            "installed.");
+DEFINE_int32(fcodegen_threads,
+             1,
+             "Number of threads to emit kernel sources, 0 to use all cores.");
+
+namespace
+{
+    // stable across builds and platforms, unlike std::hash
+    uint64_t fnv1a_hash(const std::string& str)
+    {
+        uint64_t hash = 14695981039346656037ULL;
+        for (unsigned char c : str)
+        {
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+}
 
 bool BaseCodegenPass::run(std::shared_ptr<InterpreterContext> ctx,
                           std::shared_ptr<TranslationUnit> tu)
@@ -25,6 +52,8 @@ bool BaseCodegenPass::run(std::shared_ptr<InterpreterContext> ctx,
 
     // codegen
     projgen->codegen();
+    if (FLAGS_fincremental_codegen)
+        remove_stale_kernel_files();
     NNFUSION_CHECK(after_projgen());
     NNFUSION_LOG(INFO) << "Codegen for " << get_device_str(device_type()) << " done.";
     exit(0);
@@ -73,7 +102,18 @@ void BaseCodegenPass::separate_func_defs_files(int file_number, const string& ke
             if (func_def->pwd.empty())
                 func_def->pwd = kernel_folder;
             string fname = func_def->symbol;
-            if (fname.length() > 128)
+            if (FLAGS_fincremental_codegen)
+            {
+                // the file name only changes with its content
+                std::string content = func_def->get_code();
+                for (auto& sym : std::set<std::string>(func_def->required.begin(),
+                                                       func_def->required.end()))
+                    content += "\n" + sym;
+                std::stringstream ss;
+                ss << "kernel_" << std::hex << fnv1a_hash(content);
+                fname = ss.str();
+            }
+            else if (fname.length() > 128)
             {
                 size_t hashcode = std::hash<std::string>{}(fname);
                 fname = "compressed_src_" + std::to_string(hashcode);
@@ -96,6 +136,33 @@ void BaseCodegenPass::separate_func_defs_files(int file_number, const string& ke
     }
 }
 
+void BaseCodegenPass::remove_stale_kernel_files()
+{
+    DIR* dir = opendir(m_kernel_folder.c_str());
+    if (dir == nullptr)
+        return;
+    auto& codegen_files = projgen->get_codegen_files();
+    size_t removed = 0;
+    while (struct dirent* entry = readdir(dir))
+    {
+        std::string name = entry->d_name;
+        if (name.compare(0, 7, "kernel_") != 0 || name.size() < m_kernel_suffix.size() ||
+            name.compare(name.size() - m_kernel_suffix.size(),
+                         m_kernel_suffix.size(),
+                         m_kernel_suffix) != 0)
+            continue;
+        std::string path = m_kernel_folder + name;
+        if (codegen_files.find(path) == codegen_files.end())
+        {
+            NNFUSION_CHECK(remove(path.c_str()) == 0) << "Failed to remove " << path;
+            removed++;
+        }
+    }
+    closedir(dir);
+    if (removed > 0)
+        NNFUSION_LOG(INFO) << "Removed " << removed << " stale kernel files.";
+}
+
 void BaseCodegenPass::add_init_and_exit_pair(LanguageUnit_p lup_in_init, LanguageUnit_p lup_in_exit)
 {
     //add to init
@@ -195,6 +262,65 @@ bool BaseCodegenPass::collect_mem(std::shared_ptr<InterpreterContext> ctx,
     return true;
 }
 
+void BaseCodegenPass::emit_kernel_sources(std::shared_ptr<TranslationUnit> tu)
+{
+    size_t num_threads = FLAGS_fcodegen_threads > 0 ? FLAGS_fcodegen_threads
+                                                    : std::thread::hardware_concurrency();
+    if (num_threads <= 1)
+        return;
+
+    // collect kernels in program order, names are generated serially in this order so
+    // that the emitted code is the same as a serial run.
+    std::vector<KernelEmitter::Pointer> kernels;
+    std::unordered_set<KernelEmitter::Pointer> visited;
+    for (auto iterator : tu->program)
+    {
+        for (auto ins : *iterator)
+        {
+            auto kernel = ins->getKernel();
+            if (!kernel || kernel->is_emitted() || visited.count(kernel) > 0)
+                continue;
+            visited.insert(kernel);
+            kernel->prepare_function_name();
+            kernels.push_back(kernel);
+        }
+    }
+    num_threads = std::min(num_threads, kernels.size());
+    if (num_threads <= 1)
+        return;
+
+    // each kernel only touches its own emitter, dependencies are merged later in the
+    // serial codegen loops.
+    std::atomic<size_t> next(0);
+    std::vector<std::exception_ptr> errors(kernels.size());
+    auto worker = [&]() {
+        for (size_t i = next++; i < kernels.size(); i = next++)
+        {
+            try
+            {
+                kernels[i]->get_or_emit_source();
+            }
+            catch (...)
+            {
+                errors[i] = std::current_exception();
+            }
+        }
+    };
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < num_threads; i++)
+        workers.emplace_back(worker);
+    for (auto& t : workers)
+        t.join();
+
+    for (auto& error : errors)
+    {
+        if (error)
+            std::rethrow_exception(error);
+    }
+    NNFUSION_LOG(INFO) << "Emitted " << kernels.size() << " kernels with " << num_threads
+                       << " threads.";
+}
+
 bool BaseCodegenPass::after_projgen()
 {
     struct stat s;
@@ -64,6 +64,10 @@ namespace nnfusion
             const std::string& get_kernel_suffix() const { return m_kernel_suffix; }
             const std::string& get_kernel_folder() const { return m_kernel_folder; }
             void separate_func_defs_files(int file_number, const std::string& kernel_folder);
+            // remove kernel files left in the kernel folder by previous runs
+            void remove_stale_kernel_files();
+            // emit the sources of all kernels in tu concurrently, see -fcodegen_threads
+            void emit_kernel_sources(std::shared_ptr<TranslationUnit> tu);
             void add_init_and_exit_pair(LanguageUnit_p lup_in_init, LanguageUnit_p lup_in_exit);
 
             template <typename LanguageUnitType1, typename LanguageUnitType2>
@@ -95,6 +95,15 @@ add_dependencies(${TARGET_NAME} CUB)
 include_directories(${CUB_INCLUDE_DIR})
 )");
 
+LU_DEFINE(nnfusion::codegen::cmake::ccache,
+          R"(
+find_program(CCACHE_PROGRAM ccache)
+if (CCACHE_PROGRAM)
+set(CMAKE_C_COMPILER_LAUNCHER ${CCACHE_PROGRAM})
+set(CMAKE_CXX_COMPILER_LAUNCHER ${CCACHE_PROGRAM})
+endif()
+)");
+
 LU_DEFINE(nnfusion::codegen::helper::debug,
           R"(
 
@@ -20,6 +20,7 @@ namespace nnfusion
             LU_DECLARE(cuda_lib);
             LU_DECLARE(rocm_lib);
             LU_DECLARE(cub);
+            LU_DECLARE(ccache);
         } // namespace cmake
         namespace helper
         {
@@ -7,6 +7,7 @@
 
 DECLARE_bool(fkernels_as_files);
 DECLARE_int64(fkernels_files_number);
+DECLARE_bool(fincremental_codegen);
 
 using namespace nnfusion;
 using namespace nnfusion::codegen;
@@ -204,6 +205,17 @@ bool CodeGenerator::codegen()
     }
 
     std::unordered_set<std::string> codegen_files;
+    // with -fincremental_codegen, previous versions of the files are kept aside and put back
+    // if nothing changed, so that their timestamps are kept and build tools do not recompile
+    // them.
+    const std::string prev_suffix = ".nnfusion_prev";
+    auto keep_prev_file = [&](const std::string& path) {
+        if (!FLAGS_fincremental_codegen)
+            return;
+        struct stat buffer;
+        if (stat(path.c_str(), &buffer) == 0 && S_ISREG(buffer.st_mode))
+            NNFUSION_CHECK(rename(path.c_str(), (path + prev_suffix).c_str()) == 0);
+    };
     auto clear_file = [&](const std::string& pwd, const std::string& write_to) {
         int pos = pwd.find("/");
         while (pos != std::string::npos)
@@ -229,6 +241,7 @@ bool CodeGenerator::codegen()
             if (codegen_files.find(shared_header) == codegen_files.end())
             {
                 codegen_files.insert(shared_header);
+                keep_prev_file(shared_header);
                 std::ofstream file;
                 file.open(shared_header);
                 // file << nnfusion::kernels::boilerplate::MIT1->get_code();
@@ -245,6 +258,7 @@ bool CodeGenerator::codegen()
         if (codegen_files.find(search) == codegen_files.end())
         {
             codegen_files.insert(search);
+            keep_prev_file(search);
             std::ofstream file;
             file.open(search);
             // if (search.find(".txt", search.size() - 4) == string::npos)
@@ -299,6 +313,34 @@ bool CodeGenerator::codegen()
         file.close();
     }
 
+    auto read_file = [](const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    };
+    size_t unchanged = 0;
+    if (FLAGS_fincremental_codegen)
+    {
+        for (auto search : codegen_files)
+        {
+            std::string prev = search + prev_suffix;
+            struct stat buffer;
+            if (stat(prev.c_str(), &buffer) != 0)
+                continue;
+            if (read_file(prev) == read_file(search))
+            {
+                NNFUSION_CHECK(rename(prev.c_str(), search.c_str()) == 0);
+                unchanged++;
+            }
+            else
+            {
+                NNFUSION_CHECK(remove(prev.c_str()) == 0);
+            }
+        }
+    }
+    NNFUSION_LOG(INFO) << "Codegen wrote " << codegen_files.size() - unchanged << " files, "
+                       << unchanged << " unchanged.";
+    m_codegen_files = codegen_files;
+
     return true;
 }
 
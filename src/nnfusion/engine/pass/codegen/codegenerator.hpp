@@ -114,6 +114,11 @@ namespace nnfusion
             }
             const std::string& get_codegen_folder() const { return m_codegen_folder; }
             bool need_shared_file() { return !files_include_shared.empty(); }
+            // files written by the last codegen()
+            const std::unordered_set<std::string>& get_codegen_files() const
+            {
+                return m_codegen_files;
+            }
             using Pointer = std::shared_ptr<CodeGenerator>;
 
         protected:
@@ -121,6 +126,7 @@ namespace nnfusion
             std::string m_codegen_folder;
             std::string m_kernel_suffix;
             std::unordered_set<std::string> files_include_shared;
+            std::unordered_set<std::string> m_codegen_files;
         };
     }
 }
\ No newline at end of file
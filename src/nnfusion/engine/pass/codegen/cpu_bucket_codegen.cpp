@@ -0,0 +1,615 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "cpu_bucket_codegen.hpp"
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <unordered_map>
+
+#include "nnfusion/core/kernels/common_langunit.hpp"
+
+using namespace nnfusion;
+
+namespace
+{
+    struct BucketParam
+    {
+        // the frontend name keys the parameter across the para_info.json of the buckets
+        std::string key;
+        std::string name;
+        std::string type;
+        bool is_output;
+        std::vector<nnfusion::Shape> shapes;
+        // the index of the dim each axis follows, -1 for a static axis
+        std::vector<int> axis_dims;
+    };
+
+    nlohmann::json read_para_info(const std::string& folder)
+    {
+        std::ifstream in(folder + "para_info.json");
+        NNFUSION_CHECK(in.is_open()) << "Failed to open " << folder << "para_info.json";
+        nlohmann::json para_info;
+        in >> para_info;
+        return para_info;
+    }
+
+    // the kernel_entry parameters in order, i.e. all inputs then all outputs
+    std::vector<BucketParam> read_params(const nlohmann::json& para_info)
+    {
+        std::vector<std::pair<size_t, BucketParam>> inputs, outputs;
+        for (auto type : {"input", "weight", "output"})
+        {
+            if (para_info.find(type) == para_info.end())
+                continue;
+            bool is_output = std::string(type) == "output";
+            std::string array = is_output ? "outputs[" : "inputs[";
+            for (auto it = para_info[type].begin(); it != para_info[type].end(); ++it)
+            {
+                // the id is like ((float*)(inputs[0]))
+                std::string id = it.value()["id"];
+                auto type_end = id.find("*)");
+                auto index_begin = id.find(array);
+                NNFUSION_CHECK(id.compare(0, 2, "((") == 0 && type_end != std::string::npos &&
+                               index_begin != std::string::npos)
+                    << "Unknown parameter id " << id;
+                BucketParam param;
+                param.key = it.key();
+                param.name = it.value()["name"];
+                param.type = id.substr(2, type_end - 2);
+                param.is_output = is_output;
+                size_t index = std::stoull(id.substr(index_begin + array.size()));
+                (is_output ? outputs : inputs).push_back(std::make_pair(index, param));
+            }
+        }
+        std::sort(inputs.begin(), inputs.end(), [](const std::pair<size_t, BucketParam>& a,
+                                                   const std::pair<size_t, BucketParam>& b) {
+            return a.first < b.first;
+        });
+        std::sort(outputs.begin(), outputs.end(), [](const std::pair<size_t, BucketParam>& a,
+                                                     const std::pair<size_t, BucketParam>& b) {
+            return a.first < b.first;
+        });
+        std::vector<BucketParam> params;
+        for (auto& it : inputs)
+            params.push_back(it.second);
+        for (auto& it : outputs)
+            params.push_back(it.second);
+        return params;
+    }
+
+    nnfusion::Shape find_shape(const nlohmann::json& para_info, const BucketParam& param)
+    {
+        for (auto type : {"input", "weight", "output"})
+        {
+            if ((std::string(type) == "output") != param.is_output ||
+                para_info.find(type) == para_info.end() ||
+                para_info[type].find(param.key) == para_info[type].end())
+                continue;
+            std::vector<size_t> shape = para_info[type][param.key]["shape"];
+            return nnfusion::Shape(shape);
+        }
+        NNFUSION_CHECK_FAIL() << "Parameter " << param.key << " is missed in a bucket.";
+        return nnfusion::Shape();
+    }
+
+    std::vector<std::string> list_files(const std::string& folder)
+    {
+        std::vector<std::string> files;
+        DIR* dir = opendir(folder.c_str());
+        if (!dir)
+            return files;
+        while (auto entry = readdir(dir))
+        {
+            std::string file = entry->d_name;
+            struct stat st;
+            if (stat((folder + file).c_str(), &st) == 0 && S_ISREG(st.st_mode))
+                files.push_back(file);
+        }
+        closedir(dir);
+        std::sort(files.begin(), files.end());
+        return files;
+    }
+
+    bool ends_with(const std::string& str, const std::string& suffix)
+    {
+        return str.size() >= suffix.size() &&
+               str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+
+    // Moves the blob constants of the buckets into one blob written to path, which holds every
+    // distinct constant once. Returns the offsets of the constants of each bucket in the order
+    // of its manifest, i.e. the order its cpu_set_constants() takes them.
+    std::vector<std::vector<size_t>>
+        pack_constants(const std::string& folder,
+                       const std::vector<nnfusion::codegen::ShapeBucket>& buckets,
+                       const std::string& path)
+    {
+        std::vector<std::vector<size_t>> offsets(buckets.size());
+        std::string packed;
+        // the offsets of the packed constants by the hash of their data
+        std::unordered_multimap<size_t, size_t> packed_offsets;
+        for (size_t b = 0; b < buckets.size(); b++)
+        {
+            std::string constant_folder = folder + buckets[b].folder + "/Constant/";
+            auto files = list_files(constant_folder);
+            std::vector<std::string> manifests;
+            for (auto& file : files)
+            {
+                if (ends_with(file, ".json"))
+                    manifests.push_back(file);
+            }
+            NNFUSION_CHECK(manifests.size() <= 1) << "Bucket " << buckets[b].folder
+                                                  << " has more than one constant blob.";
+            if (manifests.empty())
+            {
+                NNFUSION_CHECK(files.empty())
+                    << "Bucket " << buckets[b].folder
+                    << " loads its constant files itself, compile it with -fcpu_constant_mmap.";
+                continue;
+            }
+
+            nlohmann::json manifest;
+            {
+                std::ifstream in(constant_folder + manifests[0]);
+                NNFUSION_CHECK(in.is_open()) << "Failed to open " << constant_folder
+                                             << manifests[0];
+                in >> manifest;
+            }
+            std::string blob_file = manifest["blob"];
+            for (auto& file : files)
+            {
+                NNFUSION_CHECK(file == manifests[0] || file == blob_file)
+                    << "Bucket " << buckets[b].folder << " loads constant file " << file
+                    << " itself, it must be compiled with -fcpu_constant_mmap.";
+            }
+            std::ifstream in(constant_folder + blob_file, std::ios::binary);
+            NNFUSION_CHECK(in.is_open()) << "Failed to open " << constant_folder << blob_file;
+            std::string blob((std::istreambuf_iterator<char>(in)),
+                             std::istreambuf_iterator<char>());
+            in.close();
+
+            for (auto& constant : manifest["constants"])
+            {
+                size_t offset = constant["offset"], size = constant["size"];
+                NNFUSION_CHECK(offset + size <= blob.size()) << "Constant " << constant["name"]
+                                                             << " exceeds " << blob_file;
+                std::string data = blob.substr(offset, size);
+                size_t hash = std::hash<std::string>()(data);
+                size_t packed_offset = packed.size();
+                auto range = packed_offsets.equal_range(hash);
+                for (auto it = range.first; it != range.second; ++it)
+                {
+                    if (packed.compare(it->second, size, data) == 0)
+                    {
+                        packed_offset = it->second;
+                        break;
+                    }
+                }
+                if (packed_offset == packed.size())
+                {
+                    packed += data;
+                    packed.resize((packed.size() + 63) / 64 * 64, 0);
+                    packed_offsets.insert(std::make_pair(hash, packed_offset));
+                }
+                offsets[b].push_back(packed_offset);
+            }
+            for (auto& file : files)
+            {
+                NNFUSION_CHECK(unlink((constant_folder + file).c_str()) == 0)
+                    << "Failed to remove " << constant_folder << file;
+            }
+            rmdir(constant_folder.c_str());
+        }
+
+        if (!packed.empty())
+        {
+            NNFUSION_CHECK(nnfusion::codegen::create_folder(folder + "Constant/"));
+            std::ofstream out(path, std::ios::binary);
+            NNFUSION_CHECK(out.is_open()) << "Failed to open " << path;
+            out.write(packed.data(), packed.size());
+        }
+        return offsets;
+    }
+
+    template <typename T>
+    std::string join_braced(const std::vector<T>& values)
+    {
+        return "{" + (values.empty() ? std::string("0") : join(values, ", ")) + "}";
+    }
+}
+
+void nnfusion::codegen::generate_cpu_bucket_dispatcher(const std::string& folder,
+                                                       const std::vector<ShapeBucket>& buckets)
+{
+    NNFUSION_CHECK(!buckets.empty());
+    std::vector<nlohmann::json> para_infos;
+    for (auto& bucket : buckets)
+        para_infos.push_back(read_para_info(folder + bucket.folder + "/"));
+
+    // the dims telling the buckets apart, in the order kernel_entry_dynamic() takes them
+    std::vector<std::string> dim_names;
+    for (auto& dim : buckets.front().dims)
+    {
+        for (auto& bucket : buckets)
+        {
+            NNFUSION_CHECK(bucket.dims.count(dim.first) > 0)
+                << "All buckets must set dim " << dim.first;
+            if (bucket.dims.at(dim.first) != dim.second)
+            {
+                dim_names.push_back(dim.first);
+                break;
+            }
+        }
+    }
+    NNFUSION_CHECK(!dim_names.empty()) << "The shape buckets do not differ in any dim.";
+
+    auto params = read_params(para_infos.front());
+    size_t max_rank = 1;
+    for (auto& param : params)
+    {
+        for (auto& para_info : para_infos)
+            param.shapes.push_back(find_shape(para_info, param));
+        size_t rank = param.shapes.front().size();
+        max_rank = std::max(max_rank, rank);
+        for (size_t axis = 0; axis < rank; axis++)
+        {
+            bool is_static = true;
+            for (auto& shape : param.shapes)
+            {
+                NNFUSION_CHECK(shape.size() == rank) << "Rank of " << param.key
+                                                     << " differs across buckets.";
+                is_static &= shape[axis] == param.shapes.front()[axis];
+            }
+            int axis_dim = -1;
+            for (size_t d = 0; d < dim_names.size() && !is_static && axis_dim < 0; d++)
+            {
+                bool follows = true;
+                for (size_t b = 0; b < buckets.size(); b++)
+                    follows &= param.shapes[b][axis] == buckets[b].dims.at(dim_names[d]);
+                if (follows)
+                    axis_dim = d;
+            }
+            NNFUSION_CHECK(is_static || axis_dim >= 0)
+                << "Axis " << axis << " of " << param.key
+                << " varies across buckets but does not equal a dim, it can not be padded.";
+            param.axis_dims.push_back(axis_dim);
+        }
+    }
+
+    // the constants shared by the buckets are mapped once by the dispatcher
+    const std::string constants_file = "Constant/nnfusion_constants.bin";
+    auto constant_offsets = pack_constants(folder, buckets, folder + constants_file);
+    std::vector<size_t> constant_begins{0}, constant_table;
+    size_t constants_size = 0;
+    for (auto& offsets : constant_offsets)
+    {
+        constant_table.insert(constant_table.end(), offsets.begin(), offsets.end());
+        constant_begins.push_back(constant_table.size());
+    }
+    {
+        struct stat st;
+        if (stat((folder + constants_file).c_str(), &st) == 0)
+            constants_size = st.st_size;
+    }
+
+    std::vector<std::string> signature, arg_types, casted_args, entry_args;
+    for (size_t p = 0; p < params.size(); p++)
+    {
+        signature.push_back(params[p].type + "* " + params[p].name);
+        arg_types.push_back(params[p].type + "*");
+        casted_args.push_back("(" + params[p].type + "*)args[" + std::to_string(p) + "]");
+        entry_args.push_back("(void*)" + params[p].name);
+    }
+
+    // header
+    {
+        std::ofstream out(folder + "nnfusion_rt.h");
+        out << "#pragma once\n";
+        out << nnfusion::kernels::declaration::typedef_int->get_code() << "\n";
+        out << "extern \"C\" int get_device_type();\n";
+        out << "// runs the largest bucket\n";
+        out << "extern \"C\" int kernel_entry(" << join(signature, ", ") << ");\n";
+        out << "// dims are " << join(dim_names, ", ")
+            << ", the inputs are zero padded to the first bucket fitting them, -1 for none\n";
+        out << "extern \"C\" int kernel_entry_dynamic(const int64_t* dims, "
+            << join(signature, ", ") << ");\n";
+        out << "extern \"C\" void cpu_init();\n";
+        out << "extern \"C\" void cpu_free();\n";
+    }
+
+    // source
+    {
+        LanguageUnit lu("bucket_dispatcher");
+        lu << "#include <dlfcn.h>\n#include <fcntl.h>\n#include <limits.h>\n#include <stdlib.h>\n"
+           << "#include <string.h>\n#include <sys/mman.h>\n#include <sys/stat.h>\n"
+           << "#include <unistd.h>\n#include <algorithm>\n#include <stdexcept>\n#include <string>\n"
+           << "#include \"nnfusion_rt.h\"\n\n";
+        lu << "// 0: CUDA_GPU; 1: ROCM_GPU; 2: GENERIC_CPU; 3: HLSL; 4: GraphCore; 5: UNKNOWN\n";
+        lu << "int get_device_type()\n{\n    return " << GENERIC_CPU << ";\n}\n\n";
+
+        lu << "namespace\n{\n";
+        lu << "typedef int (*entry_func)(" << join(arg_types, ", ") << ");\n\n";
+        lu << "const int num_buckets = " << buckets.size() << ";\n";
+        lu << "const int num_dims = " << dim_names.size() << ";\n";
+        lu << "const int num_params = " << params.size() << ";\n";
+        lu << "const int max_rank = " << max_rank << ";\n\n";
+        lu << "struct Bucket\n{\n";
+        lu << "    const char* folder;\n    int64_t dims[num_dims];\n    void* handle;\n";
+        lu << "    entry_func entry;\n    void (*init)();\n    void (*free)();\n";
+        lu << "    void (*set_workspace)(char*);\n    int64_t (*workspace_size)();\n"
+           << "    void (*set_constants)(char**);\n};\n\n";
+        lu << "Bucket buckets[num_buckets] = {\n";
+        for (auto& bucket : buckets)
+        {
+            std::vector<size_t> dims;
+            for (auto& name : dim_names)
+                dims.push_back(bucket.dims.at(name));
+            lu << "    {\"" << bucket.folder << "\", " << join_braced(dims) << "},\n";
+        }
+        lu << "};\n\n";
+
+        std::vector<size_t> ranks;
+        std::vector<std::string> element_sizes, is_outputs, axis_dims, bucket_shapes;
+        for (auto& param : params)
+        {
+            ranks.push_back(param.axis_dims.size());
+            element_sizes.push_back("sizeof(" + param.type + ")");
+            is_outputs.push_back(param.is_output ? "true" : "false");
+            axis_dims.push_back(join_braced(param.axis_dims));
+        }
+        for (size_t b = 0; b < buckets.size(); b++)
+        {
+            std::vector<std::string> shapes;
+            for (auto& param : params)
+                shapes.push_back(join_braced(param.shapes[b]));
+            bucket_shapes.push_back(join_braced(shapes));
+        }
+        lu << "const int ranks[num_params] = " << join_braced(ranks) << ";\n";
+        lu << "const size_t element_sizes[num_params] = " << join_braced(element_sizes) << ";\n";
+        lu << "const bool is_outputs[num_params] = " << join_braced(is_outputs) << ";\n";
+        lu << "// the dim each axis follows, -1 for a static axis\n";
+        lu << "const int axis_dims[num_params][max_rank] = " << join_braced(axis_dims) << ";\n";
+        lu << "const int64_t shapes[num_buckets][num_params][max_rank] = {\n    "
+           << join(bucket_shapes, ",\n    ") << "};\n\n";
+
+        lu << "const char* constants_file = \"" << constants_file << "\";\n";
+        lu << "const size_t constants_size = " << constants_size << ";\n";
+        lu << "const int num_constants = " << constant_table.size() << ";\n";
+        lu << "// the constants of bucket b start at constants + constant_begins[b]\n";
+        lu << "const int constant_begins[num_buckets + 1] = " << join_braced(constant_begins)
+           << ";\n";
+        lu << "const size_t constant_offsets[] = " << join_braced(constant_table) << ";\n\n";
+
+        lu << R"(char* workspace = nullptr;
+char* staging[num_params];
+char* constants_blob = nullptr;
+char* constants[num_constants + 1];
+
+void* load_symbol(void* handle, const char* symbol)
+{
+    void* address = dlsym(handle, symbol);
+    if (!address)
+        throw std::runtime_error(std::string("Missed ") + symbol + " in a bucket runtime");
+    return address;
+}
+
+size_t get_bytes(const int64_t* shape, int rank, size_t element_size)
+{
+    size_t bytes = element_size;
+    for (int i = 0; i < rank; i++)
+        bytes *= shape[i];
+    return bytes;
+}
+
+// copy the leading box of src into dst, both in row major order of their own shapes
+void copy_box(const char* src, const int64_t* src_shape, char* dst, const int64_t* dst_shape,
+              const int64_t* box, int rank, size_t element_size)
+{
+    if (rank <= 1)
+    {
+        memcpy(dst, src, (rank == 1 ? box[0] : 1) * element_size);
+        return;
+    }
+    size_t src_stride = get_bytes(src_shape + 1, rank - 1, element_size);
+    size_t dst_stride = get_bytes(dst_shape + 1, rank - 1, element_size);
+    for (int64_t i = 0; i < box[0]; i++)
+        copy_box(src + i * src_stride, src_shape + 1, dst + i * dst_stride, dst_shape + 1,
+                 box + 1, rank - 1, element_size);
+}
+
+)";
+        lu << "int run(int b, void** args)\n{\n    return buckets[b].entry("
+           << join(casted_args, ", ") << ");\n}\n";
+        lu << "}\n\n";
+
+        lu << R"(extern "C" void cpu_init()
+{
+    char cwd[PATH_MAX];
+    if (!getcwd(cwd, sizeof(cwd)))
+        throw std::runtime_error("Failed to get the working directory");
+    int64_t workspace_size = 0;
+    for (int b = 0; b < num_buckets; b++)
+    {
+        auto& bucket = buckets[b];
+        std::string lib = std::string(cwd) + "/" + bucket.folder + "/libnnfusion_cpu_rt.so";
+        // every bucket binds to its own kernels and globals of the same names
+        bucket.handle = dlopen(lib.c_str(), RTLD_NOW | RTLD_LOCAL | RTLD_DEEPBIND);
+        if (!bucket.handle)
+            throw std::runtime_error(dlerror());
+        bucket.entry = (entry_func)load_symbol(bucket.handle, "kernel_entry");
+        bucket.init = (void (*)())load_symbol(bucket.handle, "cpu_init");
+        bucket.free = (void (*)())load_symbol(bucket.handle, "cpu_free");
+        bucket.set_workspace = (void (*)(char*))load_symbol(bucket.handle, "cpu_set_workspace");
+        bucket.workspace_size = (int64_t(*)())load_symbol(bucket.handle, "cpu_workspace_size");
+        bucket.set_constants = (void (*)(char**))load_symbol(bucket.handle, "cpu_set_constants");
+        workspace_size = std::max(workspace_size, bucket.workspace_size());
+    }
+    if (constants_size > 0)
+    {
+        // constants equal across the buckets are mapped once, shared by all of them
+        int fd = open(constants_file, O_RDONLY);
+        struct stat st;
+        if (fd < 0 || fstat(fd, &st) != 0 || (size_t)st.st_size != constants_size)
+            throw std::runtime_error(std::string("Invalid constant blob: ") + constants_file);
+        constants_blob = (char*)mmap(NULL, constants_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if ((void*)constants_blob == MAP_FAILED)
+            throw std::runtime_error(std::string("Failed to mmap ") + constants_file);
+        for (int c = 0; c < num_constants; c++)
+            constants[c] = constants_blob + constant_offsets[c];
+    }
+    // buckets never run at the same time, so they share the largest workspace
+    workspace = (char*)malloc(std::max<int64_t>(workspace_size, 1));
+    for (int p = 0; p < num_params; p++)
+    {
+        size_t bytes = 0;
+        for (int b = 0; b < num_buckets; b++)
+            bytes = std::max(bytes, get_bytes(shapes[b][p], ranks[p], element_sizes[p]));
+        staging[p] = (char*)malloc(bytes);
+    }
+    // the first bucket creating a thread pool hands it to the later ones, which are freed
+    // before it, a bucket without a pool has no cpu_set_<pool>()
+    const char* pool_names[] = {"worker_thread_pool", "schedule_thread_pool"};
+    void* pools[2] = {nullptr, nullptr};
+    for (int b = 0; b < num_buckets; b++)
+    {
+        // a bucket runs its init code relative to its folder
+        if (chdir(buckets[b].folder) != 0)
+            throw std::runtime_error(std::string("Failed to enter ") + buckets[b].folder);
+        buckets[b].set_workspace(workspace);
+        buckets[b].set_constants(constants + constant_begins[b]);
+        for (int t = 0; t < 2; t++)
+        {
+            std::string name = pool_names[t];
+            auto set_pool = (void (*)(void*))dlsym(buckets[b].handle, ("cpu_set_" + name).c_str());
+            if (set_pool && pools[t])
+                set_pool(pools[t]);
+        }
+        buckets[b].init();
+        for (int t = 0; t < 2; t++)
+        {
+            std::string name = pool_names[t];
+            auto get_pool = (void* (*)())dlsym(buckets[b].handle, ("cpu_get_" + name).c_str());
+            if (get_pool && !pools[t])
+                pools[t] = get_pool();
+        }
+        if (chdir(cwd) != 0)
+            throw std::runtime_error("Failed to restore the working directory");
+    }
+}
+
+extern "C" void cpu_free()
+{
+    for (int b = num_buckets - 1; b >= 0; b--)
+    {
+        buckets[b].free();
+        dlclose(buckets[b].handle);
+        buckets[b].handle = nullptr;
+    }
+    for (int p = 0; p < num_params; p++)
+        free(staging[p]);
+    free(workspace);
+    workspace = nullptr;
+    if (constants_blob)
+        munmap(constants_blob, constants_size);
+    constants_blob = nullptr;
+}
+
+)";
+        lu << "extern \"C\" int kernel_entry(" << join(signature, ", ") << ")\n{\n";
+        lu << "    void* args[num_params] = " << join_braced(entry_args) << ";\n";
+        lu << "    return run(num_buckets - 1, args);\n}\n\n";
+
+        lu << "extern \"C\" int kernel_entry_dynamic(const int64_t* dims, "
+           << join(signature, ", ") << ")\n{\n";
+        lu << "    void* params[num_params] = " << join_braced(entry_args) << ";\n";
+        lu << R"(    int b = 0;
+    for (; b < num_buckets; b++)
+    {
+        bool fits = true;
+        for (int d = 0; d < num_dims; d++)
+            fits &= dims[d] > 0 && dims[d] <= buckets[b].dims[d];
+        if (fits)
+            break;
+    }
+    if (b == num_buckets)
+        return -1;
+
+    void* args[num_params];
+    int64_t param_shapes[num_params][max_rank];
+    for (int p = 0; p < num_params; p++)
+    {
+        bool padded = false;
+        for (int i = 0; i < ranks[p]; i++)
+        {
+            param_shapes[p][i] = axis_dims[p][i] < 0 ? shapes[b][p][i] : dims[axis_dims[p][i]];
+            padded |= param_shapes[p][i] != shapes[b][p][i];
+        }
+        args[p] = padded ? staging[p] : params[p];
+        if (padded && !is_outputs[p])
+        {
+            memset(staging[p], 0, get_bytes(shapes[b][p], ranks[p], element_sizes[p]));
+            copy_box((const char*)params[p], param_shapes[p], staging[p], shapes[b][p],
+                     param_shapes[p], ranks[p], element_sizes[p]);
+        }
+    }
+    int ret = run(b, args);
+    for (int p = 0; p < num_params; p++)
+    {
+        if (is_outputs[p] && args[p] != params[p])
+            copy_box(staging[p], shapes[b][p], (char*)params[p], param_shapes[p], param_shapes[p],
+                     ranks[p], element_sizes[p]);
+    }
+    return ret;
+}
+)";
+        std::ofstream out(folder + "nnfusion_rt.cpp");
+        out << lu.get_code();
+    }
+
+    // cmake, the buckets are shared libraries to be loaded side by side
+    {
+        std::ofstream out(folder + "CMakeLists.txt");
+        out << R"(project(nnfusion_buckets)
+cmake_minimum_required(VERSION 3.5)
+include(ExternalProject)
+
+SET(TARGET_NAME "nnfusion_cpu_rt" CACHE STRING "codegen target name")
+set (CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -fPIC -std=gnu++11 -O3 -pthread")
+
+add_library(${TARGET_NAME} nnfusion_rt.cpp)
+target_link_libraries(${TARGET_NAME} ${CMAKE_DL_LIBS})
+)";
+        for (auto& bucket : buckets)
+        {
+            out << "\nExternalProject_Add(" << bucket.folder << "\n"
+                << "    SOURCE_DIR ${CMAKE_CURRENT_SOURCE_DIR}/" << bucket.folder << "\n"
+                << "    BINARY_DIR ${CMAKE_CURRENT_SOURCE_DIR}/" << bucket.folder << "\n"
+                << "    CMAKE_ARGS -DBUILD_SHARED_LIBS=ON\n"
+                << "    INSTALL_COMMAND \"\")\n"
+                << "add_dependencies(${TARGET_NAME} " << bucket.folder << ")\n";
+        }
+    }
+
+    // kernel_entry() takes the shapes of the largest bucket
+    {
+        std::ofstream out(folder + "para_info.json");
+        out << std::setw(4) << para_infos.back() << std::endl;
+
+        nlohmann::json bucket_info;
+        bucket_info["dims"] = dim_names;
+        for (auto& bucket : buckets)
+            bucket_info["buckets"].push_back({{"folder", bucket.folder}, {"dims", bucket.dims}});
+        std::ofstream info(folder + "bucket_info.json");
+        info << std::setw(4) << bucket_info << std::endl;
+    }
+
+    NNFUSION_LOG(INFO) << "Shape buckets of dims " << join(dim_names, ", ") << " written to "
+                       << folder;
+}
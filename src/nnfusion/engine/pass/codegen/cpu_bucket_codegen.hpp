@@ -0,0 +1,31 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "nnfusion/common/common.hpp"
+
+namespace nnfusion
+{
+    namespace codegen
+    {
+        // One shape bucket of a model, whose CPU runtime project, compiled with
+        // -fcpu_shared_workspace, -fextern_result_memory and -fcpu_constant_mmap, is the
+        // subfolder named folder.
+        struct ShapeBucket
+        {
+            std::map<std::string, size_t> dims;
+            std::string folder;
+        };
+
+        ///\brief Writes a CPU runtime project into folder, which loads the runtimes of the
+        /// buckets in cpu_init() on one shared workspace. kernel_entry_dynamic() runs the first
+        /// bucket fitting the given dims on the inputs zero padded to its shapes, and crops the
+        /// outputs back, so the buckets are expected in ascending order. kernel_entry() runs the
+        /// last bucket. The constant blobs of the buckets are packed into one blob holding every
+        /// distinct constant once, which cpu_init() maps and hands to the buckets through
+        /// cpu_set_constants().
+        void generate_cpu_bucket_dispatcher(const std::string& folder,
+                                            const std::vector<ShapeBucket>& buckets);
+    }
+}
@@ -7,6 +7,9 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <set>
+
 #include "codegen_langunit.hpp"
 #include "codegenerator_helper.hpp"
 #include "cpu_codegen_pass.hpp"
@@ -14,8 +17,12 @@
 #include "nnfusion/common/descriptor/tensor.hpp"
 #include "nnfusion/core/kernels/common_langunit.hpp"
 #include "nnfusion/core/kernels/cpu/barrier.hpp"
+#include "nnfusion/core/kernels/cpu/cpu_kernel_emitter.hpp"
 #include "nnfusion/core/kernels/cpu/cpu_langunit.hpp"
+#include "nnfusion/core/kernels/cpu/dag_executor.hpp"
+#include "nnfusion/core/kernels/cpu/reduced_precision.hpp"
 #include "nnfusion/core/kernels/cpu/reference/reference_common.hpp"
+#include "nnfusion/core/kernels/cpu/simd_dispatch.hpp"
 #include "nnfusion/core/kernels/cuda_gpu/cuda_langunit.hpp"
 
 using namespace nnfusion;
@@ -26,11 +33,99 @@ using namespace nnfusion::async;
 
 DEFINE_int32(fnuma_node_num, 1, "");
 DEFINE_int32(fthread_num_per_node, 0, "");
+DEFINE_bool(fcpu_dag_schedule,
+            false,
+            "Run the kernels of kernel_entry as a dependency DAG on a work-stealing thread pool.");
+DEFINE_bool(fcpu_simd_dispatch,
+            false,
+            "Emit SSE2/AVX2/AVX-512 versions of the simd kernels and pick one at runtime.");
+DEFINE_bool(fcpu_context_api,
+            false,
+            "Emit nnfusion_ctx_create/run/destroy, contexts own their activation memory and "
+            "share the constants, so they can run concurrently.");
+DEFINE_bool(fcpu_shared_workspace,
+            false,
+            "Place the activation pools in a workspace, which cpu_set_workspace() may hand over "
+            "before cpu_init(), so runtimes never running at the same time can share it.");
 DECLARE_bool(fkernels_as_files);
 DECLARE_int64(fkernels_files_number);
 DECLARE_bool(frt_const_folding);
 DECLARE_bool(fextern_result_memory);
 DECLARE_bool(fcustomized_mem_imp);
+DECLARE_bool(fincremental_codegen);
+DECLARE_int32(fwarmup_step);
+DECLARE_int32(frun_step);
+
+namespace
+{
+    // the tensor group of the memory pool named "group_<group>[_RDMA][_memset0]"
+    std::string get_pool_group(const std::string& symbol)
+    {
+        std::string group = symbol.compare(0, 6, "group_") == 0 ? symbol.substr(6) : symbol;
+        for (const std::string suffix : {"_memset0", "_RDMA"})
+        {
+            if (group.size() > suffix.size() &&
+                group.compare(group.size() - suffix.size(), suffix.size(), suffix) == 0)
+                group.resize(group.size() - suffix.size());
+        }
+        return group;
+    }
+
+    // the groups of the persistent tensors filled by cpu_init
+    bool is_persistent_group(const std::string& group)
+    {
+        const std::string numa = "persist_numa";
+        return group == "persist" || group.compare(0, numa.size(), numa) == 0;
+    }
+
+    // the pools reused by every run, unlike the constants and the tensors kept across runs
+    bool is_activation_pool(const std::string& symbol)
+    {
+        auto group = get_pool_group(symbol);
+        return group != "constant" && group != "persist_context" && !is_persistent_group(group);
+    }
+
+    // the declarations in a parameter list like "float* a, float** b"
+    std::vector<std::string> split_params(const std::string& params)
+    {
+        std::vector<std::string> decls;
+        size_t begin = 0;
+        while (begin < params.size())
+        {
+            size_t end = params.find(", ", begin);
+            if (end == std::string::npos)
+                end = params.size();
+            decls.push_back(params.substr(begin, end - begin));
+            begin = end + 2;
+        }
+        return decls;
+    }
+
+    // whether the identifier name appears in code
+    bool mentions(const std::string& code, const std::string& name)
+    {
+        auto is_ident = [](char c) { return isalnum(c) || c == '_'; };
+        for (size_t pos = code.find(name); pos != std::string::npos;
+             pos = code.find(name, pos + 1))
+        {
+            size_t end = pos + name.size();
+            if ((pos == 0 || !is_ident(code[pos - 1])) &&
+                (end == code.size() || !is_ident(code[end])))
+                return true;
+        }
+        return false;
+    }
+
+    std::string get_context_run_args(std::shared_ptr<TranslationUnit> tu)
+    {
+        std::vector<std::string> args;
+        for (auto& tensor : tu->arg)
+            args.push_back(tensor->get_name());
+        for (auto& tensor : tu->out)
+            args.push_back(tensor->get_name());
+        return join(args, ", ");
+    }
+}
 
 void CpuCodegenPass::set_global_member(std::shared_ptr<InterpreterContext> ctx,
                                        std::shared_ptr<TranslationUnit> tu)
@@ -38,6 +133,8 @@ void CpuCodegenPass::set_global_member(std::shared_ptr<InterpreterContext> ctx,
     this->host_async_manager =
         AsyncManagerFactory::get_host_async_manager(tu->m_graph, GENERIC_CPU);
 
+    emit_kernel_sources(tu);
+
     auto& prog = tu->program;
     for (auto iterator : prog)
     {
@@ -51,13 +148,42 @@ void CpuCodegenPass::set_global_member(std::shared_ptr<InterpreterContext> ctx,
             {
                 global_required.insert(it.second->symbol);
             }
+            for (auto& tensor : kernel->m_context->inputs)
+                need_reduced_precision |= tensor->get_element_type() == element::bf16;
+            for (auto& tensor : kernel->m_context->outputs)
+                need_reduced_precision |= tensor->get_element_type() == element::bf16;
         }
     }
+    need_reduced_precision |= global_required.count("header::reduced_precision") > 0;
     numa_node_num = FLAGS_fnuma_node_num;
     if (!host_async_manager || host_async_manager->num_non_default_stream() == 0)
     {
         numa_node_num = 1;
     }
+    dag_schedule = FLAGS_fcpu_dag_schedule;
+    context_api = FLAGS_fcpu_context_api;
+    if (context_api)
+    {
+        // streams, events and customized memory are globals shared by all runs
+        NNFUSION_CHECK(!host_async_manager || (host_async_manager->num_non_default_stream() == 0 &&
+                                               host_async_manager->num_event() == 0))
+            << "-fcpu_context_api needs a single stream.";
+        NNFUSION_CHECK(!FLAGS_fcustomized_mem_imp)
+            << "-fcpu_context_api can not be used with -fcustomized_mem_imp.";
+        // the intermediate tensors of the folded subgraphs would live in the contexts
+        NNFUSION_CHECK(!FLAGS_frt_const_folding)
+            << "-fcpu_context_api can not be used with -frt_const_folding.";
+    }
+    shared_workspace = FLAGS_fcpu_shared_workspace;
+    if (shared_workspace)
+    {
+        NNFUSION_CHECK(!context_api)
+            << "-fcpu_shared_workspace can not be used with -fcpu_context_api.";
+        NNFUSION_CHECK(!FLAGS_fcustomized_mem_imp)
+            << "-fcpu_shared_workspace can not be used with -fcustomized_mem_imp.";
+        NNFUSION_CHECK(numa_node_num == 1)
+            << "-fcpu_shared_workspace can not place the pools on NUMA nodes.";
+    }
     return;
 }
 
@@ -83,7 +209,7 @@ void CpuCodegenPass::initialize(std::shared_ptr<InterpreterContext> ctx,
         throw nnfusion::errors::RuntimeError("Failed to get the directory of executable file.\n");
     }
 
-    if (need_intra_node_threadpool ||
+    if (need_intra_node_threadpool || dag_schedule ||
         (host_async_manager && host_async_manager->num_non_default_stream() > 0))
     {
         std::string eigen_path = std::string(path) + std::string("/eigen");
@@ -118,7 +244,10 @@ void CpuCodegenPass::initialize(std::shared_ptr<InterpreterContext> ctx,
     auto& lu_exec_begin = *(projgen->lup_exec->begin);
     {
         std::string params = get_kernel_entry_paras(tu);
-        lu_exec_begin << "extern \"C\" int kernel_entry(" << params << ")\n{\n";
+        if (context_api)
+            lu_exec_begin << "int nnfusion_ctx::run(" << params << ")\n{\n";
+        else
+            lu_exec_begin << "extern \"C\" int kernel_entry(" << params << ")\n{\n";
     }
 
     auto& lu_exec_init = *(projgen->lup_exec->begin);
@@ -139,6 +268,20 @@ void CpuCodegenPass::initialize(std::shared_ptr<InterpreterContext> ctx,
     {
         lu_exec_end << "return 0;\n";
         lu_exec_end << "}\n";
+        if (context_api)
+        {
+            std::string params = get_kernel_entry_paras(tu);
+            std::string args = get_context_run_args(tu);
+            std::string ctx_params = "nnfusion_ctx* ctx" + (params.empty() ? "" : ", " + params);
+            lu_exec_end << "\nextern \"C\" int kernel_entry(" << params << ")\n{\n"
+                        << "return nnfusion_default_ctx->run(" << args << ");\n}\n";
+            lu_exec_end << "\nextern \"C\" nnfusion_ctx* nnfusion_ctx_create()\n{\n"
+                        << "return new nnfusion_ctx();\n}\n";
+            lu_exec_end << "\nextern \"C\" int nnfusion_ctx_run(" << ctx_params << ")\n{\n"
+                        << "return ctx->run(" << args << ");\n}\n";
+            lu_exec_end << "\nextern \"C\" void nnfusion_ctx_destroy(nnfusion_ctx* ctx)\n{\n"
+                        << "delete ctx;\n}\n";
+        }
     }
 
     auto& lu_exit_begin = *(projgen->lup_exit->begin);
@@ -177,12 +320,28 @@ cmake_minimum_required(VERSION 3.5)
 SET(SRC "nnfusion_rt.cpp" CACHE STRING "codegen source file")
 SET(TARGET_NAME "nnfusion_cpu_rt" CACHE STRING "codegen target name")
 
-set (CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -fPIC -std=gnu++11 -O3 -march=native -pthread")
 )";
+    // with runtime dispatch the binary must also run on machines older than the build host
+    lu << "set (CMAKE_CXX_FLAGS \"${CMAKE_CXX_FLAGS} -fPIC -std=gnu++11 -O3"
+       << (FLAGS_fcpu_simd_dispatch ? "" : " -march=native") << " -pthread\")\n";
 
     if (FLAGS_fkernels_as_files)
     {
-        lu << "\nfile(GLOB kernels kernels/*" << m_kernel_suffix << ")\n";
+        if (FLAGS_fincremental_codegen)
+        {
+            // reuse objects of unchanged kernels across build folders
+            lu << nnfusion::codegen::cmake::ccache->get_code();
+            // kernel files are renamed when they change, while CMakeLists.txt may not be
+            lu << "\nif (${CMAKE_VERSION} VERSION_LESS \"3.12\")\n"
+               << "file(GLOB kernels kernels/*" << m_kernel_suffix << ")\n"
+               << "else()\n"
+               << "file(GLOB kernels CONFIGURE_DEPENDS kernels/*" << m_kernel_suffix << ")\n"
+               << "endif()\n";
+        }
+        else
+        {
+            lu << "\nfile(GLOB kernels kernels/*" << m_kernel_suffix << ")\n";
+        }
         lu << "list(APPEND SRC ${kernels} shared" << m_kernel_suffix << ")\n";
         lu << "include_directories(${CMAKE_SOURCE_DIR})\n\n";
     }
@@ -197,7 +356,8 @@ set (CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -fPIC -std=gnu++11 -O3 -march=native -p
             lu << nnfusion::codegen::cmake::cblas->get_code();
         }
 
-        if (need_intra_node_threadpool || host_async_manager->num_non_default_stream() > 0)
+        if (need_intra_node_threadpool || dag_schedule ||
+            host_async_manager->num_non_default_stream() > 0)
         {
             // add eigen
             lu << nnfusion::codegen::cmake::eigen->get_code();
@@ -239,7 +399,8 @@ void CpuCodegenPass::create_main_file(std::shared_ptr<InterpreterContext> ctx,
     re_main->require(header::stdlib);
     re_main->require(header::sstream);
     re_main->require(header::stdexcept);
-
+    re_main->require(header::vector);
+    re_main->require(header::cmath);
     re_main->require(header::chrono);
 
     lu_main << "#include \"nnfusion_rt.h\"\n";
@@ -247,16 +408,60 @@ void CpuCodegenPass::create_main_file(std::shared_ptr<InterpreterContext> ctx,
     for (auto& it : re_main->local_symbol)
         if (it.second->symbol.find("header::") != string::npos)
             lu_main << it.second->get_code();
+    lu_main << "#include <algorithm>\n#include <string>\n#include <thread>\n"
+            << "#include <sys/wait.h>\n#include <unistd.h>\n\n";
 
     lu_main << "using Clock = std::chrono::high_resolution_clock;\n\n";
 
-    LanguageUnit fillval("fillval");
+    lu_main << R"(struct BenchResult
+{
+    int threads_per_node;
+    int iters;
+    double min_ms, median_ms, p99_ms, mean_ms, stddev_ms, throughput;
+};
+
+BenchResult summarize(std::vector<double> times, double total_ms, int threads_per_node)
+{
+    std::sort(times.begin(), times.end());
+    size_t n = times.size();
+    BenchResult result;
+    result.threads_per_node = threads_per_node;
+    result.iters = (int)n;
+    result.min_ms = times[0];
+    result.median_ms = n % 2 ? times[n / 2] : (times[n / 2 - 1] + times[n / 2]) / 2;
+    result.p99_ms = times[std::min(n - 1, (size_t)std::ceil(0.99 * n) - 1)];
+    double sum = 0, square_sum = 0;
+    for (double t : times)
+        sum += t;
+    result.mean_ms = sum / n;
+    for (double t : times)
+        square_sum += (t - result.mean_ms) * (t - result.mean_ms);
+    result.stddev_ms = std::sqrt(square_sum / n);
+    result.throughput = total_ms > 0 ? n * 1000.0 / total_ms : 0;
+    return result;
+}
 
-    lu_main << "int main(void)";
+)";
+
+    int thread_num_per_node = FLAGS_fthread_num_per_node;
+    lu_main << "// runs warmup, then times every one of iters runs between cpu_init() and "
+               "cpu_free()\n";
+    lu_main << "BenchResult benchmark(int warmup, int iters, int threads_per_node, "
+               "bool print_outputs)";
     lu_main.block_begin();
     {
+        lu_main << "if (threads_per_node > 0)\n"
+                << "    setenv(\"NNFUSION_THREAD_NUM_PER_NODE\", "
+                   "std::to_string(threads_per_node).c_str(), 1);\n";
+        lu_main << "else\n";
+        if (thread_num_per_node > 0)
+            lu_main << "    threads_per_node = " << thread_num_per_node << ";\n";
+        else
+            lu_main << "    threads_per_node = std::thread::hardware_concurrency() / "
+                    << numa_node_num << ";\n";
         lu_main << "\ncpu_init();\n\n";
 
+        LanguageUnit fillval("fillval");
         for (size_t i = 0; i < tu->arg.size(); i++)
         {
             auto& tensor = *tu->arg[i];
@@ -294,27 +499,28 @@ void CpuCodegenPass::create_main_file(std::shared_ptr<InterpreterContext> ctx,
         std::string args = get_kernel_entry_args(tu, true);
 
         lu_main << "\n//warm up\n";
-        lu_main << "int warm_steps = 5;\n";
-        lu_main << "for(int i_=0; i_<warm_steps; i_++)\n";
+        lu_main << "for(int i_=0; i_<warmup; i_++)\n";
         lu_main.block_begin();
         // kernel launch
         lu_main << "kernel_entry(" << args << ");\n";
         lu_main.block_end();
 
-        lu_main << "\n//time measurement\n";
-        lu_main << "auto t_start = Clock::now();\n\n";
-        lu_main << "//kernel call\n";
-        lu_main << "int test_steps = 100;\n";
-        lu_main << "for(int i_=0; i_<test_steps; i_++)\n";
+        lu_main << "\n//time measurement of every run\n";
+        lu_main << "std::vector<double> times(iters);\n";
+        lu_main << "auto t_begin = Clock::now();\n";
+        lu_main << "for(int i_=0; i_<iters; i_++)\n";
         lu_main.block_begin();
         // kernel launch
+        lu_main << "auto t_start = Clock::now();\n";
         lu_main << "kernel_entry(" << args << ");\n";
+        lu_main << "times[i_] = std::chrono::duration<double, std::milli>(Clock::now() - "
+                   "t_start).count();\n";
         lu_main.block_end();
+        lu_main << "double total_ms = std::chrono::duration<double, std::milli>(Clock::now() - "
+                   "t_begin).count();\n\n";
 
-        lu_main << "\n//time measurement\n";
-        lu_main << "auto t_end = Clock::now();\n";
-        lu_main << "std::chrono::duration<double, std::milli> fp_ms = t_end - t_start;\n\n";
-
+        lu_main << "if (print_outputs)";
+        lu_main.block_begin();
         for (size_t i = 0; i < tu->out.size(); i++)
         {
             auto& tensor = *tu->out[i];
@@ -326,8 +532,8 @@ void CpuCodegenPass::create_main_file(std::shared_ptr<InterpreterContext> ctx,
                     << ", ends with %e);\\n\", (float)" << tensor.get_name() << "_host["
                     << tensor.get_tensor_layout()->get_size() - 1 << "]);\n";
         }
+        lu_main.block_end();
 
-        lu_main << "\nprintf(\"function execution time: %f ms\\n\", fp_ms.count()/test_steps);\n";
         lu_main << "\n//free context\n";
         lu_main << "cpu_free();\n";
 
@@ -346,7 +552,140 @@ void CpuCodegenPass::create_main_file(std::shared_ptr<InterpreterContext> ctx,
                 lu_main << "free(" << tensor.get_name() << "_host);\n";
             }
         }
-        lu_main << "\nreturn 0;\n";
+        lu_main << "\nreturn summarize(times, total_ms, threads_per_node);\n";
+    }
+    lu_main.block_end();
+
+    lu_main << "\n// cpu_init() sets up the process wide state only once, so a thread count "
+               "sweep runs\n// every thread count in a child process\n";
+    lu_main << R"(bool benchmark_in_child(int warmup, int iters, int threads_per_node,
+                        bool print_outputs, BenchResult* result)
+{
+    int fds[2];
+    if (pipe(fds) != 0)
+        return false;
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        close(fds[0]);
+        BenchResult child_result = benchmark(warmup, iters, threads_per_node, print_outputs);
+        fflush(stdout);
+        bool written = write(fds[1], &child_result, sizeof(child_result)) == sizeof(child_result);
+        _exit(written ? 0 : 1);
+    }
+    close(fds[1]);
+    bool received = pid > 0 && read(fds[0], result, sizeof(*result)) == sizeof(*result);
+    close(fds[0]);
+    int status = 0;
+    if (pid > 0)
+        waitpid(pid, &status, 0);
+    return received && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+)";
+
+    lu_main << "int main(int argc, char** argv)";
+    lu_main.block_begin();
+    {
+        lu_main << "int warmup = " << FLAGS_fwarmup_step << ", iters = " << FLAGS_frun_step
+                << ";\n";
+        lu_main << R"(std::vector<int> thread_sweep;
+bool pin_threads = false;
+const char* json_path = nullptr;
+for (int i = 1; i < argc; i++)
+{
+    std::string arg = argv[i];
+    if (arg == "--warmup" && i + 1 < argc)
+        warmup = atoi(argv[++i]);
+    else if (arg == "--iters" && i + 1 < argc)
+        iters = atoi(argv[++i]);
+    else if (arg == "--threads" && i + 1 < argc)
+    {
+        std::stringstream ss(argv[++i]);
+        std::string count;
+        while (std::getline(ss, count, ','))
+            thread_sweep.push_back(atoi(count.c_str()));
+    }
+    else if (arg == "--pin")
+        pin_threads = true;
+    else if (arg == "--json" && i + 1 < argc)
+        json_path = argv[++i];
+    else
+    {
+        printf("usage: %s [--warmup N] [--iters N] [--threads N,N,...] [--pin] [--json FILE]\n",
+               argv[0]);
+        return 1;
+    }
+}
+warmup = std::max(warmup, 0);
+iters = std::max(iters, 1);
+if (pin_threads)
+    setenv("NNFUSION_PIN_THREADS", "1", 1);
+
+std::vector<BenchResult> results;
+if (thread_sweep.empty())
+    results.push_back(benchmark(warmup, iters, 0, true));
+for (size_t i = 0; i < thread_sweep.size(); i++)
+{
+    BenchResult result;
+    if (!benchmark_in_child(warmup, iters, thread_sweep[i], i == 0, &result))
+    {
+        fprintf(stderr, "benchmark with %d threads failed\n", thread_sweep[i]);
+        return 1;
+    }
+    results.push_back(result);
+}
+
+)";
+        lu_main << "std::stringstream json;\n";
+        lu_main << "json << \"{\\\"model\\\": \\\"" << tu->m_graph->get_name()
+                << "\\\", \\\"warmup\\\": \" << warmup << \", \\\"iters\\\": \" << iters\n"
+                << "     << \", \\\"pinned\\\": \" << (pin_threads ? \"true\" : \"false\") << "
+                   "\", \\\"runs\\\": [\";\n";
+        // without a worker pool, every kernel runs on the calling thread
+        bool has_worker_pool =
+            need_intra_node_threadpool || dag_schedule ||
+            (host_async_manager && host_async_manager->num_non_default_stream() > 0);
+        lu_main << R"(for (size_t i = 0; i < results.size(); i++)
+{
+    auto& r = results[i];
+    json << (i ? ", " : "") << "{";
+)";
+        if (has_worker_pool)
+            lu_main << "    json << \"\\\"threads_per_node\\\": \" << r.threads_per_node "
+                       "<< \", \";\n";
+        lu_main << R"(    json << "\"min_ms\": " << r.min_ms << ", \"median_ms\": " << r.median_ms
+         << ", \"p99_ms\": " << r.p99_ms << ", \"mean_ms\": " << r.mean_ms
+         << ", \"stddev_ms\": " << r.stddev_ms << ", \"throughput_per_sec\": " << r.throughput
+         << "}";
+}
+json << "]}";
+printf("%s\n", json.str().c_str());
+if (json_path)
+{
+    FILE* json_file = fopen(json_path, "w");
+    if (!json_file)
+    {
+        fprintf(stderr, "failed to write %s\n", json_path);
+        return 1;
+    }
+    fprintf(json_file, "%s\n", json.str().c_str());
+    fclose(json_file);
+}
+
+// the median of the fastest run, which the perf scripts compare against their baselines
+size_t fastest = 0;
+for (size_t i = 1; i < results.size(); i++)
+{
+    if (results[i].median_ms < results[fastest].median_ms)
+        fastest = i;
+}
+printf("function execution time: %f ms\n", results[fastest].median_ms);
+)";
+        if (has_worker_pool)
+            lu_main << "printf(\"threads per node: %d\\n\", results[fastest].threads_per_node);\n";
+        lu_main << "return 0;\n";
     }
     lu_main.block_end();
 
@@ -365,6 +704,8 @@ void CpuCodegenPass::create_header_file(std::shared_ptr<InterpreterContext> ctx,
     //generate include header file
     lu_header << "#pragma once\n";
     lu_header << declaration::typedef_int->get_code() << "\n";
+    if (need_reduced_precision)
+        lu_header << header::reduced_precision->get_code();
     // if (device_type() == CUDA_GPU || device_type() == ROCM_GPU)
     //     lu_header << header::cuda->get_code();
     lu_header << "extern \"C\" int get_device_type();\n";
@@ -377,6 +718,27 @@ void CpuCodegenPass::create_header_file(std::shared_ptr<InterpreterContext> ctx,
 
     lu_header << "extern \"C\" void cpu_free();\n";
 
+    if (shared_workspace)
+    {
+        // the workspace must outlive cpu_free(), cpu_init() allocates one if none is set
+        lu_header << "extern \"C\" int64_t cpu_workspace_size();\n";
+        lu_header << "extern \"C\" void cpu_set_workspace(char* workspace);\n";
+        // the blob constants in the order of the manifest in Constant/, cpu_init() maps the
+        // blob if none are set
+        lu_header << "extern \"C\" void cpu_set_constants(char** constants);\n";
+    }
+
+    if (context_api)
+    {
+        // contexts are created after cpu_init() and destroyed before cpu_free(), a context
+        // runs one request at a time while different contexts run concurrently
+        lu_header << "struct nnfusion_ctx;\n";
+        lu_header << "extern \"C\" nnfusion_ctx* nnfusion_ctx_create();\n";
+        lu_header << "extern \"C\" int nnfusion_ctx_run(nnfusion_ctx* ctx"
+                  << (params.empty() ? "" : ", " + params) << ");\n";
+        lu_header << "extern \"C\" void nnfusion_ctx_destroy(nnfusion_ctx* ctx);\n";
+    }
+
     LanguageUnit_p h =
         std::make_shared<LanguageUnit>("header::nnfusion_rt.h", "#include \"nnfusion_rt.h\"\n");
     projgen->lup_exec->require(h);
@@ -384,6 +746,161 @@ void CpuCodegenPass::create_header_file(std::shared_ptr<InterpreterContext> ctx,
     return;
 }
 
+bool CpuCodegenPass::collect_mem(std::shared_ptr<InterpreterContext> ctx,
+                                 std::shared_ptr<TranslationUnit> tu)
+{
+    if (shared_workspace)
+        return collect_workspace_mem(ctx, tu);
+    if (!context_api)
+        return CudaCodegenPass::collect_mem(ctx, tu);
+    if (!tu)
+        return false;
+
+    auto mem_pair = create_init_and_exit_pair<LanguageUnitwithVec, LanguageUnitwithVec>("MEM_ALLOC",
+                                                                                        "MEM_FREE");
+    auto lup_mem_alloc = mem_pair.first;
+    auto lup_mem_free = mem_pair.second;
+    auto& allocator_list = tu->memory_allocator_factory->get_allocator_list();
+
+    size_t shared_alloc = 0, context_alloc = 0;
+    LanguageUnit ctx_decl("ctx_decl"), ctx_alloc("ctx_alloc"), ctx_free("ctx_free");
+    auto lup_ctx = std::make_shared<LanguageUnit>("declaration::nnfusion_ctx");
+    for (const auto& allocator : allocator_list)
+    {
+        auto init = allocator.second->emit_memory_init();
+        auto alloc = allocator.second->emit_memory_alloc();
+        auto free = allocator.second->emit_memory_free();
+        if (is_context_pool(allocator.second->get_symbol()))
+        {
+            context_alloc += allocator.second->max_allocated();
+            ctx_decl << init->get_code();
+            ctx_alloc << alloc->get_code();
+            if (allocator.second->max_allocated() > 0)
+                ctx_free << free->get_code();
+            for (auto& it : init->local_symbol)
+                lup_ctx->require(it.second);
+        }
+        else
+        {
+            shared_alloc += allocator.second->max_allocated();
+            lup_mem_alloc->unit_vec.push_back(alloc);
+            lup_mem_alloc->require(init);
+            lup_mem_free->unit_vec.push_back(free);
+            lup_mem_free->require(init);
+        }
+    }
+    lup_mem_alloc->unit_vec.push_front(std::make_shared<LanguageUnit>(
+        "total_memory",
+        "// total memory:" + to_string(shared_alloc) + ", per context:" +
+            to_string(context_alloc) + "\n"));
+
+    auto& lu_ctx = *lup_ctx;
+    lu_ctx << "struct nnfusion_ctx\n{\n";
+    lu_ctx << ctx_decl.get_code();
+    if (dag_schedule)
+    {
+        // each context owns its tasks, which run on its members
+        lu_ctx << "nnfusion::cpu::DagExecutor* dag_executor;\n";
+        lu_ctx << "nnfusion_dag_args dag_args;\n";
+        ctx_alloc << "dag_build();\n";
+        ctx_free << "delete dag_executor;\n";
+        lup_ctx->require(get_dag_args_decl(tu));
+    }
+    lu_ctx << "\nnnfusion_ctx()\n{\n" << ctx_alloc.get_code() << "}\n";
+    lu_ctx << "\n~nnfusion_ctx()\n{\n" << ctx_free.get_code() << "}\n";
+    lu_ctx << "\nint run(" << get_kernel_entry_paras(tu) << ");\n";
+    if (dag_schedule)
+        lu_ctx << "void dag_build();\n";
+    lu_ctx << "};\n\n";
+    // serves kernel_entry()
+    lu_ctx << "static nnfusion_ctx* nnfusion_default_ctx = nullptr;\n";
+    lup_mem_alloc->require(lup_ctx);
+    ctx_struct_decl = lup_ctx;
+
+    return true;
+}
+
+bool CpuCodegenPass::is_context_pool(const std::string& symbol)
+{
+    // kernel_entry clears the memset pools on every run, so no tensor in them outlives a run
+    if (symbol.find("memset") != std::string::npos)
+        return true;
+    auto group = get_pool_group(symbol);
+    return group != "constant" && !is_persistent_group(group);
+}
+
+bool CpuCodegenPass::collect_workspace_mem(std::shared_ptr<InterpreterContext> ctx,
+                                           std::shared_ptr<TranslationUnit> tu)
+{
+    if (!tu)
+        return false;
+
+    auto mem_pair = create_init_and_exit_pair<LanguageUnitwithVec, LanguageUnitwithVec>("MEM_ALLOC",
+                                                                                        "MEM_FREE");
+    auto lup_mem_alloc = mem_pair.first;
+    auto lup_mem_free = mem_pair.second;
+    auto& allocator_list = tu->memory_allocator_factory->get_allocator_list();
+
+    size_t workspace_size = 0, private_alloc = 0;
+    for (const auto& allocator : allocator_list)
+    {
+        auto host_allocator = dynamic_cast<HostMemoryAllocator*>(allocator.second);
+        auto constant_allocator = dynamic_cast<HostConstantMemoryAllocator*>(allocator.second);
+        if (constant_allocator)
+        {
+            constant_allocator->set_external_table("nnfusion_constants");
+        }
+        if (host_allocator && is_activation_pool(host_allocator->get_symbol()))
+        {
+            host_allocator->set_workspace("nnfusion_workspace", workspace_size);
+            workspace_size += MemoryAllocator::align(host_allocator->max_allocated(), 64);
+        }
+        else
+        {
+            private_alloc += allocator.second->max_allocated();
+        }
+    }
+
+    auto lup_workspace = std::make_shared<LanguageUnit>("declaration::nnfusion_workspace");
+    auto& lu_workspace = *lup_workspace;
+    lu_workspace << "static char* nnfusion_workspace = nullptr;\n";
+    lu_workspace << "static bool nnfusion_own_workspace = false;\n";
+    lu_workspace << "\nextern \"C\" int64_t cpu_workspace_size()\n{\n"
+                 << "return " << workspace_size << ";\n}\n";
+    lu_workspace << "\nextern \"C\" void cpu_set_workspace(char* workspace)\n{\n"
+                 << "nnfusion_workspace = workspace;\n}\n";
+    lu_workspace << "static char** nnfusion_constants = nullptr;\n";
+    lu_workspace << "\nextern \"C\" void cpu_set_constants(char** constants)\n{\n"
+                 << "nnfusion_constants = constants;\n}\n";
+
+    auto lup_alloc = std::make_shared<LanguageUnit>("workspace_alloc");
+    *lup_alloc << "// total memory:" << private_alloc << ", workspace:" << workspace_size << "\n";
+    *lup_alloc << "if (!nnfusion_workspace)\n{\n"
+               << "nnfusion_workspace = (char*)malloc(" << workspace_size << ");\n"
+               << "nnfusion_own_workspace = true;\n}\n";
+    lup_mem_alloc->unit_vec.push_back(lup_alloc);
+    lup_mem_alloc->require(lup_workspace);
+
+    for (const auto& allocator : allocator_list)
+    {
+        lup_mem_alloc->unit_vec.push_back(allocator.second->emit_memory_alloc());
+        lup_mem_alloc->require(allocator.second->emit_memory_init());
+        lup_mem_free->unit_vec.push_back(allocator.second->emit_memory_free());
+        lup_mem_free->require(allocator.second->emit_memory_init());
+    }
+
+    auto lup_free = std::make_shared<LanguageUnit>("workspace_free");
+    *lup_free << "if (nnfusion_own_workspace)\n{\n"
+              << "free(nnfusion_workspace);\n"
+              << "nnfusion_own_workspace = false;\n}\n"
+              << "nnfusion_workspace = nullptr;\n"
+              << "nnfusion_constants = nullptr;\n";
+    lup_mem_free->unit_vec.push_back(lup_free);
+    lup_mem_free->require(lup_workspace);
+
+    return true;
+}
+
 bool CpuCodegenPass::collect_funcs(std::shared_ptr<InterpreterContext> ctx,
                                    std::shared_ptr<TranslationUnit> tu)
 {
@@ -392,23 +909,33 @@ bool CpuCodegenPass::collect_funcs(std::shared_ptr<InterpreterContext> ctx,
 
     // collect code
     auto pairs = collect_ins(ctx, tu);
+    // in dag mode, the calls of each exec instruction become one task of the dag
+    std::unordered_map<nnfusion::ir::Instruction::Pointer, std::deque<LanguageUnit_p>> dag_tasks;
+    // init code of the exec kernels, e.g. packing constant weights, ends cpu_init()
+    auto lup_kernel_init = std::make_shared<LanguageUnitwithVec>("kernel_init_code");
     for (size_t i = 0; i < pairs.size(); i++)
     {
-        int numa_node = i % numa_node_num;
         auto& it = pairs[i];
+        // streams are bound to NUMA nodes round-robin, as their memory pools are
+        NNFUSION_CHECK(!it.second.empty());
+        auto& thread_async_info = (*it.second.front())["Async_info"].as<AsyncExecutionInfo>();
+        int numa_node = thread_async_info.execution_thread->get_stream_id() % numa_node_num;
         int pos = it.first.find(":");
         NNFUSION_CHECK(pos >= 0);
         std::string thread_name = it.first.substr(pos + 1);
         std::string main_block = it.first.substr(0, pos);
+        bool dag_task = dag_schedule && main_block == "exec";
 
-        auto lup_func_calls = get_kernel_func_calls(it.first + "_func_calls", nullptr);
+        auto lup_func_calls = get_kernel_func_calls(
+            dag_task ? "exec:dag_func_calls" : it.first + "_func_calls", nullptr);
         auto thread_call_paras_args_pair = get_paras_and_args(it.second);
         auto thread_call_paras = thread_call_paras_args_pair.first;
         auto thread_call_args = thread_call_paras_args_pair.second;
         if (!thread_call_args.empty())
             thread_call_args = ", " + thread_call_args;
 
-        bool func_call_only = (main_block == "init");
+        // the dag orders the kernels by their edges, so events are not needed
+        bool func_call_only = (main_block == "init") || dag_schedule;
 
         size_t cpu_func_count = 0;
         for (auto ins : it.second)
@@ -448,13 +975,16 @@ bool CpuCodegenPass::collect_funcs(std::shared_ptr<InterpreterContext> ctx,
             }
 
             std::string function_call;
-            if (thread_name == "default_thread")
+            if (thread_name == "default_thread" || dag_schedule)
             {
                 function_call = func_name;
                 string call_str = fu->call_unit->get_code();
                 if (kernel->is_parallelism())
                 {
-                    std::string threadpool_param = "worker_thread_pool->GetRawThreadPool(), ";
+                    std::string threadpool_param = "worker_thread_pool->GetRawThreadPool(";
+                    if (thread_name != "default_thread")
+                        threadpool_param += std::to_string(numa_node);
+                    threadpool_param += "), ";
                     call_str.insert(1, threadpool_param);
                 }
                 function_call += call_str;
@@ -487,15 +1017,28 @@ bool CpuCodegenPass::collect_funcs(std::shared_ptr<InterpreterContext> ctx,
             }
 
             LanguageUnit_p kernel_func_call = func_call_codegen(ins, {}, func_call_only, function_call);
+            auto& calls = dag_task ? dag_tasks[ins] : lup_func_calls->unit_vec;
+            auto cpu_kernel = std::dynamic_pointer_cast<kernels::cpu::CpuKernelEmitter>(kernel);
+            if (auto init_code = cpu_kernel ? cpu_kernel->emit_init_code() : nullptr)
+            {
+                if (main_block == "init")
+                    calls.push_back(init_code);
+                else
+                    lup_kernel_init->unit_vec.push_back(init_code);
+            }
             if (FLAGS_fcustomized_mem_imp)
-                lup_func_calls->unit_vec.push_back(get_customized_mem_imp(ins).first);
-            lup_func_calls->unit_vec.push_back(kernel_func_call);
+                calls.push_back(get_customized_mem_imp(ins).first);
+            calls.push_back(kernel_func_call);
             if (FLAGS_fcustomized_mem_imp)
-                lup_func_calls->unit_vec.push_back(get_customized_mem_imp(ins).second);
+                calls.push_back(get_customized_mem_imp(ins).second);
             ++cpu_func_count;
         }
 
-        if (thread_name != "default_thread")
+        if (dag_task)
+        {
+            continue;
+        }
+        else if (thread_name != "default_thread" && !dag_schedule)
         {
             LanguageUnit_p new_caller =
                 std::make_shared<LanguageUnit>(lup_func_calls->symbol + "_new_caller");
@@ -547,12 +1090,196 @@ bool CpuCodegenPass::collect_funcs(std::shared_ptr<InterpreterContext> ctx,
         }
     }
 
+    if (!lup_kernel_init->unit_vec.empty())
+    {
+        // the constants must be loaded when cpu_init() returns
+        NNFUSION_CHECK(!host_async_manager || host_async_manager->num_non_default_stream() == 0)
+            << "Kernel init code, e.g. of -fcpu_prepack_weights, needs a single stream.";
+        projgen->lup_init->unit_vec.push_back(lup_kernel_init);
+    }
+
+    if (dag_schedule)
+        collect_dag_funcs(tu, dag_tasks);
+
     if (FLAGS_fkernels_as_files)
         separate_func_defs_files(FLAGS_fkernels_files_number, m_codegen_folder + "kernels/");
 
     return true;
 }
 
+void CpuCodegenPass::collect_dag_funcs(
+    std::shared_ptr<TranslationUnit> tu,
+    std::unordered_map<nnfusion::ir::Instruction::Pointer, std::deque<LanguageUnit_p>>& dag_tasks)
+{
+    // the tasks are added once by dag_build() and read the kernel_entry arguments of the
+    // current run from dag_args
+    auto params = split_params(get_kernel_entry_paras(tu));
+    std::vector<std::string> arg_names;
+    for (auto& param : params)
+        arg_names.push_back(param.substr(param.rfind(' ') + 1));
+    std::string capture = context_api ? "[this]" : "[]";
+    auto lup_dag_build = std::make_shared<LanguageUnit>("dag_build");
+    auto& lu_dag_build = *lup_dag_build;
+    if (context_api)
+    {
+        lu_dag_build << "void nnfusion_ctx::dag_build()\n{\n";
+        lup_dag_build->require(ctx_struct_decl);
+    }
+    else
+    {
+        lu_dag_build << "static void dag_build()\n{\n";
+        lup_dag_build->require(get_dag_args_decl(tu));
+    }
+    lu_dag_build << "dag_executor = new nnfusion::cpu::DagExecutor(schedule_thread_pool);\n";
+
+    // A task depends on the producers of its inputs and, as memory is shared by tensors
+    // whose lifetimes do not overlap in program order, on the earlier tasks touching the
+    // same bytes of a pool in a conflicting way.
+    struct PoolAccess
+    {
+        size_t begin;
+        size_t end;
+        int task;
+        bool write;
+    };
+    std::unordered_map<std::string, std::vector<PoolAccess>> pool_accesses;
+    std::unordered_map<std::shared_ptr<GNode>, int> task_ids;
+
+    for (auto iterator : tu->program)
+    {
+        for (auto ins : *iterator)
+        {
+            if (dag_tasks.find(ins) == dag_tasks.end())
+                continue;
+            int task_id = task_ids.size();
+            auto gnode = ins->getGNode();
+            auto kernel = ins->getKernel();
+            std::set<int> deps;
+            for (auto& edge : gnode->get_in_edges())
+            {
+                auto src = task_ids.find(edge->get_src());
+                if (src != task_ids.end())
+                    deps.insert(src->second);
+            }
+
+            std::vector<std::pair<std::shared_ptr<descriptor::Tensor>, bool>> tensors;
+            for (auto& tensor : kernel->m_context->inputs)
+                tensors.push_back(std::make_pair(tensor, false));
+            for (auto& tensor : kernel->m_context->outputs)
+                tensors.push_back(std::make_pair(tensor, true));
+            for (auto& tensor : kernel->m_context->tensors)
+                tensors.push_back(std::make_pair(tensor, true));
+            for (auto& access : tensors)
+            {
+                auto tensor = access.first;
+                if (tensor->get_pool().empty() || tensor->get_pool_offset() == SIZE_MAX)
+                    continue;
+                size_t begin = tensor->get_pool_offset();
+                size_t end = begin + tensor->size();
+                for (auto& prev : pool_accesses[tensor->get_pool()])
+                {
+                    if (prev.begin < end && begin < prev.end && (access.second || prev.write))
+                        deps.insert(prev.task);
+                }
+            }
+            for (auto& access : tensors)
+            {
+                auto tensor = access.first;
+                if (tensor->get_pool().empty() || tensor->get_pool_offset() == SIZE_MAX)
+                    continue;
+                size_t begin = tensor->get_pool_offset();
+                size_t end = begin + tensor->size();
+                auto& accesses = pool_accesses[tensor->get_pool()];
+                // accesses covered by a write are ordered through the new task
+                if (access.second)
+                {
+                    accesses.erase(std::remove_if(accesses.begin(),
+                                                  accesses.end(),
+                                                  [&](const PoolAccess& prev) {
+                                                      return begin <= prev.begin &&
+                                                             prev.end <= end;
+                                                  }),
+                                   accesses.end());
+                }
+                accesses.push_back(PoolAccess{begin, end, task_id, access.second});
+            }
+            task_ids[gnode] = task_id;
+
+            std::string calls;
+            for (auto call : dag_tasks[ins])
+            {
+                calls += call->get_code();
+                for (auto& it : call->local_symbol)
+                    lup_dag_build->require(it.second);
+            }
+            lu_dag_build << "dag_executor->AddTask(" << capture << "()\n{\n";
+            for (auto& name : arg_names)
+            {
+                if (mentions(calls, name))
+                    lu_dag_build << "auto " << name << " = dag_args." << name << ";\n";
+            }
+            lu_dag_build << calls << "}, {" << join(deps, ", ") << "});\n";
+        }
+    }
+
+    lu_dag_build << "}\n\n";
+
+    auto lup_dag_run = std::make_shared<LanguageUnit>("dag_executor_run");
+    for (auto& name : arg_names)
+        *lup_dag_run << "dag_args." << name << " = " << name << ";\n";
+    *lup_dag_run << "dag_executor->Run();\n";
+    lup_dag_run->require(get_dag_args_decl(tu));
+    projgen->lup_exec->unit_vec.push_back(lup_dag_run);
+    projgen->lup_exec->require(lup_dag_build);
+    dag_build_def = lup_dag_build;
+}
+
+LanguageUnit_p CpuCodegenPass::get_dag_args_decl(std::shared_ptr<TranslationUnit> tu)
+{
+    if (dag_args_decl)
+        return dag_args_decl;
+    dag_args_decl = std::make_shared<LanguageUnit>("declaration::nnfusion_dag_args");
+    auto& lu = *dag_args_decl;
+    lu << "struct nnfusion_dag_args\n{\n";
+    for (auto& param : split_params(get_kernel_entry_paras(tu)))
+        lu << param << ";\n";
+    lu << "};\n";
+    if (!context_api)
+    {
+        lu << "static nnfusion::cpu::DagExecutor* dag_executor = nullptr;\n";
+        lu << "static nnfusion_dag_args dag_args;\n";
+    }
+    lu << "\n";
+    return dag_args_decl;
+}
+
+LanguageUnit_p CpuCodegenPass::emit_thread_pool(const std::string& pool, const std::string& create)
+{
+    auto pool_pair =
+        create_init_and_exit_pair<LanguageUnit, LanguageUnit>("init_" + pool, "del_" + pool);
+    if (!shared_workspace)
+    {
+        *pool_pair.first << create;
+        *pool_pair.second << "delete " << pool << ";\n";
+        return pool_pair.first;
+    }
+
+    // runtimes sharing a workspace never run at the same time, so the later ones borrow the
+    // pools of the first one, which is freed last
+    auto lup_handover = std::make_shared<LanguageUnit>("declaration::" + pool + "_handover");
+    *lup_handover << "static bool nnfusion_own_" << pool << " = false;\n";
+    *lup_handover << "\nextern \"C\" void* cpu_get_" << pool << "()\n{\n"
+                  << "return " << pool << ";\n}\n";
+    *lup_handover << "\nextern \"C\" void cpu_set_" << pool << "(void* pool)\n{\n"
+                  << pool << " = (concurrency::NumaAwareThreadPool*)pool;\n}\n";
+    projgen->lup_codegen->require(lup_handover);
+    *pool_pair.first << "if (!" << pool << ")\n{\n"
+                     << create << "nnfusion_own_" << pool << " = true;\n}\n";
+    *pool_pair.second << "if (nnfusion_own_" << pool << ")\ndelete " << pool << ";\n"
+                      << pool << " = nullptr;\nnnfusion_own_" << pool << " = false;\n";
+    return pool_pair.first;
+}
+
 bool CpuCodegenPass::modify_codegen()
 {
     if (global_required.count("header::eigen_spatial_convolution") > 0)
@@ -562,40 +1289,82 @@ bool CpuCodegenPass::modify_codegen()
     }
 
     // multi-thread
-    if (need_intra_node_threadpool ||
+    if (need_intra_node_threadpool || dag_schedule ||
         (host_async_manager && host_async_manager->num_non_default_stream() > 0))
     {
         projgen->lup_codegen->require(header::threadpool);
+        projgen->lup_codegen->require(header::stdlib);
         projgen->lup_codegen->require(declaration::worker_thread_pool);
-        // worker thread pool
-        auto worker_thread_pool_pair = create_init_and_exit_pair<LanguageUnit, LanguageUnit>(
-            "init_worker_thread_pool", "del_worker_thread_pool");
-        auto lup_worker_thread_pool_init = worker_thread_pool_pair.first;
-        auto lup_worker_thread_pool_del = worker_thread_pool_pair.second;
+        // worker thread pool, the benchmark driver sweeps the thread count and pins the workers
+        // through env
+        std::stringstream create;
+        create << "const char* thread_num_env = getenv(\"NNFUSION_THREAD_NUM_PER_NODE\");\n"
+               << "const char* pin_threads_env = getenv(\"NNFUSION_PIN_THREADS\");\n"
+               << "worker_thread_pool = new concurrency::NumaAwareThreadPool(" << numa_node_num
+               << ", thread_num_env ? atoi(thread_num_env) : " << FLAGS_fthread_num_per_node
+               << ", pin_threads_env && atoi(pin_threads_env) != 0);\n";
+        auto lup_worker_thread_pool_init = emit_thread_pool("worker_thread_pool", create.str());
+        // NUMA-local memory pools are first touched by the workers during allocation
+        auto& init_units = projgen->lup_init->unit_vec;
+        auto it = std::find(init_units.begin(), init_units.end(), lup_worker_thread_pool_init);
+        NNFUSION_CHECK(it != init_units.end()) << "The worker thread pool is not created in init.";
+        init_units.erase(it);
+        init_units.push_front(lup_worker_thread_pool_init);
+    }
 
-        auto& lu_worker_thread_pool_init = *lup_worker_thread_pool_init;
-        {
-            lu_worker_thread_pool_init
-                << "worker_thread_pool = new concurrency::NumaAwareThreadPool(" << numa_node_num
-                << ", " << FLAGS_fthread_num_per_node << ");\n";
-        }
-        auto& lu_worker_thread_pool_del = *lup_worker_thread_pool_del;
+    if (need_reduced_precision)
+    {
+        projgen->lup_codegen->require(header::reduced_precision);
+        projgen->lup_codegen->require(reduced_precision_header);
+        reduced_precision_header->write_to = reduced_precision_header->symbol;
+    }
+
+    if (FLAGS_fcpu_simd_dispatch && global_required.count("header::simd_dispatch") > 0)
+    {
+        projgen->lup_codegen->require(header::simd_dispatch);
+        projgen->lup_codegen->require(simd_dispatch_header);
+        simd_dispatch_header->write_to = simd_dispatch_header->symbol;
+        // kernels in the init stream dispatch as well
+        projgen->lup_init->unit_vec.push_front(std::make_shared<LanguageUnit>(
+            "init_simd_isa", "nnfusion::cpu::init_simd_isa();\n"));
+    }
+
+    if (dag_schedule)
+    {
+        // kernels are run by the dag executor, streams and events are not used
+        projgen->lup_codegen->require(declaration::schedule_thread_pool);
+        projgen->lup_codegen->require(header::barrier);
+        projgen->lup_codegen->require(header::dag_executor);
+        projgen->lup_codegen->require(barrier_header);
+        barrier_header->write_to = barrier_header->symbol;
+        projgen->lup_codegen->require(dag_executor_header);
+        dag_executor_header->write_to = dag_executor_header->symbol;
+
+        emit_thread_pool("schedule_thread_pool",
+                         "schedule_thread_pool = new concurrency::NumaAwareThreadPool();\n");
+        if (!context_api)
         {
-            lu_worker_thread_pool_del << "delete worker_thread_pool;\n";
+            // built after the schedule thread pool and deleted before it, contexts build
+            // their own
+            auto dag_pair = create_init_and_exit_pair<LanguageUnit, LanguageUnit>(
+                "init_dag_executor", "del_dag_executor");
+            *dag_pair.first << "dag_build();\n";
+            dag_pair.first->require(dag_build_def);
+            *dag_pair.second << "delete dag_executor;\ndag_executor = nullptr;\n";
         }
     }
 
-    if (host_async_manager && host_async_manager->num_non_default_stream() > 0)
+    if (!dag_schedule && host_async_manager && host_async_manager->num_non_default_stream() > 0)
     {
         projgen->lup_codegen->require(declaration::schedule_thread_pool);
     }
 
-    if (host_async_manager &&
+    if (!dag_schedule && host_async_manager &&
         (host_async_manager->num_non_default_stream() > 0 || host_async_manager->num_event() > 0))
     {
         projgen->lup_codegen->require(header::barrier);
     }
-    if (host_async_manager && host_async_manager->num_non_default_stream() > 0)
+    if (!dag_schedule && host_async_manager && host_async_manager->num_non_default_stream() > 0)
     {
         // default barrier
         LanguageUnit_p default_barrier_decl =
@@ -633,29 +1402,17 @@ bool CpuCodegenPass::modify_codegen()
             std::make_shared<LanguageUnit>("init_barrier_wait", "init_barrier.Wait();\n");
         body.insert(body.begin(), init_barrier_wait);
         // schedule thread pool
-        auto schedule_thread_pool_pair = create_init_and_exit_pair<LanguageUnit, LanguageUnit>(
-            "init_schedule_thread_pool", "del_schedule_thread_pool");
-        auto lup_schedule_thread_pool_init = schedule_thread_pool_pair.first;
-        auto lup_schedule_thread_pool_del = schedule_thread_pool_pair.second;
-
-        auto& lu_schedule_thread_pool_init = *lup_schedule_thread_pool_init;
-        {
-            lu_schedule_thread_pool_init
-                << "schedule_thread_pool = new concurrency::NumaAwareThreadPool();\n";
-        }
-        auto& lu_schedule_thread_pool_del = *lup_schedule_thread_pool_del;
-        {
-            lu_schedule_thread_pool_del << "delete schedule_thread_pool;\n";
-        }
+        emit_thread_pool("schedule_thread_pool",
+                         "schedule_thread_pool = new concurrency::NumaAwareThreadPool();\n");
     }
 
-    if (host_async_manager && host_async_manager->num_event() > 0)
+    if (!dag_schedule && host_async_manager && host_async_manager->num_event() > 0)
     {
         auto barrier_decl = host_async_manager->emit_event_decl();
         projgen->lup_codegen->require(barrier_decl);
     }
 
-    if (host_async_manager &&
+    if (!dag_schedule && host_async_manager &&
         (host_async_manager->num_event() > 0 || host_async_manager->num_non_default_stream() > 0))
     {
         projgen->lup_codegen->require(barrier_header);
@@ -668,5 +1425,14 @@ bool CpuCodegenPass::modify_codegen()
         reference_common_header->write_to = reference_common_header->symbol;
     }
 
+    if (context_api)
+    {
+        // after the shared memory and the init kernels, before the thread pools are deleted
+        projgen->lup_init->unit_vec.push_back(std::make_shared<LanguageUnit>(
+            "init_default_ctx", "nnfusion_default_ctx = new nnfusion_ctx();\n"));
+        projgen->lup_exit->unit_vec.push_front(std::make_shared<LanguageUnit>(
+            "del_default_ctx", "delete nnfusion_default_ctx;\n"));
+    }
+
     return true;
 }
\ No newline at end of file
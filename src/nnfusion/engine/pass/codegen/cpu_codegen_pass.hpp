@@ -23,6 +23,10 @@ namespace nnfusion
             {
             }
 
+            // with the context API, whether the memory pool of symbol is a member of
+            // nnfusion_ctx rather than a global shared by the contexts
+            static bool is_context_pool(const std::string& symbol);
+
         protected:
             virtual void set_global_member(std::shared_ptr<InterpreterContext> ctx,
                                            std::shared_ptr<TranslationUnit> tu) override;
@@ -33,17 +37,44 @@ namespace nnfusion
             }
             virtual void initialize(std::shared_ptr<InterpreterContext> ctx,
                                     std::shared_ptr<TranslationUnit> tu) override;
+            // with the context API, the pools written by kernel_entry become members of
+            // nnfusion_ctx, while the pools filled by cpu_init stay shared globals
+            virtual bool collect_mem(std::shared_ptr<InterpreterContext> ctx,
+                                     std::shared_ptr<TranslationUnit> tu) override;
+            // with a shared workspace, the activation pools are offsets into one buffer
+            bool collect_workspace_mem(std::shared_ptr<InterpreterContext> ctx,
+                                       std::shared_ptr<TranslationUnit> tu);
             virtual void create_cmake_file(std::shared_ptr<InterpreterContext> ctx,
                                            std::shared_ptr<TranslationUnit> tu) override;
             virtual void create_main_file(std::shared_ptr<InterpreterContext> ctx,
                                           std::shared_ptr<TranslationUnit> tu) override;
             virtual bool collect_funcs(std::shared_ptr<InterpreterContext> ctx,
                                        std::shared_ptr<TranslationUnit> tu) override;
+            // emit the exec instructions as tasks of a dag, built once by cpu_init or by each
+            // context and run by kernel_entry
+            void collect_dag_funcs(
+                std::shared_ptr<TranslationUnit> tu,
+                std::unordered_map<nnfusion::ir::Instruction::Pointer, std::deque<LanguageUnit_p>>&
+                    dag_tasks);
+            // the struct holding the kernel_entry arguments of the current dag run
+            LanguageUnit_p get_dag_args_decl(std::shared_ptr<TranslationUnit> tu);
             virtual bool modify_codegen() override;
+            // create and delete the thread pool named pool in cpu_init and cpu_free, with a
+            // shared workspace cpu_set_<pool>() may hand over a pool to borrow instead
+            LanguageUnit_p emit_thread_pool(const std::string& pool, const std::string& create);
             virtual void create_header_file(std::shared_ptr<InterpreterContext> ctx,
                                             std::shared_ptr<TranslationUnit> tu) override;
             virtual NNFusion_DeviceType device_type() { return NNFusion_DeviceType::GENERIC_CPU; }
             bool need_intra_node_threadpool = false;
+            bool dag_schedule = false;
+            bool context_api = false;
+            bool shared_workspace = false;
+            // the declaration of nnfusion_ctx with -fcpu_context_api
+            LanguageUnit_p ctx_struct_decl;
+            LanguageUnit_p dag_args_decl;
+            LanguageUnit_p dag_build_def;
+            // some tensor is bf16, whose storage type is defined in reduced_precision.h
+            bool need_reduced_precision = false;
             int numa_node_num;
             unordered_map<std::string, int> cpu_kernel_thread_idx;
         };
@@ -3,4 +3,5 @@
 
 #pragma once
 
+#include "blockfusion_cpu_optimizer.hpp"
 #include "blockfusion_optimizer.hpp"
\ No newline at end of file
@@ -0,0 +1,211 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "blockfusion_cpu_codegen.hpp"
+#include "nnfusion/core/kernels/cpu/cpu_langunit.hpp"
+
+using namespace nnfusion;
+using namespace nnfusion::kernels;
+
+using namespace std;
+
+BlockFusionCpuCodegen::BlockFusionCpuCodegen(shared_ptr<KernelContext> ctx,
+                                             const std::vector<shared_ptr<KernelEmitter>>& kernels)
+    : CpuKernelEmitter(ctx)
+{
+    m_intra_op_parallelism = true;
+    m_context->kernels = kernels;
+    FuseContext();
+}
+
+void BlockFusionCpuCodegen::FuseContext()
+{
+    auto ctx = m_context;
+    all_args.clear();
+    for (size_t i = 0; i < ctx->inputs.size(); i++)
+        all_args[ctx->inputs[i]->get_name()] = "input" + to_string(i);
+    for (size_t i = 0; i < ctx->outputs.size(); i++)
+        all_args[ctx->outputs[i]->get_name()] = "output" + to_string(i);
+
+    // the unused outputs and the temp tensors of the kernels are temp tensors of the fused one
+    for (auto kernel : ctx->kernels)
+    {
+        auto& kernel_ctx = kernel->m_context;
+        for (auto tensors : {&kernel_ctx->outputs, &kernel_ctx->tensors})
+        {
+            for (auto tv : *tensors)
+            {
+                if (all_args.find(tv->get_name()) != all_args.end())
+                    continue;
+                ctx->tensors.push_back(tv);
+                ctx->tensor_names.push_back(tv->get_name());
+                ctx->dtypes.push_back(tv->get_element_type().c_type_string());
+                all_args[tv->get_name()] = tv->get_name();
+            }
+        }
+        for (auto tv : kernel_ctx->inputs)
+        {
+            NNFUSION_CHECK(all_args.find(tv->get_name()) != all_args.end())
+                << "Input " << tv->get_name() << " of " << kernel->get_function_name()
+                << " is not an input of the BlockFusion kernel.";
+        }
+    }
+}
+
+LanguageUnit_p BlockFusionCpuCodegen::emit_init_code()
+{
+    LanguageUnit_p _lu(new LanguageUnit(get_function_name() + "_init"));
+    for (auto kernel : m_context->kernels)
+    {
+        auto cpu_kernel = std::dynamic_pointer_cast<cpu::CpuKernelEmitter>(kernel);
+        if (auto init_code = cpu_kernel ? cpu_kernel->emit_init_code() : nullptr)
+        {
+            *_lu << init_code->get_code();
+            for (auto& it : init_code->local_symbol)
+                _lu->require(it.second);
+        }
+    }
+    return _lu->get_code().empty() ? nullptr : _lu;
+}
+
+LanguageUnit_p BlockFusionCpuCodegen::emit_block_kernel_functions()
+{
+    LanguageUnit_p _lu(new LanguageUnit(get_function_name() + "_block_kernels"));
+    LanguageUnit& lu = *_lu;
+
+    std::unordered_map<std::string, std::string> kernel_codes;
+    block_kernel_names.clear();
+    for (auto kernel : m_context->kernels)
+    {
+        auto fu = kernel->get_or_emit_source();
+        std::string code = fu->signature_unit->get_code() + fu->body_unit->get_code();
+        if (kernel_codes.find(code) != kernel_codes.end())
+        {
+            block_kernel_names.push_back(kernel_codes[code]);
+            continue;
+        }
+        std::string name = fu->name_unit->get_code();
+        kernel_codes[code] = name;
+        block_kernel_names.push_back(name);
+
+        lu << fu->comment_unit->get_code();
+        lu << "static " << fu->get_specialized_signature() << "\n";
+        lu.block_begin();
+        lu << fu->body_unit->get_code() << "\n";
+        lu.block_end();
+        lu << "\n";
+    }
+    return _lu;
+}
+
+LanguageUnit_p BlockFusionCpuCodegen::emit_function_body()
+{
+    LanguageUnit_p _lu(new LanguageUnit(get_function_name()));
+    LanguageUnit& lu = *_lu;
+
+    // the kernels with the same code are deduplicated while emitting their functions
+    if (block_kernel_names.empty())
+        emit_block_kernel_functions();
+
+    auto& kernels = m_context->kernels;
+    lu << "concurrency::ThreadPool* serial_pool = thread_pool->GetSerialView();\n";
+    lu << "const int32_t num_kernels = " << kernels.size() << ";\n";
+    lu << "std::atomic<int32_t> next_kernel(0);\n";
+    lu << "auto worker = [&](int32_t) {\n";
+    lu << "for (int32_t i = next_kernel++; i < num_kernels; i = next_kernel++)\n";
+    lu.block_begin();
+    lu << "switch (i)\n";
+    lu.block_begin();
+    for (size_t i = 0; i < kernels.size(); i++)
+    {
+        auto& kernel_ctx = kernels[i]->m_context;
+        std::vector<std::string> params;
+        if (kernels[i]->is_parallelism())
+            params.push_back("serial_pool");
+        for (auto tensors : {&kernel_ctx->inputs, &kernel_ctx->outputs, &kernel_ctx->tensors})
+        {
+            for (auto tv : *tensors)
+                params.push_back(all_args[tv->get_name()]);
+        }
+        lu << "case " << i << ": " << block_kernel_names[i] << "(" << join(params, ", ")
+           << "); break;\n";
+    }
+    lu.block_end();
+    lu.block_end();
+    lu << "};\n";
+    lu << "int32_t num_workers = thread_pool->NumThreads();\n";
+    lu << "thread_pool->ParallelFor(num_workers < num_kernels ? num_workers : num_kernels, "
+          "worker);\n";
+    return _lu;
+}
+
+LanguageUnit_p BlockFusionCpuCodegen::emit_dependency()
+{
+    LanguageUnit_p _lu(new LanguageUnit(get_function_name() + "_dep"));
+    _lu->require(header::atomic);
+    _lu->require(header::threadpool);
+
+    // keep each kernel's dependency
+    for (auto kernel : m_context->kernels)
+    {
+        auto kernel_dep = kernel->get_or_emit_source()->dep_unit;
+        for (auto& it : kernel_dep->local_symbol)
+        {
+            _lu->require(it.second);
+        }
+    }
+    return _lu;
+}
+
+LanguageUnit_p BlockFusionCpuCodegen::emit_function_name()
+{
+    LanguageUnit_p _lu(new LanguageUnit("function_name"));
+    auto& lu = *_lu;
+    lu << "BlockFusionKernel_" << m_kernel_type << "_"
+       << m_context->gnode->get_op_ptr()->get_unique_name();
+    return _lu;
+}
+
+LanguageUnit_p BlockFusionCpuCodegen::emit_comments()
+{
+    LanguageUnit_p _lu(new LanguageUnit(get_function_name() + "_comments"));
+    LanguageUnit& lu = *_lu;
+
+    lu << "// Node name:\t BlockFusion"
+       << "\n";
+    lu << "// Input:\n";
+    for (auto in : m_context->inputs)
+    {
+        lu << "//\t- name: " << in->get_name();
+        lu << "\ttype: " << in->get_element_type().c_type_string();
+        lu << "\tshape: " << in->get_shape();
+        lu << "\n";
+    }
+
+    lu << "// Output:\n";
+    for (auto out : m_context->outputs)
+    {
+        lu << "//\t- name: " << out->get_name();
+        lu << "\ttype: " << out->get_element_type().c_type_string();
+        lu << "\tshape: " << out->get_shape();
+        lu << "\n";
+    }
+
+    if (!m_context->tensors.empty())
+    {
+        lu << "// Other tensors in use:\n";
+        for (auto persist : m_context->tensors)
+        {
+            lu << "//\t- name: " << persist->get_name();
+            lu << "\ttype: " << persist->get_element_type().c_type_string();
+            lu << "\tshape: " << persist->get_shape();
+            lu << "\n";
+        }
+    }
+    lu << "\n";
+
+    // emit block kernel functions here, the definition of the fused function follows
+    lu << emit_block_kernel_functions()->get_code();
+
+    return _lu;
+}
@@ -0,0 +1,37 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "nnfusion/core/kernels/cpu/cpu_kernel_emitter.hpp"
+
+using namespace nnfusion::kernels;
+
+// Runs the kernels of a wavefront in one parallel region: min(#threads, #kernels) workers
+// take the kernels from a shared queue in the given order and call them with the serial
+// view of the thread pool, so each kernel runs on the thread that took it.
+class BlockFusionCpuCodegen : public cpu::CpuKernelEmitter
+{
+public:
+    using Pointer = shared_ptr<BlockFusionCpuCodegen>;
+    // ctx is the context of the fused node, whose inputs and outputs cover the ones of kernels
+    BlockFusionCpuCodegen(shared_ptr<KernelContext> ctx,
+                          const std::vector<shared_ptr<KernelEmitter>>& kernels);
+    // the init code of the kernels
+    LanguageUnit_p emit_init_code() override;
+
+private:
+    LanguageUnit_p emit_function_body() override;
+    LanguageUnit_p emit_dependency() override;
+    LanguageUnit_p emit_function_name() override;
+    LanguageUnit_p emit_comments() override;
+
+    void FuseContext();
+    LanguageUnit_p emit_block_kernel_functions();
+
+private:
+    // tensor_name -> argument of the fused function
+    std::unordered_map<std::string, std::string> all_args;
+    // kernels with the same code share the function of the first one
+    std::vector<std::string> block_kernel_names;
+};
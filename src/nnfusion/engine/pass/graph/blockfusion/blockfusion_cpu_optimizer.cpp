@@ -0,0 +1,227 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "blockfusion_cpu_optimizer.hpp"
+#include "blockfusion_cpu_codegen.hpp"
+#include "nnfusion/core/kernels/cpu/controlflow_emitter.hpp"
+#include "nnfusion/core/operators/op_define/noop.hpp"
+
+using namespace nnfusion;
+using namespace nnfusion::graph;
+using namespace nnfusion::kernels;
+
+size_t BlockFusionCpuOptimizer::MAX_GROUP = 128;
+
+BlockFusionCpuOptimizer::BlockFusionCpuOptimizer(std::shared_ptr<Graph> g,
+                                                 size_t max_elements,
+                                                 bool is_outmost_graph)
+    : BlockFusionOptimizer(g, "CPU", false)
+    , m_max_elements(max_elements)
+    , m_is_outmost_graph(is_outmost_graph)
+{
+    for (auto gnode : m_graph->get_ordered_ops())
+    {
+        m_active_gnodes_name.insert(gnode->get_name());
+    }
+}
+
+bool BlockFusionCpuOptimizer::Optimize()
+{
+    if (!m_enable_blockfusion)
+    {
+        return false;
+    }
+    // the kernels of subgraphs are called by the control flow kernels
+    if (!m_is_outmost_graph)
+    {
+        return true;
+    }
+
+    size_t fused_kernels = 0;
+    auto groups = ExtractFusionGroups();
+    for (auto& group : groups)
+    {
+        for (size_t start = 0; start + 1 < group.size(); start += MAX_GROUP)
+        {
+            size_t end = std::min(start + MAX_GROUP, group.size());
+            if (end - start < 2)
+                break;
+            FuseGroupOnGraph(FusionGroup(group.begin() + start, group.begin() + end));
+            fused_kernels += end - start;
+        }
+    }
+    NNFUSION_LOG(INFO) << "BlockFusion fused " << fused_kernels << " CPU kernels.";
+    return true;
+}
+
+size_t BlockFusionCpuOptimizer::get_output_elements(std::shared_ptr<GNode> node)
+{
+    size_t elements = 0;
+    for (size_t i = 0; i < node->get_output_size(); i++)
+    {
+        elements = std::max(elements, shape_size(node->get_output_shape(i)));
+    }
+    return elements;
+}
+
+bool BlockFusionCpuOptimizer::verify_node(std::shared_ptr<GNode> node)
+{
+    NNFUSION_CHECK_NOT_NULLPTR(node);
+
+    // ignore dead gnodes
+    if (m_active_gnodes_name.find(node->get_name()) == m_active_gnodes_name.end())
+    {
+        return false;
+    }
+
+    if (node->is_constant() || node->is_parameter() || node->is_variable() ||
+        node->get_op_type() == "Result")
+    {
+        return false;
+    }
+
+    if (!(*node)["Kernel_Selection_Result"].is_valid())
+    {
+        return false;
+    }
+    auto emitted_kernel =
+        (*node)["Kernel_Selection_Result"].as<pair<NNFusion_DeviceType, KernelEmitter::Pointer>>();
+    auto kernel = emitted_kernel.second;
+    if (emitted_kernel.first != GENERIC_CPU ||
+        std::dynamic_pointer_cast<cpu::CpuKernelEmitter>(kernel) == nullptr)
+    {
+        return false;
+    }
+    // the kernels of the subgraphs would run on the serial view of the thread pool
+    if (std::dynamic_pointer_cast<cpu::ControlFlowEmitter>(kernel) != nullptr)
+    {
+        return false;
+    }
+    if (!kernel->is_emitted() || kernel->get_or_emit_source() == nullptr ||
+        kernel->is_eliminative() || kernel->is_static_function())
+    {
+        return false;
+    }
+
+    // the fused kernel does not share the buffers of its inputs and outputs
+    if (auto annotations = kernel->m_context->annotations)
+    {
+        for (auto& oi_pair : annotations->get_in_place_oi_pairs())
+        {
+            if (oi_pair.force_inplace)
+                return false;
+        }
+    }
+
+    return get_output_elements(node) <= m_max_elements;
+}
+
+std::vector<BlockFusionCpuOptimizer::FusionGroup> BlockFusionCpuOptimizer::ExtractFusionGroups()
+{
+    std::vector<FusionGroup> groups;
+    std::unordered_map<std::shared_ptr<GNode>, size_t> ready_inputs;
+    FusionGroup wavefront;
+    for (auto node : m_graph->get_ordered_ops())
+    {
+        if (node->get_in_edges().empty())
+            wavefront.push_back(node);
+    }
+
+    while (!wavefront.empty())
+    {
+        FusionGroup group;
+        FusionGroup next_wavefront;
+        for (auto node : wavefront)
+        {
+            if (verify_node(node))
+                group.push_back(node);
+            for (auto edge : node->get_out_edges())
+            {
+                auto dst = edge->get_dst();
+                if (++ready_inputs[dst] == dst->get_in_edges().size())
+                    next_wavefront.push_back(dst);
+            }
+        }
+        if (group.size() > 1)
+            groups.push_back(group);
+        wavefront = next_wavefront;
+    }
+    return groups;
+}
+
+void BlockFusionCpuOptimizer::FuseGroupOnGraph(FusionGroup group)
+{
+    // the workers take the kernels in order, so the largest ones start first
+    std::stable_sort(group.begin(),
+                     group.end(),
+                     [this](const std::shared_ptr<GNode>& a, const std::shared_ptr<GNode>& b) {
+                         return get_output_elements(a) > get_output_elements(b);
+                     });
+
+    auto fused_op = std::make_shared<nnfusion::op::NoOp>("blockfusion_kernel");
+    GNodeVector empty_inputs;
+    auto fused_node = std::make_shared<GNode>(fused_op, empty_inputs);
+    m_graph->add_node(fused_node);
+
+    // rewrite the graph by replacing the group with fused node, the kernels of a wavefront
+    // do not depend on each other
+    std::map<std::pair<std::shared_ptr<GNode>, int>, int> input_ids;
+    std::vector<std::shared_ptr<KernelEmitter>> kernels;
+    for (auto node : group)
+    {
+        for (const auto& in_edge : node->get_in_edges())
+        {
+            auto src = in_edge->get_src();
+            if (in_edge->is_control_edge())
+            {
+                m_graph->add_control_edge(src, fused_node);
+                continue;
+            }
+            auto key = std::make_pair(src, in_edge->get_src_output());
+            if (input_ids.find(key) == input_ids.end())
+            {
+                int input_id = input_ids.size();
+                input_ids[key] = input_id;
+                fused_node->set_input(input_id, node->get_inputs().at(in_edge->get_dst_input()));
+                m_graph->add_edge(src, in_edge->get_src_output(), fused_node, input_id);
+            }
+        }
+
+        for (size_t i = 0; i < node->get_output_size(); i++)
+        {
+            auto out_edges = node->get_output_users(i);
+            if (out_edges.empty())
+                continue;
+            int output_id = fused_node->get_output_size();
+            fused_node->set_output(output_id, node->get_outputs().at(i));
+            for (const auto& out_edge : out_edges)
+            {
+                m_graph->add_edge(
+                    fused_node, output_id, out_edge->get_dst(), out_edge->get_dst_input());
+            }
+        }
+        for (const auto& out_edge : node->get_out_edges())
+        {
+            if (out_edge->is_control_edge())
+                m_graph->add_control_edge(fused_node, out_edge->get_dst());
+        }
+
+        auto emitted_kernel = (*node)["Kernel_Selection_Result"]
+                                  .as<pair<NNFusion_DeviceType, KernelEmitter::Pointer>>();
+        kernels.push_back(emitted_kernel.second);
+    }
+
+    auto ctx = std::make_shared<KernelContext>(fused_node);
+    auto kernel = std::make_shared<BlockFusionCpuCodegen>(ctx, kernels);
+    kernel->get_or_emit_source();
+
+    (*fused_node)["DeviceType"] = (*group[0])["DeviceType"].as<NNFusion_DeviceType>();
+    (*fused_node)["DeviceID"] = (*group[0])["DeviceID"].as<int>();
+    (*fused_node)["Kernel_Selection_Result"] =
+        std::make_pair(GENERIC_CPU, std::dynamic_pointer_cast<KernelEmitter>(kernel));
+
+    for (auto node : group)
+    {
+        m_graph->remove_node(node);
+    }
+}
@@ -0,0 +1,36 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "blockfusion_optimizer.hpp"
+
+// Fuses the independent small kernels of each wavefront into a BlockFusionCpuCodegen kernel,
+// which pays one fork/join of the thread pool instead of one per kernel.
+class BlockFusionCpuOptimizer : public BlockFusionOptimizer
+{
+public:
+    BlockFusionCpuOptimizer(std::shared_ptr<nnfusion::graph::Graph> g,
+                            size_t max_elements,
+                            bool is_outmost_graph = true);
+
+    bool Optimize() override;
+
+private:
+    using FusionGroup = std::vector<std::shared_ptr<nnfusion::graph::GNode>>;
+
+    bool verify_node(std::shared_ptr<nnfusion::graph::GNode> node);
+    size_t get_output_elements(std::shared_ptr<nnfusion::graph::GNode> node);
+
+    // the fusible nodes of each wavefront in topological order
+    std::vector<FusionGroup> ExtractFusionGroups();
+    void FuseGroupOnGraph(FusionGroup group);
+
+private:
+    size_t m_max_elements; // kernels writing more elements are not fused
+    bool m_is_outmost_graph;
+    std::unordered_set<std::string> m_active_gnodes_name;
+
+private:
+    static size_t MAX_GROUP;
+};
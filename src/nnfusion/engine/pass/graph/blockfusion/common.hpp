@@ -13,7 +13,7 @@ namespace nnfusion
 {
     namespace blockfusion
     {
-        const static std::vector<std::string> BlockFusionSupportBackend = {"CUDA", "ROCm"};
+        const static std::vector<std::string> BlockFusionSupportBackend = {"CUDA", "ROCm", "CPU"};
 
         class BlockExecutorInstruction
         {
@@ -20,6 +20,12 @@ DEFINE_bool(fblockfusion_check_correctness,
             false,
             "Check the correctness of BlockFusion codegen and fallback to original execution when "
             "failure detected");
+DEFINE_bool(fblockfusion_cpu,
+            false,
+            "Fuse the independent small CPU kernels of each wavefront into one parallel region");
+DEFINE_int64(fblockfusion_cpu_max_elements,
+             65536,
+             "BlockFusion on CPU only fuses the kernels whose outputs have at most so many elements");
 DECLARE_string(fproduct_name);
 DECLARE_string(fdefault_device);
 
@@ -35,7 +41,18 @@ bool BlockFusionPass::run_on_graph(std::shared_ptr<nnfusion::graph::Graph>& grap
     auto ctx = get_context();
     // fix the compile bug of below code
     bool is_outmost_graph = (ctx != nullptr && ctx->is_outmost_graph);
-    if (FLAGS_fblockfusion_level == 1)
+    if (FLAGS_fdefault_device == "CPU")
+    {
+        if (!FLAGS_fblockfusion_cpu)
+        {
+            NNFUSION_LOG(INFO) << "BlockFusion on CPU is disabled.";
+            return true;
+        }
+        // CPU kernels are fused per wavefront at any level
+        optimizer = std::make_shared<BlockFusionCpuOptimizer>(
+            graph, FLAGS_fblockfusion_cpu_max_elements, is_outmost_graph);
+    }
+    else if (FLAGS_fblockfusion_level == 1)
     {
         optimizer =
             std::make_shared<BlockFusionWavefrontOptimizer>(graph,
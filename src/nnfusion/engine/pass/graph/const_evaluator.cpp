@@ -0,0 +1,544 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "const_evaluator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <type_traits>
+
+#include "nnfusion/core/operators/op_define/broadcast.hpp"
+#include "nnfusion/core/operators/op_define/concat.hpp"
+#include "nnfusion/core/operators/op_define/convert.hpp"
+#include "nnfusion/core/operators/op_define/dot.hpp"
+#include "nnfusion/core/operators/op_define/reshape.hpp"
+#include "nnfusion/core/operators/op_define/reverse.hpp"
+#include "nnfusion/core/operators/op_define/slice.hpp"
+#include "nnfusion/core/operators/util/arithmetic_reduction.hpp"
+
+using namespace nnfusion;
+using namespace nnfusion::graph;
+using namespace nnfusion::pass::graph;
+
+namespace
+{
+    std::vector<int64_t> get_strides(const Shape& shape)
+    {
+        std::vector<int64_t> strides(shape.size());
+        int64_t stride = 1;
+        for (size_t i = shape.size(); i-- > 0;)
+        {
+            strides[i] = stride;
+            stride *= shape[i];
+        }
+        return strides;
+    }
+
+    // calls func(i, offset) for the i-th element of shape in row-major order, where the element
+    // at coordinate c has offset + sum(c[d] * strides[d])
+    template <typename F>
+    void for_each_offset(const Shape& shape,
+                         const std::vector<int64_t>& strides,
+                         int64_t offset,
+                         F func)
+    {
+        size_t rank = shape.size();
+        size_t count = shape_size(shape);
+        std::vector<size_t> coord(rank, 0);
+        for (size_t i = 0; i < count; ++i)
+        {
+            func(i, offset);
+            for (size_t d = rank; d-- > 0;)
+            {
+                offset += strides[d];
+                if (++coord[d] < shape[d])
+                    break;
+                offset -= strides[d] * shape[d];
+                coord[d] = 0;
+            }
+        }
+    }
+
+    void strided_copy(const void* in,
+                      void* out,
+                      const Shape& out_shape,
+                      const std::vector<int64_t>& in_strides,
+                      int64_t in_offset,
+                      size_t elem_size)
+    {
+        const char* src = static_cast<const char*>(in);
+        char* dst = static_cast<char*>(out);
+        for_each_offset(out_shape, in_strides, in_offset, [&](size_t i, int64_t offset) {
+            memcpy(dst + i * elem_size, src + offset * elem_size, elem_size);
+        });
+    }
+
+    template <template <typename> class Kernel, typename... Args>
+    bool dispatch(const element::Type& type, Args&&... args)
+    {
+        if (type == element::f32)
+            return Kernel<float>()(std::forward<Args>(args)...);
+        else if (type == element::f64)
+            return Kernel<double>()(std::forward<Args>(args)...);
+        else if (type == element::i8)
+            return Kernel<int8_t>()(std::forward<Args>(args)...);
+        else if (type == element::i16)
+            return Kernel<int16_t>()(std::forward<Args>(args)...);
+        else if (type == element::i32)
+            return Kernel<int32_t>()(std::forward<Args>(args)...);
+        else if (type == element::i64)
+            return Kernel<int64_t>()(std::forward<Args>(args)...);
+        else if (type == element::u8)
+            return Kernel<uint8_t>()(std::forward<Args>(args)...);
+        else if (type == element::u16)
+            return Kernel<uint16_t>()(std::forward<Args>(args)...);
+        else if (type == element::u32)
+            return Kernel<uint32_t>()(std::forward<Args>(args)...);
+        else if (type == element::u64)
+            return Kernel<uint64_t>()(std::forward<Args>(args)...);
+        else if (type == element::boolean)
+            return Kernel<char>()(std::forward<Args>(args)...);
+        return false;
+    }
+
+    template <typename T>
+    struct UnaryKernel
+    {
+        bool operator()(const std::string& op_type, const void* in, void* out, size_t count) const
+        {
+            std::function<T(T)> func;
+            if (op_type == "Abs")
+                func = [](T x) { return x > T(0) ? x : T(-x); };
+            else if (op_type == "Negative")
+                func = [](T x) { return T(-x); };
+            else if (op_type == "Square")
+                func = [](T x) { return T(x * x); };
+            else if (op_type == "Relu")
+                func = [](T x) { return x > T(0) ? x : T(0); };
+            else if (op_type == "Sign")
+                func = [](T x) { return T((T(0) < x) - (x < T(0))); };
+            else if (op_type == "Not")
+                func = [](T x) { return T(!x); };
+            else if (!std::is_floating_point<T>::value)
+                return false;
+            else if (op_type == "Exp")
+                func = [](T x) { return T(std::exp(x)); };
+            else if (op_type == "Log")
+                func = [](T x) { return T(std::log(x)); };
+            else if (op_type == "Sqrt")
+                func = [](T x) { return T(std::sqrt(x)); };
+            else if (op_type == "Rsqrt")
+                func = [](T x) { return T(1 / std::sqrt(x)); };
+            else if (op_type == "Sin")
+                func = [](T x) { return T(std::sin(x)); };
+            else if (op_type == "Cos")
+                func = [](T x) { return T(std::cos(x)); };
+            else if (op_type == "Tan")
+                func = [](T x) { return T(std::tan(x)); };
+            else if (op_type == "Sinh")
+                func = [](T x) { return T(std::sinh(x)); };
+            else if (op_type == "Cosh")
+                func = [](T x) { return T(std::cosh(x)); };
+            else if (op_type == "Tanh")
+                func = [](T x) { return T(std::tanh(x)); };
+            else if (op_type == "Asin")
+                func = [](T x) { return T(std::asin(x)); };
+            else if (op_type == "Acos")
+                func = [](T x) { return T(std::acos(x)); };
+            else if (op_type == "Atan")
+                func = [](T x) { return T(std::atan(x)); };
+            else if (op_type == "Erf")
+                func = [](T x) { return T(std::erf(x)); };
+            else if (op_type == "Sigmoid")
+                func = [](T x) { return T(1 / (1 + std::exp(-x))); };
+            else if (op_type == "Floor")
+                func = [](T x) { return T(std::floor(x)); };
+            else if (op_type == "Ceiling")
+                func = [](T x) { return T(std::ceil(x)); };
+            else
+                return false;
+
+            const T* a = static_cast<const T*>(in);
+            T* o = static_cast<T*>(out);
+            for (size_t i = 0; i < count; ++i)
+                o[i] = func(a[i]);
+            return true;
+        }
+    };
+
+    template <typename T>
+    struct BinaryKernel
+    {
+        bool operator()(const std::string& op_type,
+                        const void* in0,
+                        const void* in1,
+                        void* out,
+                        size_t count) const
+        {
+            const T* a = static_cast<const T*>(in0);
+            const T* b = static_cast<const T*>(in1);
+            std::function<T(T, T)> func;
+            if (op_type == "Add")
+                func = [](T x, T y) { return T(x + y); };
+            else if (op_type == "Subtract")
+                func = [](T x, T y) { return T(x - y); };
+            else if (op_type == "Multiply")
+                func = [](T x, T y) { return T(x * y); };
+            else if (op_type == "Divide")
+                func = [](T x, T y) { return T(x / y); };
+            else if (op_type == "DivNoNan")
+                func = [](T x, T y) { return y == T(0) ? T(0) : T(x / y); };
+            else if (op_type == "Maximum")
+                func = [](T x, T y) { return x > y ? x : y; };
+            else if (op_type == "Minimum")
+                func = [](T x, T y) { return x < y ? x : y; };
+            else if (op_type == "Power")
+                func = [](T x, T y) { return T(std::pow(x, y)); };
+            else if (op_type == "And")
+                func = [](T x, T y) { return T(x && y); };
+            else if (op_type == "Or")
+                func = [](T x, T y) { return T(x || y); };
+            else
+                return false;
+
+            // integer division by zero traps, leave it to the runtime of the target
+            if (op_type == "Divide" && !std::is_floating_point<T>::value &&
+                std::find(b, b + count, T(0)) != b + count)
+                return false;
+
+            T* o = static_cast<T*>(out);
+            for (size_t i = 0; i < count; ++i)
+                o[i] = func(a[i], b[i]);
+            return true;
+        }
+    };
+
+    template <typename T>
+    struct ComparisonKernel
+    {
+        bool operator()(const std::string& op_type,
+                        const void* in0,
+                        const void* in1,
+                        void* out,
+                        size_t count) const
+        {
+            std::function<bool(T, T)> func;
+            if (op_type == "Equal")
+                func = [](T x, T y) { return x == y; };
+            else if (op_type == "NotEqual")
+                func = [](T x, T y) { return x != y; };
+            else if (op_type == "Less")
+                func = [](T x, T y) { return x < y; };
+            else if (op_type == "LessEq")
+                func = [](T x, T y) { return x <= y; };
+            else if (op_type == "Greater")
+                func = [](T x, T y) { return x > y; };
+            else if (op_type == "GreaterEq")
+                func = [](T x, T y) { return x >= y; };
+            else
+                return false;
+
+            const T* a = static_cast<const T*>(in0);
+            const T* b = static_cast<const T*>(in1);
+            char* o = static_cast<char*>(out);
+            for (size_t i = 0; i < count; ++i)
+                o[i] = func(a[i], b[i]);
+            return true;
+        }
+    };
+
+    template <typename TI>
+    struct ConvertKernel
+    {
+        template <typename TO>
+        static bool convert(const void* in, void* out, size_t count)
+        {
+            const TI* a = static_cast<const TI*>(in);
+            TO* o = static_cast<TO*>(out);
+            for (size_t i = 0; i < count; ++i)
+                o[i] = static_cast<TO>(a[i]);
+            return true;
+        }
+
+        bool operator()(const element::Type& out_type,
+                        const void* in,
+                        void* out,
+                        size_t count) const
+        {
+            if (out_type == element::f32)
+                return convert<float>(in, out, count);
+            else if (out_type == element::f64)
+                return convert<double>(in, out, count);
+            else if (out_type == element::i8)
+                return convert<int8_t>(in, out, count);
+            else if (out_type == element::i16)
+                return convert<int16_t>(in, out, count);
+            else if (out_type == element::i32)
+                return convert<int32_t>(in, out, count);
+            else if (out_type == element::i64)
+                return convert<int64_t>(in, out, count);
+            else if (out_type == element::u8)
+                return convert<uint8_t>(in, out, count);
+            else if (out_type == element::u16)
+                return convert<uint16_t>(in, out, count);
+            else if (out_type == element::u32)
+                return convert<uint32_t>(in, out, count);
+            else if (out_type == element::u64)
+                return convert<uint64_t>(in, out, count);
+            else if (out_type == element::boolean)
+            {
+                const TI* a = static_cast<const TI*>(in);
+                char* o = static_cast<char*>(out);
+                for (size_t i = 0; i < count; ++i)
+                    o[i] = a[i] != TI(0);
+                return true;
+            }
+            return false;
+        }
+    };
+
+    template <typename T>
+    struct ReduceKernel
+    {
+        bool operator()(const std::string& op_type,
+                        const void* in,
+                        void* out,
+                        const Shape& in_shape,
+                        const AxisSet& reduction_axes) const
+        {
+            T init;
+            std::function<T(T, T)> func;
+            if (op_type == "Sum")
+            {
+                init = T(0);
+                func = [](T x, T y) { return T(x + y); };
+            }
+            else if (op_type == "Product")
+            {
+                init = T(1);
+                func = [](T x, T y) { return T(x * y); };
+            }
+            else if (op_type == "Max")
+            {
+                init = std::numeric_limits<T>::lowest();
+                func = [](T x, T y) { return x > y ? x : y; };
+            }
+            else if (op_type == "Min")
+            {
+                init = std::numeric_limits<T>::max();
+                func = [](T x, T y) { return x < y ? x : y; };
+            }
+            else
+                return false;
+
+            Shape out_shape;
+            for (size_t i = 0; i < in_shape.size(); ++i)
+                if (!reduction_axes.count(i))
+                    out_shape.push_back(in_shape[i]);
+            auto out_strides = get_strides(out_shape);
+            // reduced axes do not move in the output
+            std::vector<int64_t> strides(in_shape.size(), 0);
+            for (size_t i = 0, j = 0; i < in_shape.size(); ++i)
+                if (!reduction_axes.count(i))
+                    strides[i] = out_strides[j++];
+
+            const T* a = static_cast<const T*>(in);
+            T* o = static_cast<T*>(out);
+            std::fill(o, o + shape_size(out_shape), init);
+            for_each_offset(in_shape, strides, 0, [&](size_t i, int64_t offset) {
+                o[offset] = func(o[offset], a[i]);
+            });
+            return true;
+        }
+    };
+
+    template <typename T>
+    struct DotKernel
+    {
+        bool operator()(const void* in0,
+                        const void* in1,
+                        void* out,
+                        const Shape& a_shape,
+                        const Shape& b_shape,
+                        size_t reduction_axes_count) const
+        {
+            if (reduction_axes_count > a_shape.size() || reduction_axes_count > b_shape.size())
+                return false;
+            size_t m = shape_size(Shape(a_shape.begin(), a_shape.end() - reduction_axes_count));
+            size_t k = shape_size(Shape(a_shape.end() - reduction_axes_count, a_shape.end()));
+            size_t n = shape_size(Shape(b_shape.begin() + reduction_axes_count, b_shape.end()));
+
+            const T* a = static_cast<const T*>(in0);
+            const T* b = static_cast<const T*>(in1);
+            T* o = static_cast<T*>(out);
+            std::fill(o, o + m * n, T(0));
+            for (size_t i = 0; i < m; ++i)
+                for (size_t r = 0; r < k; ++r)
+                    for (size_t j = 0; j < n; ++j)
+                        o[i * n + j] += a[i * k + r] * b[r * n + j];
+            return true;
+        }
+    };
+}
+
+bool ConstEvaluator::evaluate(std::shared_ptr<GNode> gnode,
+                              const std::vector<const void*>& inputs,
+                              std::vector<char>& output)
+{
+    if (gnode->get_output_size() != 1 || inputs.size() != gnode->get_input_size())
+        return false;
+    for (auto input : inputs)
+        if (input == nullptr)
+            return false;
+
+    auto op = gnode->get_op_ptr();
+    auto op_type = gnode->get_op_type();
+    auto& out_type = gnode->get_output_element_type(0);
+    auto& out_shape = gnode->get_output_shape(0);
+    size_t elem_size = out_type.size();
+    size_t count = shape_size(out_shape);
+    output.resize(count * elem_size);
+    void* out = output.data();
+
+    if (op_type == "Identity" || op_type == "StopGradient")
+    {
+        memcpy(out, inputs[0], output.size());
+        return true;
+    }
+    else if (op_type == "Reshape")
+    {
+        auto& in_shape = gnode->get_input_shape(0);
+        auto& input_order = std::static_pointer_cast<op::Reshape>(op)->get_input_order();
+        if (input_order.size() != in_shape.size())
+            return false;
+        // a reshape only moves data when the input order transposes
+        Shape transposed_shape(in_shape.size());
+        std::vector<int64_t> in_strides(in_shape.size());
+        auto row_strides = get_strides(in_shape);
+        for (size_t i = 0; i < input_order.size(); ++i)
+        {
+            transposed_shape[i] = in_shape[input_order[i]];
+            in_strides[i] = row_strides[input_order[i]];
+        }
+        strided_copy(inputs[0], out, transposed_shape, in_strides, 0, elem_size);
+        return true;
+    }
+    else if (op_type == "Broadcast")
+    {
+        auto& broadcast_axes = std::static_pointer_cast<op::Broadcast>(op)->get_broadcast_axes();
+        auto row_strides = get_strides(gnode->get_input_shape(0));
+        std::vector<int64_t> in_strides(out_shape.size(), 0);
+        for (size_t i = 0, j = 0; i < out_shape.size(); ++i)
+            if (!broadcast_axes.count(i))
+                in_strides[i] = row_strides[j++];
+        strided_copy(inputs[0], out, out_shape, in_strides, 0, elem_size);
+        return true;
+    }
+    else if (op_type == "Slice")
+    {
+        auto slice = std::static_pointer_cast<op::Slice>(op);
+        auto& lower_bounds = slice->get_lower_bounds();
+        auto& strides = slice->get_strides();
+        auto row_strides = get_strides(gnode->get_input_shape(0));
+        std::vector<int64_t> in_strides(out_shape.size());
+        int64_t in_offset = 0;
+        for (size_t i = 0; i < out_shape.size(); ++i)
+        {
+            in_strides[i] = row_strides[i] * strides[i];
+            in_offset += row_strides[i] * lower_bounds[i];
+        }
+        strided_copy(inputs[0], out, out_shape, in_strides, in_offset, elem_size);
+        return true;
+    }
+    else if (op_type == "Reverse")
+    {
+        auto& reversed_axes = std::static_pointer_cast<op::Reverse>(op)->get_reversed_axes();
+        auto in_strides = get_strides(out_shape);
+        int64_t in_offset = 0;
+        for (size_t i = 0; i < out_shape.size(); ++i)
+        {
+            if (!reversed_axes.count(i) || out_shape[i] == 0)
+                continue;
+            in_offset += in_strides[i] * (out_shape[i] - 1);
+            in_strides[i] = -in_strides[i];
+        }
+        strided_copy(inputs[0], out, out_shape, in_strides, in_offset, elem_size);
+        return true;
+    }
+    else if (op_type == "Concat")
+    {
+        size_t axis = std::static_pointer_cast<op::Concat>(op)->get_concatenation_axis();
+        size_t outer = shape_size(Shape(out_shape.begin(), out_shape.begin() + axis));
+        char* dst = static_cast<char*>(out);
+        for (size_t o = 0; o < outer; ++o)
+        {
+            for (size_t i = 0; i < inputs.size(); ++i)
+            {
+                auto& in_shape = gnode->get_input_shape(i);
+                size_t chunk =
+                    shape_size(Shape(in_shape.begin() + axis, in_shape.end())) * elem_size;
+                memcpy(dst, static_cast<const char*>(inputs[i]) + o * chunk, chunk);
+                dst += chunk;
+            }
+        }
+        return true;
+    }
+    else if (op_type == "Select")
+    {
+        const char* cond = static_cast<const char*>(inputs[0]);
+        const char* a = static_cast<const char*>(inputs[1]);
+        const char* b = static_cast<const char*>(inputs[2]);
+        char* dst = static_cast<char*>(out);
+        for (size_t i = 0; i < count; ++i)
+            memcpy(dst + i * elem_size, (cond[i] ? a : b) + i * elem_size, elem_size);
+        return true;
+    }
+    else if (op_type == "Convert")
+    {
+        return dispatch<ConvertKernel>(
+            gnode->get_input_element_type(0), out_type, inputs[0], out, count);
+    }
+    else if (op_type == "Sum" || op_type == "Product" || op_type == "Max" || op_type == "Min")
+    {
+        auto& reduction_axes =
+            std::static_pointer_cast<op::ArithmeticReduction>(op)->get_reduction_axes();
+        return dispatch<ReduceKernel>(
+            out_type, op_type, inputs[0], out, gnode->get_input_shape(0), reduction_axes);
+    }
+    else if (op_type == "Dot")
+    {
+        auto dot = std::static_pointer_cast<op::Dot>(op);
+        if (dot->get_transpose_A() || dot->get_transpose_B() ||
+            gnode->get_input_element_type(0) != out_type ||
+            gnode->get_input_element_type(1) != out_type)
+            return false;
+        return dispatch<DotKernel>(out_type,
+                                   inputs[0],
+                                   inputs[1],
+                                   out,
+                                   gnode->get_input_shape(0),
+                                   gnode->get_input_shape(1),
+                                   dot->get_reduction_axes_count());
+    }
+
+    // elementwise ops, whose inputs have the shape of the output
+    for (size_t i = 0; i < inputs.size(); ++i)
+        if (gnode->get_input_shape(i) != out_shape)
+            return false;
+    if (inputs.size() == 1 && gnode->get_input_element_type(0) == out_type)
+        return dispatch<UnaryKernel>(out_type, op_type, inputs[0], out, count);
+    if (inputs.size() == 2 && gnode->get_input_element_type(1) == gnode->get_input_element_type(0))
+    {
+        if (out_type == gnode->get_input_element_type(0) &&
+            dispatch<BinaryKernel>(out_type, op_type, inputs[0], inputs[1], out, count))
+            return true;
+        // comparisons of booleans have the type of the output too
+        if (out_type == element::boolean)
+            return dispatch<ComparisonKernel>(
+                gnode->get_input_element_type(0), op_type, inputs[0], inputs[1], out, count);
+    }
+    return false;
+}
@@ -0,0 +1,31 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <vector>
+
+#include "nnfusion/core/graph/gnode.hpp"
+
+namespace nnfusion
+{
+    namespace pass
+    {
+        namespace graph
+        {
+            ///\brief In-process evaluation of the common ops for constant folding, following the
+            /// semantics of the cpu reference kernels. Shape manipulations work on raw bytes and
+            /// support every element type, arithmetic supports the real, integral and boolean
+            /// types but not f16/bf16.
+            class ConstEvaluator
+            {
+            public:
+                // inputs[i] points to the data of the i-th input, outputs are not supported
+                // for nodes with more than one output
+                static bool evaluate(std::shared_ptr<nnfusion::graph::GNode> gnode,
+                                     const std::vector<const void*>& inputs,
+                                     std::vector<char>& output);
+            };
+        } // namespace graph
+    }     // namespace pass
+} // namespace nnfusion
@@ -7,9 +7,13 @@
 #include "nnfusion/core/operators/op_define/loop.hpp"
 #include "nnfusion/core/operators/op_define/recursion.hpp"
 #include "nnfusion/core/operators/op_define/while.hpp"
+#include "nnfusion/engine/device/cpu.hpp"
 #include "nnfusion/engine/device/cuda.hpp"
+#include "nnfusion/core/kernels/cpu/general/controlflow.hpp"
 #include "nnfusion/core/kernels/cuda_gpu/kernels/recursion.hpp"
 
+DECLARE_string(fdefault_device);
+
 using namespace nnfusion;
 using namespace nnfusion::pass::graph;
 using namespace nnfusion::engine;
@@ -35,8 +39,12 @@ void update_callers(std::shared_ptr<nnfusion::graph::Graph> graph, nnfusion::ir:
                 graph->add_edge(const_node, 0, node, idx);
                 NNFUSION_LOG(INFO) << "new node:" << *node;
                 int demangle_status;
-                auto func_forward_kernel = dynamic_pointer_cast<nnfusion::kernels::cuda::FuncForward>(ins->getKernel());
-                func_forward_kernel->update_context_from_gnode(node);
+                if (auto cpu_kernel = dynamic_pointer_cast<nnfusion::kernels::cpu::FuncForward>(ins->getKernel())) {
+                    cpu_kernel->update_context_from_gnode(node);
+                } else {
+                    auto func_forward_kernel = dynamic_pointer_cast<nnfusion::kernels::cuda::FuncForward>(ins->getKernel());
+                    func_forward_kernel->update_context_from_gnode(node);
+                }
                 NNFUSION_LOG(INFO) << "forward kernel type: " << abi::__cxa_demangle(typeid(*(ins->getKernel())).name(), 0, 0, &demangle_status);
             } else if (node->get_op_type() == "While") {
                 auto op = static_pointer_cast<While>(node->get_op_ptr());
@@ -56,6 +64,32 @@ void update_callers(std::shared_ptr<nnfusion::graph::Graph> graph, nnfusion::ir:
     }
 }
 
+// compile the subgraph with the engine of the default device
+nnfusion::TranslationUnit::Pointer compile_subgraph(std::shared_ptr<nnfusion::graph::Graph> graph)
+{
+    if (nnfusion::get_device_type(FLAGS_fdefault_device) == GENERIC_CPU)
+        return CpuEngine().convert_graph_to_program(graph, false);
+    return CudaEngine().convert_graph_to_program(graph, false);
+}
+
+// name the Recursion op called by the FuncForward nodes of its body, nested Recursion ops
+// name their own
+void mark_recursive_calls(std::shared_ptr<nnfusion::graph::Graph> graph, const std::string& op_name)
+{
+    for (auto node : graph->get_nodes())
+    {
+        if (node->get_op_type() == "FuncForward") {
+            node->Set<std::string>("recursion_op", std::string(op_name));
+        } else if (node->get_op_type() == "Loop" || node->get_op_type() == "While") {
+            mark_recursive_calls(static_pointer_cast<Loop>(node->get_op_ptr())->get_loop_body_graph(), op_name);
+        } else if (node->get_op_type() == "If") {
+            auto op = static_pointer_cast<If>(node->get_op_ptr());
+            mark_recursive_calls(op->get_then_branch_graph(), op_name);
+            mark_recursive_calls(op->get_else_branch_graph(), op_name);
+        }
+    }
+}
+
 // this func append Constants in the subgraph as additional inputs to the control flow node
 void extract_constant_nodes(std::shared_ptr<nnfusion::graph::Graph>& graph,
                                    std::shared_ptr<nnfusion::graph::GNode> gnode,
@@ -97,7 +131,7 @@ bool ControlFlowPass::run_on_graph(std::shared_ptr<nnfusion::graph::Graph>& grap
             auto op = static_pointer_cast<Loop>(gnode->get_op_ptr());
             NNFUSION_CHECK_NOT_NULLPTR(op);
             auto loop_body = op->get_loop_body_graph();
-            auto loop_body_tu = CudaEngine().convert_graph_to_program(loop_body, false);
+            auto loop_body_tu = compile_subgraph(loop_body);
             op->set_loop_body_tu(loop_body_tu);
             extract_constant_nodes(graph, gnode, loop_body_tu->program);
         }
@@ -106,7 +140,7 @@ bool ControlFlowPass::run_on_graph(std::shared_ptr<nnfusion::graph::Graph>& grap
             auto op = static_pointer_cast<While>(gnode->get_op_ptr());
             NNFUSION_CHECK_NOT_NULLPTR(op);
             auto loop_body = op->get_loop_body_graph();
-            auto loop_body_tu = CudaEngine().convert_graph_to_program(loop_body, false);
+            auto loop_body_tu = compile_subgraph(loop_body);
             op->set_loop_body_tu(loop_body_tu);
             extract_constant_nodes(graph, gnode, loop_body_tu->program);
         }
@@ -116,8 +150,8 @@ bool ControlFlowPass::run_on_graph(std::shared_ptr<nnfusion::graph::Graph>& grap
             NNFUSION_CHECK_NOT_NULLPTR(op);
             auto then_branch = op->get_then_branch_graph();
             auto else_branch = op->get_else_branch_graph();
-            auto then_branch_tu = CudaEngine().convert_graph_to_program(then_branch, false);
-            auto else_branch_tu = CudaEngine().convert_graph_to_program(else_branch, false);
+            auto then_branch_tu = compile_subgraph(then_branch);
+            auto else_branch_tu = compile_subgraph(else_branch);
             op->set_then_branch_tu(then_branch_tu);
             op->set_else_branch_tu(else_branch_tu);
             extract_constant_nodes(graph, gnode, then_branch_tu->program);
@@ -128,7 +162,8 @@ bool ControlFlowPass::run_on_graph(std::shared_ptr<nnfusion::graph::Graph>& grap
             auto op = static_pointer_cast<Recursion>(gnode->get_op_ptr());
             NNFUSION_CHECK_NOT_NULLPTR(op);
             auto body = op->get_body_graph();
-            auto body_tu = CudaEngine().convert_graph_to_program(body, false);
+            mark_recursive_calls(body, op->get_unique_name());
+            auto body_tu = compile_subgraph(body);
             op->set_body_tu(body_tu);
             extract_constant_nodes(graph, gnode, body_tu->program);
         }
@@ -0,0 +1,143 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "graph_snapshot_pass.hpp"
+#include "assign_layout_pass.hpp"
+#include "nnfusion/engine/engine.hpp"
+
+#include <sstream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+DEFINE_string(fgraph_snapshot_dir,
+              "",
+              "Folder of the graph snapshots taken before kernel selection, which are reused "
+              "when the model and the flags match. Empty to disable.");
+
+using namespace nnfusion::graph;
+using namespace nnfusion::pass::graph;
+
+namespace
+{
+    // bump when the serialized graph or the passes before the snapshot change
+    const std::string snapshot_format = "1";
+
+    // stable across builds and platforms, unlike std::hash
+    uint64_t fnv1a_hash(const char* data, size_t size, uint64_t hash = 14695981039346656037ULL)
+    {
+        for (size_t i = 0; i < size; i++)
+        {
+            hash ^= (unsigned char)data[i];
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    uint64_t fnv1a_hash(const std::string& str, uint64_t hash)
+    {
+        return fnv1a_hash(str.data(), str.size(), hash);
+    }
+
+    // empty if the model cannot be read
+    std::string get_snapshot_path(const std::string& model_path, const std::string& model_options)
+    {
+        std::ifstream model(model_path, std::ios::binary);
+        if (!model)
+            return "";
+        uint64_t hash = fnv1a_hash(snapshot_format, 14695981039346656037ULL);
+        std::vector<char> buffer(1 << 20);
+        while (model)
+        {
+            model.read(buffer.data(), buffer.size());
+            hash = fnv1a_hash(buffer.data(), model.gcount(), hash);
+        }
+        hash = fnv1a_hash(model_options, hash);
+
+        std::vector<google::CommandLineFlagInfo> flags;
+        google::GetAllFlags(&flags);
+        for (auto& flag : flags)
+        {
+            if (flag.name == "fgraph_snapshot_dir")
+                continue;
+            hash = fnv1a_hash(flag.name + "=" + flag.current_value + ";", hash);
+        }
+
+        std::stringstream ss;
+        ss << std::hex << hash;
+        auto dir = FLAGS_fgraph_snapshot_dir;
+        if (dir.back() != '/')
+            dir += "/";
+        return dir + ss.str() + ".pb";
+    }
+}
+
+std::shared_ptr<Graph> GraphSnapshotPass::load(const std::string& model_path,
+                                               const std::string& model_options,
+                                               std::shared_ptr<EngineContext> context)
+{
+    if (FLAGS_fgraph_snapshot_dir.empty())
+        return nullptr;
+    auto path = get_snapshot_path(model_path, model_options);
+    if (path.empty())
+        return nullptr;
+    context->Set<std::string>("graph_snapshot_path", std::move(path));
+
+    struct stat s;
+    auto& snapshot = context->Get<std::string>("graph_snapshot_path");
+    if (stat(snapshot.c_str(), &s) != 0)
+        return nullptr;
+    auto graph = Graph::deserialize_from_file(snapshot);
+    if (graph == nullptr)
+        return nullptr;
+    NNFUSION_LOG(INFO) << "Graph restored from snapshot " << snapshot;
+    context->Set<bool>("graph_snapshot_restored", true);
+    return graph;
+}
+
+bool GraphSnapshotPass::is_restored(std::shared_ptr<EngineContext> context)
+{
+    return context != nullptr && context->hasAttribute("graph_snapshot_restored") &&
+           context->Get<bool>("graph_snapshot_restored");
+}
+
+bool GraphSnapshotPass::run_on_graph(std::shared_ptr<Graph>& graph)
+{
+    auto context = get_context();
+    if (context == nullptr || !context->is_outmost_graph ||
+        !context->hasAttribute("graph_snapshot_path"))
+        return true;
+
+    // tensor layouts are not part of the snapshot
+    if (is_restored(context))
+        return AssignLayoutPass().run_on_graph(graph);
+
+    auto& path = context->Get<std::string>("graph_snapshot_path");
+    // create the missing parents as well, like mkdir -p
+    bool created = true;
+    const std::string& dir = FLAGS_fgraph_snapshot_dir;
+    for (size_t pos = dir.find('/', 1); created; pos = dir.find('/', pos + 1))
+    {
+        created = nnfusion::codegen::create_folder(dir.substr(0, pos));
+        if (pos == std::string::npos)
+            break;
+    }
+    if (!created)
+    {
+        NNFUSION_LOG(NNFUSION_WARNING) << "Failed to create graph snapshot folder "
+                                       << FLAGS_fgraph_snapshot_dir;
+        return true;
+    }
+    // other processes may read the snapshots, so publish the file atomically
+    auto tmp_path = path + ".tmp" + std::to_string(getpid());
+    if (!graph->serialize_to_file(tmp_path))
+    {
+        NNFUSION_LOG(INFO) << "Graph cannot be restored from a snapshot, skip saving it.";
+        remove(tmp_path.c_str());
+        return true;
+    }
+    if (rename(tmp_path.c_str(), path.c_str()) != 0)
+        remove(tmp_path.c_str());
+    else
+        NNFUSION_LOG(INFO) << "Graph snapshot saved to " << path;
+    return true;
+}
@@ -0,0 +1,37 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "graph_pass_base.hpp"
+#include "nnfusion/common/common.hpp"
+
+DECLARE_string(fgraph_snapshot_dir);
+
+namespace nnfusion
+{
+    namespace pass
+    {
+        namespace graph
+        {
+            ///\brief Caches the graph produced by the graph passes before kernel selection. The
+            /// snapshot is stored as <dir>/<key>.pb, where the key hashes the model file, its
+            /// frontend options and the values of all flags. When the tool restores a snapshot,
+            /// the engine skips the passes before this one and this pass only rebuilds the
+            /// tensor layouts; otherwise it writes the snapshot of the current graph.
+            class GraphSnapshotPass : public GraphPassBase
+            {
+            public:
+                bool run_on_graph(std::shared_ptr<nnfusion::graph::Graph>& graph) override;
+
+                // Returns the snapshot of the model if -fgraph_snapshot_dir is set and holds
+                // one, nullptr otherwise. The context is tagged for run_on_graph either way.
+                static std::shared_ptr<nnfusion::graph::Graph>
+                    load(const std::string& model_path,
+                         const std::string& model_options,
+                         std::shared_ptr<EngineContext> context);
+                static bool is_restored(std::shared_ptr<EngineContext> context);
+            };
+        }
+    }
+}
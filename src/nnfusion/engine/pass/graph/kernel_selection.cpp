@@ -2,13 +2,18 @@
 // Licensed under the MIT License.
 
 #include "kernel_selection.hpp"
+#include <algorithm>
 #include <queue>
+#include <thread>
 #include <utility>
 #include "nnfusion/core/kernels/cpu/cpu_kernel_emitter.hpp"
 #include "nnfusion/core/kernels/cuda_gpu/cuda_emitter.hpp"
 #include "nnfusion/core/kernels/cuda_gpu/cpu_op_emitter.hpp"
 #include "nnfusion/core/kernels/hlsl/hlsl_kernel_emitter.hpp"
+#include "nnfusion/core/operators/generic_op/generic_op.hpp"
 #include "nnfusion/core/operators/op_define/if_single.hpp"
+#include "nnfusion/engine/profiler/cpu_runtime.hpp"
+#include "nnfusion/engine/profiler/library_cache.hpp"
 
 using namespace nnfusion;
 using namespace nnfusion::pass::graph;
@@ -16,8 +21,34 @@ using namespace nnfusion::profiler;
 
 DEFINE_bool(fkernel_selection, false, "Select 'best' kernel based on the profiling information.");
 DEFINE_bool(fcustom_kernel, true, "Register custom kernels during kernel selection.");
+DEFINE_bool(fcpu_kernel_tuning,
+            false,
+            "Profile every CPU kernel candidate and record the fastest in the kernel cache DB.");
 DECLARE_bool(fantares_mode);
 DECLARE_string(fproduct_name);
+DECLARE_int32(fthread_num_per_node);
+
+namespace
+{
+    const std::string cpu_tuning_source = "CpuTuning";
+
+    size_t cpu_tuning_threads()
+    {
+        return FLAGS_fthread_num_per_node > 0 ? FLAGS_fthread_num_per_node
+                                              : std::thread::hardware_concurrency();
+    }
+
+    // A tuned entry only holds for the same machine, thread count and op attributes; generic
+    // ops keep attributes like trans_B or activation out of the identifier.
+    std::string cpu_tuning_key(const std::string& identifier, shared_ptr<GNode> gnode)
+    {
+        std::string attrs;
+        if (auto generic_op = dynamic_pointer_cast<nnfusion::op::GenericOp>(gnode->get_op_ptr()))
+            attrs = generic_op->localOpConfig.getRoot().dump();
+        return cpu_tuning_source + ":" + LibraryCache::get_cpu_model() + ":" +
+               std::to_string(cpu_tuning_threads()) + ":" + identifier + attrs;
+    }
+}
 
 pair<NNFusion_DeviceType, kernels::KernelEmitter::Pointer>
     ProfilingBasedKernelSelector::profiling_best(shared_ptr<GNode> gnode,
@@ -74,8 +105,101 @@ pair<NNFusion_DeviceType, kernels::KernelEmitter::Pointer>
     return std::make_pair(devtype, nullptr);
 }
 
+kernels::KernelEmitter::Pointer ProfilingBasedKernelSelector::cpu_tuning_best(
+    shared_ptr<cache::KernelCacheManager> cache_manager, shared_ptr<GNode> gnode)
+{
+    std::vector<shared_ptr<const KernelRegistration>> kernel_regs =
+        KernelRegistry::Global()->FindKernelRegistrations(
+            gnode->get_op_type(), GENERIC_CPU, element::f32);
+    if (kernel_regs.size() < 2 || gnode->is_constant())
+        return nullptr;
+
+    auto runtime = CPUDefaultRuntime::Runtime();
+    nlohmann::json candidates = nlohmann::json::array();
+    shared_ptr<const KernelRegistration> best_reg;
+    KernelEmitter::Pointer best_kernel;
+    double best_time = 0;
+    for (auto kernel_reg : kernel_regs)
+    {
+        // emitters allocate their temp tensors into the context, so each gets its own
+        auto kernel = kernel_reg->m_factory(make_shared<KernelContext>(gnode));
+        if (!kernel->get_or_emit_source())
+            continue;
+
+        auto pctx = make_shared<ProfilingContext>(kernel);
+        pctx->num_threads = cpu_tuning_threads();
+        Profiler prof(runtime, pctx);
+        if (!prof.execute() || pctx->result.get_device_durations().empty())
+        {
+            NNFUSION_LOG(INFO) << "Kernel Failed: " << gnode->get_name() << " ("
+                               << kernel_reg->m_tag << ")";
+            continue;
+        }
+
+        double time = pctx->result.get_device_avg();
+        candidates.push_back(
+            {{"tag", kernel_reg->m_tag}, {"priority", kernel_reg->m_priority}, {"time", time}});
+        if (best_kernel == nullptr || time < best_time)
+        {
+            best_reg = kernel_reg;
+            best_kernel = kernel;
+            best_time = time;
+        }
+    }
+    if (best_kernel == nullptr)
+        return nullptr;
+
+    NNFUSION_LOG(INFO) << "Tuned " << gnode->get_name() << ": " << best_reg->m_tag
+                       << " kernel, time cost(ms): " << best_time;
+
+    auto identifier = best_kernel->m_context->generate_identifier();
+    if (identifier != "" && cache_manager != nullptr)
+    {
+        auto kernel_entry = make_shared<cache::KernelEntry>();
+        kernel_entry->key = cpu_tuning_key(identifier, gnode);
+        kernel_entry->source = cpu_tuning_source;
+        kernel_entry->miscs["cpu_tuning"] = {{"cpu_model", LibraryCache::get_cpu_model()},
+                                             {"threads", cpu_tuning_threads()},
+                                             {"kernel_tag", best_reg->m_tag},
+                                             {"priority", best_reg->m_priority},
+                                             {"time", best_time},
+                                             {"candidates", candidates}};
+        kernel_entry = best_kernel->get_kernel_cache_entry(kernel_entry);
+        if (kernel_entry != nullptr)
+        {
+            // tags are stored comma separated
+            auto cpu_model = LibraryCache::get_cpu_model();
+            std::replace(cpu_model.begin(), cpu_model.end(), ',', ' ');
+            kernel_entry->tags.insert(cpu_tuning_source);
+            kernel_entry->tags.insert("cpu_model:" + cpu_model);
+            cache_manager->insert_kernel_entry(kernel_entry, true);
+        }
+    }
+    return best_kernel;
+}
+
 bool ProfilingBasedKernelSelector::run_on_graph(std::shared_ptr<nnfusion::graph::Graph>& graph)
 {
+    if (FLAGS_fcpu_kernel_tuning)
+    {
+        auto cache_manager = std::make_shared<cache::KernelCacheManager>();
+        if (!cache_manager->is_valid())
+        {
+            NNFUSION_LOG(INFO)
+                << "No valid kernel cache, tuned CPU kernels will not be inserted to kernel cache DB";
+            cache_manager = nullptr;
+        }
+        for (auto it : graph->get_nodes())
+        {
+            if ((*it)["Kernel_Selection_Result"].is_valid() || !(*it)["DeviceType"].is_valid() ||
+                (*it)["DeviceType"].as<NNFusion_DeviceType>() != GENERIC_CPU)
+                continue;
+            auto kernel = cpu_tuning_best(cache_manager, it);
+            if (kernel != nullptr)
+                (*it)["Kernel_Selection_Result"] = std::make_pair(GENERIC_CPU, kernel);
+        }
+    }
+
     bool enable_selection = FLAGS_fkernel_selection;
     if (!enable_selection)
         return true;
@@ -320,6 +444,9 @@ pair<NNFusion_DeviceType, kernels::KernelEmitter::Pointer>
     std::vector<nlohmann::json> functions;
 
     std::string identifier = ctx->generate_identifier();
+    if (devtype == GENERIC_CPU)
+        return std::make_pair(devtype, fetch_cpu_tuned(cache_manager, gnode));
+
     // Todo: platform interface to be coordinated with nnfusion devtype
     const std::vector<std::string> SUPPORT_PLATFORM = {"CUDA_GPU", "ROCM_GPU"};
 
@@ -399,6 +526,36 @@ pair<NNFusion_DeviceType, kernels::KernelEmitter::Pointer>
     return std::make_pair(devtype, nullptr);
 }
 
+kernels::KernelEmitter::Pointer
+    FetchBasedSelector::fetch_cpu_tuned(shared_ptr<cache::KernelCacheManager> cache_manager,
+                                        shared_ptr<GNode> gnode)
+{
+    shared_ptr<KernelContext> ctx(new KernelContext(gnode));
+    std::string identifier = ctx->generate_identifier();
+    if (identifier == "" || gnode->is_constant())
+        return nullptr;
+
+    // the entry names the registration that won, its code is emitted again from the emitter
+    auto key = cpu_tuning_key(identifier, gnode);
+    for (auto kernel_entry : cache_manager->fetch_all(identifier, get_device_str(GENERIC_CPU)))
+    {
+        if (kernel_entry->source != cpu_tuning_source || kernel_entry->key != key)
+            continue;
+        auto& tuned = kernel_entry->miscs["cpu_tuning"];
+        for (auto kernel_reg : KernelRegistry::Global()->FindKernelRegistrations(
+                 gnode->get_op_type(), GENERIC_CPU, element::f32))
+        {
+            if (kernel_reg->m_tag != tuned["kernel_tag"].get<std::string>() ||
+                kernel_reg->m_priority != tuned["priority"].get<size_t>())
+                continue;
+            auto kernel = kernel_reg->m_factory(ctx);
+            if (kernel->get_or_emit_source())
+                return kernel;
+        }
+    }
+    return nullptr;
+}
+
 bool FetchBasedSelector::run_on_graph(std::shared_ptr<nnfusion::graph::Graph>& graph)
 {
     auto cache_manager = std::make_shared<cache::KernelCacheManager>();
@@ -24,6 +24,12 @@ namespace nnfusion
                     profiling_best(shared_ptr<GNode> gnode,
                                    NNFusion_DeviceType devtype,
                                    nnfusion::profiler::IProfilingRuntime::Pointer runtime);
+
+                // Profiles every CPU candidate of the node with CPUDefaultRuntime and records the
+                // fastest one in the kernel cache DB for this CPU model and thread count.
+                nnfusion::kernels::KernelEmitter::Pointer
+                    cpu_tuning_best(shared_ptr<cache::KernelCacheManager> cache_manager,
+                                    shared_ptr<GNode> gnode);
             };
 
             class DefaultKernelSelector : public GraphPassBase
@@ -43,6 +49,9 @@ namespace nnfusion
                     fetch_inventory(shared_ptr<cache::KernelCacheManager> cache_manager,
                                     shared_ptr<GNode> gnode,
                                     NNFusion_DeviceType devtype);
+                nnfusion::kernels::KernelEmitter::Pointer
+                    fetch_cpu_tuned(shared_ptr<cache::KernelCacheManager> cache_manager,
+                                    shared_ptr<GNode> gnode);
             };
 
             class CPUOpSelector: public DefaultKernelSelector
@@ -2,10 +2,20 @@
 // Licensed under the MIT License.
 
 #include "runtime_const_folding_pass.hpp"
+#include "const_evaluator.hpp"
+
+#include <algorithm>
+#include <unordered_map>
 
 DEFINE_string(fconst_folding_backend,
               "",
-              "Choose which backend will be used in Constant folding pass. Disable when not set.");
+              "Choose which backend will be used in Constant folding pass. Only the native "
+              "folding runs when not set.");
+DEFINE_bool(fconst_folding_native,
+            false,
+            "Evaluate the common ops of constant subgraphs in-process, before using the backend "
+            "if one is set. Ops whose output is larger than their inputs are only folded into "
+            "the ops they feed.");
 
 using namespace nnfusion::pass::graph;
 
@@ -215,6 +225,111 @@ int RuntimeConstantFoldingPass::runtime_const_folding_iterate_once(
     return folding_cnt;
 }
 
+int RuntimeConstantFoldingPass::native_const_folding(
+    std::shared_ptr<Graph>& graph, std::set<std::shared_ptr<GNode>>& blocklist_nodes)
+{
+    std::unordered_map<std::shared_ptr<GNode>, std::vector<char>> values;
+    GNodeVector folded_nodes;
+    std::set<std::shared_ptr<GNode>> upstream_nodes;
+
+    for (auto& it : graph->get_ordered_ops())
+    {
+        if (it->is_constant() || blocklist_nodes.count(it) || it->get_in_edges().empty())
+            continue;
+
+        std::vector<const void*> inputs(it->get_input_size(), nullptr);
+        bool inferable = true;
+        for (auto& in_edge : it->get_in_edges())
+        {
+            auto src = in_edge->get_src();
+            auto value = values.find(src);
+            if (value == values.end() && !src->is_constant())
+            {
+                inferable = false;
+                break;
+            }
+            if (in_edge->is_control_edge())
+                continue;
+            if (value != values.end())
+                inputs[in_edge->get_dst_input()] = value->second.data();
+            else
+                inputs[in_edge->get_dst_input()] =
+                    std::static_pointer_cast<op::Constant>(src->get_op_ptr())->get_data_ptr();
+        }
+        if (!inferable)
+            continue;
+
+        std::vector<char> output;
+        if (!ConstEvaluator::evaluate(it, inputs, output))
+            continue;
+        values[it] = std::move(output);
+        folded_nodes.push_back(it);
+        for (auto& in_edge : it->get_in_edges())
+            if (in_edge->get_src()->is_constant())
+                upstream_nodes.insert(in_edge->get_src());
+    }
+
+    // Broadcast, Tile and the like would bloat the constants of the model, they stay in the
+    // graph unless their consumers are folded too, consumers are visited first
+    for (auto it = folded_nodes.rbegin(); it != folded_nodes.rend(); ++it)
+    {
+        auto node = *it;
+        size_t input_bytes = 0;
+        for (size_t i = 0; i < node->get_input_size(); i++)
+            input_bytes +=
+                shape_size(node->get_input_shape(i)) * node->get_input_element_type(i).size();
+        if (values[node].size() <= input_bytes)
+            continue;
+        bool boundary = node->get_out_edges().empty();
+        for (auto& out_edge : node->get_out_edges())
+            boundary |= values.find(out_edge->get_dst()) == values.end();
+        if (boundary)
+            values.erase(node);
+    }
+    folded_nodes.erase(std::remove_if(folded_nodes.begin(),
+                                      folded_nodes.end(),
+                                      [&](const std::shared_ptr<GNode>& node) {
+                                          return values.find(node) == values.end();
+                                      }),
+                       folded_nodes.end());
+
+    // Only the folded nodes consumed outside of the subgraph become constants
+    std::set<std::shared_ptr<GNode>> replaced_nodes;
+    for (auto& it : folded_nodes)
+    {
+        bool boundary = it->get_out_edges().empty();
+        for (auto& out_edge : it->get_out_edges())
+            boundary |= values.find(out_edge->get_dst()) == values.end();
+        if (!boundary)
+            continue;
+
+        auto new_constant_op = std::make_shared<op::Constant>(
+            it->get_output_element_type(0), it->get_output_shape(0), values[it].data());
+        auto new_constant_gnode =
+            std::make_shared<nnfusion::graph::GNode>(new_constant_op, GNodeVector());
+        graph->replace_node(it, new_constant_gnode, false);
+        replaced_nodes.insert(it);
+    }
+
+    // The rest of the subgraph is dead now, consumers are removed before their producers
+    for (auto it = folded_nodes.rbegin(); it != folded_nodes.rend(); ++it)
+    {
+        if (replaced_nodes.count(*it))
+            continue;
+        NNFUSION_CHECK((*it)->get_out_edges().empty());
+        graph->remove_node(*it);
+    }
+    for (auto& node : upstream_nodes)
+    {
+        if (node->get_out_edges().empty() && !blocklist_nodes.count(node))
+            graph->remove_node(node);
+    }
+
+    NNFUSION_LOG(INFO) << ">> Native constant folding folds " << folded_nodes.size()
+                       << " nodes into " << replaced_nodes.size() << " constants";
+    return folded_nodes.size();
+}
+
 bool RuntimeConstantFoldingPass::run_on_graph(std::shared_ptr<Graph>& graph)
 {
     int at = FLAGS_fconst_folding_backend.find(":DEBUG");
@@ -229,8 +344,21 @@ bool RuntimeConstantFoldingPass::run_on_graph(std::shared_ptr<Graph>& graph)
         this->fast_debug = false;
     }
 
+    // Folding output nodes results in kernel_emitter crashes
+    std::set<std::shared_ptr<GNode>> blocklist_nodes = {};
+    for (auto& node : graph->get_outputs())
+        blocklist_nodes.insert(node);
+
     if (this->backend == "")
+    {
+        // without a backend, only the ops evaluated in-process are folded
+        if (FLAGS_fconst_folding_native)
+        {
+            while (native_const_folding(graph, blocklist_nodes) > 0)
+                ;
+        }
         return true;
+    }
 
     static bool has_warning = false;
     if (!has_warning)
@@ -241,15 +369,14 @@ bool RuntimeConstantFoldingPass::run_on_graph(std::shared_ptr<Graph>& graph)
     NNFUSION_LOG(INFO) << "Runtime Constant Folding Pass starts up for Graph: "
                        << graph->get_name();
 
-    // Folding output nodes results in kernel_emitter crashes
-    std::set<std::shared_ptr<GNode>> blocklist_nodes = {};
-    for (auto& node : graph->get_outputs())
-        blocklist_nodes.insert(node);
-
     int folding_cnt;
     do
     {
-        folding_cnt = runtime_const_folding_iterate_once(graph, blocklist_nodes);
+        folding_cnt = 0;
+        // what the backend folds may unlock more native folding downstream
+        if (FLAGS_fconst_folding_native)
+            folding_cnt += native_const_folding(graph, blocklist_nodes);
+        folding_cnt += runtime_const_folding_iterate_once(graph, blocklist_nodes);
         NNFUSION_LOG(INFO) << ">> Runtime One Iteration Folds Infer-able Node Count: "
                            << folding_cnt;
     } while (folding_cnt > 0);
@@ -20,6 +20,10 @@ namespace nnfusion
                 int runtime_const_folding_iterate_once(
                     std::shared_ptr<Graph>& graph,
                     std::set<std::shared_ptr<GNode>>& blocklist_nodes);
+                // folds the maximal constant subgraph in one topological sweep with the
+                // in-process ConstEvaluator, nodes it cannot evaluate are left to the backend
+                int native_const_folding(std::shared_ptr<Graph>& graph,
+                                         std::set<std::shared_ptr<GNode>>& blocklist_nodes);
 
             public:
                 bool run_on_graph(std::shared_ptr<Graph>& graph) override;
@@ -1,13 +1,18 @@
 #include "matmuladd_fusion_optimizer.hpp"
+#include "nnfusion/core/operators/op_define/broadcast.hpp"
 #include "nnfusion/frontend/util/evaluator.hpp"
 
+DECLARE_string(fdefault_device);
+
 using namespace nnfusion;
 using namespace nnfusion::graph;
 using namespace nnfusion::pass::graph;
 
 bool MatMulAddFusionOptimizer::create_subgraphs()
 {
-    auto check_root = [](std::shared_ptr<GNode> gnode) -> bool {
+    // the CPU kernel takes an activation and a row bias in its epilogue, for f32 only
+    bool is_cpu = nnfusion::get_device_type(FLAGS_fdefault_device) == GENERIC_CPU;
+    auto check_root = [is_cpu](std::shared_ptr<GNode> gnode) -> bool {
         if (gnode->get_op_type() != "Dot")
             return false;
         auto A_shape = gnode->get_input_shape(0);
@@ -16,9 +21,35 @@ bool MatMulAddFusionOptimizer::create_subgraphs()
             return false;
         if (gnode->get_out_edges().size() != 1)
             return false;
+        if (is_cpu && gnode->get_output_element_type(0) != element::f32)
+            return false;
         return true;
     };
 
+    if (is_cpu)
+    {
+        for (auto activation : {"Relu", "Gelu"})
+        {
+            Pattern::Pointer p_matmuladd_act = std::make_shared<Pattern>();
+            std::vector<std::string> ops{"Dot", "Add", activation};
+            p_matmuladd_act->descriptions.push_back(std::make_pair(ops, 1));
+            p_matmuladd_act->reverse_order = false;
+            auto check_matmuladd_act = [](const PatternRecord& pr) -> bool {
+                auto matmul = pr.nodes[0];
+                auto add = pr.nodes[1];
+                return (matmul->get_output_element_type(0) == add->get_output_element_type(0)) &&
+                       add->get_out_edges().size() == 1;
+            };
+            p_matmuladd_act->check.push_back(check_matmuladd_act);
+
+            SubGraph::Pointer s_matmuladd_act = std::make_shared<SubGraph>();
+            s_matmuladd_act->name = "matmuladd_" + std::string(activation);
+            s_matmuladd_act->check_starting_node = check_root;
+            s_matmuladd_act->patterns.push_back(p_matmuladd_act);
+            m_subgraphs.push_back(s_matmuladd_act);
+        }
+    }
+
     SubGraph::Pointer s_matmuladd = std::make_shared<SubGraph>();
     s_matmuladd->name = "matmuladd";
     s_matmuladd->check_starting_node = check_root;
@@ -47,20 +78,38 @@ bool MatMulAddFusionOptimizer::fuse_subgraph(SubGraphRecord::Pointer subgraph_re
     auto pr_matmuladd = subgraph_record->pattern_records[0];
     auto matmul = pr_matmuladd->nodes[0];
     auto add = pr_matmuladd->nodes[1];
+    std::shared_ptr<GNode> activation;
+    if (pr_matmuladd->nodes.size() > 2)
+        activation = pr_matmuladd->nodes[2];
     auto matmul_a = matmul->get_in_edge(0)->get_src();
     auto matmul_b = matmul->get_in_edge(1)->get_src();
 
     std::shared_ptr<GNode> nodeC;
+    int nodeC_output = 0;
     for (auto in_edge : add->get_in_edges())
     {
         auto src = in_edge->get_src();
         if (src != matmul)
         {
             nodeC = src;
+            nodeC_output = in_edge->get_src_output();
             break;
         }
     }
 
+    // the CPU kernel reads a bias broadcast along the rows without the broadcast
+    std::shared_ptr<GNode> bias_broadcast;
+    if (nnfusion::get_device_type(FLAGS_fdefault_device) == GENERIC_CPU &&
+        nodeC->get_op_type() == "Broadcast" && nodeC->get_out_edges().size() == 1 &&
+        nodeC->get_input_shape(0) == nnfusion::Shape{add->get_output_shape(0)[1]} &&
+        std::static_pointer_cast<op::Broadcast>(nodeC->get_op_ptr())->get_broadcast_axes() ==
+            nnfusion::AxisSet{0})
+    {
+        bias_broadcast = nodeC;
+        nodeC = bias_broadcast->get_in_edge(0)->get_src();
+        nodeC_output = bias_broadcast->get_in_edge(0)->get_src_output();
+    }
+
     // create matmuladd node
     auto matmul_op = std::dynamic_pointer_cast<op::Dot>(matmul->get_op_ptr());
     NNFUSION_CHECK_NOT_NULLPTR(matmul_op);
@@ -69,13 +118,16 @@ bool MatMulAddFusionOptimizer::fuse_subgraph(SubGraphRecord::Pointer subgraph_re
     nnfusion::op::OpConfig::any myConfig;
     myConfig["trans_A"] = trans_A;
     myConfig["trans_B"] = trans_B;
+    if (activation)
+        myConfig["activation"] = activation->get_op_type() == "Relu" ? "relu" : "gelu";
 
     auto matmuladd_op = std::make_shared<nnfusion::op::GenericOp>(
         matmul->get_name() + "add", "MatMulAdd", myConfig);
     auto matmuladd_gnode = graph->add_node_and_edge(
-        matmuladd_op, {GNodeIndex{matmul_a, 0}, GNodeIndex{matmul_b, 0}, GNodeIndex{nodeC, 0}});
+        matmuladd_op,
+        {GNodeIndex{matmul_a, 0}, GNodeIndex{matmul_b, 0}, GNodeIndex{nodeC, nodeC_output}});
 
-    std::shared_ptr<GNode> last_node = add;
+    std::shared_ptr<GNode> last_node = activation ? activation : add;
 
     auto out_edges = last_node->get_out_edges();
     for (auto out_edge : out_edges)
@@ -88,6 +140,8 @@ bool MatMulAddFusionOptimizer::fuse_subgraph(SubGraphRecord::Pointer subgraph_re
 
     std::unordered_set<std::shared_ptr<GNode>> nodes_to_remove;
     nodes_to_remove.insert(pr_matmuladd->nodes.begin(), pr_matmuladd->nodes.end());
+    if (bias_broadcast)
+        nodes_to_remove.insert(bias_broadcast);
 
     return RemoveNodes(nodes_to_remove, matmuladd_gnode);
 }
\ No newline at end of file
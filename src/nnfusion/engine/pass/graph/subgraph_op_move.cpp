@@ -110,8 +110,9 @@ void SubGraphOpMovePass::move_out(GNodeVector to_move, std::shared_ptr<GNode> if
 
                     new_params[in_unique_name] = param_gnode;
                 }
-                gnode->remove_in_edge(in_edge);
-                sub_graph->add_edge(new_params[in_unique_name], 0, gnode, in_edge->get_dst_input());
+                int dst_input = in_edge->get_dst_input();
+                sub_graph->remove_edge(in_edge);
+                sub_graph->add_edge(new_params[in_unique_name], 0, gnode, dst_input);
             }
         }
     }
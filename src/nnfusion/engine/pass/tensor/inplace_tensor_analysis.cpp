@@ -99,7 +99,8 @@ bool InplaceTensorAnalysis::run(std::shared_ptr<InterpreterContext> ctx,
                             auto input = kernel->m_context->inputs[oi_pair.input];
                             auto input_gnode = gnode->get_in_edge(oi_pair.input)->get_src();
 
-                            if (input_gnode->is_parameter())
+                            // tensors in the read-only constant blob can not be moved
+                            if (input_gnode->is_parameter() || input->get_group() == "constant")
                             {
                                 can_do_inplace_concat = false;
                                 break;
@@ -264,6 +265,15 @@ bool InplaceTensorAnalysis::run(std::shared_ptr<InterpreterContext> ctx,
                                 continue;
                             }
 
+                            // never write into the read-only constant blob
+                            auto root_input = inplace_inputs.count(input) > 0
+                                                  ? inplace_inputs[input].tensor
+                                                  : input;
+                            if (oi_pair.destructive && root_input->get_group() == "constant")
+                            {
+                                continue;
+                            }
+
                             // If the inplace is destructive, the output should not overwrite the constant tensor,
                             // parameter tensor and persistent tensor, and the input must be in free_list of this node.
                             // Otherwise, it is safe to do inplace reuse.
@@ -18,12 +18,68 @@ using namespace nnfusion::kernels;
 using namespace nnfusion::async;
 
 DEFINE_bool(frt_const_folding, false, "Add runtime constant folding.");
+DEFINE_bool(fcpu_constant_mmap,
+            false,
+            "Pack CPU constants into one blob which is mmap-ed read-only at init.");
+DEFINE_bool(fnuma_local_memory,
+            false,
+            "Place CPU memory pools and constants on the NUMA node of the kernels using them.");
+DECLARE_int32(fnuma_node_num);
+DECLARE_bool(fcpu_context_api);
+
+namespace
+{
+    // the NUMA node shared by all consumers of gnode, or -1 if they run on different nodes.
+    int get_consumer_numa_node(std::shared_ptr<nnfusion::graph::GNode> gnode, int numa_node_num)
+    {
+        int numa_node = -1;
+        for (auto& edge : gnode->get_out_edges())
+        {
+            if (edge->is_control_edge())
+                continue;
+            auto dst = edge->get_dst();
+            if (!(*dst)["Async_info"].is_valid())
+                return -1;
+            auto thread = (*dst)["Async_info"].as<AsyncExecutionInfo>().execution_thread;
+            if (!thread)
+                return -1;
+            int node = thread->get_stream_id() % numa_node_num;
+            if (numa_node >= 0 && node != numa_node)
+                return -1;
+            numa_node = node;
+        }
+        return numa_node;
+    }
+
+    // groups which place persistent tensors into a dedicated pool, kept by set_tensor_group
+    bool is_placed_group(const std::string& group)
+    {
+        const std::string numa = "persist_numa";
+        return group == "persist_context" || group == "constant" ||
+               group.compare(0, numa.size(), numa) == 0;
+    }
+}
 
 bool TensorLivenessAnalysis::run(std::shared_ptr<InterpreterContext> ctx,
                                  std::shared_ptr<TranslationUnit> tu)
 {
     bool enable_rt_const_folding = FLAGS_frt_const_folding;
+    bool enable_constant_mmap = FLAGS_fcpu_constant_mmap;
+    NNFUSION_CHECK(!(enable_rt_const_folding && enable_constant_mmap))
+        << "-fcpu_constant_mmap can not be used with -frt_const_folding.";
     std::unordered_set<shared_ptr<descriptor::Tensor>> persist_candidate;
+    // with the context API, results are written into a pool of each context, while the
+    // tensors filled by cpu_init stay in the shared persistent pool
+    bool context_api = FLAGS_fcpu_context_api;
+    std::unordered_set<shared_ptr<descriptor::Tensor>> init_tensors;
+    // pools are bound to NUMA nodes only when the streams are spread over several nodes
+    int numa_node_num = 1;
+    auto host_async_manager = AsyncManagerFactory::get_host_async_manager(tu->m_graph, GENERIC_CPU);
+    if (FLAGS_fnuma_local_memory && host_async_manager &&
+        host_async_manager->num_non_default_stream() > 0)
+    {
+        numa_node_num = std::max(FLAGS_fnuma_node_num, 1);
+    }
 
     auto& p = tu->program;
     for (auto block_iter : p)
@@ -64,23 +120,20 @@ bool TensorLivenessAnalysis::run(std::shared_ptr<InterpreterContext> ctx,
                     auto tensor = outputs[i];
                     tensor->set_persistent();
                     set_tensor_group(tensor, to_string(stream_id));
+                    init_tensors.insert(tensor);
                 }
             }
             else if (gnode && gnode->get_op_ptr()->is_output())
             {
-                auto& outputs = ins->get_outputs();
-                for (size_t i = 0; i < outputs.size(); i++)
+                std::vector<shared_ptr<descriptor::Tensor>> tensors(ins->get_outputs().begin(),
+                                                                    ins->get_outputs().end());
+                tensors.insert(tensors.end(), ins->get_inputs().begin(), ins->get_inputs().end());
+                for (auto tensor : tensors)
                 {
-                    auto tensor = outputs[i];
-                    tensor->set_persistent();
-                    set_tensor_group(tensor, to_string(stream_id));
-                }
-                auto& inputs = ins->get_inputs();
-                for (size_t i = 0; i < inputs.size(); i++)
-                {
-                    auto tensor = inputs[i];
                     tensor->set_persistent();
                     set_tensor_group(tensor, to_string(stream_id));
+                    if (context_api && !tensor->is_parameter() && init_tensors.count(tensor) == 0)
+                        tensor->set_group("persist_context");
                 }
             }
             else if (gnode && gnode->is_constant())
@@ -98,6 +151,20 @@ bool TensorLivenessAnalysis::run(std::shared_ptr<InterpreterContext> ctx,
                         tensor->set_persistent();
                     }
                     set_tensor_group(tensor, to_string(stream_id));
+                    init_tensors.insert(tensor);
+                    // read-only constants are placed into the mmap-ed blob
+                    if (enable_constant_mmap && tensor->get_device_type() == GENERIC_CPU)
+                    {
+                        tensor->set_group("constant");
+                    }
+                    // or into the persistent pool of the NUMA node of their consumers
+                    else if (numa_node_num > 1 && tensor->get_group() == "persist" &&
+                             tensor->get_device_type() == GENERIC_CPU)
+                    {
+                        int numa_node = get_consumer_numa_node(gnode, numa_node_num);
+                        if (numa_node >= 0)
+                            tensor->set_group("persist_numa" + to_string(numa_node));
+                    }
                 }
             }
             else
@@ -241,7 +308,7 @@ bool TensorLivenessAnalysis::run(std::shared_ptr<InterpreterContext> ctx,
 void TensorLivenessAnalysis::set_tensor_group(shared_ptr<descriptor::Tensor> tensor,
                                               const std::string& group)
 {
-    if (tensor->is_persistent())
+    if (tensor->is_persistent() && !is_placed_group(tensor->get_group()))
     {
         tensor->set_group("persist");
     }
@@ -9,21 +9,29 @@
 #include <utility>
 
 #include "nnfusion/common/util.hpp"
+#include "nnfusion/engine/async_manager.hpp"
 #include "nnfusion/engine/memory_allocator.hpp"
 #include "nnfusion/engine/profiler/profiler.hpp"
 
 #include "nnfusion/core/operators/op_define/concat.hpp"
+#include "nnfusion/core/operators/op_define/constant.hpp"
 
 using namespace std;
 using namespace nnfusion;
 using namespace nnfusion::pass;
 using namespace nnfusion::kernels;
+using namespace nnfusion::async;
 
 DEFINE_bool(fmem_trace, false, "Record and dump memory trace.");
 DEFINE_string(fmem_log_path, "memory.log", "The file path of memory log.");
+DEFINE_string(fmem_alloc_scheme,
+              "first_fit",
+              "Memory allocation scheme: first_fit, best_fit, no_reuse or greedy_by_size.");
 DECLARE_string(fhlsl_codegen_type);
 DECLARE_bool(fextern_result_memory);
 DECLARE_bool(fhost_entry);
+DECLARE_bool(fnuma_local_memory);
+DECLARE_int32(fnuma_node_num);
 DEFINE_bool(fenable_extern_result_inline, true, "Enable the elimination of d2d copy from extern_result_memory.");
 
 bool AssignTensorMemoryLayout::run(std::shared_ptr<InterpreterContext> ctx,
@@ -39,6 +47,12 @@ bool AssignTensorMemoryLayout::run(std::shared_ptr<InterpreterContext> ctx,
     tu->memory_allocator_factory =
         std::make_shared<MemoryAllocatorFactory>(m_alignment, m_disable_memory_sharing);
     auto maf = tu->memory_allocator_factory;
+    auto host_async_manager = AsyncManagerFactory::get_host_async_manager(tu->m_graph, GENERIC_CPU);
+    if (FLAGS_fnuma_local_memory && host_async_manager &&
+        host_async_manager->num_non_default_stream() > 0)
+    {
+        maf->set_numa_node_num(FLAGS_fnuma_node_num);
+    }
     // std::unordered_set<shared_ptr<descriptor::Tensor>> persistent_tensors;
     auto& p = tu->program;
 
@@ -175,6 +189,41 @@ bool AssignTensorMemoryLayout::run(std::shared_ptr<InterpreterContext> ctx,
         }
     }
 
+    // interval-based schemes assign the real offsets once all lifetimes are known
+    for (const auto& allocator : maf->get_allocator_list())
+    {
+        allocator.second->plan();
+        NNFUSION_LOG(INFO) << allocator.second->get_name() << " ("
+                           << MemoryAllocator::get_alloc_scheme_name(
+                                  allocator.second->get_alloc_scheme())
+                           << "): " << allocator.second->max_allocated() << " bytes";
+    }
+
+    // pack the data of mmap-ed constants into their blob, now that offsets are final
+    std::unordered_set<HostConstantMemoryAllocator*> constant_allocators;
+    for (auto iterator : p)
+    {
+        for (auto ins : *iterator)
+        {
+            auto gnode = ins->getGNode();
+            if (!gnode || !gnode->is_constant() || ins->get_outputs()[0]->get_group() != "constant")
+                continue;
+            auto tensor = ins->get_outputs()[0];
+            auto allocator = dynamic_cast<HostConstantMemoryAllocator*>(maf->get_allocator(tensor));
+            if (allocator == nullptr)
+                continue;
+            auto op = std::dynamic_pointer_cast<nnfusion::op::Constant>(gnode->get_op_ptr());
+            NNFUSION_CHECK_NOT_NULLPTR(op);
+            NNFUSION_CHECK(op->get_data_size() == tensor->size());
+            allocator->bind_data(tensor, op->get_data_ptr());
+            constant_allocators.insert(allocator);
+        }
+    }
+    for (auto allocator : constant_allocators)
+    {
+        allocator->dump_blob();
+    }
+
     if (dump_trace)
     {
         // close memory log file.
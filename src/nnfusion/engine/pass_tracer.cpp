@@ -0,0 +1,220 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "pass_tracer.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <sys/resource.h>
+
+DEFINE_bool(fpass_trace, false, "Record time, memory and graph size of every compiler pass.");
+DEFINE_string(fpass_trace_path,
+              "nnfusion_pass_trace.json",
+              "The file path of the Chrome trace written by -fpass_trace.");
+
+using namespace nnfusion;
+
+namespace
+{
+    std::string escape_json(const std::string& s)
+    {
+        std::string escaped;
+        for (char c : s)
+        {
+            if (c == '"' || c == '\\')
+                escaped += '\\';
+            escaped += c;
+        }
+        return escaped;
+    }
+}
+
+PassTracer::Scope::Scope(PassTracer& tracer,
+                         const std::string& name,
+                         const std::string& category,
+                         graph::Graph::Pointer graph)
+    : m_tracer(tracer)
+    , m_graph(graph)
+    , m_id(tracer.begin(name, category, graph))
+{
+}
+
+PassTracer::Scope::~Scope()
+{
+    m_tracer.end(m_id, m_graph);
+}
+
+PassTracer::PassTracer(bool enabled, const std::string& trace_path)
+    : m_enabled(enabled)
+    , m_trace_path(trace_path)
+    , m_origin(std::chrono::steady_clock::now())
+{
+}
+
+PassTracer& PassTracer::get()
+{
+    static PassTracer tracer(FLAGS_fpass_trace, FLAGS_fpass_trace_path);
+    static bool registered = false;
+    if (tracer.is_enabled() && !registered)
+    {
+        // BaseCodegenPass exits the process, so flush the records on the way out.
+        std::atexit([]() { PassTracer::get().finish(); });
+        registered = true;
+    }
+    return tracer;
+}
+
+int PassTracer::begin(const std::string& name,
+                      const std::string& category,
+                      graph::Graph::Pointer graph)
+{
+    if (!m_enabled || m_finished)
+        return -1;
+    Record record;
+    record.name = name;
+    record.category = category;
+    record.depth = m_open.size();
+    if (graph)
+    {
+        record.nodes_before = graph->get_node_size();
+        record.edges_before = graph->get_edge_size();
+    }
+    record.start_us = now_us();
+    m_records.push_back(record);
+    m_rss_begin.push_back(peak_rss_kb());
+    m_open.push_back(m_records.size() - 1);
+    return m_records.size() - 1;
+}
+
+void PassTracer::end(int id, graph::Graph::Pointer graph)
+{
+    if (id < 0 || m_finished)
+        return;
+    NNFUSION_CHECK(size_t(id) < m_records.size());
+    auto& record = m_records[id];
+    record.duration_us = now_us() - record.start_us;
+    record.rss_peak_delta_kb = peak_rss_kb() - m_rss_begin[id];
+    if (graph)
+    {
+        record.nodes_after = graph->get_node_size();
+        record.edges_after = graph->get_edge_size();
+    }
+    record.finished = true;
+    m_open.erase(std::remove(m_open.begin(), m_open.end(), id), m_open.end());
+}
+
+void PassTracer::finish()
+{
+    if (!m_enabled || m_finished)
+        return;
+    // passes still open did not return, e.g. the codegen pass calling exit()
+    while (!m_open.empty())
+    {
+        int id = m_open.back();
+        auto& record = m_records[id];
+        record.duration_us = now_us() - record.start_us;
+        record.rss_peak_delta_kb = peak_rss_kb() - m_rss_begin[id];
+        record.nodes_after = record.nodes_before;
+        record.edges_after = record.edges_before;
+        m_open.pop_back();
+    }
+    m_finished = true;
+
+    if (!m_trace_path.empty() && dump_trace(m_trace_path))
+        NNFUSION_LOG(INFO) << "Pass trace written to " << m_trace_path;
+    std::stringstream summary;
+    dump_summary(summary);
+    NNFUSION_LOG(INFO) << "Pass summary:\n" << summary.str();
+}
+
+bool PassTracer::dump_trace(const std::string& path) const
+{
+    std::ofstream out(path);
+    if (!out.is_open())
+    {
+        NNFUSION_LOG(NNFUSION_WARNING) << "Failed to write pass trace to " << path;
+        return false;
+    }
+    out << "{\"traceEvents\": [\n";
+    for (size_t i = 0; i < m_records.size(); i++)
+    {
+        auto& r = m_records[i];
+        out << "{\"name\": \"" << escape_json(r.name) << "\", \"cat\": \"" << r.category
+            << "\", \"ph\": \"X\", \"pid\": 0, \"tid\": 0, \"ts\": " << r.start_us
+            << ", \"dur\": " << r.duration_us << ", \"args\": {\"rss_peak_delta_kb\": "
+            << r.rss_peak_delta_kb << ", \"nodes_before\": " << r.nodes_before
+            << ", \"nodes_after\": " << r.nodes_after << ", \"edges_before\": "
+            << r.edges_before << ", \"edges_after\": " << r.edges_after
+            << ", \"finished\": " << (r.finished ? "true" : "false") << "}}"
+            << (i + 1 < m_records.size() ? ",\n" : "\n");
+    }
+    out << "], \"displayTimeUnit\": \"ms\"}\n";
+    return out.good();
+}
+
+void PassTracer::dump_summary(std::ostream& out) const
+{
+    struct Summary
+    {
+        size_t calls = 0;
+        int64_t duration_us = 0;
+        int64_t rss_peak_delta_kb = 0;
+        int64_t node_delta = 0;
+        int64_t edge_delta = 0;
+    };
+    // nested records are already accounted in their parent
+    int64_t total_us = 0;
+    std::map<std::string, Summary> summaries;
+    for (auto& r : m_records)
+    {
+        auto& s = summaries[r.name];
+        s.calls++;
+        s.duration_us += r.duration_us;
+        s.rss_peak_delta_kb += r.rss_peak_delta_kb;
+        s.node_delta += (int64_t)r.nodes_after - (int64_t)r.nodes_before;
+        s.edge_delta += (int64_t)r.edges_after - (int64_t)r.edges_before;
+        if (r.depth == 0)
+            total_us += r.duration_us;
+    }
+    std::vector<std::pair<std::string, Summary>> sorted(summaries.begin(), summaries.end());
+    std::sort(sorted.begin(), sorted.end(), [](const std::pair<std::string, Summary>& a,
+                                               const std::pair<std::string, Summary>& b) {
+        return a.second.duration_us > b.second.duration_us;
+    });
+
+    out << std::left << std::setw(56) << "pass" << std::right << std::setw(7) << "calls"
+        << std::setw(12) << "time(ms)" << std::setw(8) << "%" << std::setw(14) << "peak_rss(KB)"
+        << std::setw(9) << "nodes" << std::setw(9) << "edges"
+        << "\n";
+    for (auto& item : sorted)
+    {
+        auto& s = item.second;
+        out << std::left << std::setw(56) << item.first << std::right << std::setw(7) << s.calls
+            << std::setw(12) << std::fixed << std::setprecision(2) << s.duration_us / 1000.0
+            << std::setw(8) << std::setprecision(1)
+            << (total_us > 0 ? 100.0 * s.duration_us / total_us : 0.0) << std::setw(14)
+            << s.rss_peak_delta_kb << std::setw(9) << std::showpos << s.node_delta
+            << std::setw(9) << s.edge_delta << std::noshowpos << "\n";
+    }
+    out << std::left << std::setw(56) << "total" << std::right << std::setw(7) << m_records.size()
+        << std::setw(12) << std::fixed << std::setprecision(2) << total_us / 1000.0 << "\n";
+}
+
+int64_t PassTracer::now_us() const
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - m_origin)
+        .count();
+}
+
+int64_t PassTracer::peak_rss_kb()
+{
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+    return usage.ru_maxrss;
+}
@@ -0,0 +1,99 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <chrono>
+#include <cxxabi.h>
+#include <ostream>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+#include "nnfusion/common/common.hpp"
+#include "nnfusion/core/graph/graph.hpp"
+
+DECLARE_bool(fpass_trace);
+DECLARE_string(fpass_trace_path);
+
+namespace nnfusion
+{
+    ///\brief Records the wall time, peak RSS growth and graph size of every pass the
+    /// engine runs. The records are written as a Chrome trace (chrome://tracing) and
+    /// summarized in the log when finish() is called, which happens at process exit
+    /// for the global tracer since the codegen pass never returns.
+    class PassTracer
+    {
+    public:
+        struct Record
+        {
+            std::string name;
+            std::string category;
+            // microseconds since the tracer was created
+            int64_t start_us = 0;
+            int64_t duration_us = 0;
+            // growth of the peak resident set size during the pass, in KB
+            int64_t rss_peak_delta_kb = 0;
+            size_t nodes_before = 0;
+            size_t nodes_after = 0;
+            size_t edges_before = 0;
+            size_t edges_after = 0;
+            size_t depth = 0;
+            bool finished = false;
+        };
+
+        class Scope
+        {
+        public:
+            Scope(PassTracer& tracer,
+                  const std::string& name,
+                  const std::string& category,
+                  graph::Graph::Pointer graph);
+            ~Scope();
+
+        private:
+            PassTracer& m_tracer;
+            graph::Graph::Pointer m_graph;
+            int m_id;
+        };
+
+        PassTracer(bool enabled = false, const std::string& trace_path = "");
+        // the tracer configured by -fpass_trace and -fpass_trace_path
+        static PassTracer& get();
+
+        bool is_enabled() const { return m_enabled; }
+        // returns the record id passed to end(), -1 when disabled
+        int begin(const std::string& name,
+                  const std::string& category,
+                  graph::Graph::Pointer graph);
+        void end(int id, graph::Graph::Pointer graph);
+        // close the unfinished records, write the trace and log the summary, once.
+        void finish();
+
+        bool dump_trace(const std::string& path) const;
+        void dump_summary(std::ostream& out) const;
+        const std::vector<Record>& get_records() const { return m_records; }
+        template <typename T>
+        static std::string get_pass_name(const T& pass)
+        {
+            int status;
+            char* demangled = abi::__cxa_demangle(typeid(pass).name(), 0, 0, &status);
+            std::string name = status == 0 ? demangled : typeid(pass).name();
+            free(demangled);
+            return name;
+        }
+
+    private:
+        int64_t now_us() const;
+        static int64_t peak_rss_kb();
+
+        bool m_enabled;
+        bool m_finished = false;
+        std::string m_trace_path;
+        std::chrono::steady_clock::time_point m_origin;
+        std::vector<Record> m_records;
+        // peak rss at the beginning of each open record
+        std::vector<int64_t> m_rss_begin;
+        std::vector<int> m_open;
+    };
+}
@@ -9,10 +9,15 @@
 #include <cstdio>
 #include <libgen.h>
 #include <limits.h>
+#include <thread>
 
 #include "cpu_runtime.hpp"
+#include "library_cache.hpp"
+#include "nnfusion/core/kernels/cpu/cpu_kernel_emitter.hpp"
 #include "nnfusion/core/kernels/cpu/cpu_langunit.hpp"
+#include "nnfusion/core/kernels/cpu/reduced_precision.hpp"
 #include "nnfusion/core/kernels/cpu/reference/reference_common.hpp"
+#include "nnfusion/core/kernels/cpu/simd_dispatch.hpp"
 
 using namespace nnfusion::profiler;
 using namespace nnfusion::kernels;
@@ -198,19 +203,27 @@ bool ReferenceRuntime::compile(const ProfilingContext::Pointer& ke)
 {
     if (ke->entry_point != nullptr)
         return true;
-    string filename = string(tmpnam(nullptr));
-    string objname = filename + DLIB_SUFFIX;
-    string srcname = filename + ".cpp";
-    // ofstream source_file(ke->working_dir + "/" + ke->source_code->symbol);
-    ofstream source_file(srcname);
-    source_file << ke->source_code->get_code();
-    source_file.close();
-
-    int ret = system(("gcc\t-fPIC\t-shared\t-std=c++11\t" + srcname + "\t-o\t" + objname).c_str());
-    if (ret != 0)
-        return false;
-    if (!file_exsits(objname))
-        return false;
+    string compiler = "gcc\t-fPIC\t-shared\t-std=c++11\t";
+    auto& cache = LibraryCache::get();
+    string key = cache.get_key(ke->source_code->get_code(), compiler);
+    string objname = cache.lookup(key);
+    if (objname.empty())
+    {
+        string filename = string(tmpnam(nullptr));
+        objname = filename + DLIB_SUFFIX;
+        string srcname = filename + ".cpp";
+        // ofstream source_file(ke->working_dir + "/" + ke->source_code->symbol);
+        ofstream source_file(srcname);
+        source_file << ke->source_code->get_code();
+        source_file.close();
+
+        int ret = system((compiler + srcname + "\t-o\t" + objname).c_str());
+        if (ret != 0)
+            return false;
+        if (!file_exsits(objname))
+            return false;
+        objname = cache.insert(key, objname);
+    }
     auto obj = get_library_handle(objname);
     auto entry = get_funcion_pointer(
         ke->kernel->get_or_emit_source()->name_unit->get_code() + "_entry", obj);
@@ -303,6 +316,11 @@ bool CPUDefaultRuntime::codegen(const ProfilingContext::Pointer& ke)
                 writer << "using namespace reference_common;\n";
                 writer << "// Unfolded reference_common.h ends\n";
             }
+            // the header is written by the codegen, not next to the profiled kernel
+            else if (it.second->symbol == "header::reduced_precision")
+                writer << reduced_precision_header->get_code();
+            else if (it.second->symbol == "header::simd_dispatch")
+                writer << simd_dispatch_header->get_code();
             else
                 writer << it.second->get_code();
         }
@@ -456,7 +474,11 @@ bool CPUDefaultRuntime::codegen(const ProfilingContext::Pointer& ke)
         if (ke->kernel->is_parallelism())
         {
             writer << declaration::worker_thread_pool->get_code() << "\n";
-            writer << "worker_thread_pool = new concurrency::NumaAwareThreadPool(1, 1);\n";
+            // resolved here, so that the cached libraries of different thread counts differ
+            size_t num_threads =
+                ke->num_threads > 0 ? ke->num_threads : std::thread::hardware_concurrency();
+            writer << "worker_thread_pool = new concurrency::NumaAwareThreadPool(1, "
+                   << num_threads << ");\n";
         }
 
         for (size_t i = 0; i < temp.size(); i++)
@@ -474,6 +496,14 @@ bool CPUDefaultRuntime::codegen(const ProfilingContext::Pointer& ke)
             }
         }
 
+        // e.g. the packed weights of mlas gemms are filled once before timing
+        auto cpu_kernel = dynamic_pointer_cast<cpu::CpuKernelEmitter>(ke->kernel);
+        if (cpu_kernel)
+        {
+            if (auto init = cpu_kernel->emit_init_code())
+                writer << init->get_code();
+        }
+
         writer << "std::chrono::high_resolution_clock::time_point t1,t2;\n";
         writer << "for(int i=0; i < " << ke->warmup_times + ke->runtime_times << "; i++)\n";
         writer.block_begin();
@@ -818,30 +848,41 @@ bool CPUDefaultRuntime::compile(const ProfilingContext::Pointer& ke)
 {
     if (ke->entry_point != nullptr)
         return true;
+    // the CMakeLists carries the compiler flags and the linked libraries
+    auto& cache = LibraryCache::get();
+    string key = cache.get_key(ke->source_code->get_code(), ke->cmake_code->get_code());
+    string objname = cache.lookup(key);
+    if (!objname.empty())
+        NNFUSION_LOG(DEBUG) << "Load cached cpu kernel library " << objname;
+
     // setpwd
     std::string working_dir = "./cpu_profiler/";
     nnfusion::codegen::create_folder(working_dir);
     int status = chdir(working_dir.c_str());
     NNFUSION_CHECK(status == 0);
 
-    // src file
-    string filename = ke->source_code->get_symbol();
-    if (filename.length() > 128)
+    if (objname.empty())
     {
-        size_t hashcode = std::hash<std::string>{}(filename);
-        filename = "compressed_src_" + std::to_string(hashcode);
-    }
+        // src file
+        string filename = ke->source_code->get_symbol();
+        if (filename.length() > 128)
+        {
+            size_t hashcode = std::hash<std::string>{}(filename);
+            filename = "compressed_src_" + std::to_string(hashcode);
+        }
 
-    string objname = std::string("lib") + filename + DLIB_SUFFIX;
-    string srcname = filename + ".cpp";
+        objname = std::string("lib") + filename + DLIB_SUFFIX;
+        string srcname = filename + ".cpp";
 
-    std::string cmd = std::string("cmake . -DSOURCE_FILE=") + srcname +
-                      std::string(" -DTARGET_NAME=") + filename + string("&& make -j");
-    int ret = system((cmd.c_str()));
-    if (ret != 0)
-        return false;
-    if (!file_exsits(objname))
-        return false;
+        std::string cmd = std::string("cmake . -DSOURCE_FILE=") + srcname +
+                          std::string(" -DTARGET_NAME=") + filename + string("&& make -j");
+        int ret = system((cmd.c_str()));
+        if (ret != 0)
+            return false;
+        if (!file_exsits(objname))
+            return false;
+        objname = cache.insert(key, objname);
+    }
     auto obj = get_library_handle(objname);
     auto entry = get_funcion_pointer(
         ke->kernel->get_or_emit_source()->name_unit->get_code() + "_entry", obj);
@@ -0,0 +1,266 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "library_cache.hpp"
+#include "binary_utils.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <dirent.h>
+#include <fstream>
+#include <libgen.h>
+#include <limits.h>
+#include <sstream>
+#include <sys/stat.h>
+#include <tuple>
+#include <unistd.h>
+#include <utime.h>
+#include <vector>
+
+DEFINE_string(fprofiler_cache_dir,
+              "",
+              "Folder of the compiled profiling libraries, ~/.cache/nnfusion/profiler by default.");
+DEFINE_int64(fprofiler_cache_size,
+             0,
+             "Capacity in MB of the compiled profiling library cache, 0 to disable it.");
+
+using namespace nnfusion::profiler;
+
+namespace
+{
+    // stable across builds and platforms, unlike std::hash
+    uint64_t fnv1a_hash(const std::string& str, uint64_t hash = 14695981039346656037ULL)
+    {
+        for (unsigned char c : str)
+        {
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    // hash the files under path, in name order so the hash does not depend on the file system
+    uint64_t hash_folder(const std::string& path, uint64_t hash)
+    {
+        DIR* dir = opendir(path.c_str());
+        if (dir == nullptr)
+            return hash;
+        std::vector<std::string> names;
+        while (struct dirent* entry = readdir(dir))
+        {
+            std::string name = entry->d_name;
+            if (name != "." && name != "..")
+                names.push_back(name);
+        }
+        closedir(dir);
+        std::sort(names.begin(), names.end());
+
+        for (auto& name : names)
+        {
+            std::string file = path + "/" + name;
+            struct stat s;
+            if (stat(file.c_str(), &s) != 0)
+                continue;
+            hash = fnv1a_hash(name, hash);
+            if (S_ISDIR(s.st_mode))
+            {
+                hash = hash_folder(file, hash);
+            }
+            else
+            {
+                std::ifstream in(file, std::ios::binary);
+                std::stringstream content;
+                content << in.rdbuf();
+                hash = fnv1a_hash(content.str(), hash);
+            }
+        }
+        return hash;
+    }
+
+    std::string get_cache_dir()
+    {
+        if (FLAGS_fprofiler_cache_dir != "")
+            return FLAGS_fprofiler_cache_dir;
+        const char* home = getenv("HOME");
+        if (home == nullptr)
+        {
+            NNFUSION_LOG(NNFUSION_WARNING)
+                << "HOME is not set, the profiler cache needs -fprofiler_cache_dir";
+            return "";
+        }
+        return home + std::string("/.cache/nnfusion/profiler/");
+    }
+}
+
+LibraryCache::LibraryCache(const std::string& dir, size_t capacity)
+    : m_dir(dir)
+    , m_capacity(capacity)
+{
+    if (!is_enabled())
+        return;
+    if (m_dir.back() != '/')
+        m_dir += "/";
+    // the profiling runtimes change the working directory while building
+    char cwd[PATH_MAX];
+    if (m_dir[0] != '/' && getcwd(cwd, PATH_MAX) != nullptr)
+        m_dir = std::string(cwd) + "/" + m_dir;
+    // create the missing parents as well, like mkdir -p
+    bool created = true;
+    for (size_t pos = m_dir.find('/', 1); created && pos != std::string::npos;
+         pos = m_dir.find('/', pos + 1))
+        created = nnfusion::codegen::create_folder(m_dir.substr(0, pos));
+    if (!created)
+    {
+        NNFUSION_LOG(NNFUSION_WARNING) << "Failed to create profiler cache folder " << m_dir;
+        m_capacity = 0;
+    }
+}
+
+LibraryCache& LibraryCache::get()
+{
+    static LibraryCache cache(FLAGS_fprofiler_cache_size > 0 ? get_cache_dir() : "",
+                              FLAGS_fprofiler_cache_size > 0 ? FLAGS_fprofiler_cache_size << 20
+                                                             : 0);
+    return cache;
+}
+
+std::string LibraryCache::get_runtime_version()
+{
+    static std::string version;
+    if (version.empty())
+    {
+        // the profiling libraries build and link the runtime sources shipped next to nnfusion
+        uint64_t hash = fnv1a_hash("");
+        char exe_path[PATH_MAX];
+        ssize_t count = readlink("/proc/self/exe", exe_path, PATH_MAX - 1);
+        if (count != -1)
+        {
+            exe_path[count] = '\0';
+            std::string path = dirname(exe_path);
+            for (auto lib : {"eigen", "threadpool", "mlas"})
+                hash = hash_folder(path + "/" + lib, hash);
+        }
+        std::stringstream ss;
+        ss << std::hex << hash;
+        version = ss.str();
+    }
+    return version;
+}
+
+std::string LibraryCache::get_cpu_model()
+{
+    static std::string model;
+    if (model.empty())
+    {
+        std::ifstream cpuinfo("/proc/cpuinfo");
+        std::string line;
+        while (std::getline(cpuinfo, line))
+        {
+            if (line.compare(0, 10, "model name") == 0)
+            {
+                model = line.substr(line.find(':') + 1);
+                break;
+            }
+        }
+        if (model.empty())
+            model = "unknown";
+    }
+    return model;
+}
+
+std::string LibraryCache::get_key(const std::string& source, const std::string& recipe) const
+{
+    uint64_t hash = fnv1a_hash(source);
+    hash = fnv1a_hash(recipe, hash);
+    hash = fnv1a_hash(get_cpu_model(), hash);
+    hash = fnv1a_hash(get_runtime_version(), hash);
+    std::stringstream ss;
+    ss << std::hex << hash;
+    return ss.str();
+}
+
+std::string LibraryCache::get_path(const std::string& key) const
+{
+    return m_dir + "lib" + key + DLIB_SUFFIX;
+}
+
+std::string LibraryCache::lookup(const std::string& key)
+{
+    if (!is_enabled())
+        return "";
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto path = get_path(key);
+    if (!file_exsits(path))
+        return "";
+    // refresh the lru order
+    utime(path.c_str(), nullptr);
+    return path;
+}
+
+std::string LibraryCache::insert(const std::string& key, const std::string& lib_path)
+{
+    if (!is_enabled())
+        return lib_path;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto path = get_path(key);
+        // other processes may read the cache, so publish the library atomically
+        auto tmp_path = path + ".tmp" + std::to_string(getpid());
+        {
+            std::ifstream in(lib_path, std::ios::binary);
+            std::ofstream out(tmp_path, std::ios::binary);
+            out << in.rdbuf();
+            if (!in.good() || !out.good())
+            {
+                remove(tmp_path.c_str());
+                return lib_path;
+            }
+        }
+        if (rename(tmp_path.c_str(), path.c_str()) != 0)
+        {
+            remove(tmp_path.c_str());
+            return lib_path;
+        }
+    }
+    evict(key);
+    return lookup(key);
+}
+
+void LibraryCache::evict(const std::string& keep)
+{
+    if (!is_enabled())
+        return;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    DIR* dir = opendir(m_dir.c_str());
+    if (dir == nullptr)
+        return;
+    // <mtime in ns, size, path>
+    std::vector<std::tuple<int64_t, size_t, std::string>> libs;
+    size_t total = 0;
+    std::string suffix = DLIB_SUFFIX;
+    while (struct dirent* entry = readdir(dir))
+    {
+        std::string name = entry->d_name;
+        if (name.size() <= suffix.size() ||
+            name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0)
+            continue;
+        struct stat s;
+        std::string path = m_dir + name;
+        if (stat(path.c_str(), &s) != 0)
+            continue;
+        libs.emplace_back(
+            s.st_mtim.tv_sec * 1000000000LL + s.st_mtim.tv_nsec, s.st_size, path);
+        total += s.st_size;
+    }
+    closedir(dir);
+
+    std::sort(libs.begin(), libs.end());
+    // file timestamps are coarse, so the library just inserted is kept explicitly
+    std::string keep_path = keep.empty() ? "" : get_path(keep);
+    for (size_t i = 0; i < libs.size() && total > m_capacity; i++)
+    {
+        // libraries already loaded stay mapped after unlink
+        if (std::get<2>(libs[i]) != keep_path && remove(std::get<2>(libs[i]).c_str()) == 0)
+            total -= std::get<1>(libs[i]);
+    }
+}
@@ -0,0 +1,56 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+/**
+ * \brief On-disk cache of the shared libraries built by the profiling runtimes
+ */
+
+#pragma once
+
+#include <mutex>
+#include <string>
+
+#include "nnfusion/common/common.hpp"
+
+DECLARE_string(fprofiler_cache_dir);
+DECLARE_int64(fprofiler_cache_size);
+
+namespace nnfusion
+{
+    namespace profiler
+    {
+        ///\brief Libraries are stored as <dir>/<key>.so, where the key hashes the generated
+        /// source, its build recipe, the runtime libraries it links and the CPU model, so
+        /// a library is only reused on a machine and a release it was built for. The
+        /// modification time of a library is refreshed on every hit and the least recently
+        /// used ones are removed once the total size exceeds the capacity.
+        class LibraryCache
+        {
+        public:
+            LibraryCache(const std::string& dir, size_t capacity);
+            // the cache configured by -fprofiler_cache_dir and -fprofiler_cache_size
+            static LibraryCache& get();
+
+            bool is_enabled() const { return m_capacity > 0 && !m_dir.empty(); }
+            std::string get_key(const std::string& source, const std::string& recipe) const;
+            // path of the cached library, empty on miss
+            std::string lookup(const std::string& key);
+            // copy the built library into the cache and return its cached path
+            std::string insert(const std::string& key, const std::string& lib_path);
+            // remove the least recently used libraries other than keep until the total size
+            // fits the capacity
+            void evict(const std::string& keep = "");
+            const std::string& get_dir() const { return m_dir; }
+            static std::string get_cpu_model();
+            // hash of the eigen, threadpool and mlas sources the libraries are built with
+            static std::string get_runtime_version();
+
+        private:
+            std::string get_path(const std::string& key) const;
+
+            std::string m_dir;
+            size_t m_capacity;
+            std::mutex m_mutex;
+        };
+    }
+}
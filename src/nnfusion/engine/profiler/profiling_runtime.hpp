@@ -474,6 +474,8 @@ INSERT INTO KernelCache(key_code, key_op, device_type, cost) VALUES(?, ?, ?, ?);
             size_t warmup_times = 5;
             size_t host_times = 1;
             size_t runtime_times = 100;
+            // worker threads for parallel CPU kernels, 0 for all cores
+            size_t num_threads = 1;
             // This emitter includes the kernel context;
             ProfilingResult result;
             kernels::KernelEmitter::Pointer kernel;
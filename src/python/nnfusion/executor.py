@@ -169,7 +169,22 @@ class Executor(object):
         # self.feed_tensors(*args, **kwargs)
         self.feed_data(*args, **kwargs)
 
-    def feed_data(self, inputs, outputs, strict=True):
+    def create_context(self):
+        """
+        Create a context of a runtime generated with -fcpu_context_api. Contexts own
+        their activation memory, so runs on different contexts may be concurrent.
+        """
+        if not hasattr(self.libnnf, "nnfusion_ctx_create"):
+            raise Exception(
+                "No nnfusion_ctx_create in nnfusion_rt, codegen with -fcpu_context_api")
+        self.libnnf.nnfusion_ctx_create.restype = ctypes.c_void_p
+        return ctypes.c_void_p(self.libnnf.nnfusion_ctx_create())
+
+    def destroy_context(self, context):
+        self.libnnf.nnfusion_ctx_destroy.argtypes = [ctypes.c_void_p]
+        self.libnnf.nnfusion_ctx_destroy(context)
+
+    def feed_data(self, inputs, outputs, strict=True, context=None):
         """
         Execute the kernel_entry in nnf runtime
 
@@ -177,6 +192,7 @@ class Executor(object):
             inputs: a dict from name to nnf DataFormat
             outputs: a dict from name to nnf DataFormat
             strict: False if allow unused inputs/outputs
+            context: run on a context from create_context instead of kernel_entry
 
         Returns:
             None
@@ -212,11 +228,16 @@ class Executor(object):
             else:
                 if strict:
                     raise Exception(f"Unused output {name}")
-        self.feed_pointers(signature, params)
+        self.feed_pointers(signature, params, context)
 
     def alloc_output_buffer(self):
         return tuple(desc.get_torch_cuda_buffer() for desc in self.output_descs) 
 
-    def feed_pointers(self, signature, params):
-        self.kernel_entry.argtypes = signature
-        self.kernel_entry(*params)
\ No newline at end of file
+    def feed_pointers(self, signature, params, context=None):
+        if context is None:
+            self.kernel_entry.argtypes = signature
+            self.kernel_entry(*params)
+        else:
+            ctx_run = self.libnnf.nnfusion_ctx_run
+            ctx_run.argtypes = [ctypes.c_void_p] + signature
+            ctx_run(context, *params)
\ No newline at end of file
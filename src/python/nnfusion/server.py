@@ -0,0 +1,389 @@
+# Copyright (c) Microsoft Corporation.
+# Licensed under the MIT License.
+
+import argparse
+import collections
+import threading
+import time
+from concurrent.futures import Future
+from multiprocessing.connection import Client, Listener
+
+import numpy as np
+
+from .data_format import cast_numpy_array
+from .executor import Executor
+
+
+class _Request(object):
+    def __init__(self, inputs, batch):
+        self.inputs = inputs
+        self.batch = batch
+        self.arrival = time.monotonic()
+        self.future = Future()
+
+
+class BatchingServer(object):
+    """
+    Dynamic batching harness around a compiled nnf_rt.
+    Requests are queued in process and coalesced up to the compiled batch size, or until
+    the oldest one has waited max_latency_ms. Partial batches are padded with zeros before
+    they are dispatched to kernel_entry, and the outputs are split back per request.
+    """
+    def __init__(self,
+                 nnf_rt_dir,
+                 max_latency_ms=5.0,
+                 num_workers=1,
+                 batch_dim=0,
+                 static_inputs=None,
+                 history=10000):
+        """
+        Parameters:
+            nnf_rt_dir: A full string path to nnfusion runtime, the outputs must be
+                written to the given buffers, i.e. codegen with -fextern_result_memory.
+            max_latency_ms: How long the oldest queued request waits for a fuller batch.
+            num_workers: Batches run concurrently, each on its own context, more than one
+                worker needs a runtime generated with -fcpu_context_api.
+            batch_dim: The batch dimension of every request input and model output.
+            static_inputs: A dict from name to numpy array fed to every batch, e.g. weights.
+            history: How many latest requests the latency percentiles are computed over.
+        """
+        self.executor = Executor(nnf_rt_dir)
+        self.max_latency = max_latency_ms / 1000.0
+        self.batch_dim = batch_dim
+        self.static_inputs = {
+            name: cast_numpy_array(np.ascontiguousarray(value))
+            for name, value in (static_inputs or {}).items()
+        }
+        self.request_descs = [
+            desc for desc in self.executor.get_inputs()
+            if desc.name not in self.static_inputs
+        ]
+        if not self.request_descs:
+            raise Exception("No request inputs left for batching")
+        batch_sizes = set(desc.shape[batch_dim]
+                          for desc in self.request_descs + list(
+                              self.executor.get_outputs()))
+        if len(batch_sizes) != 1:
+            raise Exception(
+                f"Inputs and outputs disagree on batch dim {batch_dim}: {batch_sizes}")
+        self.batch_size = batch_sizes.pop()
+
+        self._contexts = [None]
+        if num_workers > 1:
+            self._contexts = [
+                self.executor.create_context() for _ in range(num_workers)
+            ]
+        self._pending = collections.deque()
+        self._cond = threading.Condition()
+        self._stopped = False
+        self._workers = []
+
+        self._stats_lock = threading.Lock()
+        self._latencies = collections.deque(maxlen=history)
+        self._start_time = None
+        self._requests = 0
+        self._samples = 0
+        self._batches = 0
+        self._padded = 0
+
+    def start(self):
+        self._stopped = False
+        self._start_time = time.monotonic()
+        self._workers = [
+            threading.Thread(target=self._work, args=(context, ), daemon=True)
+            for context in self._contexts
+        ]
+        for worker in self._workers:
+            worker.start()
+        return self
+
+    def stop(self):
+        with self._cond:
+            self._stopped = True
+            self._cond.notify_all()
+        for worker in self._workers:
+            worker.join()
+        self._workers = []
+
+    def close(self):
+        self.stop()
+        for context in self._contexts:
+            if context is not None:
+                self.executor.destroy_context(context)
+        self._contexts = []
+
+    def __enter__(self):
+        return self.start()
+
+    def __exit__(self, *args):
+        self.close()
+
+    def submit(self, inputs):
+        """
+        Queue one request.
+
+        Parameters:
+            inputs: a dict from name to numpy array, whose batch dim is at most the
+                compiled batch size.
+
+        Returns:
+            A Future of a dict from output name to numpy array.
+        """
+        batch = None
+        arrays = {}
+        for desc in self.request_descs:
+            if desc.name not in inputs:
+                raise Exception(f"Missed input {desc.name}")
+            array = np.asarray(inputs[desc.name], dtype=desc.dtype)
+            shape = list(desc.shape)
+            shape[self.batch_dim] = array.shape[self.batch_dim] if array.ndim == len(
+                shape) else -1
+            if list(array.shape) != shape or shape[self.batch_dim] == 0:
+                raise Exception(
+                    f"Shape mismatch for input {desc.name}, expect {desc.shape} with any "
+                    f"batch up to {self.batch_size}, feed {array.shape}")
+            if batch is not None and shape[self.batch_dim] != batch:
+                raise Exception("Request inputs disagree on the batch size")
+            batch = shape[self.batch_dim]
+            arrays[desc.name] = array
+        if batch > self.batch_size:
+            raise Exception(
+                f"Request batch {batch} exceeds the compiled batch {self.batch_size}")
+
+        request = _Request(arrays, batch)
+        with self._cond:
+            if self._stopped or not self._workers:
+                raise Exception("Server is not running")
+            self._pending.append(request)
+            self._cond.notify()
+        return request.future
+
+    def infer(self, inputs, timeout=None):
+        return self.submit(inputs).result(timeout)
+
+    def stats(self):
+        """
+        Returns:
+            A dict of the request and sample throughput since start, the batch usage and
+            the p50/p99 latency in ms of the latest requests.
+        """
+        with self._stats_lock:
+            latencies = sorted(self._latencies)
+            elapsed = time.monotonic() - self._start_time if self._start_time else 0.0
+            stats = {
+                "requests": self._requests,
+                "batches": self._batches,
+                "samples": self._samples,
+                "padded_samples": self._padded,
+                "requests_per_sec": self._requests / elapsed if elapsed > 0 else 0.0,
+                "samples_per_sec": self._samples / elapsed if elapsed > 0 else 0.0,
+                "avg_batch": self._samples / self._batches if self._batches else 0.0,
+            }
+
+        def percentile(p):
+            if not latencies:
+                return 0.0
+            index = min(len(latencies) - 1, int(round(p / 100.0 * (len(latencies) - 1))))
+            return latencies[index] * 1000.0
+
+        stats["p50_ms"] = percentile(50)
+        stats["p99_ms"] = percentile(99)
+        return stats
+
+    def _next_batch(self):
+        # the longest prefix of the queue fitting into one batch, taken once it is full,
+        # blocked by a request not fitting any more, or the oldest request is due
+        with self._cond:
+            while not self._pending and not self._stopped:
+                self._cond.wait()
+            if not self._pending:
+                return None
+            deadline = self._pending[0].arrival + self.max_latency
+            while True:
+                count, samples = 0, 0
+                for request in self._pending:
+                    if samples + request.batch > self.batch_size:
+                        break
+                    count += 1
+                    samples += request.batch
+                remaining = deadline - time.monotonic()
+                if (samples == self.batch_size or count < len(self._pending)
+                        or remaining <= 0 or self._stopped):
+                    return [self._pending.popleft() for _ in range(count)]
+                self._cond.wait(remaining)
+
+    def _work(self, context):
+        while True:
+            requests = self._next_batch()
+            if requests is None:
+                return
+            try:
+                self._run_batch(requests, context)
+            except Exception as e:
+                for request in requests:
+                    if not request.future.done():
+                        request.future.set_exception(e)
+
+    def _run_batch(self, requests, context):
+        samples = sum(request.batch for request in requests)
+        inputs = dict(self.static_inputs)
+        for desc in self.request_descs:
+            parts = [request.inputs[desc.name] for request in requests]
+            if samples < self.batch_size:
+                pad_shape = list(desc.shape)
+                pad_shape[self.batch_dim] = self.batch_size - samples
+                parts.append(np.zeros(pad_shape, dtype=desc.dtype))
+            batch = np.ascontiguousarray(np.concatenate(parts, axis=self.batch_dim))
+            inputs[desc.name] = cast_numpy_array(batch)
+
+        outputs = {
+            desc.name: np.empty(desc.shape, dtype=desc.dtype)
+            for desc in self.executor.get_outputs()
+        }
+        self.executor.feed_data(inputs, {
+            name: cast_numpy_array(array)
+            for name, array in outputs.items()
+        },
+                                context=context)
+
+        done = time.monotonic()
+        offset = 0
+        for request in requests:
+            index = [slice(None)] * self.batch_dim + [
+                slice(offset, offset + request.batch)
+            ]
+            request.future.set_result({
+                name: array[tuple(index)].copy()
+                for name, array in outputs.items()
+            })
+            offset += request.batch
+
+        with self._stats_lock:
+            self._requests += len(requests)
+            self._samples += samples
+            self._batches += 1
+            self._padded += self.batch_size - samples
+            self._latencies.extend(done - request.arrival for request in requests)
+
+
+def serve(server, address, authkey=b"nnfusion"):
+    """
+    Serve a started BatchingServer on a local socket, a path for a unix socket or a
+    (host, port) tuple, until interrupted. Each connection sends ("infer", inputs) or
+    ("stats", None) and receives the outputs, the stats or an Exception.
+    """
+    def handle(conn):
+        with conn:
+            while True:
+                try:
+                    command, payload = conn.recv()
+                except EOFError:
+                    return
+                try:
+                    if command == "infer":
+                        conn.send(server.infer(payload))
+                    elif command == "stats":
+                        conn.send(server.stats())
+                    else:
+                        conn.send(Exception(f"Unknown command {command}"))
+                except Exception as e:
+                    conn.send(e)
+
+    with Listener(address, authkey=authkey) as listener:
+        while True:
+            conn = listener.accept()
+            threading.Thread(target=handle, args=(conn, ), daemon=True).start()
+
+
+class BatchingClient(object):
+    """ Client of a BatchingServer served on a local socket, one connection per client. """
+    def __init__(self, address, authkey=b"nnfusion"):
+        self._conn = Client(address, authkey=authkey)
+
+    def _call(self, command, payload):
+        self._conn.send((command, payload))
+        result = self._conn.recv()
+        if isinstance(result, Exception):
+            raise result
+        return result
+
+    def infer(self, inputs):
+        return self._call("infer", inputs)
+
+    def stats(self):
+        return self._call("stats", None)
+
+    def close(self):
+        self._conn.close()
+
+
+def load_test(server, num_requests, concurrency, request_batch=1):
+    """ Send num_requests random requests from concurrency threads, and return the stats. """
+    def random_inputs():
+        inputs = {}
+        for desc in server.request_descs:
+            shape = list(desc.shape)
+            shape[server.batch_dim] = request_batch
+            inputs[desc.name] = np.random.rand(*shape).astype(desc.dtype)
+        return inputs
+
+    counter = iter(range(num_requests))
+    lock = threading.Lock()
+
+    def client():
+        while True:
+            with lock:
+                if next(counter, None) is None:
+                    return
+            server.infer(random_inputs())
+
+    threads = [threading.Thread(target=client) for _ in range(concurrency)]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    return server.stats()
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Dynamic batching server around a compiled nnf_rt")
+    parser.add_argument("nnf_rt_dir", help="folder of the compiled nnfusion runtime")
+    parser.add_argument("--max_latency_ms", type=float, default=5.0)
+    parser.add_argument("--workers", type=int, default=1)
+    parser.add_argument("--batch_dim", type=int, default=0)
+    parser.add_argument("--address",
+                        default="/tmp/nnfusion_server.sock",
+                        help="unix socket path, or host:port")
+    parser.add_argument("--load_test",
+                        type=int,
+                        default=0,
+                        help="run so many in-process requests and print the stats "
+                        "instead of serving")
+    parser.add_argument("--concurrency", type=int, default=16)
+    parser.add_argument("--request_batch", type=int, default=1)
+    args = parser.parse_args()
+
+    server = BatchingServer(args.nnf_rt_dir,
+                            max_latency_ms=args.max_latency_ms,
+                            num_workers=args.workers,
+                            batch_dim=args.batch_dim)
+    with server:
+        if args.load_test > 0:
+            for name, value in load_test(server, args.load_test, args.concurrency,
+                                         args.request_batch).items():
+                print(f"{name}: {value}")
+            return
+        address = args.address
+        if ":" in address:
+            host, port = address.rsplit(":", 1)
+            address = (host, int(port))
+        print(f"Serving batch {server.batch_size} on {args.address}")
+        try:
+            serve(server, address)
+        except KeyboardInterrupt:
+            pass
+
+
+if __name__ == "__main__":
+    main()
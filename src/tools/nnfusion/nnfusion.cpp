@@ -6,6 +6,9 @@
 // g++ ./nnfusion.cpp -std=c++11 -I$HOME/ngraph_dist/include -L$HOME/ngraph_dist/lib -lngraph -o nnfusion
 // env LD_LIBRARY_PATH=$HOME/ngraph_dist/lib ./nnfusion
 
+#include <sys/wait.h>
+#include <unistd.h>
+
 #include <fstream>
 #include <iomanip>
 
@@ -20,6 +23,8 @@
 #include "nnfusion/engine/device/graphcore.hpp"
 #include "nnfusion/engine/device/hlsl.hpp"
 #include "nnfusion/engine/device/rocm.hpp"
+#include "nnfusion/engine/pass/codegen/cpu_bucket_codegen.hpp"
+#include "nnfusion/engine/pass/graph/graph_snapshot_pass.hpp"
 
 using namespace std;
 
@@ -35,6 +40,15 @@ DEFINE_string(params,
               "\"1,1:float;2,3,4,5:double\", for onnx, it's dynamic dim like "
               "\"dim1_name:4;dim2_name:128\"");
 
+DEFINE_string(fshape_buckets,
+              "",
+              "Compile one CPU runtime for several shapes of an onnx model, given as dim params "
+              "overriding -p and separated by '|', like \"seq:32|seq:64|seq:128\". Its "
+              "kernel_entry_dynamic() runs the smallest bucket fitting the actual dims on "
+              "zero padded inputs, which is only exact for models whose outputs do not depend on "
+              "the padding, reductions like Sum, Mean or Softmax over a padded axis see the "
+              "zeros.");
+
 void display_help()
 {
     cout << R"###(
@@ -54,68 +68,28 @@ bool file_exists(const string& filename)
     return (stat(filename.c_str(), &buffer) == 0);
 }
 
-int main(int argc, char** argv)
+void compile_model(const string& model, const string& format, const string& params)
 {
-    bool failed = false;
-    string model, format, params, backend = "NNFusion";
-
-    model = format = params = "##UNSET##";
-
-    if (argc > 1)
-    {
-        model = argv[1];
-    }
-    else
-    {
-        display_help();
-        GFLAGS_NAMESPACE::ShowUsageWithFlags(argv[0]);
-        return 1;
-    }
-
-    // To support abbreviation along Gflags;
-    for (size_t i = 2; i < argc; i++)
-    {
-        string arg = argv[i];
-        if (arg == "-f")
-        {
-            format = argv[++i];
-        }
-        else if (arg == "-p")
-        {
-            params = argv[++i];
-        }
-    }
-
-    google::SetUsageMessage(argv[0]);
-    google::AllowCommandLineReparsing();
-    google::ParseCommandLineFlags(&argc, &argv, true);
-
-    if (format == "##UNSET##")
-        format = FLAGS_format;
-
-    if (params == "##UNSET##")
-        params = FLAGS_params;
-
-    if (!model.empty() && !file_exists(model))
-    {
-        cout << "File " << model << " not found\n";
-        failed = true;
-    }
-
-    if (failed)
-    {
-        display_help();
-        return 1;
-    }
-
+    string backend = "NNFusion";
     cout << "\n";
     cout << "============================================================================\n";
     cout << "---- Processing '" << model << "'\n";
     cout << "============================================================================\n";
-    // try
-    // {
     shared_ptr<nnfusion::graph::Graph> graph = nullptr;
-    if (format == "tensorflow")
+    auto context = make_shared<nnfusion::EngineContext>();
+    // engines running the snapshot pass
+    auto device_type = get_device_type(FLAGS_fdefault_device);
+    if (device_type == CUDA_GPU || device_type == ROCM_GPU || device_type == GENERIC_CPU)
+    {
+        graph = nnfusion::pass::graph::GraphSnapshotPass::load(
+            model, format + ";" + params, context);
+    }
+
+    if (graph != nullptr)
+    {
+        // restored from the graph snapshot
+    }
+    else if (format == "tensorflow")
     {
         // load tensorlfow model as graph
         graph = nnfusion::frontend::load_tensorflow_model(model);
@@ -159,22 +133,22 @@ int main(int argc, char** argv)
             nnfusion::engine::ROCmEngine rocm_engine;
             nnfusion::engine::CpuEngine cpu_engine;
 
-            switch (get_device_type(FLAGS_fdefault_device))
+            switch (device_type)
             {
             case CUDA_GPU:
-                cuda_engine.run_on_graph(graph);
+                cuda_engine.run_on_graph(graph, context);
                 break;
             // case CUDA_GPU:
             //     runtime->codegen(graph);
             //     break;
             case ROCM_GPU:
-                rocm_engine.run_on_graph(graph);
+                rocm_engine.run_on_graph(graph, context);
                 break;
             // case ROCM_GPU: runtime->codegen(graph); break;
             // case GENERIC_CPU: runtime->codegen(graph); break;
-            case GENERIC_CPU: cpu_engine.run_on_graph(graph); break;
-            case HLSL: hlsl_engine.run_on_graph(graph); break;
-            case GraphCore: gc_engine.run_on_graph(graph); break;
+            case GENERIC_CPU: cpu_engine.run_on_graph(graph, context); break;
+            case HLSL: hlsl_engine.run_on_graph(graph, context); break;
+            case GraphCore: gc_engine.run_on_graph(graph, context); break;
             default:
                 throw nnfusion::errors::NotSupported("Unsupported device type:" +
                                                      FLAGS_fdefault_device);
@@ -185,5 +159,136 @@ int main(int argc, char** argv)
             throw nnfusion::errors::InvalidArgument("Default device cannot be empty.");
         }
     }
+}
+
+// every bucket is compiled in a child process, as the engines keep global state per graph
+int compile_shape_buckets(const string& model, const string& format, const string& params)
+{
+    NNFUSION_CHECK(format == "onnx") << "-fshape_buckets needs an onnx model.";
+    NNFUSION_CHECK(get_device_type(FLAGS_fdefault_device) == GENERIC_CPU)
+        << "-fshape_buckets supports CPU only.";
+
+    std::unordered_map<std::string, size_t> base_dims;
+    if (params != "##UNSET##")
+        base_dims = nnfusion::frontend::build_onnx_params_from_string(params);
+    std::vector<nnfusion::codegen::ShapeBucket> buckets;
+    for (size_t begin = 0, end = 0; begin <= FLAGS_fshape_buckets.size(); begin = end + 1)
+    {
+        end = std::min(FLAGS_fshape_buckets.find('|', begin), FLAGS_fshape_buckets.size());
+        auto bucket_params = FLAGS_fshape_buckets.substr(begin, end - begin);
+        nnfusion::codegen::ShapeBucket bucket;
+        bucket.dims.insert(base_dims.begin(), base_dims.end());
+        for (auto& dim : nnfusion::frontend::build_onnx_params_from_string(bucket_params))
+            bucket.dims[dim.first] = dim.second;
+        buckets.push_back(bucket);
+    }
+    auto volume = [](const nnfusion::codegen::ShapeBucket& bucket) {
+        size_t volume = 1;
+        for (auto& dim : bucket.dims)
+            volume *= dim.second;
+        return volume;
+    };
+    std::stable_sort(buckets.begin(),
+                     buckets.end(),
+                     [&](const nnfusion::codegen::ShapeBucket& a,
+                         const nnfusion::codegen::ShapeBucket& b) { return volume(a) < volume(b); });
+
+    // buckets run one at a time on the workspace of the dispatcher, writing the outputs to the
+    // buffers it passes, and take their constants from the blob it maps once
+    GFLAGS_NAMESPACE::SetCommandLineOption("fcpu_shared_workspace", "true");
+    GFLAGS_NAMESPACE::SetCommandLineOption("fextern_result_memory", "true");
+    GFLAGS_NAMESPACE::SetCommandLineOption("fcpu_constant_mmap", "true");
+
+    const string rt_folder = "./nnfusion_rt/cpu_codegen/";
+    const string buckets_folder = "./nnfusion_rt/cpu_buckets/";
+    NNFUSION_CHECK(system(("rm -rf " + rt_folder + " " + buckets_folder).c_str()) == 0);
+    NNFUSION_CHECK(nnfusion::codegen::create_folder("./nnfusion_rt") &&
+                   nnfusion::codegen::create_folder(buckets_folder));
+    for (size_t i = 0; i < buckets.size(); i++)
+    {
+        std::vector<string> dims;
+        for (auto& dim : buckets[i].dims)
+            dims.push_back(dim.first + ":" + to_string(dim.second));
+        buckets[i].folder = "bucket_" + to_string(i);
+
+        cout.flush();
+        pid_t pid = fork();
+        NNFUSION_CHECK(pid >= 0) << "Failed to fork for shape bucket " << i;
+        if (pid == 0)
+        {
+            compile_model(model, format, join(dims, ";"));
+            cout.flush();
+            exit(0);
+        }
+        int status = 0;
+        NNFUSION_CHECK(waitpid(pid, &status, 0) == pid && WIFEXITED(status) &&
+                       WEXITSTATUS(status) == 0)
+            << "Failed to compile shape bucket " << join(dims, ";");
+        NNFUSION_CHECK(rename(rt_folder.c_str(), (buckets_folder + buckets[i].folder).c_str()) ==
+                       0);
+    }
+    NNFUSION_CHECK(rename(buckets_folder.c_str(), rt_folder.c_str()) == 0);
+    nnfusion::codegen::generate_cpu_bucket_dispatcher(rt_folder, buckets);
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    bool failed = false;
+    string model, format, params;
+
+    model = format = params = "##UNSET##";
+
+    if (argc > 1)
+    {
+        model = argv[1];
+    }
+    else
+    {
+        display_help();
+        GFLAGS_NAMESPACE::ShowUsageWithFlags(argv[0]);
+        return 1;
+    }
+
+    // To support abbreviation along Gflags;
+    for (size_t i = 2; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "-f")
+        {
+            format = argv[++i];
+        }
+        else if (arg == "-p")
+        {
+            params = argv[++i];
+        }
+    }
+
+    google::SetUsageMessage(argv[0]);
+    google::AllowCommandLineReparsing();
+    google::ParseCommandLineFlags(&argc, &argv, true);
+
+    if (format == "##UNSET##")
+        format = FLAGS_format;
+
+    if (params == "##UNSET##")
+        params = FLAGS_params;
+
+    if (!model.empty() && !file_exists(model))
+    {
+        cout << "File " << model << " not found\n";
+        failed = true;
+    }
+
+    if (failed)
+    {
+        display_help();
+        return 1;
+    }
+
+    if (!FLAGS_fshape_buckets.empty())
+        return compile_shape_buckets(model, format, params);
+
+    compile_model(model, format, params);
     return 0;
 }
\ No newline at end of file
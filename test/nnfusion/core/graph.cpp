@@ -0,0 +1,137 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+/**
+ * \brief Unit tests for cached orders, adjacency and serialization of Graph
+ */
+
+#include "../test_util/common.hpp"
+#include "gtest/gtest.h"
+#include "nnfusion/core/graph/graph.hpp"
+#include "nnfusion/core/operators/op_define/add.hpp"
+#include "nnfusion/core/operators/op_define/broadcast.hpp"
+#include "nnfusion/core/operators/op_define/constant.hpp"
+#include "nnfusion/core/operators/op_define/parameter.hpp"
+#include "nnfusion/core/operators/op_define/relu.hpp"
+#include "nnfusion/core/operators/op_define/reshape.hpp"
+
+using namespace nnfusion;
+using namespace nnfusion::graph;
+
+TEST(nnfusion_core_graph, cached_orders_and_adjacency)
+{
+    auto graph = std::make_shared<Graph>();
+    Shape shape{2, 3};
+    auto a = graph->add_node_and_edge(std::make_shared<op::Parameter>(element::f32, shape),
+                                      GNodeVector());
+    auto b = graph->add_node_and_edge(std::make_shared<op::Parameter>(element::f32, shape),
+                                      GNodeVector());
+    auto add = graph->add_node_and_edge(std::make_shared<op::Add>(), GNodeVector({a, b}));
+    graph->set_outputs(GNodeVector({add}));
+
+    auto version = graph->get_version();
+    auto ops = graph->get_ordered_ops();
+    ASSERT_EQ(ops.size(), 3);
+    EXPECT_EQ(ops.back(), add);
+    EXPECT_EQ(graph->get_version(), version);
+    EXPECT_EQ(graph->get_adjacency(), graph->get_adjacency());
+
+    auto adjacency = graph->get_adjacency();
+    auto in_edges = adjacency->get_in_edges(add->get_id());
+    ASSERT_EQ(in_edges.size(), 2);
+    EXPECT_EQ(in_edges.begin()[0]->get_src(), a);
+    EXPECT_EQ(in_edges.begin()[1]->get_src(), b);
+    EXPECT_EQ(adjacency->get_out_edges(a->get_id()).size(), 1);
+    EXPECT_TRUE(adjacency->get_in_edges(a->get_id()).empty());
+    EXPECT_TRUE(adjacency->get_out_edges(add->get_id()).empty());
+
+    // mutations invalidate the cached orders and adjacency
+    auto relu = graph->add_node_and_edge(std::make_shared<op::Relu>(), GNodeVector({add}));
+    graph->set_outputs(GNodeVector({relu}));
+    EXPECT_GT(graph->get_version(), version);
+    ops = graph->get_ordered_ops();
+    ASSERT_EQ(ops.size(), 4);
+    EXPECT_EQ(ops.back(), relu);
+    EXPECT_NE(graph->get_adjacency(), adjacency);
+    EXPECT_EQ(graph->get_adjacency()->get_out_edges(add->get_id()).size(), 1);
+    // the nodes queried in the old view are a snapshot
+    EXPECT_EQ(adjacency->get_max_node_id(), 3);
+    EXPECT_TRUE(adjacency->get_out_edges(add->get_id()).empty());
+
+    graph->remove_node(relu);
+    graph->set_outputs(GNodeVector({add}));
+    EXPECT_EQ(graph->get_ordered_ops().size(), 3);
+    EXPECT_TRUE(graph->get_adjacency()->get_out_edges(add->get_id()).empty());
+
+    // so do edges changed directly on a node
+    adjacency = graph->get_adjacency();
+    add->remove_in_edge(add->get_in_edge(1));
+    EXPECT_NE(graph->get_adjacency(), adjacency);
+    EXPECT_EQ(graph->get_adjacency()->get_in_edges(add->get_id()).size(), 1);
+    EXPECT_EQ(graph->get_ordered_ops().size(), 2);
+}
+
+TEST(nnfusion_core_graph, serialize_round_trip)
+{
+    auto graph = std::make_shared<Graph>("round_trip");
+    auto b = graph->add_node_and_edge(
+        std::make_shared<op::Parameter>(element::f32, Shape{3, 2}, true), GNodeVector());
+    auto a = graph->add_node_and_edge(std::make_shared<op::Parameter>(element::i32, Shape{2, 3}),
+                                      GNodeVector());
+    auto c = graph->add_node_and_edge(
+        std::make_shared<op::Constant>(element::f32, Shape{3}, std::vector<float>{1, 2, 3}),
+        GNodeVector());
+    auto broadcast = graph->add_node_and_edge(
+        std::make_shared<op::Broadcast>(Shape{3, 2}, AxisSet{1}), GNodeVector({c}));
+    auto add = graph->add_node_and_edge(std::make_shared<op::Add>(), GNodeVector({b, broadcast}));
+    auto transpose = graph->add_node_and_edge(
+        std::make_shared<op::Reshape>(AxisVector{1, 0}, Shape{2, 3}), GNodeVector({add}));
+    graph->add_control_edge(a, transpose);
+    add->set_name("renamed_add");
+    add->Set<std::string>("Alias", "alias");
+    add->Set<int>("DeviceID", 1);
+    add->Set<NNFusion_DeviceType>("DeviceType", GENERIC_CPU);
+    graph->set_outputs({transpose, a});
+
+    auto path = "nnfusion_core_graph_round_trip.pb";
+    ASSERT_TRUE(graph->serialize_to_file(path));
+    auto restored = Graph::deserialize_from_file(path);
+    remove(path);
+    ASSERT_NE(restored, nullptr);
+
+    EXPECT_EQ(restored->get_friendly_name(), "round_trip");
+    EXPECT_EQ(restored->get_node_size(), graph->get_node_size());
+    auto parameters = restored->get_parameters();
+    ASSERT_EQ(parameters.size(), 2);
+    EXPECT_EQ(parameters[0]->get_element_type(), element::f32);
+    EXPECT_TRUE(std::static_pointer_cast<op::Parameter>(parameters[0]->get_op_ptr())
+                    ->get_cacheable());
+    EXPECT_EQ(parameters[1]->get_element_type(), element::i32);
+
+    auto outputs = restored->get_outputs();
+    ASSERT_EQ(outputs.size(), 2);
+    EXPECT_EQ(outputs[1], parameters[1]);
+    auto r_transpose = outputs[0];
+    EXPECT_EQ(r_transpose->get_op_type(), "Reshape");
+    EXPECT_EQ(r_transpose->get_shape(), Shape({2, 3}));
+    ASSERT_EQ(r_transpose->get_in_edges().size(), 2);
+    EXPECT_EQ(r_transpose->get_in_edge(0)->get_src()->get_name(), "renamed_add");
+    auto r_add = r_transpose->get_in_edge(0)->get_src();
+    EXPECT_EQ(r_add->get_in_edge(0)->get_src(), parameters[0]);
+    EXPECT_EQ(r_add->Get<std::string>("Alias"), "alias");
+    EXPECT_EQ(r_add->Get<int>("DeviceID"), 1);
+    EXPECT_EQ(r_add->Get<NNFusion_DeviceType>("DeviceType"), GENERIC_CPU);
+    auto r_broadcast = r_add->get_in_edge(1)->get_src();
+    EXPECT_EQ(std::static_pointer_cast<op::Broadcast>(r_broadcast->get_op_ptr())
+                  ->get_broadcast_axes(),
+              AxisSet({1}));
+    auto r_constant = r_broadcast->get_in_edge(0)->get_src();
+    ASSERT_TRUE(r_constant->is_constant());
+    EXPECT_EQ(std::static_pointer_cast<op::Constant>(r_constant->get_op_ptr())->get_vector<float>(),
+              std::vector<float>({1, 2, 3}));
+
+    // tags of unknown types cannot be restored
+    add->Set<std::vector<int>>("unknown", std::vector<int>{1});
+    EXPECT_FALSE(graph->serialize_to_file(path));
+    remove(path);
+}
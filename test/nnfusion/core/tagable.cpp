@@ -8,6 +8,7 @@
 #include <iostream>
 #include <set>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "../test_util/common.hpp"
@@ -39,4 +40,54 @@ TEST(nnfusion_core_ir, tagable)
     EXPECT_TRUE(!ins["Example"].is_valid());
     ins["Example1"].remove();
     EXPECT_TRUE(!ins["Example1"].is_valid());
-}
\ No newline at end of file
+}
+
+TEST(nnfusion_core_ir, tagable_symbol)
+{
+    // Symbols are interned, equal names share one id and the original string;
+    nnfusion::ir::Symbol a("Kernel_Selection_Result");
+    nnfusion::ir::Symbol b(std::string("Kernel_Selection_Result"));
+    nnfusion::ir::Symbol c("Async_info");
+    EXPECT_EQ(a.id(), b.id());
+    EXPECT_EQ(&a.str(), &b.str());
+    EXPECT_NE(a, c);
+    EXPECT_EQ(c.str(), "Async_info");
+    EXPECT_EQ(nnfusion::ir::Symbol().id(), 0);
+    auto count = nnfusion::ir::Symbol::count();
+    nnfusion::ir::Symbol d("Async_info");
+    EXPECT_EQ(nnfusion::ir::Symbol::count(), count);
+
+    // Tags set by string are found by symbol and the other way round;
+    nnfusion::graph::GNode gnode;
+    gnode["Async_info"] = 3;
+    EXPECT_TRUE(gnode[c].is_valid_as<int>());
+    EXPECT_FALSE(gnode[c].is_valid_as<int64_t>());
+    gnode[a] = std::string("Yes");
+    EXPECT_EQ(gnode.Get<std::string>("Kernel_Selection_Result"), "Yes");
+    auto names = gnode.attributeNames();
+    ASSERT_EQ(names.size(), 2);
+    EXPECT_EQ(names[0].str(), "Async_info");
+    EXPECT_EQ(names[1], a);
+}
+
+TEST(nnfusion_core_ir, tagable_symbol_concurrent)
+{
+    // Threads interning the same new names, past a growth of the table, agree on the ids;
+    const size_t num_names = 500;
+    std::vector<std::vector<uint32_t>> ids(4, std::vector<uint32_t>(num_names));
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < ids.size(); t++)
+    {
+        threads.emplace_back([&ids, t]() {
+            for (size_t i = 0; i < num_names; i++)
+                ids[t][i] = nnfusion::ir::Symbol("tagable_symbol_" + std::to_string(i)).id();
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+    for (size_t t = 1; t < ids.size(); t++)
+        EXPECT_EQ(ids[t], ids[0]);
+    std::set<uint32_t> distinct(ids[0].begin(), ids[0].end());
+    EXPECT_EQ(distinct.size(), num_names);
+    EXPECT_EQ(nnfusion::ir::Symbol("tagable_symbol_7").id(), ids[0][7]);
+}
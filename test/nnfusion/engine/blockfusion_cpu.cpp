@@ -0,0 +1,98 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+/**
+ * \brief Unit tests for the BlockFusion of the kernels of a CPU wavefront
+ */
+
+#include "../test_util/common.hpp"
+#include "gtest/gtest.h"
+#include "nnfusion/core/operators/op_define/abs.hpp"
+#include "nnfusion/core/operators/op_define/add.hpp"
+#include "nnfusion/core/operators/op_define/negative.hpp"
+#include "nnfusion/core/operators/op_define/parameter.hpp"
+#include "nnfusion/engine/pass/graph/blockfusion/blockfusion_cpu_optimizer.hpp"
+
+using namespace nnfusion;
+using namespace nnfusion::graph;
+using namespace nnfusion::kernels;
+
+namespace
+{
+    // select the first non-eigen CPU kernel emitting source for gnode
+    bool select_cpu_kernel(std::shared_ptr<GNode> gnode)
+    {
+        auto kernel_regs = KernelRegistry::Global()->FindKernelRegistrations(
+            gnode->get_op_type(), GENERIC_CPU, element::f32);
+        for (auto& kernel_reg : kernel_regs)
+        {
+            if (kernel_reg->m_tag == "eigen")
+                continue;
+            auto kernel = kernel_reg->m_factory(std::make_shared<KernelContext>(gnode));
+            if (kernel->get_or_emit_source())
+            {
+                (*gnode)["DeviceType"] = GENERIC_CPU;
+                (*gnode)["DeviceID"] = 0;
+                (*gnode)["Kernel_Selection_Result"] = std::make_pair(GENERIC_CPU, kernel);
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+TEST(nnfusion_engine_blockfusion_cpu, fuse_wavefront)
+{
+    auto graph = std::make_shared<Graph>();
+    auto a = graph->add_node_and_edge(std::make_shared<op::Parameter>(element::f32, Shape{4}),
+                                      GNodeVector());
+    auto b = graph->add_node_and_edge(std::make_shared<op::Parameter>(element::f32, Shape{4}),
+                                      GNodeVector());
+    auto abs = graph->add_node_and_edge(std::make_shared<op::Abs>(), GNodeVector({a}));
+    auto negative = graph->add_node_and_edge(std::make_shared<op::Negative>(), GNodeVector({b}));
+    auto add = graph->add_node_and_edge(std::make_shared<op::Add>(), GNodeVector({abs, negative}));
+    graph->set_outputs({add});
+    for (auto gnode : {abs, negative, add})
+        ASSERT_TRUE(select_cpu_kernel(gnode));
+
+    EXPECT_TRUE(BlockFusionCpuOptimizer(graph, 65536).Optimize());
+
+    // abs and negative form the second wavefront, the add depends on both
+    std::shared_ptr<GNode> fused;
+    for (auto gnode : graph->get_ordered_ops())
+    {
+        if (gnode->get_op_type() == "blockfusion_kernel")
+            fused = gnode;
+    }
+    ASSERT_NE(fused, nullptr);
+    EXPECT_EQ(graph->get_node_size(), 4);
+    EXPECT_EQ(fused->get_input_size(), 2);
+    EXPECT_EQ(fused->get_output_size(), 2);
+    EXPECT_EQ(add->get_in_edge(0)->get_src(), fused);
+    EXPECT_EQ(add->get_in_edge(1)->get_src(), fused);
+
+    // compile and run the fused kernel
+    std::vector<float> data_a{-1, 2, -3, 4}, data_b{5, -6, 7, -8};
+    std::vector<float> in;
+    for (size_t i = 0; i < fused->get_input_size(); i++)
+    {
+        bool is_a = fused->get_in_edge(i)->get_src() == a;
+        in.insert(in.end(), (is_a ? data_a : data_b).begin(), (is_a ? data_a : data_b).end());
+    }
+    auto kernel = (*fused)["Kernel_Selection_Result"]
+                      .as<std::pair<NNFusion_DeviceType, KernelEmitter::Pointer>>()
+                      .second;
+    auto pctx = std::make_shared<ProfilingContext>(kernel);
+    pctx->runtime_times = 1;
+    pctx->warmup_times = 0;
+    Profiler prof(get_default_runtime(GENERIC_CPU), pctx);
+    auto res = prof.unsafe_execute<float>((void*)in.data());
+    ASSERT_EQ(res.size(), 2);
+    for (size_t i = 0; i < res.size(); i++)
+    {
+        bool is_abs = fused->get_output_tensor_ptr(i) == abs->get_output_tensor_ptr(0);
+        std::vector<float> expected =
+            is_abs ? std::vector<float>{1, 2, 3, 4} : std::vector<float>{-5, 6, -7, 8};
+        EXPECT_TRUE(test::all_close(res[i], expected));
+    }
+}
@@ -0,0 +1,117 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+/**
+ * \brief Unit tests for the in-process constant folding
+ */
+
+#include "../test_util/common.hpp"
+#include "gtest/gtest.h"
+#include "nnfusion/core/operators/op_define/add.hpp"
+#include "nnfusion/core/operators/op_define/broadcast.hpp"
+#include "nnfusion/core/operators/op_define/constant.hpp"
+#include "nnfusion/core/operators/op_define/convert.hpp"
+#include "nnfusion/core/operators/op_define/less.hpp"
+#include "nnfusion/core/operators/op_define/multiply.hpp"
+#include "nnfusion/core/operators/op_define/parameter.hpp"
+#include "nnfusion/core/operators/op_define/reshape.hpp"
+#include "nnfusion/core/operators/op_define/sum.hpp"
+#include "nnfusion/engine/pass/graph/const_evaluator.hpp"
+#include "nnfusion/engine/pass/graph/runtime_const_folding_pass.hpp"
+
+using namespace nnfusion;
+using namespace nnfusion::graph;
+using namespace nnfusion::pass::graph;
+
+DECLARE_bool(fconst_folding_native);
+
+TEST(nnfusion_engine_const_folding, fold_subgraph)
+{
+    auto graph = std::make_shared<Graph>();
+    auto a = graph->add_node_and_edge(
+        std::make_shared<op::Constant>(
+            element::f32, Shape{2, 3}, std::vector<float>{1, 2, 3, 4, 5, 6}),
+        GNodeVector());
+    auto b = graph->add_node_and_edge(
+        std::make_shared<op::Constant>(element::f32, Shape{3}, std::vector<float>{1, 2, 3}),
+        GNodeVector());
+    auto broadcast = graph->add_node_and_edge(
+        std::make_shared<op::Broadcast>(Shape{2, 3}, AxisSet{0}), GNodeVector({b}));
+    auto add = graph->add_node_and_edge(std::make_shared<op::Add>(), GNodeVector({a, broadcast}));
+    auto transpose = graph->add_node_and_edge(
+        std::make_shared<op::Reshape>(AxisVector{1, 0}, Shape{3, 2}), GNodeVector({add}));
+    auto sum =
+        graph->add_node_and_edge(std::make_shared<op::Sum>(AxisSet{1}), GNodeVector({transpose}));
+    auto param = graph->add_node_and_edge(
+        std::make_shared<op::Parameter>(element::f32, Shape{3}), GNodeVector());
+    auto mul =
+        graph->add_node_and_edge(std::make_shared<op::Multiply>(), GNodeVector({param, sum}));
+    graph->set_outputs({mul});
+
+    // without a backend, only the native folding runs
+    bool native = FLAGS_fconst_folding_native;
+    FLAGS_fconst_folding_native = true;
+    RuntimeConstantFoldingPass().run_on_graph(graph);
+    FLAGS_fconst_folding_native = native;
+
+    // the whole subgraph is folded into the constant input of the output
+    EXPECT_EQ(graph->get_node_size(), 3);
+    auto folded = mul->get_in_edge(1)->get_src();
+    ASSERT_TRUE(folded->is_constant());
+    auto values = std::static_pointer_cast<op::Constant>(folded->get_op_ptr())->get_vector<float>();
+    EXPECT_EQ(values, std::vector<float>({7, 11, 15}));
+}
+
+TEST(nnfusion_engine_const_folding, keep_expanding_ops)
+{
+    auto graph = std::make_shared<Graph>();
+    auto a = graph->add_node_and_edge(
+        std::make_shared<op::Constant>(element::f32, Shape{3}, std::vector<float>{1, 2, 3}),
+        GNodeVector());
+    auto b = graph->add_node_and_edge(
+        std::make_shared<op::Constant>(element::f32, Shape{3}, std::vector<float>{1, 1, 1}),
+        GNodeVector());
+    auto add = graph->add_node_and_edge(std::make_shared<op::Add>(), GNodeVector({a, b}));
+    auto broadcast = graph->add_node_and_edge(
+        std::make_shared<op::Broadcast>(Shape{64, 3}, AxisSet{0}), GNodeVector({add}));
+    auto param = graph->add_node_and_edge(
+        std::make_shared<op::Parameter>(element::f32, Shape{64, 3}), GNodeVector());
+    auto mul =
+        graph->add_node_and_edge(std::make_shared<op::Multiply>(), GNodeVector({param, broadcast}));
+    graph->set_outputs({mul});
+
+    bool native = FLAGS_fconst_folding_native;
+    FLAGS_fconst_folding_native = true;
+    RuntimeConstantFoldingPass().run_on_graph(graph);
+    FLAGS_fconst_folding_native = native;
+
+    // the Add is folded, the Broadcast feeding a runtime op is not materialized
+    EXPECT_EQ(graph->get_node_size(), 4);
+    EXPECT_EQ(mul->get_in_edge(1)->get_src(), broadcast);
+    auto folded = broadcast->get_in_edge(0)->get_src();
+    ASSERT_TRUE(folded->is_constant());
+    auto values = std::static_pointer_cast<op::Constant>(folded->get_op_ptr())->get_vector<float>();
+    EXPECT_EQ(values, std::vector<float>({2, 3, 4}));
+}
+
+TEST(nnfusion_engine_const_folding, evaluate_types)
+{
+    auto graph = std::make_shared<Graph>();
+    auto a = graph->add_node_and_edge(
+        std::make_shared<op::Constant>(element::i64, Shape{3}, std::vector<int64_t>{-1, 2, 3}),
+        GNodeVector());
+    auto b = graph->add_node_and_edge(
+        std::make_shared<op::Constant>(element::i64, Shape{3}, std::vector<int64_t>{2, 2, 2}),
+        GNodeVector());
+    auto less = graph->add_node_and_edge(std::make_shared<op::Less>(), GNodeVector({a, b}));
+    auto convert = graph->add_node_and_edge(std::make_shared<op::Convert>(element::f32),
+                                            GNodeVector({a}));
+
+    std::vector<int64_t> a_data{-1, 2, 3}, b_data{2, 2, 2};
+    std::vector<char> output;
+    ASSERT_TRUE(ConstEvaluator::evaluate(less, {a_data.data(), b_data.data()}, output));
+    EXPECT_EQ(output, std::vector<char>({1, 0, 0}));
+    ASSERT_TRUE(ConstEvaluator::evaluate(convert, {a_data.data()}, output));
+    EXPECT_EQ(std::vector<float>((float*)output.data(), (float*)output.data() + 3),
+              std::vector<float>({-1, 2, 3}));
+}
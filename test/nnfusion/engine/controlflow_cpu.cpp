@@ -0,0 +1,143 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+/**
+ * \brief Unit tests for the host kernels of the If and Loop ops
+ */
+
+#include <cstring>
+#include "../test_util/common.hpp"
+#include "gtest/gtest.h"
+#include "nnfusion/core/operators/op_define/abs.hpp"
+#include "nnfusion/core/operators/op_define/add.hpp"
+#include "nnfusion/core/operators/op_define/if.hpp"
+#include "nnfusion/core/operators/op_define/loop.hpp"
+#include "nnfusion/core/operators/op_define/negative.hpp"
+#include "nnfusion/core/operators/op_define/parameter.hpp"
+#include "nnfusion/engine/pass/graph/control_flow_pass.hpp"
+
+DECLARE_string(fdefault_device);
+
+using namespace nnfusion;
+using namespace nnfusion::graph;
+using namespace nnfusion::kernels;
+
+namespace
+{
+    // a subgraph parameter read from input index of the control-flow node
+    std::shared_ptr<GNode> add_subgraph_input(std::shared_ptr<Graph> graph, int index)
+    {
+        auto param = graph->add_node_and_edge(
+            std::make_shared<op::Parameter>(element::f32, Shape{4}), GNodeVector());
+        param->Set<int>("subgraph_input_map", int(index));
+        return param;
+    }
+
+    // compiles the subgraphs of gnode for CPU and runs its kernel on the packed inputs
+    std::vector<std::vector<float>> run_cpu_controlflow(std::shared_ptr<Graph> graph,
+                                                        std::shared_ptr<GNode> gnode,
+                                                        const std::vector<char>& in)
+    {
+        auto saved_device = FLAGS_fdefault_device;
+        FLAGS_fdefault_device = "CPU";
+        pass::graph::ControlFlowPass().run_on_graph(graph);
+        FLAGS_fdefault_device = saved_device;
+
+        auto kernel_regs = KernelRegistry::Global()->FindKernelRegistrations(
+            gnode->get_op_type(), GENERIC_CPU, element::f32);
+        NNFUSION_CHECK(!kernel_regs.empty());
+        auto kernel = kernel_regs[0]->m_factory(std::make_shared<KernelContext>(gnode));
+        NNFUSION_CHECK(kernel->get_or_emit_source() != nullptr);
+
+        auto pctx = std::make_shared<ProfilingContext>(kernel);
+        pctx->runtime_times = 1;
+        pctx->warmup_times = 0;
+        Profiler prof(get_default_runtime(GENERIC_CPU), pctx);
+        return prof.unsafe_execute<float>((void*)in.data());
+    }
+
+    // the packed inputs of an If on cond and x
+    std::vector<char> pack_if_inputs(char cond, const std::vector<float>& x)
+    {
+        std::vector<char> in(1 + x.size() * sizeof(float));
+        in[0] = cond;
+        memcpy(in.data() + 1, x.data(), x.size() * sizeof(float));
+        return in;
+    }
+
+    // If (cond) Abs(x) else Negative(x)
+    std::vector<float> run_if(char cond, const std::vector<float>& x)
+    {
+        auto then_branch = std::make_shared<Graph>();
+        auto then_x = add_subgraph_input(then_branch, 1);
+        auto abs =
+            then_branch->add_node_and_edge(std::make_shared<op::Abs>(), GNodeVector({then_x}));
+        then_branch->set_outputs({abs});
+
+        auto else_branch = std::make_shared<Graph>();
+        auto else_x = add_subgraph_input(else_branch, 1);
+        auto negative =
+            else_branch->add_node_and_edge(std::make_shared<op::Negative>(), GNodeVector({else_x}));
+        else_branch->set_outputs({negative});
+
+        auto graph = std::make_shared<Graph>();
+        auto cond_param = graph->add_node_and_edge(
+            std::make_shared<op::Parameter>(element::boolean, Shape{}), GNodeVector());
+        auto x_param = graph->add_node_and_edge(
+            std::make_shared<op::Parameter>(element::f32, Shape{4}), GNodeVector());
+        auto if_op = std::make_shared<op::If>(then_branch,
+                                              else_branch,
+                                              std::vector<PartialShape>{PartialShape(Shape{4})},
+                                              std::vector<element::Type>{element::f32});
+        if_op->set_output_map({{abs->get_output_tensor_ptr(0)->get_name(false), 0},
+                               {negative->get_output_tensor_ptr(0)->get_name(false), 0}});
+        auto if_node = graph->add_node_and_edge(if_op, GNodeVector({cond_param, x_param}));
+        graph->set_outputs({if_node});
+
+        auto res = run_cpu_controlflow(graph, if_node, pack_if_inputs(cond, x));
+        NNFUSION_CHECK(res.size() == 1);
+        return res[0];
+    }
+}
+
+TEST(nnfusion_engine_controlflow_cpu, if_branches)
+{
+    std::vector<float> x{-1, 2, -3, 4};
+    EXPECT_TRUE(test::all_close(run_if(1, x), std::vector<float>{1, 2, 3, 4}));
+    EXPECT_TRUE(test::all_close(run_if(0, x), std::vector<float>{1, -2, 3, -4}));
+}
+
+TEST(nnfusion_engine_controlflow_cpu, loop_carried_state)
+{
+    // the body doubles the state, so each iteration reads the state of the previous one
+    auto body = std::make_shared<Graph>();
+    auto state = add_subgraph_input(body, 2);
+    auto add = body->add_node_and_edge(std::make_shared<op::Add>(), GNodeVector({state, state}));
+    body->set_outputs({add});
+
+    auto graph = std::make_shared<Graph>();
+    auto trip_count = graph->add_node_and_edge(
+        std::make_shared<op::Parameter>(element::i64, Shape{}), GNodeVector());
+    auto cond = graph->add_node_and_edge(
+        std::make_shared<op::Parameter>(element::boolean, Shape{}), GNodeVector());
+    auto init = graph->add_node_and_edge(
+        std::make_shared<op::Parameter>(element::f32, Shape{4}), GNodeVector());
+    auto loop_op = std::make_shared<op::Loop>(body,
+                                              std::vector<PartialShape>{PartialShape(Shape{4})},
+                                              std::vector<element::Type>{element::f32});
+    // the first output of the body would be the condition, which is left unchanged here
+    loop_op->set_loop_output_map({{add->get_output_tensor_ptr(0)->get_name(false), 1}});
+    auto loop_node = graph->add_node_and_edge(loop_op, GNodeVector({trip_count, cond, init}));
+    graph->set_outputs({loop_node});
+
+    int64_t trips = 3;
+    std::vector<float> x{-1, 2, -3, 4};
+    std::vector<char> in(sizeof(int64_t) + 1 + x.size() * sizeof(float));
+    memcpy(in.data(), &trips, sizeof(int64_t));
+    in[sizeof(int64_t)] = 1;
+    memcpy(in.data() + sizeof(int64_t) + 1, x.data(), x.size() * sizeof(float));
+
+    auto res = run_cpu_controlflow(graph, loop_node, in);
+    ASSERT_EQ(res.size(), 1);
+    EXPECT_TRUE(test::all_close(res[0], std::vector<float>{-8, 16, -24, 32}));
+}
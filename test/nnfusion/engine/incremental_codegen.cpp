@@ -0,0 +1,89 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+/**
+ * \brief Unit tests for the files kept by -fincremental_codegen
+ */
+
+#include <sys/stat.h>
+#include <utime.h>
+
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include "../test_util/common.hpp"
+#include "gtest/gtest.h"
+#include "nnfusion/engine/pass/codegen/codegenerator.hpp"
+
+DECLARE_bool(fincremental_codegen);
+
+using namespace nnfusion::codegen;
+
+namespace
+{
+    const std::string folder = "incremental_codegen_test/";
+
+    // a project of a main file requiring two kernel files
+    void generate(const std::string& code_a, const std::string& code_b)
+    {
+        CodeGenerator projgen(folder, ".cpp");
+        projgen.lup_codegen->pwd = folder;
+        projgen.lup_codegen->write_to = "main.cpp";
+        for (auto& kernel : {std::make_pair("a", code_a), std::make_pair("b", code_b)})
+        {
+            auto lu = std::make_shared<LanguageUnit>(std::string("kernel_") + kernel.first,
+                                                     kernel.second);
+            lu->pwd = folder;
+            lu->write_to = std::string("kernel_") + kernel.first + ".cpp";
+            projgen.lup_codegen->require(lu);
+        }
+        ASSERT_TRUE(projgen.codegen());
+    }
+
+    std::string read_file(const std::string& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    time_t get_mtime(const std::string& path)
+    {
+        struct stat st;
+        return stat(path.c_str(), &st) == 0 ? st.st_mtime : 0;
+    }
+}
+
+TEST(nnfusion_engine_incremental_codegen, keep_unchanged_files)
+{
+    auto saved_incremental = FLAGS_fincremental_codegen;
+    FLAGS_fincremental_codegen = true;
+    ASSERT_EQ(system(("rm -rf " + folder).c_str()), 0);
+
+    generate("void a() {}\n", "void b() {}\n");
+    auto content_a = read_file(folder + "kernel_a.cpp");
+    auto content_b = read_file(folder + "kernel_b.cpp");
+    EXPECT_NE(content_a.find("void a()"), std::string::npos);
+
+    // date the files back instead of waiting for the clock to tick
+    const time_t old_time = 1000000000;
+    struct utimbuf times = {old_time, old_time};
+    for (auto file : {"main.cpp", "kernel_a.cpp", "kernel_b.cpp"})
+        ASSERT_EQ(utime((folder + file).c_str(), &times), 0);
+
+    generate("void a() {}\n", "void b() { return; }\n");
+    // the unchanged files are put back as they were, the changed one is rewritten
+    EXPECT_EQ(read_file(folder + "kernel_a.cpp"), content_a);
+    EXPECT_EQ(get_mtime(folder + "kernel_a.cpp"), old_time);
+    EXPECT_EQ(get_mtime(folder + "main.cpp"), old_time);
+    EXPECT_NE(read_file(folder + "kernel_b.cpp"), content_b);
+    EXPECT_NE(read_file(folder + "kernel_b.cpp").find("return;"), std::string::npos);
+    EXPECT_NE(get_mtime(folder + "kernel_b.cpp"), old_time);
+    // no previous versions are left behind
+    struct stat st;
+    EXPECT_NE(stat((folder + "kernel_a.cpp.nnfusion_prev").c_str(), &st), 0);
+    EXPECT_NE(stat((folder + "kernel_b.cpp.nnfusion_prev").c_str(), &st), 0);
+
+    FLAGS_fincremental_codegen = saved_incremental;
+    EXPECT_EQ(system(("rm -rf " + folder).c_str()), 0);
+}
@@ -0,0 +1,58 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+/**
+ * \brief Unit tests for the in-memory front cache of kernel cache DB
+ */
+
+#include <cstdio>
+#include <string>
+
+#include "../test_util/common.hpp"
+#include "gtest/gtest.h"
+#include "nnfusion/engine/cache/manager.hpp"
+
+DECLARE_string(fkernel_cache_path);
+
+using namespace nnfusion::cache;
+
+TEST(nnfusion_engine_kernel_cache, front_cache)
+{
+    auto saved_path = FLAGS_fkernel_cache_path;
+    FLAGS_fkernel_cache_path = "./kernel_cache_front_test.db";
+    remove(FLAGS_fkernel_cache_path.c_str());
+    {
+        KernelCacheManager cache_manager;
+        ASSERT_TRUE(cache_manager.is_valid());
+        for (int i = 0; i < 3; i++)
+        {
+            auto entry = std::make_shared<KernelEntry>();
+            entry->key = "key_" + std::to_string(i);
+            entry->identifier = i < 2 ? "Dot[a]" : "Dot[b]";
+            entry->op_type = "Dot";
+            entry->source = "External";
+            entry->device_type = "CUDA_GPU";
+            entry->function = nlohmann::json::object({{"code", "..."}});
+            entry->miscs = nlohmann::json::object();
+            entry->tags = {"tag_" + std::to_string(i)};
+            EXPECT_TRUE(cache_manager.insert_kernel_entry(entry));
+        }
+
+        auto hits = KernelCacheManager::get_front_cache_hits();
+        auto misses = KernelCacheManager::get_front_cache_misses();
+        EXPECT_EQ(cache_manager.fetch_all("Dot[a]", "CUDA_GPU").size(), 2);
+        EXPECT_EQ(cache_manager.fetch_all("Dot[c]", "CUDA_GPU").size(), 0);
+        EXPECT_EQ(cache_manager.fetch_all("Dot[c]", "CUDA_GPU").size(), 0);
+        EXPECT_NE(cache_manager.fetch_with_tags("Dot[b]", "CUDA_GPU", {"tag_2"}), nullptr);
+        EXPECT_EQ(cache_manager.fetch_with_tags("Dot[b]", "CUDA_GPU", {"tag_0"}), nullptr);
+        // only the first lookup of Dot[c] goes to the database
+        EXPECT_EQ(KernelCacheManager::get_front_cache_hits() - hits, 4);
+        EXPECT_EQ(KernelCacheManager::get_front_cache_misses() - misses, 1);
+
+        // fetched entries are copies, modifying them does not change the cache
+        cache_manager.fetch_all("Dot[a]", "CUDA_GPU")[0]->tags.clear();
+        EXPECT_EQ(cache_manager.fetch_all("Dot[a]", "CUDA_GPU")[0]->tags.size(), 1);
+    }
+    remove(FLAGS_fkernel_cache_path.c_str());
+    FLAGS_fkernel_cache_path = saved_path;
+}
@@ -0,0 +1,147 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+/**
+ * \brief Unit tests for the tensor groups assigned by the liveness analysis
+ */
+
+#include "../test_util/common.hpp"
+#include "gtest/gtest.h"
+#include "nnfusion/core/operators/op_define/add.hpp"
+#include "nnfusion/core/operators/op_define/constant.hpp"
+#include "nnfusion/core/operators/op_define/parameter.hpp"
+#include "nnfusion/core/operators/op_define/result.hpp"
+#include "nnfusion/engine/async_manager.hpp"
+#include "nnfusion/engine/pass/codegen/cpu_codegen_pass.hpp"
+#include "nnfusion/engine/pass/tensor/liveness_analysis.hpp"
+
+DECLARE_bool(fcpu_constant_mmap);
+DECLARE_bool(fcpu_context_api);
+DECLARE_bool(fnuma_local_memory);
+DECLARE_int32(fnuma_node_num);
+
+using namespace nnfusion;
+using namespace nnfusion::graph;
+using namespace nnfusion::async;
+
+namespace
+{
+    // a translation unit running gnodes in order, gnodes[i] on streams[i]
+    std::shared_ptr<TranslationUnit>
+        make_translation_unit(std::shared_ptr<Graph> graph,
+                              const std::vector<std::shared_ptr<GNode>>& gnodes,
+                              const std::vector<std::string>& streams)
+    {
+        auto tu = std::make_shared<TranslationUnit>();
+        tu->m_graph = graph;
+        auto async_manager = AsyncManagerFactory::get_host_async_manager(graph, GENERIC_CPU);
+        auto bb = std::make_shared<ir::BasicBlock>();
+        for (size_t i = 0; i < gnodes.size(); i++)
+        {
+            auto gnode = gnodes[i];
+            for (size_t j = 0; j < gnode->get_output_size(); j++)
+                gnode->get_output_tensor_ptr(j)->set_device_type(GENERIC_CPU);
+            AsyncExecutionInfo async_info;
+            async_info.execution_thread = async_manager->set_stream(0, streams[i]);
+            (*gnode)["Async_info"] = async_info;
+            bb->push_back(std::make_shared<ir::Instruction>(gnode));
+        }
+        tu->program.push_back(bb);
+        return tu;
+    }
+
+    // a constant consumed by an add, the instructions run on the given streams in order
+    std::shared_ptr<TranslationUnit>
+        make_constant_consumer(const std::vector<std::string>& streams,
+                               std::shared_ptr<GNode>& constant)
+    {
+        auto graph = std::make_shared<Graph>();
+        constant = graph->add_node_and_edge(
+            std::make_shared<op::Constant>(element::f32, Shape{2}, std::vector<float>{1, 2}),
+            GNodeVector());
+        auto param = graph->add_node_and_edge(
+            std::make_shared<op::Parameter>(element::f32, Shape{2}), GNodeVector());
+        auto add =
+            graph->add_node_and_edge(std::make_shared<op::Add>(), GNodeVector({param, constant}));
+        graph->set_outputs({add});
+        return make_translation_unit(graph, {constant, param, add}, streams);
+    }
+}
+
+TEST(nnfusion_engine_liveness_analysis, constant_group_kept_after_consumer)
+{
+    std::shared_ptr<GNode> constant;
+    auto tu = make_constant_consumer({"default", "default", "default"}, constant);
+
+    auto saved_mmap = FLAGS_fcpu_constant_mmap;
+    FLAGS_fcpu_constant_mmap = true;
+    pass::TensorLivenessAnalysis().run(nullptr, tu);
+    FLAGS_fcpu_constant_mmap = saved_mmap;
+
+    // visiting the add must not move the constant back into the persistent pool
+    auto tensor = constant->get_output_tensor_ptr(0);
+    EXPECT_TRUE(tensor->is_persistent());
+    EXPECT_EQ(tensor->get_group(), "constant");
+}
+
+TEST(nnfusion_engine_liveness_analysis, numa_group_kept_after_consumer)
+{
+    // the add runs on stream 1, i.e. on the second of two NUMA nodes
+    std::shared_ptr<GNode> constant;
+    auto tu = make_constant_consumer({"default", "default", "numa1"}, constant);
+
+    auto saved_local_memory = FLAGS_fnuma_local_memory;
+    auto saved_node_num = FLAGS_fnuma_node_num;
+    FLAGS_fnuma_local_memory = true;
+    FLAGS_fnuma_node_num = 2;
+    pass::TensorLivenessAnalysis().run(nullptr, tu);
+    FLAGS_fnuma_local_memory = saved_local_memory;
+    FLAGS_fnuma_node_num = saved_node_num;
+
+    auto tensor = constant->get_output_tensor_ptr(0);
+    EXPECT_TRUE(tensor->is_persistent());
+    EXPECT_EQ(tensor->get_group(), "persist_numa1");
+}
+
+TEST(nnfusion_engine_liveness_analysis, context_group_for_results)
+{
+    auto graph = std::make_shared<Graph>();
+    auto constant = graph->add_node_and_edge(
+        std::make_shared<op::Constant>(element::f32, Shape{2}, std::vector<float>{1, 2}),
+        GNodeVector());
+    auto param = graph->add_node_and_edge(std::make_shared<op::Parameter>(element::f32, Shape{2}),
+                                          GNodeVector());
+    auto add =
+        graph->add_node_and_edge(std::make_shared<op::Add>(), GNodeVector({param, constant}));
+    auto result = graph->add_node_and_edge(std::make_shared<op::Result>(), GNodeVector({add}));
+    auto constant_result =
+        graph->add_node_and_edge(std::make_shared<op::Result>(), GNodeVector({constant}));
+    graph->set_outputs({result, constant_result});
+    auto tu = make_translation_unit(graph,
+                                    {constant, param, add, result, constant_result},
+                                    {"default", "default", "default", "default", "default"});
+
+    auto saved_context_api = FLAGS_fcpu_context_api;
+    FLAGS_fcpu_context_api = true;
+    pass::TensorLivenessAnalysis().run(nullptr, tu);
+    FLAGS_fcpu_context_api = saved_context_api;
+
+    // each context writes its own results, the constant filled by cpu_init stays shared
+    EXPECT_EQ(add->get_output_tensor_ptr(0)->get_group(), "persist_context");
+    EXPECT_EQ(result->get_output_tensor_ptr(0)->get_group(), "persist_context");
+    EXPECT_EQ(constant->get_output_tensor_ptr(0)->get_group(), "persist");
+    EXPECT_EQ(constant_result->get_output_tensor_ptr(0)->get_group(), "persist_context");
+}
+
+TEST(nnfusion_engine_liveness_analysis, context_pools)
+{
+    using codegen::CpuCodegenPass;
+    EXPECT_TRUE(CpuCodegenPass::is_context_pool("group_0"));
+    EXPECT_TRUE(CpuCodegenPass::is_context_pool("group_0_memset0"));
+    EXPECT_TRUE(CpuCodegenPass::is_context_pool("group_persist_context"));
+    // kernel_entry clears the memset pools, so a shared one would race between contexts
+    EXPECT_TRUE(CpuCodegenPass::is_context_pool("group_persist_memset0"));
+    EXPECT_FALSE(CpuCodegenPass::is_context_pool("group_persist"));
+    EXPECT_FALSE(CpuCodegenPass::is_context_pool("group_persist_numa1"));
+    EXPECT_FALSE(CpuCodegenPass::is_context_pool("group_constant"));
+}
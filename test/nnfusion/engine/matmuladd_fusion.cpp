@@ -0,0 +1,71 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+/**
+ * \brief Unit tests for the MatMulAdd fusion of a bias broadcast on CPU
+ */
+
+#include "../test_util/common.hpp"
+#include "gtest/gtest.h"
+#include "nnfusion/core/operators/op_define/add.hpp"
+#include "nnfusion/core/operators/op_define/broadcast.hpp"
+#include "nnfusion/core/operators/op_define/dot.hpp"
+#include "nnfusion/core/operators/op_define/parameter.hpp"
+#include "nnfusion/engine/pass/graph/subgraph_fusion_optimizer/matmuladd_fusion_optimizer.hpp"
+
+DECLARE_string(fdefault_device);
+
+using namespace nnfusion;
+using namespace nnfusion::graph;
+using namespace nnfusion::pass::graph;
+
+namespace
+{
+    // the bias input of the MatMulAdd fused from a square dot plus a bias broadcast on axes
+    std::shared_ptr<GNode> fuse_square_bias(const AxisSet& axes, std::shared_ptr<GNode>& bias)
+    {
+        auto graph = std::make_shared<Graph>();
+        auto a = graph->add_node_and_edge(
+            std::make_shared<op::Parameter>(element::f32, Shape{4, 4}), GNodeVector());
+        auto b = graph->add_node_and_edge(
+            std::make_shared<op::Parameter>(element::f32, Shape{4, 4}), GNodeVector());
+        bias = graph->add_node_and_edge(std::make_shared<op::Parameter>(element::f32, Shape{4}),
+                                        GNodeVector());
+        auto dot = graph->add_node_and_edge(std::make_shared<op::Dot>(), GNodeVector({a, b}));
+        auto broadcast = graph->add_node_and_edge(
+            std::make_shared<op::Broadcast>(Shape{4, 4}, axes), GNodeVector({bias}));
+        auto add =
+            graph->add_node_and_edge(std::make_shared<op::Add>(), GNodeVector({dot, broadcast}));
+        graph->set_outputs({add});
+
+        auto saved_device = FLAGS_fdefault_device;
+        FLAGS_fdefault_device = "CPU";
+        MatMulAddFusionOptimizer(graph).Optimize();
+        FLAGS_fdefault_device = saved_device;
+
+        for (auto gnode : graph->get_ordered_ops())
+        {
+            if (gnode->get_op_type() == "MatMulAdd")
+                return gnode->get_in_edge(2)->get_src();
+        }
+        return nullptr;
+    }
+}
+
+TEST(nnfusion_engine_matmuladd_fusion, row_bias_broadcast)
+{
+    std::shared_ptr<GNode> bias;
+    auto bias_input = fuse_square_bias(AxisSet{0}, bias);
+    ASSERT_NE(bias_input, nullptr);
+    // the kernel adds the bias to every row itself
+    EXPECT_EQ(bias_input, bias);
+}
+
+TEST(nnfusion_engine_matmuladd_fusion, column_bias_broadcast)
+{
+    std::shared_ptr<GNode> bias;
+    auto bias_input = fuse_square_bias(AxisSet{1}, bias);
+    ASSERT_NE(bias_input, nullptr);
+    // a column bias of the same length is not a row bias, the broadcast is kept
+    EXPECT_EQ(bias_input->get_op_type(), "Broadcast");
+}
@@ -0,0 +1,126 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+/**
+ * \brief Unit tests for memory allocation schemes
+ */
+
+#include <string>
+#include <vector>
+
+#include "../test_util/common.hpp"
+#include "gtest/gtest.h"
+#include "nnfusion/engine/memory_allocator.hpp"
+
+using namespace nnfusion;
+
+namespace
+{
+    shared_ptr<descriptor::Tensor> make_tensor(const std::string& name, size_t num_elements)
+    {
+        return make_shared<descriptor::Tensor>(element::f32,
+                                               PartialShape(Shape{num_elements}),
+                                               name,
+                                               GENERIC_CPU,
+                                               false,
+                                               false,
+                                               false,
+                                               false,
+                                               "0",
+                                               0);
+    }
+
+    // a and c are never alive together, d is an inplace view of c.
+    size_t run_trace(const std::string& scheme, std::vector<shared_ptr<descriptor::Tensor>>& ts)
+    {
+        auto saved_scheme = FLAGS_fmem_alloc_scheme;
+        FLAGS_fmem_alloc_scheme = scheme;
+        MemoryAllocatorFactory maf(1, false);
+        auto a = make_tensor("a", 4);
+        auto b = make_tensor("b", 4);
+        auto c = make_tensor("c", 8);
+        auto d = make_tensor("d", 2);
+        auto allocator = maf.get_allocator(a);
+        allocator->allocate(a);
+        allocator->allocate(b);
+        allocator->free(a);
+        allocator->allocate(c);
+        allocator->allocate(d, c, c->get_pool_offset() + 8);
+        allocator->free(b);
+        allocator->free(d);
+        allocator->free(c);
+        allocator->plan();
+        FLAGS_fmem_alloc_scheme = saved_scheme;
+        ts = {a, b, c, d};
+        return allocator->max_allocated();
+    }
+}
+
+TEST(nnfusion_engine_memory_allocator, greedy_by_size)
+{
+    std::vector<shared_ptr<descriptor::Tensor>> ts;
+    // first fit can not reuse the hole left by a for the larger c
+    EXPECT_EQ(run_trace("first_fit", ts), 64);
+    EXPECT_EQ(run_trace("greedy_by_size", ts), 48);
+
+    auto a = ts[0], b = ts[1], c = ts[2], d = ts[3];
+    EXPECT_EQ(c->get_pool_offset(), 0);
+    EXPECT_EQ(b->get_pool_offset(), 32);
+    EXPECT_EQ(a->get_pool_offset(), 0);
+    EXPECT_EQ(d->get_pool_offset(), c->get_pool_offset() + 8);
+}
+
+TEST(nnfusion_engine_memory_allocator, numa_local_pools)
+{
+    MemoryAllocatorFactory maf(1, false);
+    maf.set_numa_node_num(2);
+    EXPECT_EQ(maf.get_numa_node("3"), 1);
+    EXPECT_EQ(maf.get_numa_node("persist_numa0"), 0);
+    EXPECT_EQ(maf.get_numa_node("persist"), -1);
+
+    auto a = make_tensor("a", 4);
+    a->set_group("3");
+    auto allocator = dynamic_cast<HostMemoryAllocator*>(maf.get_allocator(a));
+    ASSERT_NE(allocator, nullptr);
+    EXPECT_EQ(allocator->get_numa_node(), 1);
+    allocator->allocate(a);
+    auto code = allocator->emit_memory_alloc()->get_code();
+    EXPECT_NE(code.find("MAP_ANONYMOUS"), std::string::npos);
+    EXPECT_NE(code.find("worker_thread_pool->ScheduleSync"), std::string::npos);
+}
+
+TEST(nnfusion_engine_memory_allocator, grouped_interval)
+{
+    auto saved_scheme = FLAGS_fmem_alloc_scheme;
+    auto saved_trace = FLAGS_fmem_trace;
+    FLAGS_fmem_alloc_scheme = "greedy_by_size";
+    FLAGS_fmem_trace = true;
+    MemoryAllocatorFactory maf(1, false);
+    auto a = make_tensor("a", 4);
+    auto b = make_tensor("b", 4);
+    auto c = make_tensor("c", 8);
+    auto allocator = maf.get_allocator(a);
+    std::vector<shared_ptr<descriptor::Tensor>> group{a, b};
+    allocator->allocate(group);
+    allocator->free(a);
+    // b is still alive, so c can not reuse the interval of a and b
+    allocator->allocate(c);
+    allocator->free(c);
+    allocator->free(b);
+    allocator->plan();
+    FLAGS_fmem_alloc_scheme = saved_scheme;
+    FLAGS_fmem_trace = saved_trace;
+
+    EXPECT_EQ(allocator->max_allocated(), 64);
+    EXPECT_EQ(b->get_pool_offset(), a->get_pool_offset() + 16);
+    EXPECT_TRUE(c->get_pool_offset() >= b->get_pool_offset() + 16 ||
+                c->get_pool_offset() + 32 <= a->get_pool_offset());
+
+    std::stringstream trace;
+    allocator->dump(trace);
+    size_t frees = 0;
+    for (size_t at = trace.str().find("[free]"); at != std::string::npos;
+         at = trace.str().find("[free]", at + 1))
+        frees++;
+    EXPECT_EQ(frees, 3);
+}
@@ -0,0 +1,113 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+/**
+ * \brief Unit tests for the concurrent kernel emission of -fcodegen_threads
+ */
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "../test_util/common.hpp"
+#include "gtest/gtest.h"
+#include "nnfusion/core/operators/op_define/abs.hpp"
+#include "nnfusion/core/operators/op_define/add.hpp"
+#include "nnfusion/core/operators/op_define/exp.hpp"
+#include "nnfusion/core/operators/op_define/multiply.hpp"
+#include "nnfusion/core/operators/op_define/parameter.hpp"
+#include "nnfusion/core/operators/op_define/relu.hpp"
+#include "nnfusion/engine/pass/codegen/cpu_codegen_pass.hpp"
+
+DECLARE_int32(fcodegen_threads);
+
+using namespace nnfusion;
+using namespace nnfusion::graph;
+using namespace nnfusion::kernels;
+
+namespace
+{
+    class EmitCodegenPass : public codegen::CpuCodegenPass
+    {
+    public:
+        using CpuCodegenPass::emit_kernel_sources;
+    };
+
+    // Emits the kernels of a small graph like the codegen does, with threads emitting before
+    // the serial loop. Returns the sources in program order, each kernel name replaced by its
+    // index since the names hold the unique names of the ops.
+    std::vector<std::string> emit_sources(int threads)
+    {
+        auto graph = std::make_shared<Graph>();
+        Shape shape{4, 37};
+        auto a = graph->add_node_and_edge(std::make_shared<op::Parameter>(element::f32, shape),
+                                          GNodeVector());
+        auto b = graph->add_node_and_edge(std::make_shared<op::Parameter>(element::f32, shape),
+                                          GNodeVector());
+        auto add = graph->add_node_and_edge(std::make_shared<op::Add>(), GNodeVector({a, b}));
+        auto relu = graph->add_node_and_edge(std::make_shared<op::Relu>(), GNodeVector({add}));
+        auto exp = graph->add_node_and_edge(std::make_shared<op::Exp>(), GNodeVector({relu}));
+        auto abs = graph->add_node_and_edge(std::make_shared<op::Abs>(), GNodeVector({a}));
+        auto multiply =
+            graph->add_node_and_edge(std::make_shared<op::Multiply>(), GNodeVector({exp, abs}));
+        graph->set_outputs({multiply});
+
+        // an instruction per kernel of each op, so that every kind of emitter runs
+        auto tu = std::make_shared<TranslationUnit>();
+        tu->m_graph = graph;
+        auto bb = std::make_shared<ir::BasicBlock>();
+        std::vector<KernelEmitter::Pointer> kernels;
+        for (auto gnode : {add, relu, exp, abs, multiply})
+        {
+            for (auto& kernel_reg : KernelRegistry::Global()->FindKernelRegistrations(
+                     gnode->get_op_type(), GENERIC_CPU, element::f32))
+            {
+                auto ins = std::make_shared<ir::Instruction>(gnode);
+                auto kernel = kernel_reg->m_factory(std::make_shared<KernelContext>(gnode));
+                ins->setKernel(kernel);
+                bb->push_back(ins);
+                kernels.push_back(kernel);
+            }
+        }
+        tu->program.push_back(bb);
+
+        auto saved_threads = FLAGS_fcodegen_threads;
+        FLAGS_fcodegen_threads = threads;
+        EmitCodegenPass().emit_kernel_sources(tu);
+        FLAGS_fcodegen_threads = saved_threads;
+        for (auto& kernel : kernels)
+            EXPECT_EQ(kernel->is_emitted(), threads > 1);
+
+        std::vector<std::string> sources;
+        for (size_t i = 0; i < kernels.size(); i++)
+        {
+            auto fu = kernels[i]->get_or_emit_source();
+            if (!fu)
+            {
+                sources.push_back("");
+                continue;
+            }
+            std::string source = fu->signature_unit->get_code() + fu->body_unit->get_code();
+            std::vector<std::string> deps(fu->dep_unit->required.begin(),
+                                          fu->dep_unit->required.end());
+            std::sort(deps.begin(), deps.end());
+            source += join(deps, "\n");
+            std::string name = fu->name_unit->get_code();
+            for (auto pos = source.find(name); pos != std::string::npos;
+                 pos = source.find(name, pos))
+                source.replace(pos, name.size(), "kernel_" + std::to_string(i));
+            sources.push_back(source);
+        }
+        return sources;
+    }
+}
+
+TEST(nnfusion_engine_parallel_codegen, same_sources_as_serial)
+{
+    auto serial = emit_sources(1);
+    auto parallel = emit_sources(4);
+    ASSERT_EQ(serial.size(), parallel.size());
+    EXPECT_GT(serial.size(), 5);
+    for (size_t i = 0; i < serial.size(); i++)
+        EXPECT_EQ(parallel[i], serial[i]) << "kernel " << i;
+}
@@ -0,0 +1,61 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+/**
+ * \brief Unit tests for pass-level tracing of the engine pipeline
+ */
+
+#include <fstream>
+#include <sstream>
+
+#include "../test_util/common.hpp"
+#include "gtest/gtest.h"
+#include "nnfusion/core/operators/op_define/parameter.hpp"
+#include "nnfusion/core/operators/op_define/relu.hpp"
+#include "nnfusion/engine/pass_tracer.hpp"
+
+using namespace nnfusion;
+using namespace nnfusion::graph;
+
+TEST(nnfusion_engine_pass_tracer, records_and_chrome_trace)
+{
+    auto graph = std::make_shared<Graph>();
+    auto a = graph->add_node_and_edge(std::make_shared<op::Parameter>(element::f32, Shape{4}),
+                                      GNodeVector());
+
+    std::string path = "pass_tracer_test.json";
+    PassTracer tracer(true, path);
+    {
+        PassTracer::Scope outer(tracer, "OuterPass", "graph_pass", graph);
+        PassTracer::Scope inner(tracer, "InnerPass", "graph_pass", graph);
+        graph->add_node_and_edge(std::make_shared<op::Relu>(), GNodeVector({a}));
+    }
+    PassTracer::Scope unfinished(tracer, "ExitingPass", "interpreter_pass", graph);
+    tracer.finish();
+
+    auto& records = tracer.get_records();
+    ASSERT_EQ(records.size(), 3);
+    EXPECT_EQ(records[0].name, "OuterPass");
+    EXPECT_EQ(records[1].depth, 1);
+    EXPECT_EQ(records[1].nodes_before, 1);
+    EXPECT_EQ(records[1].nodes_after, 2);
+    EXPECT_EQ(records[1].edges_after, records[1].edges_before + 1);
+    EXPECT_TRUE(records[0].finished);
+    EXPECT_FALSE(records[2].finished);
+    EXPECT_GE(records[0].duration_us, records[1].duration_us);
+
+    std::ifstream in(path);
+    std::stringstream trace;
+    trace << in.rdbuf();
+    EXPECT_NE(trace.str().find("\"traceEvents\""), std::string::npos);
+    EXPECT_NE(trace.str().find("\"name\": \"InnerPass\""), std::string::npos);
+    std::remove(path.c_str());
+
+    std::stringstream summary;
+    tracer.dump_summary(summary);
+    EXPECT_NE(summary.str().find("ExitingPass"), std::string::npos);
+
+    PassTracer disabled;
+    EXPECT_EQ(disabled.begin("Pass", "graph_pass", graph), -1);
+    EXPECT_TRUE(disabled.get_records().empty());
+}
@@ -6,12 +6,16 @@
  * \author wenxh
  */
 
+#include <chrono>
+#include <fstream>
 #include <set>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "../test_util/common.hpp"
 #include "gtest/gtest.h"
+#include "nnfusion/engine/profiler/library_cache.hpp"
 #include "nnfusion/engine/profiler/profiler.hpp"
 
 using namespace nnfusion::profiler;
@@ -63,4 +67,44 @@ TEST(nnfusion_engine_profiler, basic_utils)
         }
     }
     EXPECT_TRUE(has_valid_kernel);
-}
\ No newline at end of file
+}
+TEST(nnfusion_engine_profiler, library_cache)
+{
+    // the missing parents are created as well
+    std::string dir = "profiler_library_cache_test/nested";
+    auto write_lib = [](const std::string& path, size_t size) {
+        std::ofstream out(path, std::ios::binary);
+        out << std::string(size, 'x');
+    };
+
+    // room for two libraries of 1KB
+    LibraryCache cache(dir, 2048);
+    ASSERT_TRUE(cache.is_enabled());
+    auto key_a = cache.get_key("source_a", "-O3");
+    EXPECT_EQ(key_a, cache.get_key("source_a", "-O3"));
+    EXPECT_NE(key_a, cache.get_key("source_a", "-O0"));
+    EXPECT_TRUE(cache.lookup(key_a).empty());
+
+    std::vector<std::string> keys;
+    for (auto source : {"source_a", "source_b", "source_c"})
+    {
+        // file timestamps are coarse
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        write_lib("library_cache_test.so", 1024);
+        keys.push_back(cache.get_key(source, "-O3"));
+        auto path = cache.insert(keys.back(), "library_cache_test.so");
+        EXPECT_EQ(path, cache.lookup(keys.back()));
+        // a hit on a makes b the least recently used
+        if (keys.size() == 2)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            EXPECT_FALSE(cache.lookup(keys[0]).empty());
+        }
+    }
+    EXPECT_FALSE(cache.lookup(keys[0]).empty());
+    EXPECT_TRUE(cache.lookup(keys[1]).empty());
+    EXPECT_FALSE(cache.lookup(keys[2]).empty());
+
+    std::remove("library_cache_test.so");
+    EXPECT_EQ(system("rm -rf profiler_library_cache_test"), 0);
+}
@@ -0,0 +1,131 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+/**
+ * \brief Unit tests for the -fshape_buckets dispatcher on stub bucket runtimes
+ */
+
+#include <dlfcn.h>
+#include <unistd.h>
+
+#include <climits>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "../test_util/common.hpp"
+#include "gtest/gtest.h"
+#include "nnfusion/engine/pass/codegen/cpu_bucket_codegen.hpp"
+
+using namespace nnfusion::codegen;
+
+namespace
+{
+    // A bucket runtime of y = 2 * x + 1 on x of shape [2, seq], which also reports its index.
+    // Like the generated runtimes, the first bucket creates the worker pool and the others
+    // borrow it.
+    void write_bucket(const std::string& folder, size_t seq, int index)
+    {
+        NNFUSION_CHECK(create_folder(folder));
+        nlohmann::json para_info;
+        para_info["input"]["x"] = {
+            {"name", "x"}, {"id", "((float*)(inputs[0]))"}, {"shape", {2, seq}}};
+        para_info["output"]["y"] = {
+            {"name", "y"}, {"id", "((float*)(outputs[0]))"}, {"shape", {2, seq}}};
+        para_info["output"]["bucket"] = {
+            {"name", "bucket"}, {"id", "((int64_t*)(outputs[1]))"}, {"shape", {1}}};
+        std::ofstream(folder + "para_info.json") << para_info;
+
+        std::ofstream(folder + "nnfusion_rt.cpp")
+            << "#include <stdint.h>\n"
+            << "static int* pool = nullptr;\nstatic bool own_pool = false;\n"
+            << "extern \"C\" int64_t cpu_workspace_size() { return 64; }\n"
+            << "extern \"C\" void cpu_set_workspace(char*) {}\n"
+            << "extern \"C\" void cpu_set_constants(char**) {}\n"
+            << "extern \"C\" void* cpu_get_worker_thread_pool() { return pool; }\n"
+            << "extern \"C\" void cpu_set_worker_thread_pool(void* p) { pool = (int*)p; }\n"
+            << "extern \"C\" void cpu_init()\n{\n"
+            << "    if (!pool) { pool = new int(0); own_pool = true; }\n}\n"
+            << "extern \"C\" void cpu_free()\n{\n"
+            << "    if (own_pool) delete pool;\n    pool = nullptr;\n    own_pool = false;\n}\n"
+            << "extern \"C\" int kernel_entry(float* x, float* y, int64_t* bucket)\n{\n"
+            << "    for (int i = 0; i < " << 2 * seq << "; i++)\n"
+            << "        y[i] = 2 * x[i] + 1;\n"
+            << "    *bucket = " << index << ";\n    return 0;\n}\n";
+        std::string cmd = "g++ -std=c++11 -shared -fPIC -o " + folder + "libnnfusion_cpu_rt.so " +
+                          folder + "nnfusion_rt.cpp";
+        NNFUSION_CHECK(system(cmd.c_str()) == 0) << "Failed to compile " << folder;
+    }
+}
+
+TEST(nnfusion_engine_shape_buckets, dispatch)
+{
+    std::string folder = "shape_buckets_test/";
+    ASSERT_EQ(system(("rm -rf " + folder).c_str()), 0);
+    ASSERT_TRUE(create_folder(folder));
+    std::vector<ShapeBucket> buckets = {{{{"seq", 4}}, "bucket_0"}, {{{"seq", 8}}, "bucket_1"}};
+    for (int b = 0; b < 2; b++)
+        write_bucket(folder + buckets[b].folder + "/", buckets[b].dims["seq"], b);
+    generate_cpu_bucket_dispatcher(folder, buckets);
+    std::string cmd = "g++ -std=gnu++11 -shared -fPIC -o " + folder + "libnnfusion_cpu_rt.so " +
+                      folder + "nnfusion_rt.cpp -ldl";
+    ASSERT_EQ(system(cmd.c_str()), 0);
+
+    char cwd[PATH_MAX];
+    ASSERT_NE(getcwd(cwd, sizeof(cwd)), nullptr);
+    std::string lib = std::string(cwd) + "/" + folder + "libnnfusion_cpu_rt.so";
+    void* handle = dlopen(lib.c_str(), RTLD_NOW | RTLD_LOCAL);
+    ASSERT_NE(handle, nullptr) << dlerror();
+    auto cpu_init = (void (*)())dlsym(handle, "cpu_init");
+    auto cpu_free = (void (*)())dlsym(handle, "cpu_free");
+    auto entry = (int (*)(const int64_t*, float*, float*, int64_t*))dlsym(
+        handle, "kernel_entry_dynamic");
+    ASSERT_TRUE(cpu_init && cpu_free && entry);
+
+    // the buckets are loaded relative to the working directory
+    ASSERT_EQ(chdir(folder.c_str()), 0);
+    cpu_init();
+    ASSERT_EQ(chdir(cwd), 0);
+
+    // the second bucket borrows the worker pool of the first
+    std::vector<void*> pools;
+    for (auto& bucket : buckets)
+    {
+        std::string path =
+            std::string(cwd) + "/" + folder + bucket.folder + "/libnnfusion_cpu_rt.so";
+        void* bucket_handle = dlopen(path.c_str(), RTLD_NOW | RTLD_NOLOAD);
+        ASSERT_NE(bucket_handle, nullptr);
+        pools.push_back(((void* (*)())dlsym(bucket_handle, "cpu_get_worker_thread_pool"))());
+        dlclose(bucket_handle);
+    }
+    EXPECT_NE(pools[0], nullptr);
+    EXPECT_EQ(pools[0], pools[1]);
+
+    // the smallest bucket fitting seq runs on x zero padded to it, y is cropped back
+    for (auto seq_bucket : {std::make_pair(1, 0), std::make_pair(4, 0), std::make_pair(5, 1),
+                            std::make_pair(8, 1)})
+    {
+        int64_t seq = seq_bucket.first;
+        std::vector<float> x, y(2 * seq + 1, -7.0f);
+        for (int64_t i = 0; i < 2 * seq; i++)
+            x.push_back(0.5f * i - 3);
+        int64_t bucket = -1;
+        EXPECT_EQ(entry(&seq, x.data(), y.data(), &bucket), 0) << "seq " << seq;
+        EXPECT_EQ(bucket, seq_bucket.second) << "seq " << seq;
+        for (int64_t i = 0; i < 2 * seq; i++)
+            EXPECT_EQ(y[i], 2 * x[i] + 1) << "seq " << seq << ", element " << i;
+        EXPECT_EQ(y[2 * seq], -7.0f) << "seq " << seq;
+    }
+
+    // no bucket fits
+    for (int64_t seq : {0, 9})
+    {
+        std::vector<float> x(2 * seq + 2), y(2 * seq + 2);
+        int64_t bucket = -1;
+        EXPECT_EQ(entry(&seq, x.data(), y.data(), &bucket), -1) << "seq " << seq;
+    }
+
+    cpu_free();
+    dlclose(handle);
+    EXPECT_EQ(system(("rm -rf " + folder).c_str()), 0);
+}
@@ -0,0 +1,73 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+/**
+ * \brief Unit tests for the Attention generic op
+ */
+
+#include "../test_util/common.hpp"
+#include "nnfusion/core/operators/generic_op/generic_op.hpp"
+
+namespace nnfusion
+{
+    namespace inventory
+    {
+        template <>
+        shared_ptr<graph::GNode> create_object<generic::Attention, float>(int option)
+        {
+            switch (option)
+            {
+            case 0:
+            {
+                // one batch of two tokens, one head of size 2
+                auto graph = std::make_shared<graph::Graph>();
+                auto A = make_shared<op::Parameter>(element::f32, Shape{2, 6});
+                auto A_gnode = graph->add_node_and_edge(A, GNodeVector({}));
+                op::OpConfig::any config;
+                config["num_heads"] = 1;
+                config["batch_size"] = 1;
+                config["sequence_length"] = 2;
+                config["head_size"] = 2;
+                auto r = make_shared<op::GenericOp>("attention", "Attention", config);
+                auto r_gnode = graph->add_node_and_edge(r, {A_gnode});
+                return r_gnode;
+            }
+            default: return nullptr;
+            }
+        }
+
+        template <>
+        vector<float> generate_input<generic::Attention, float>(int option)
+        {
+            switch (option)
+            {
+            case 0:
+            {
+                // each row holds q, k and v of a token
+                vector<float> qkv{1, 0, 1, 0, 1, 2, 0, 1, 0, 1, 3, 4};
+                auto return_vector = vector<float>();
+                return_vector.insert(return_vector.end(), qkv.begin(), qkv.end());
+                return return_vector;
+            }
+            default: return vector<float>();
+            }
+        }
+
+        template <>
+        vector<float> generate_output<generic::Attention, float>(int option)
+        {
+            switch (option)
+            {
+            case 0:
+            {
+                // softmax(q * k' / sqrt(2)) * v
+                vector<float> result{1.6604769f, 2.6604769f, 2.3395231f, 3.3395231f};
+                auto return_vector = vector<float>();
+                return_vector.insert(return_vector.end(), result.begin(), result.end());
+                return return_vector;
+            }
+            default: return vector<float>();
+            }
+        }
+    }
+}
@@ -0,0 +1,76 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+/**
+ * \brief Unit tests for the GatherV2 generic op
+ */
+
+#include <cstring>
+
+#include "../test_util/common.hpp"
+#include "nnfusion/core/operators/generic_op/generic_op.hpp"
+
+namespace nnfusion
+{
+    namespace inventory
+    {
+        template <>
+        shared_ptr<graph::GNode> create_object<generic::GatherV2, float>(int option)
+        {
+            switch (option)
+            {
+            case 0:
+            {
+                auto graph = std::make_shared<graph::Graph>();
+                auto A = make_shared<op::Parameter>(element::f32, Shape{3, 2});
+                auto A_gnode = graph->add_node_and_edge(A, GNodeVector({}));
+                auto I = make_shared<op::Parameter>(element::i32, Shape{3});
+                auto I_gnode = graph->add_node_and_edge(I, GNodeVector({}));
+                op::OpConfig::any config;
+                config["axis"] = 0;
+                auto r = make_shared<op::GenericOp>("gather", "GatherV2", config);
+                auto r_gnode = graph->add_node_and_edge(r, {A_gnode, I_gnode});
+                return r_gnode;
+            }
+            default: return nullptr;
+            }
+        }
+
+        template <>
+        vector<float> generate_input<generic::GatherV2, float>(int option)
+        {
+            switch (option)
+            {
+            case 0:
+            {
+                // the int32 indices are passed bitwise in the float input, -1 is the last row
+                vector<float> a{1, 2, 3, 4, 5, 6};
+                vector<int32_t> indices{2, 0, -1};
+                vector<float> i(indices.size());
+                memcpy(i.data(), indices.data(), indices.size() * sizeof(int32_t));
+                auto return_vector = vector<float>();
+                return_vector.insert(return_vector.end(), a.begin(), a.end());
+                return_vector.insert(return_vector.end(), i.begin(), i.end());
+                return return_vector;
+            }
+            default: return vector<float>();
+            }
+        }
+
+        template <>
+        vector<float> generate_output<generic::GatherV2, float>(int option)
+        {
+            switch (option)
+            {
+            case 0:
+            {
+                vector<float> result{5, 6, 1, 2, 5, 6};
+                auto return_vector = vector<float>();
+                return_vector.insert(return_vector.end(), result.begin(), result.end());
+                return return_vector;
+            }
+            default: return vector<float>();
+            }
+        }
+    }
+}
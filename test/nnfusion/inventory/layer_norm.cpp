@@ -0,0 +1,84 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+/**
+ * \brief Unit tests for the LayerNorm generic op
+ */
+
+#include "../test_util/common.hpp"
+#include "nnfusion/core/operators/generic_op/generic_op.hpp"
+
+namespace nnfusion
+{
+    namespace inventory
+    {
+        template <>
+        shared_ptr<graph::GNode> create_object<generic::LayerNorm, float>(int option)
+        {
+            switch (option)
+            {
+            case 0:
+            {
+                auto graph = std::make_shared<graph::Graph>();
+                auto X = make_shared<op::Parameter>(element::f32, Shape{2, 4});
+                auto X_gnode = graph->add_node_and_edge(X, GNodeVector({}));
+                auto G = make_shared<op::Parameter>(element::f32, Shape{4});
+                auto G_gnode = graph->add_node_and_edge(G, GNodeVector({}));
+                auto B = make_shared<op::Parameter>(element::f32, Shape{4});
+                auto B_gnode = graph->add_node_and_edge(B, GNodeVector({}));
+                op::OpConfig::any config;
+                config["axis"] = -1;
+                config["epsilon"] = 1e-5f;
+                auto r = make_shared<op::GenericOp>("layer_norm", "LayerNorm", config);
+                auto r_gnode = graph->add_node_and_edge(r, {X_gnode, G_gnode, B_gnode});
+                return r_gnode;
+            }
+            default: return nullptr;
+            }
+        }
+
+        template <>
+        vector<float> generate_input<generic::LayerNorm, float>(int option)
+        {
+            switch (option)
+            {
+            case 0:
+            {
+                // the first row has a mean far larger than its deviation
+                vector<float> x{10000, 10001, 10002, 10003, 1, 2, 3, 4};
+                vector<float> gamma{1, 2, 1, 2};
+                vector<float> beta{0, 0, 1, 1};
+                auto return_vector = vector<float>();
+                return_vector.insert(return_vector.end(), x.begin(), x.end());
+                return_vector.insert(return_vector.end(), gamma.begin(), gamma.end());
+                return_vector.insert(return_vector.end(), beta.begin(), beta.end());
+                return return_vector;
+            }
+            default: return vector<float>();
+            }
+        }
+
+        template <>
+        vector<float> generate_output<generic::LayerNorm, float>(int option)
+        {
+            switch (option)
+            {
+            case 0:
+            {
+                vector<float> result{-1.3416355f,
+                                     -0.8944236f,
+                                     1.4472119f,
+                                     3.6832709f,
+                                     -1.3416355f,
+                                     -0.8944236f,
+                                     1.4472119f,
+                                     3.6832709f};
+                auto return_vector = vector<float>();
+                return_vector.insert(return_vector.end(), result.begin(), result.end());
+                return return_vector;
+            }
+            default: return vector<float>();
+            }
+        }
+    }
+}
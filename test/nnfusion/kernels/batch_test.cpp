@@ -124,6 +124,12 @@ TEST(nnfusion_core_kernels, batch_kernel_tests_arg_min)
 }
 */
 
+TEST(nnfusion_core_kernels, batch_kernel_tests_attention)
+{
+    EXPECT_TRUE(nnfusion::test::check_kernels<nnfusion::inventory::generic::Attention>(
+        GENERIC_CPU, element::f32));
+}
+
 TEST(nnfusion_core_kernels, batch_kernel_tests_broadcast)
 {
     EXPECT_TRUE(nnfusion::test::check_kernels<nnfusion::op::Broadcast>(GENERIC_CPU, element::f32));
@@ -175,6 +181,12 @@ TEST(nnfusion_core_kernels, batch_kernel_tests_floor)
     EXPECT_TRUE(nnfusion::test::check_kernels<nnfusion::op::Floor>(CUDA_GPU, element::f32));
 }
 
+TEST(nnfusion_core_kernels, batch_kernel_tests_gather_v2)
+{
+    EXPECT_TRUE(nnfusion::test::check_kernels<nnfusion::inventory::generic::GatherV2>(
+        GENERIC_CPU, element::f32));
+}
+
 /* TODO: return type is bool, enable if bool data type is supported, the test case data type should also be modified 
 TEST(nnfusion_core_kernels, batch_kernel_tests_greater)
 {
@@ -201,6 +213,12 @@ TEST(nnfusion_core_kernels, batch_kernel_tests_less_eq)
 }
 */
 
+TEST(nnfusion_core_kernels, batch_kernel_tests_layer_norm)
+{
+    EXPECT_TRUE(nnfusion::test::check_kernels<nnfusion::inventory::generic::LayerNorm>(
+        GENERIC_CPU, element::f32));
+}
+
 TEST(nnfusion_core_kernels, batch_kernel_tests_max)
 {
     EXPECT_TRUE(nnfusion::test::check_kernels<nnfusion::op::Max>(GENERIC_CPU, element::f32));
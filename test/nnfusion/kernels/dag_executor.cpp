@@ -0,0 +1,144 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+///\brief Test of the DagExecutor of -fcpu_dag_schedule running a branching graph repeatedly
+
+#include <fstream>
+#include <string>
+
+#include "../test_util/common.hpp"
+#include "gtest/gtest.h"
+#include "nnfusion/core/kernels/cpu/barrier.hpp"
+#include "nnfusion/core/kernels/cpu/dag_executor.hpp"
+
+namespace
+{
+    // a stand-in for the thread pool of the runtime, whose workers run the tasks in the order
+    // they are scheduled
+    const char* thread_pool_header = R"(#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace concurrency
+{
+    class NumaAwareThreadPool
+    {
+    public:
+        NumaAwareThreadPool()
+        {
+            for (int i = 0; i < 4; i++)
+                workers_.emplace_back([this]() { Work(); });
+        }
+        ~NumaAwareThreadPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stop_ = true;
+            }
+            cv_.notify_all();
+            for (auto& worker : workers_)
+                worker.join();
+        }
+        void Schedule(std::function<void()> fn, int numa_node = 0)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                queue_.push_back(std::move(fn));
+            }
+            cv_.notify_one();
+        }
+
+    private:
+        void Work()
+        {
+            while (true)
+            {
+                std::function<void()> fn;
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    cv_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+                    if (queue_.empty())
+                        return;
+                    fn = std::move(queue_.front());
+                    queue_.pop_front();
+                }
+                fn();
+            }
+        }
+        std::vector<std::thread> workers_;
+        std::deque<std::function<void()>> queue_;
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        bool stop_ = false;
+    };
+}
+)";
+
+    // Two roots, a diamond and a join with an early branch, run like the DAG mode of the
+    // generated runtime and checked against the same kernels run in program order.
+    const char* test_source = R"(#include <cstdio>
+#include "dag_executor.h"
+
+const int n = 1024;
+float a[n], b[n], c[n], d[n], e[n], f[n], g[n], expected[n];
+
+void times_two() { for (int i = 0; i < n; i++) b[i] = a[i] * 2; }
+void plus_one() { for (int i = 0; i < n; i++) c[i] = a[i] + 1; }
+void add() { for (int i = 0; i < n; i++) d[i] = b[i] + c[i]; }
+void square() { for (int i = 0; i < n; i++) e[i] = b[i] * b[i]; }
+void subtract() { for (int i = 0; i < n; i++) f[i] = d[i] - e[i]; }
+void join() { for (int i = 0; i < n; i++) g[i] = f[i] * c[i]; }
+
+int main()
+{
+    concurrency::NumaAwareThreadPool pool;
+    nnfusion::cpu::DagExecutor executor(&pool);
+    int t0 = executor.AddTask(times_two, {});
+    int t1 = executor.AddTask(plus_one, {});
+    int t2 = executor.AddTask(add, {t0, t1});
+    int t3 = executor.AddTask(square, {t0});
+    int t4 = executor.AddTask(subtract, {t2, t3});
+    executor.AddTask(join, {t4, t1});
+    for (int run = 0; run < 200; run++)
+    {
+        for (int i = 0; i < n; i++)
+            a[i] = float((i * 7 + run) % 13) - 6;
+        times_two(); plus_one(); add(); square(); subtract(); join();
+        for (int i = 0; i < n; i++)
+            expected[i] = g[i];
+        for (int i = 0; i < n; i++)
+            b[i] = c[i] = d[i] = e[i] = f[i] = g[i] = -1;
+        executor.Run();
+        for (int i = 0; i < n; i++)
+        {
+            if (g[i] != expected[i])
+            {
+                printf("run %d, element %d: %f != %f\n", run, i, g[i], expected[i]);
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+)";
+}
+
+TEST(nnfusion_core_kernels, dag_executor_repeated_runs)
+{
+    std::string folder = "dag_executor_test/";
+    ASSERT_EQ(system(("rm -rf " + folder).c_str()), 0);
+    ASSERT_TRUE(nnfusion::codegen::create_folder(folder));
+    std::ofstream(folder + "numa_aware_threadpool.h") << thread_pool_header;
+    std::ofstream(folder + "barrier.h") << nnfusion::kernels::barrier_header->get_code();
+    std::ofstream(folder + "dag_executor.h") << nnfusion::kernels::dag_executor_header->get_code();
+    std::ofstream(folder + "main.cpp") << test_source;
+
+    std::string cmd = "g++ -std=c++11 -O2 -pthread -o " + folder + "main " + folder + "main.cpp";
+    ASSERT_EQ(system(cmd.c_str()), 0);
+    EXPECT_EQ(system(("./" + folder + "main").c_str()), 0);
+    EXPECT_EQ(system(("rm -rf " + folder).c_str()), 0);
+}
@@ -0,0 +1,36 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+///\brief Test of the int8 conversions of the CPU elementwise kernels
+
+#include <vector>
+
+#include "../test_util/common.hpp"
+#include "gtest/gtest.h"
+#include "nnfusion/core/operators/op_define/add.hpp"
+#include "nnfusion/engine/profiler/profiler.hpp"
+
+using namespace nnfusion::profiler;
+
+TEST(nnfusion_core_kernels, add_int8_tail)
+{
+    // 11 elements are not a multiple of any vector width, the last ones run the scalar tail
+    auto graph = std::make_shared<graph::Graph>();
+    Shape shape{11};
+    auto A = make_shared<op::Parameter>(element::i8, shape);
+    auto A_gnode = graph->add_node_and_edge(A, GNodeVector({}));
+    auto B = make_shared<op::Parameter>(element::i8, shape);
+    auto B_gnode = graph->add_node_and_edge(B, GNodeVector({}));
+    auto gnode = graph->add_node_and_edge(make_shared<op::Add>(), {A_gnode, B_gnode});
+
+    // the sums past 127 wrap around in the vector body and in the tail alike
+    vector<int8_t> IN, OUT;
+    for (int i = 0; i < 11; i++)
+        IN.push_back(int8_t(100 + i));
+    for (int i = 0; i < 11; i++)
+        IN.push_back(int8_t(20 + i));
+    for (int i = 0; i < 11; i++)
+        OUT.push_back(int8_t(uint8_t(120 + 2 * i)));
+
+    EXPECT_TRUE(nnfusion::test::check_kernel<int8_t>(gnode, GENERIC_CPU, IN, OUT));
+}
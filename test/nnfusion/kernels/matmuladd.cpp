@@ -0,0 +1,108 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+///\brief Test of the tiled MatMulAdd MLAS kernel against Dot followed by Add and the activation
+
+#include <cmath>
+#include <vector>
+
+#include "../test_util/common.hpp"
+#include "gtest/gtest.h"
+#include "nnfusion/core/operators/generic_op/generic_op.hpp"
+#include "nnfusion/core/operators/op_define/dot.hpp"
+#include "nnfusion/engine/profiler/profiler.hpp"
+
+using namespace nnfusion::profiler;
+
+namespace
+{
+    vector<float> run_mlas(shared_ptr<GNode> gnode, const vector<float>& IN)
+    {
+        shared_ptr<KernelContext> ctx(new KernelContext(gnode));
+        for (auto& kernel_reg : KernelRegistry::Global()->FindKernelRegistrations(
+                 gnode->get_op_type(), GENERIC_CPU, element::f32))
+        {
+            if (kernel_reg->m_tag != "mlas")
+                continue;
+            auto kernel = kernel_reg->m_factory(ctx);
+            if (!kernel->get_or_emit_source())
+                return vector<float>();
+            auto pctx = make_shared<ProfilingContext>(kernel);
+            pctx->runtime_times = 1;
+            pctx->warmup_times = 0;
+            Profiler prof(get_default_runtime(GENERIC_CPU), pctx);
+            auto res = prof.unsafe_execute<float>((void*)IN.data());
+            return res.empty() ? vector<float>() : res[0];
+        }
+        return vector<float>();
+    }
+
+    vector<float> make_input(size_t size, float scale)
+    {
+        vector<float> input;
+        for (size_t i = 0; i < size; i++)
+            input.push_back(scale * (int(i * 37 + 11) % 19 - 9));
+        return input;
+    }
+}
+
+TEST(nnfusion_core_kernels, mlas_matmuladd)
+{
+    // neither M nor N are multiples of the 32 x 128 tiles
+    size_t M = 45, N = 150, K = 19;
+    struct Case
+    {
+        bool trans_A, trans_B, row_bias;
+        std::string activation;
+    };
+    for (auto& c : {Case{false, false, true, "relu"},
+                    Case{true, false, false, "gelu"},
+                    Case{false, true, true, "gelu"},
+                    Case{true, true, false, ""},
+                    Case{false, false, false, "relu"}})
+    {
+        auto A = make_input(M * K, 0.125f), B = make_input(K * N, 0.25f);
+        auto C = make_input(c.row_bias ? N : M * N, 0.5f);
+
+        auto graph = std::make_shared<graph::Graph>();
+        auto A_gnode = graph->add_node_and_edge(
+            make_shared<op::Parameter>(element::f32, c.trans_A ? Shape{K, M} : Shape{M, K}),
+            GNodeVector({}));
+        auto B_gnode = graph->add_node_and_edge(
+            make_shared<op::Parameter>(element::f32, c.trans_B ? Shape{N, K} : Shape{K, N}),
+            GNodeVector({}));
+        auto C_gnode = graph->add_node_and_edge(
+            make_shared<op::Parameter>(element::f32, c.row_bias ? Shape{N} : Shape{M, N}),
+            GNodeVector({}));
+        auto dot = graph->add_node_and_edge(
+            make_shared<op::Dot>(1, true, c.trans_A, c.trans_B), {A_gnode, B_gnode});
+        nnfusion::op::OpConfig::any config;
+        config["trans_A"] = c.trans_A;
+        config["trans_B"] = c.trans_B;
+        config["activation"] = c.activation;
+        auto matmuladd = graph->add_node_and_edge(
+            make_shared<nnfusion::op::GenericOp>("matmuladd", "MatMulAdd", config),
+            {A_gnode, B_gnode, C_gnode});
+
+        vector<float> IN = A;
+        IN.insert(IN.end(), B.begin(), B.end());
+        auto OUT = run_mlas(dot, IN);
+        ASSERT_EQ(OUT.size(), M * N);
+        for (size_t i = 0; i < M * N; i++)
+        {
+            float x = OUT[i] + C[c.row_bias ? i % N : i];
+            if (c.activation == "relu")
+                x = std::max(x, 0.0f);
+            else if (c.activation == "gelu")
+                x = 0.5f * x * (1.0f + std::erf(x * 0.70710678f));
+            OUT[i] = x;
+        }
+
+        IN.insert(IN.end(), C.begin(), C.end());
+        auto res = run_mlas(matmuladd, IN);
+        ASSERT_EQ(res.size(), OUT.size());
+        EXPECT_TRUE(nnfusion::test::all_close<float>(res, OUT, 1e-5f, 1e-5f))
+            << "trans_A " << c.trans_A << ", trans_B " << c.trans_B << ", row bias "
+            << c.row_bias << ", activation " << c.activation;
+    }
+}
@@ -0,0 +1,135 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+///\brief Test of the MLAS gemms on B packed by MlasGemmPackB, as -fcpu_prepack_weights runs them
+
+#include <vector>
+
+#include "../test_util/common.hpp"
+#include "gtest/gtest.h"
+#include "nnfusion/core/kernels/cpu/cpu_kernel_emitter.hpp"
+#include "nnfusion/core/kernels/cpu/cpu_langunit.hpp"
+#include "nnfusion/core/operators/op_define/dot.hpp"
+#include "nnfusion/engine/profiler/profiler.hpp"
+
+using namespace nnfusion::profiler;
+
+namespace
+{
+    // A * B of a Dot, B packed tile by tile of tile_n columns like MatMulAdd packs its weight,
+    // every call of the kernel packs it again
+    class PackedDotMlas : public cpu::MlasKernelEmitter
+    {
+    public:
+        PackedDotMlas(shared_ptr<KernelContext> ctx, size_t tile_n)
+            : MlasKernelEmitter(ctx)
+            , tile_n(tile_n)
+        {
+            auto dot = static_pointer_cast<op::Dot>(ctx->gnode->get_op_ptr());
+            trans_A = dot->get_transpose_A();
+            trans_B = dot->get_transpose_B();
+            auto& A_shape = ctx->inputs[0]->get_shape();
+            auto& B_shape = ctx->inputs[1]->get_shape();
+            M = trans_A ? A_shape[1] : A_shape[0];
+            K = trans_A ? A_shape[0] : A_shape[1];
+            N = trans_B ? B_shape[0] : B_shape[1];
+            packed = allocate_tensor(Shape{(N + 15) / 16 * 16 * K}, element::f32);
+        }
+
+        LanguageUnit_p emit_function_body() override
+        {
+            LanguageUnit_p _lu(new LanguageUnit(get_function_name()));
+            *_lu << op::create_code_from_template(
+                R"(for (size_t n0 = 0; n0 < @N@; n0 += @tile_n@)
+{
+    size_t cols = std::min<size_t>(@tile_n@, @N@ - n0);
+    MlasGemmPackB(@trans_B@, cols, @K@, input1 + n0 * @b_stride@, @ldb@, @packed@ + n0 * @K@);
+    MlasGemm(@trans_A@, @M@, cols, @K@, 1.0f, input0, @lda@, @packed@ + n0 * @K@, 0.0f,
+             output0 + n0, @N@, thread_pool);
+}
+)",
+                {{"M", M},
+                 {"N", N},
+                 {"K", K},
+                 {"tile_n", tile_n},
+                 {"trans_A", trans_A ? "CblasTrans" : "CblasNoTrans"},
+                 {"trans_B", trans_B ? "CblasTrans" : "CblasNoTrans"},
+                 {"b_stride", trans_B ? K : 1},
+                 {"lda", trans_A ? M : K},
+                 {"ldb", trans_B ? K : N},
+                 {"packed", packed->get_name()}});
+            return _lu;
+        }
+
+        LanguageUnit_p emit_dependency() override
+        {
+            LanguageUnit_p _lu(new LanguageUnit(get_function_name() + "_dep"));
+            _lu->require(header::mlas);
+            return _lu;
+        }
+
+    private:
+        bool trans_A, trans_B;
+        size_t M, N, K, tile_n;
+        shared_ptr<nnfusion::descriptor::Tensor> packed;
+    };
+
+    vector<float> run(shared_ptr<KernelEmitter> kernel, const vector<float>& IN)
+    {
+        if (!kernel->get_or_emit_source())
+            return vector<float>();
+        auto pctx = make_shared<ProfilingContext>(kernel);
+        pctx->runtime_times = 1;
+        pctx->warmup_times = 0;
+        Profiler prof(get_default_runtime(GENERIC_CPU), pctx);
+        auto res = prof.unsafe_execute<float>((void*)IN.data());
+        return res.empty() ? vector<float>() : res[0];
+    }
+}
+
+TEST(nnfusion_core_kernels, mlas_gemm_packed_b)
+{
+    // odd sizes leave partial 16-column panels in the packs
+    size_t M = 7, N = 37, K = 13;
+    vector<float> IN;
+    for (size_t i = 0; i < M * K + K * N; i++)
+        IN.push_back(0.25f * (int(i * 37 + 11) % 19 - 9));
+
+    for (bool trans_A : {false, true})
+    {
+        for (bool trans_B : {false, true})
+        {
+            // every kernel gets a node of its own, the profiler names its library after it
+            auto make_dot = [&]() {
+                auto graph = std::make_shared<graph::Graph>();
+                auto A = graph->add_node_and_edge(
+                    make_shared<op::Parameter>(element::f32, trans_A ? Shape{K, M} : Shape{M, K}),
+                    GNodeVector({}));
+                auto B = graph->add_node_and_edge(
+                    make_shared<op::Parameter>(element::f32, trans_B ? Shape{N, K} : Shape{K, N}),
+                    GNodeVector({}));
+                auto dot = graph->add_node_and_edge(
+                    make_shared<op::Dot>(1, true, trans_A, trans_B), {A, B});
+                return shared_ptr<KernelContext>(new KernelContext(dot));
+            };
+
+            vector<float> OUT;
+            for (auto& kernel_reg : KernelRegistry::Global()->FindKernelRegistrations(
+                     "Dot", GENERIC_CPU, element::f32))
+            {
+                if (kernel_reg->m_tag == "mlas")
+                    OUT = run(kernel_reg->m_factory(make_dot()), IN);
+            }
+            ASSERT_EQ(OUT.size(), M * N);
+
+            // a single pack of B, and one pack per tile of 16 columns
+            for (size_t tile_n : {N, size_t(16)})
+            {
+                auto res = run(make_shared<PackedDotMlas>(make_dot(), tile_n), IN);
+                ASSERT_EQ(res.size(), OUT.size());
+                EXPECT_TRUE(nnfusion::test::all_close<float>(res, OUT))
+                    << "trans_A " << trans_A << ", trans_B " << trans_B << ", tile_n " << tile_n;
+            }
+        }
+    }
+}
@@ -0,0 +1,235 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+///\brief Test of the bf16 and int8 paths of the MLAS kernels against reference loops
+
+#include <cstring>
+#include <vector>
+
+#include "../test_util/common.hpp"
+#include "gtest/gtest.h"
+#include "nnfusion/core/operators/generic_op/generic_op.hpp"
+#include "nnfusion/core/operators/op_define/convolution.hpp"
+#include "nnfusion/core/operators/op_define/dot.hpp"
+#include "nnfusion/engine/profiler/profiler.hpp"
+
+using namespace nnfusion::profiler;
+
+namespace
+{
+    // the operands are small integers, exact in bf16 as well as their sums
+    uint16_t to_bf16(float value)
+    {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        return bits >> 16;
+    }
+
+    template <typename T>
+    vector<T> make_input(size_t size, int range)
+    {
+        vector<T> input;
+        for (size_t i = 0; i < size; i++)
+            input.push_back(T(int(i * 7 + 3) % (2 * range + 1) - range));
+        return input;
+    }
+
+    // C = A * B of row-major matrices, accumulated in int64 and converted to T at the end
+    template <typename T>
+    vector<T> reference_gemm(const vector<T>& A,
+                             const vector<T>& B,
+                             size_t M,
+                             size_t N,
+                             size_t K,
+                             bool trans_A,
+                             bool trans_B)
+    {
+        vector<T> C;
+        for (size_t m = 0; m < M; m++)
+        {
+            for (size_t n = 0; n < N; n++)
+            {
+                int64_t sum = 0;
+                for (size_t k = 0; k < K; k++)
+                    sum += int64_t(trans_A ? A[k * M + m] : A[m * K + k]) *
+                           int64_t(trans_B ? B[n * K + k] : B[k * N + n]);
+                C.push_back(T(sum));
+            }
+        }
+        return C;
+    }
+
+    vector<uint16_t> to_bf16(const vector<float>& values)
+    {
+        vector<uint16_t> result;
+        for (auto value : values)
+            result.push_back(to_bf16(value));
+        return result;
+    }
+
+    template <typename T>
+    vector<T> concat(vector<T> a, const vector<T>& b)
+    {
+        a.insert(a.end(), b.begin(), b.end());
+        return a;
+    }
+
+    // runs the MLAS kernel of gnode, IN packs the inputs and T is only used for their layout
+    template <typename T>
+    vector<T> run_mlas(shared_ptr<GNode> gnode, const vector<T>& IN)
+    {
+        shared_ptr<KernelContext> ctx(new KernelContext(gnode));
+        for (auto& kernel_reg : KernelRegistry::Global()->FindKernelRegistrations(
+                 gnode->get_op_type(), GENERIC_CPU, element::f32))
+        {
+            if (kernel_reg->m_tag != "mlas")
+                continue;
+            auto kernel = kernel_reg->m_factory(ctx);
+            if (!kernel->get_or_emit_source())
+                return vector<T>();
+            auto pctx = make_shared<ProfilingContext>(kernel);
+            pctx->runtime_times = 1;
+            pctx->warmup_times = 0;
+            Profiler prof(get_default_runtime(GENERIC_CPU), pctx);
+            auto res = prof.unsafe_execute<T>((void*)IN.data());
+            return res.empty() ? vector<T>() : res[0];
+        }
+        return vector<T>();
+    }
+
+    shared_ptr<GNode>
+        make_dot(element::Type type, size_t M, size_t N, size_t K, bool trans_A, bool trans_B)
+    {
+        auto graph = std::make_shared<graph::Graph>();
+        auto A = graph->add_node_and_edge(
+            make_shared<op::Parameter>(type, trans_A ? Shape{K, M} : Shape{M, K}),
+            GNodeVector({}));
+        auto B = graph->add_node_and_edge(
+            make_shared<op::Parameter>(type, trans_B ? Shape{N, K} : Shape{K, N}),
+            GNodeVector({}));
+        return graph->add_node_and_edge(make_shared<op::Dot>(1, true, trans_A, trans_B), {A, B});
+    }
+
+    shared_ptr<GNode> make_batch_matmul(
+        element::Type type, size_t batch, size_t M, size_t N, size_t K, bool trans_B)
+    {
+        auto graph = std::make_shared<graph::Graph>();
+        auto A = graph->add_node_and_edge(make_shared<op::Parameter>(type, Shape{batch, M, K}),
+                                          GNodeVector({}));
+        auto B = graph->add_node_and_edge(
+            make_shared<op::Parameter>(type, trans_B ? Shape{batch, N, K} : Shape{batch, K, N}),
+            GNodeVector({}));
+        nnfusion::op::OpConfig::any config;
+        config["adj_x"]["b"] = false;
+        config["adj_y"]["b"] = trans_B;
+        auto op = std::make_shared<nnfusion::op::GenericOp>("BatchMatMul", "BatchMatMul", config);
+        return graph->add_node_and_edge(op, {A, B});
+    }
+
+    shared_ptr<GNode> make_convolution(element::Type type)
+    {
+        auto graph = std::make_shared<graph::Graph>();
+        auto data = graph->add_node_and_edge(
+            make_shared<op::Parameter>(type, Shape{1, 3, 6, 6}), GNodeVector({}));
+        auto filter = graph->add_node_and_edge(
+            make_shared<op::Parameter>(type, Shape{4, 3, 3, 3}), GNodeVector({}));
+        return graph->add_node_and_edge(make_shared<op::Convolution>(), {data, filter});
+    }
+}
+
+TEST(nnfusion_core_kernels, mlas_dot_bf16)
+{
+    // 64 x 1100 is split into two panels of B
+    size_t M = 3, N = 1100, K = 64;
+    auto A = make_input<float>(M * K, 1), B = make_input<float>(K * N, 1);
+    auto OUT = to_bf16(reference_gemm(A, B, M, N, K, false, false));
+    auto res = run_mlas(make_dot(element::bf16, M, N, K, false, false),
+                        concat(to_bf16(A), to_bf16(B)));
+    EXPECT_EQ(res, OUT);
+
+    for (auto trans : {std::make_pair(true, false), std::make_pair(true, true)})
+    {
+        M = 5, N = 9, K = 7;
+        A = make_input<float>(M * K, 2), B = make_input<float>(K * N, 2);
+        OUT = to_bf16(reference_gemm(A, B, M, N, K, trans.first, trans.second));
+        res = run_mlas(make_dot(element::bf16, M, N, K, trans.first, trans.second),
+                       concat(to_bf16(A), to_bf16(B)));
+        EXPECT_EQ(res, OUT);
+    }
+}
+
+TEST(nnfusion_core_kernels, mlas_dot_int8)
+{
+    // the sums overflow int8 and wrap around like the elementwise kernels
+    size_t M = 5, N = 9, K = 7;
+    auto A = make_input<int8_t>(M * K, 120), B = make_input<int8_t>(K * N, 120);
+    auto OUT = reference_gemm(A, B, M, N, K, false, false);
+    auto res = run_mlas(make_dot(element::i8, M, N, K, false, false), concat(A, B));
+    EXPECT_EQ(res, OUT);
+
+    // MLAS has no int8 gemm of transposed operands
+    EXPECT_TRUE(run_mlas(make_dot(element::i8, M, N, K, false, true), concat(A, B))
+                    .empty());
+}
+
+TEST(nnfusion_core_kernels, mlas_batch_matmul_bf16)
+{
+    // each shard stages its batches in a workspace slot of its own
+    size_t batch = 3, M = 4, N = 5, K = 6;
+    for (bool trans_B : {false, true})
+    {
+        auto A = make_input<float>(batch * M * K, 2), B = make_input<float>(batch * K * N, 2);
+        vector<float> OUT;
+        for (size_t b = 0; b < batch; b++)
+        {
+            vector<float> a(A.begin() + b * M * K, A.begin() + (b + 1) * M * K);
+            vector<float> b_(B.begin() + b * K * N, B.begin() + (b + 1) * K * N);
+            OUT = concat(OUT, reference_gemm(a, b_, M, N, K, false, trans_B));
+        }
+        auto res = run_mlas(make_batch_matmul(element::bf16, batch, M, N, K, trans_B),
+                            concat(to_bf16(A), to_bf16(B)));
+        EXPECT_EQ(res, to_bf16(OUT));
+    }
+}
+
+TEST(nnfusion_core_kernels, mlas_batch_matmul_int8)
+{
+    size_t batch = 3, M = 4, N = 5, K = 6;
+    auto A = make_input<int8_t>(batch * M * K, 120), B = make_input<int8_t>(batch * K * N, 120);
+    vector<int8_t> OUT;
+    for (size_t b = 0; b < batch; b++)
+    {
+        vector<int8_t> a(A.begin() + b * M * K, A.begin() + (b + 1) * M * K);
+        vector<int8_t> b_(B.begin() + b * K * N, B.begin() + (b + 1) * K * N);
+        OUT = concat(OUT, reference_gemm(a, b_, M, N, K, false, false));
+    }
+    auto res = run_mlas(make_batch_matmul(element::i8, batch, M, N, K, false), concat(A, B));
+    EXPECT_EQ(res, OUT);
+}
+
+TEST(nnfusion_core_kernels, mlas_convolution_bf16)
+{
+    auto data = make_input<float>(3 * 6 * 6, 1), filter = make_input<float>(4 * 3 * 3 * 3, 1);
+    vector<float> OUT;
+    for (size_t f = 0; f < 4; f++)
+        for (size_t y = 0; y < 4; y++)
+            for (size_t x = 0; x < 4; x++)
+            {
+                float sum = 0;
+                for (size_t c = 0; c < 3; c++)
+                    for (size_t ky = 0; ky < 3; ky++)
+                        for (size_t kx = 0; kx < 3; kx++)
+                            sum += data[(c * 6 + y + ky) * 6 + x + kx] *
+                                   filter[((f * 3 + c) * 3 + ky) * 3 + kx];
+                OUT.push_back(sum);
+            }
+
+    auto res = run_mlas(make_convolution(element::bf16), concat(to_bf16(data), to_bf16(filter)));
+    EXPECT_EQ(res, to_bf16(OUT));
+
+    // there is no int8 convolution in MLAS, another kernel has to be selected
+    EXPECT_TRUE(run_mlas(make_convolution(element::i8),
+                         concat(make_input<int8_t>(3 * 6 * 6, 1),
+                                make_input<int8_t>(4 * 3 * 3 * 3, 1)))
+                    .empty());
+}
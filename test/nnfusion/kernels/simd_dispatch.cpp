@@ -0,0 +1,103 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+///\brief Test of the -fcpu_simd_dispatch versions of the CPU simd kernels
+
+#include <cmath>
+#include <vector>
+
+#include "../test_util/common.hpp"
+#include "gtest/gtest.h"
+#include "nnfusion/core/operators/op_define/ceiling.hpp"
+#include "nnfusion/core/operators/op_define/floor.hpp"
+#include "nnfusion/core/operators/op_define/rsqrt.hpp"
+#include "nnfusion/engine/profiler/profiler.hpp"
+
+using namespace nnfusion::profiler;
+
+DECLARE_bool(fcpu_simd_dispatch);
+
+namespace
+{
+    // The dispatched source holds the AVX-512, AVX2 and SSE2 versions, any of them failing to
+    // compile leaves the profiler without results.
+    vector<float> run_dispatched(shared_ptr<op::Op> op, const vector<float>& IN)
+    {
+        bool dispatch = FLAGS_fcpu_simd_dispatch;
+        FLAGS_fcpu_simd_dispatch = true;
+
+        auto graph = std::make_shared<graph::Graph>();
+        auto A = make_shared<op::Parameter>(element::f32, Shape{IN.size()});
+        auto A_gnode = graph->add_node_and_edge(A, GNodeVector({}));
+        auto gnode = graph->add_node_and_edge(op, {A_gnode});
+
+        vector<float> result;
+        shared_ptr<KernelContext> ctx(new KernelContext(gnode));
+        for (auto& kernel_reg : KernelRegistry::Global()->FindKernelRegistrations(
+                 gnode->get_op_type(), GENERIC_CPU, element::f32))
+        {
+            if (kernel_reg->m_tag != "simd")
+                continue;
+            auto kernel = kernel_reg->m_factory(ctx);
+            if (!kernel->get_or_emit_source())
+                break;
+            auto pctx = make_shared<ProfilingContext>(kernel);
+            pctx->runtime_times = 1;
+            pctx->warmup_times = 0;
+            Profiler prof(get_default_runtime(GENERIC_CPU), pctx);
+            auto res = prof.unsafe_execute<float>((void*)IN.data());
+            if (!res.empty())
+                result = res[0];
+            break;
+        }
+
+        FLAGS_fcpu_simd_dispatch = dispatch;
+        return result;
+    }
+
+    // 37 elements leave a scalar tail after the vector body for every width
+    vector<float> make_input(bool positive)
+    {
+        vector<float> IN;
+        for (int i = 0; i < 37; i++)
+            IN.push_back(positive ? 0.25f + 0.75f * i : -9.25f + 0.5f * i);
+        return IN;
+    }
+}
+
+TEST(nnfusion_core_kernels, simd_dispatch_ceiling)
+{
+    auto IN = make_input(false);
+    vector<float> OUT;
+    for (auto x : IN)
+        OUT.push_back(std::ceil(x));
+
+    auto res = run_dispatched(make_shared<op::Ceiling>(), IN);
+    EXPECT_EQ(res.size(), OUT.size());
+    EXPECT_TRUE(nnfusion::test::all_close<float>(res, OUT));
+}
+
+TEST(nnfusion_core_kernels, simd_dispatch_floor)
+{
+    auto IN = make_input(false);
+    vector<float> OUT;
+    for (auto x : IN)
+        OUT.push_back(std::floor(x));
+
+    auto res = run_dispatched(make_shared<op::Floor>(), IN);
+    EXPECT_EQ(res.size(), OUT.size());
+    EXPECT_TRUE(nnfusion::test::all_close<float>(res, OUT));
+}
+
+TEST(nnfusion_core_kernels, simd_dispatch_rsqrt)
+{
+    auto IN = make_input(true);
+    vector<float> OUT;
+    for (auto x : IN)
+        OUT.push_back(1.0f / std::sqrt(x));
+
+    // the rsqrt approximations are only good to 12 bits
+    auto res = run_dispatched(make_shared<op::Rsqrt>(), IN);
+    EXPECT_EQ(res.size(), OUT.size());
+    EXPECT_TRUE(nnfusion::test::all_close<float>(res, OUT, 1e-3f, 1e-5f));
+}
@@ -57,7 +57,8 @@ class E2EEvaluator:
         return True
     
     def allclose(self):
-        code = os.system("cd %s/nnfusion_rt/%s/ && ./main_test > result.txt"%(self.working_foler, self.codegen_folder))
+        main_args = getattr(self.testcase, "main_args", "")
+        code = os.system("cd %s/nnfusion_rt/%s/ && ./main_test %s > result.txt"%(self.working_foler, self.codegen_folder, main_args))
         if code != 0:
             logging.error("%s execution failed."%self.testcase.casename)
             return False
@@ -1,13 +1,64 @@
 # Copyright (c) Microsoft Corporation.
 # Licensed under the MIT License.
 
+import datetime
 import logging
 import os
+import subprocess
 from testcases.testcase import *
 
 
+def load_benchmark_report(raw_strdata):
+    # main_test prints the benchmark report as one json line before the execution time
+    for line in reversed(raw_strdata):
+        if line.startswith("{"):
+            return json.loads(line)
+    return None
+
+
+def current_commit():
+    commit = os.environ.get("NNFUSION_COMMIT")
+    if commit:
+        return commit
+    try:
+        return subprocess.check_output(
+            ["git", "rev-parse", "HEAD"],
+            cwd=os.path.dirname(os.path.abspath(__file__)),
+            stderr=subprocess.DEVNULL).decode().strip()
+    except (subprocess.CalledProcessError, OSError):
+        return ""
+
+
+def check_latency(casename, flag, baseline, raw_strdata):
+    """
+    Compare the median latency of the fastest run against the baseline in ms, and append
+    the report to the json lines file in NNFUSION_CPU_PERF_HISTORY to track it per commit.
+    """
+    report = load_benchmark_report(raw_strdata)
+    if report is None:
+        logging.error("%s has no benchmark report." % (casename))
+        return False
+    real_time = min(run["median_ms"] for run in report["runs"])
+    history = os.environ.get("NNFUSION_CPU_PERF_HISTORY")
+    if history:
+        with open(history, "a") as f:
+            f.write(json.dumps({
+                "testcase": casename,
+                "commit": current_commit(),
+                "time": datetime.datetime.now().isoformat(),
+                "flag": flag,
+                "baseline": baseline,
+                "report": report
+            }) + "\n")
+    if real_time / baseline > 1.5:
+        logging.error("%s has unacceptable latency. ref_time = %.2f, real_time = %.2f." %
+                      (casename, baseline, real_time))
+        return False
+    return True
+
+
 class TestSingleOutput(TestCase):
-    def __init__(self, casename, strdata, filename, tags, flag, baseline):
+    def __init__(self, casename, strdata, filename, tags, flag, baseline, main_args=""):
         self.casename = casename
         self.ground_truth = [float(v.strip()) for v in strdata.split("..")[
             0].strip().split(" ")]
@@ -17,6 +68,7 @@ class TestSingleOutput(TestCase):
         self.tags = tags
         self.flag = flag
         self.baseline = baseline
+        self.main_args = main_args
 
     # Get data from output of main_test
     def allclose(self, raw_strdata):
@@ -30,14 +82,10 @@ class TestSingleOutput(TestCase):
         return True
     
     def latency_test(self, raw_strdata):
-        real_time = float(raw_strdata[-1].strip("\n").split(" ")[-2])
-        if real_time / self.baseline > 1.5:
-            logging.error("%s has unacceptable latency. ref_time = %.2f, real_time = %.2f." % (self.casename, self.cpu_ref_time, real_time))
-            return False
-        return True
+        return check_latency(self.casename, self.flag, self.baseline, raw_strdata)
 
 class TestMultiOutput(TestCase):
-    def __init__(self, casename, strdata, filename, tags, flag, baseline):
+    def __init__(self, casename, strdata, filename, tags, flag, baseline, main_args=""):
         self.casename = casename
         self.ground_truth = self.extract_data(strdata.split("\n"))
         self.rtol = 1.e-2
@@ -46,12 +94,15 @@ class TestMultiOutput(TestCase):
         self.tags = tags
         self.flag = flag
         self.baseline = baseline
+        self.main_args = main_args
 
     def extract_data(self, strs):
+        # the value lines of the outputs, skipping the names and the benchmark report
         data = list()
-        for i in range(1, len(strs), 2):
-            data.append([float(v.strip())
-                         for v in strs[i].strip().split("..")[0].strip().split(" ")])
+        for line in strs:
+            if " .. (size = " in line:
+                data.append([float(v.strip())
+                             for v in line.strip().split("..")[0].strip().split(" ")])
         return data
 
     def all_allclose(self, a, b):
@@ -70,16 +121,12 @@ class TestMultiOutput(TestCase):
     def allclose(self, raw_strdata):
         if not self.all_allclose(self.extract_data(raw_strdata), self.ground_truth):
             return False
-        if not latency_test(raw_strdata):
+        if not self.latency_test(raw_strdata):
             return False
         return True
     
     def latency_test(self, raw_strdata):
-        real_time = float(raw_strdata[-1].strip("\n").split(" ")[-2])
-        if real_time / self.cpu_ref_time > 1.5:
-            logging.error("%s has unacceptable latency. ref_time = %.2f, real_time = %.2f." % (self.casename, self.cpu_ref_time, real_time))
-            return False
-        return True
+        return check_latency(self.casename, self.flag, self.baseline, raw_strdata)
 
 def create_cpu_perf_case_single_line(base_folder, json_data):
     testcase = json_data["testcase"]
@@ -90,7 +137,8 @@ def create_cpu_perf_case_single_line(base_folder, json_data):
     if "flag" in json_data:
         flag = json_data["flag"]
     baseline = json_data["baseline"]
-    return TestSingleOutput(testcase, output, filename, tags, flag, baseline)
+    main_args = json_data.get("main_args", "")
+    return TestSingleOutput(testcase, output, filename, tags, flag, baseline, main_args)
 
 
 def create_cpu_perf_case_multi_lines(base_folder, json_data):
@@ -101,5 +149,6 @@ def create_cpu_perf_case_multi_lines(base_folder, json_data):
     flag = ""
     if "flag" in json_data:
         flag = json_data["flag"]
-    baseline = json_data["baseline"]    
-    return TestMultiOutput(testcase, output, filename, tags, flag, baseline)
+    baseline = json_data["baseline"]
+    main_args = json_data.get("main_args", "")
+    return TestMultiOutput(testcase, output, filename, tags, flag, baseline, main_args)
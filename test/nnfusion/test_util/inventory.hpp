@@ -25,5 +25,13 @@ namespace nnfusion
         vector<dtype> generate_output(int option = 0);
         template <class T, class dtype>
         vector<dtype> generate_param(int option = 0);
+
+        // generic ops have no op class, their inventory is keyed by these tags
+        namespace generic
+        {
+            struct Attention;
+            struct GatherV2;
+            struct LayerNorm;
+        }
     }
 }
\ No newline at end of file
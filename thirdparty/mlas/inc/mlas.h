@@ -126,6 +126,47 @@ MlasGemm(
     MLAS_THREADPOOL* ThreadPool
     );
 
+//
+// Packed matrix/matrix multiply routines. Matrix B is packed once by
+// MlasGemmPackB into a buffer of MlasGemmPackBSize bytes, aligned to at least
+// 16 bytes, and then shared by any number of MlasGemm calls.
+//
+
+size_t
+MLASCALL
+MlasGemmPackBSize(
+    size_t N,
+    size_t K
+    );
+
+void
+MLASCALL
+MlasGemmPackB(
+    CBLAS_TRANSPOSE TransB,
+    size_t N,
+    size_t K,
+    const float* B,
+    size_t ldb,
+    void* PackedB
+    );
+
+void
+MLASCALL
+MlasGemm(
+    CBLAS_TRANSPOSE TransA,
+    size_t M,
+    size_t N,
+    size_t K,
+    float alpha,
+    const float* A,
+    size_t lda,
+    const void* PackedB,
+    float beta,
+    float* C,
+    size_t ldc,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
 void
 MLASCALL
 MlasGemm(
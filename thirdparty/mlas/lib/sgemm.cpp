@@ -26,6 +26,14 @@ Abstract:
 
 #define MLAS_SGEMM_TRANSA_ROWS              12
 
+//
+// Define the number of elements along the K dimension of a panel of a packed
+// matrix B. Each panel holds the columns of the matrix padded to a multiple of
+// 16 elements.
+//
+
+#define MLAS_SGEMM_PACKED_STRIDEK           256
+
 //
 // Define the parameters to execute segments of a SGEMM operation on worker
 // threads.
@@ -49,6 +57,29 @@ struct MLAS_SGEMM_WORK_BLOCK {
     } Segments[MLAS_MAXIMUM_THREAD_COUNT];
 };
 
+//
+// Define the parameters to execute segments of a SGEMM operation with a packed
+// matrix B on worker threads.
+//
+
+struct MLAS_SGEMM_PACKED_WORK_BLOCK {
+    CBLAS_TRANSPOSE TransA;
+    size_t K;
+    size_t lda;
+    size_t ldc;
+    size_t AlignedN;
+    float alpha;
+    float beta;
+    const float* PackedB;
+    struct SEGMENT {
+        size_t M;
+        size_t StartN;
+        size_t CountN;
+        const float* A;
+        float* C;
+    } Segments[MLAS_MAXIMUM_THREAD_COUNT];
+};
+
 void
 MlasSgemmMultiplyBeta(
     float* C,
@@ -762,6 +793,148 @@ Return Value:
     }
 }
 
+void
+MlasSgemmMultiplyPanel(
+    CBLAS_TRANSPOSE TransA,
+    float* PanelA,
+    const float* A,
+    size_t lda,
+    size_t k,
+    const float* PanelB,
+    float* C,
+    size_t ldc,
+    size_t CountM,
+    size_t CountN,
+    size_t CountK,
+    float alpha,
+    bool ZeroMode
+    )
+/*++
+
+Routine Description:
+
+    This routine multiplies all rows of a slice of matrix A along the K
+    dimension by a packed panel of matrix B.
+
+Arguments:
+
+    TransA - Supplies the transpose operation for matrix A.
+
+    PanelA - Supplies the address of a local buffer of at least
+        MLAS_SGEMM_TRANSA_ROWS * CountK elements to transpose matrix A.
+
+    A - Supplies the address of matrix A.
+
+    lda - Supplies the first dimension of matrix A.
+
+    k - Supplies the index of the slice along the K dimension.
+
+    PanelB - Supplies the address of the packed panel of matrix B.
+
+    C - Supplies the address of matrix C.
+
+    ldc - Supplies the first dimension of matrix C.
+
+    CountM - Supplies the number of rows of matrix A and matrix C.
+
+    CountN - Supplies the number of columns of the panel and matrix C.
+
+    CountK - Supplies the number of columns of the slice of matrix A.
+
+    alpha - Supplies the scalar alpha multiplier (see SGEMM definition).
+
+    ZeroMode - Supplies true if the output matrix must be zero initialized,
+        else false if the output matrix is accumulated into.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    float* c = C;
+
+    size_t RowsRemaining = CountM;
+    size_t RowsHandled;
+
+    if (TransA == CblasNoTrans) {
+
+        const float* a = A + k;
+
+        //
+        // Step through the rows of matrix A.
+        //
+
+        do {
+
+#if defined(MLAS_TARGET_AMD64_IX86)
+            RowsHandled = MlasPlatform.GemmFloatKernel(a, PanelB, c, CountK, RowsRemaining, CountN, lda, ldc, alpha, ZeroMode);
+#else
+            if (ZeroMode) {
+                RowsHandled = MlasSgemmKernelZero(a, PanelB, c, CountK, RowsRemaining, CountN, lda, ldc, alpha);
+            } else {
+                RowsHandled = MlasSgemmKernelAdd(a, PanelB, c, CountK, RowsRemaining, CountN, lda, ldc, alpha);
+            }
+#endif
+
+            c += ldc * RowsHandled;
+            a += lda * RowsHandled;
+
+            RowsRemaining -= RowsHandled;
+
+        } while (RowsRemaining > 0);
+
+    } else {
+
+        const float* a = A + k * lda;
+
+        do {
+
+            //
+            // Transpose elements from matrix A into a local buffer.
+            //
+
+            size_t RowsTransposed = RowsRemaining;
+
+            if (RowsTransposed > MLAS_SGEMM_TRANSA_ROWS) {
+                RowsTransposed = MLAS_SGEMM_TRANSA_ROWS;
+            }
+
+            RowsRemaining -= RowsTransposed;
+
+            MlasSgemmTransposeA(PanelA, a, lda, RowsTransposed, CountK);
+
+            a += RowsTransposed;
+
+            //
+            // Step through the rows of the local buffer.
+            //
+
+            const float* pa = PanelA;
+
+            do {
+
+#if defined(MLAS_TARGET_AMD64_IX86)
+                RowsHandled = MlasPlatform.GemmFloatKernel(pa, PanelB, c, CountK, RowsTransposed, CountN, CountK, ldc, alpha, ZeroMode);
+#else
+                if (ZeroMode) {
+                    RowsHandled = MlasSgemmKernelZero(pa, PanelB, c, CountK, RowsTransposed, CountN, CountK, ldc, alpha);
+                } else {
+                    RowsHandled = MlasSgemmKernelAdd(pa, PanelB, c, CountK, RowsTransposed, CountN, CountK, ldc, alpha);
+                }
+#endif
+
+                c += ldc * RowsHandled;
+                pa += CountK * RowsHandled;
+
+                RowsTransposed -= RowsHandled;
+
+            } while (RowsTransposed > 0);
+
+        } while (RowsRemaining > 0);
+    }
+}
+
 void
 MlasSgemmOperation(
     CBLAS_TRANSPOSE TransA,
@@ -923,91 +1096,8 @@ Return Value:
                 MlasSgemmTransposePackB(PanelB, B + k + n * ldb, ldb, CountN, CountK);
             }
 
-            //
-            // Step through each slice of matrix A along the M dimension.
-            //
-
-            float* c = C + n;
-
-            size_t RowsRemaining = M;
-            size_t RowsHandled;
-
-            if (TransA == CblasNoTrans) {
-
-                const float* a = A + k;
-
-                //
-                // Step through the rows of matrix A.
-                //
-
-                do {
-
-#if defined(MLAS_TARGET_AMD64_IX86)
-                    RowsHandled = MlasPlatform.GemmFloatKernel(a, PanelB, c, CountK, RowsRemaining, CountN, lda, ldc, alpha, ZeroMode);
-#else
-                    if (ZeroMode) {
-                        RowsHandled = MlasSgemmKernelZero(a, PanelB, c, CountK, RowsRemaining, CountN, lda, ldc, alpha);
-                    } else {
-                        RowsHandled = MlasSgemmKernelAdd(a, PanelB, c, CountK, RowsRemaining, CountN, lda, ldc, alpha);
-                    }
-#endif
-
-                    c += ldc * RowsHandled;
-                    a += lda * RowsHandled;
-
-                    RowsRemaining -= RowsHandled;
-
-                } while (RowsRemaining > 0);
-
-            } else {
-
-                const float* a = A + k * lda;
-
-                do {
-
-                    //
-                    // Transpose elements from matrix A into a local buffer.
-                    //
-
-                    size_t RowsTransposed = RowsRemaining;
-
-                    if (RowsTransposed > MLAS_SGEMM_TRANSA_ROWS) {
-                        RowsTransposed = MLAS_SGEMM_TRANSA_ROWS;
-                    }
-
-                    RowsRemaining -= RowsTransposed;
-
-                    MlasSgemmTransposeA(PanelA, a, lda, RowsTransposed, CountK);
-
-                    a += RowsTransposed;
-
-                    //
-                    // Step through the rows of the local buffer.
-                    //
-
-                    const float* pa = PanelA;
-
-                    do {
-
-#if defined(MLAS_TARGET_AMD64_IX86)
-                        RowsHandled = MlasPlatform.GemmFloatKernel(pa, PanelB, c, CountK, RowsTransposed, CountN, CountK, ldc, alpha, ZeroMode);
-#else
-                        if (ZeroMode) {
-                            RowsHandled = MlasSgemmKernelZero(pa, PanelB, c, CountK, RowsTransposed, CountN, CountK, ldc, alpha);
-                        } else {
-                            RowsHandled = MlasSgemmKernelAdd(pa, PanelB, c, CountK, RowsTransposed, CountN, CountK, ldc, alpha);
-                        }
-#endif
-
-                        c += ldc * RowsHandled;
-                        pa += CountK * RowsHandled;
-
-                        RowsTransposed -= RowsHandled;
-
-                    } while (RowsTransposed > 0);
-
-                } while (RowsRemaining > 0);
-            }
+            MlasSgemmMultiplyPanel(TransA, PanelA, A, lda, k, PanelB, C + n, ldc, M, CountN,
+                CountK, alpha, ZeroMode);
         }
     }
 }
@@ -1290,3 +1380,386 @@ Return Value:
         MlasSgemmOperation(TransA, TransB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
     }
 }
+
+void
+MlasSgemmPackedOperation(
+    CBLAS_TRANSPOSE TransA,
+    size_t M,
+    size_t StartN,
+    size_t CountN,
+    size_t K,
+    float alpha,
+    const float* A,
+    size_t lda,
+    const float* PackedB,
+    size_t AlignedN,
+    float beta,
+    float* C,
+    size_t ldc
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the single precision matrix/matrix multiply
+    operation (SGEMM) for a range of columns of a packed matrix B.
+
+Arguments:
+
+    TransA - Supplies the transpose operation for matrix A.
+
+    M - Supplies the number of rows of matrix A and matrix C.
+
+    StartN - Supplies the first column of the packed matrix B to use, which is
+        a multiple of 16.
+
+    CountN - Supplies the number of columns of the packed matrix B to use.
+
+    K - Supplies the number of columns of matrix A and the number of rows of
+        matrix B.
+
+    alpha - Supplies the scalar alpha multiplier (see SGEMM definition).
+
+    A - Supplies the address of matrix A.
+
+    lda - Supplies the first dimension of matrix A.
+
+    PackedB - Supplies the address of the packed matrix B.
+
+    AlignedN - Supplies the number of columns of the packed matrix B padded to
+        a multiple of 16.
+
+    beta - Supplies the scalar beta multiplier (see SGEMM definition).
+
+    C - Supplies the address of the first column of matrix C to compute.
+
+    ldc - Supplies the first dimension of matrix C.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    float PanelA[MLAS_SGEMM_TRANSA_ROWS * MLAS_SGEMM_PACKED_STRIDEK];
+
+    //
+    // Step through each slice of matrix C along the N dimension, so that the
+    // slice stays in the cache while the panels along the K dimension are
+    // accumulated into it.
+    //
+
+    size_t StrideN = MLAS_SGEMM_STRIDEN;
+
+    for (size_t CountSliceN, n = 0; n < CountN; n += CountSliceN) {
+
+        CountSliceN = StrideN;
+
+        if (CountSliceN > (CountN - n)) {
+            CountSliceN = CountN - n;
+        }
+
+        if (beta != 0.0f && beta != 1.0f) {
+            MlasSgemmMultiplyBeta(C + n, M, CountSliceN, ldc, beta);
+        }
+
+        for (size_t CountK, k = 0; k < K; k += CountK) {
+
+            bool ZeroMode = (k == 0 && beta == 0.0f);
+
+            CountK = MLAS_SGEMM_PACKED_STRIDEK;
+
+            if (CountK > (K - k)) {
+                CountK = K - k;
+            }
+
+            const float* PanelB = PackedB + AlignedN * k + CountK * (StartN + n);
+
+            MlasSgemmMultiplyPanel(TransA, PanelA, A, lda, k, PanelB, C + n, ldc, M,
+                CountSliceN, CountK, alpha, ZeroMode);
+        }
+    }
+}
+
+void
+MlasSgemmPackedOperationThreaded(
+    void* Context,
+    int32_t Index
+    )
+/*++
+
+Routine Description:
+
+    This routine is invoked from a worker thread to execute a segment of a
+    SGEMM operation with a packed matrix B.
+
+Arguments:
+
+    Context - Supplies the pointer to the context for the threaded operation.
+
+    Index - Supplies the current index of the threaded operation.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_SGEMM_PACKED_WORK_BLOCK* WorkBlock = (MLAS_SGEMM_PACKED_WORK_BLOCK*)Context;
+
+    MLAS_SGEMM_PACKED_WORK_BLOCK::SEGMENT* Segment = &WorkBlock->Segments[Index];
+
+    MlasSgemmPackedOperation(WorkBlock->TransA, Segment->M, Segment->StartN,
+        Segment->CountN, WorkBlock->K, WorkBlock->alpha, Segment->A, WorkBlock->lda,
+        WorkBlock->PackedB, WorkBlock->AlignedN, WorkBlock->beta, Segment->C,
+        WorkBlock->ldc);
+}
+
+size_t
+MLASCALL
+MlasGemmPackBSize(
+    size_t N,
+    size_t K
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the number of bytes required to pack matrix B.
+
+Arguments:
+
+    N - Supplies the number of columns of matrix B.
+
+    K - Supplies the number of rows of matrix B.
+
+Return Value:
+
+    Returns the size of the packed buffer in bytes.
+
+--*/
+{
+    size_t AlignedN = (N + 15) & ~size_t(15);
+
+    return AlignedN * K * sizeof(float);
+}
+
+void
+MLASCALL
+MlasGemmPackB(
+    CBLAS_TRANSPOSE TransB,
+    size_t N,
+    size_t K,
+    const float* B,
+    size_t ldb,
+    void* PackedB
+    )
+/*++
+
+Routine Description:
+
+    This routine packs matrix B into panels of MLAS_SGEMM_PACKED_STRIDEK rows,
+    laid out the way the SGEMM kernels read them.
+
+Arguments:
+
+    TransB - Supplies the transpose operation for matrix B.
+
+    N - Supplies the number of columns of matrix B.
+
+    K - Supplies the number of rows of matrix B.
+
+    B - Supplies the address of matrix B.
+
+    ldb - Supplies the first dimension of matrix B.
+
+    PackedB - Supplies the address of the packed buffer, which holds
+        MlasGemmPackBSize(N, K) bytes.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    size_t AlignedN = (N + 15) & ~size_t(15);
+    float* D = (float*)PackedB;
+
+    for (size_t CountK, k = 0; k < K; k += CountK) {
+
+        CountK = MLAS_SGEMM_PACKED_STRIDEK;
+
+        if (CountK > (K - k)) {
+            CountK = K - k;
+        }
+
+        if (TransB == CblasNoTrans) {
+            MlasSgemmCopyPackB(D, B + k * ldb, ldb, N, CountK);
+        } else {
+            MlasSgemmTransposePackB(D, B + k, ldb, N, CountK);
+        }
+
+        D += AlignedN * CountK;
+    }
+}
+
+void
+MLASCALL
+MlasGemm(
+    CBLAS_TRANSPOSE TransA,
+    size_t M,
+    size_t N,
+    size_t K,
+    float alpha,
+    const float* A,
+    size_t lda,
+    const void* PackedB,
+    float beta,
+    float* C,
+    size_t ldc,
+    MLAS_THREADPOOL* ThreadPool
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the single precision matrix/matrix multiply
+    operation (SGEMM) with a matrix B packed by MlasGemmPackB.
+
+Arguments:
+
+    TransA - Supplies the transpose operation for matrix A.
+
+    M - Supplies the number of rows of matrix A and matrix C.
+
+    N - Supplies the number of columns of matrix B and matrix C.
+
+    K - Supplies the number of columns of matrix A and the number of rows of
+        matrix B.
+
+    alpha - Supplies the scalar alpha multiplier (see SGEMM definition).
+
+    A - Supplies the address of matrix A.
+
+    lda - Supplies the first dimension of matrix A.
+
+    PackedB - Supplies the address of the packed matrix B.
+
+    beta - Supplies the scalar beta multiplier (see SGEMM definition).
+
+    C - Supplies the address of matrix C.
+
+    ldc - Supplies the first dimension of matrix C.
+
+    ThreadPool - Supplies the thread pool object to use, else nullptr if the
+        base library threading support should be used.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_SGEMM_PACKED_WORK_BLOCK WorkBlock;
+    int32_t TargetThreadCount;
+
+    WorkBlock.TransA = TransA;
+    WorkBlock.K = K;
+    WorkBlock.lda = lda;
+    WorkBlock.ldc = ldc;
+    WorkBlock.AlignedN = (N + 15) & ~size_t(15);
+    WorkBlock.alpha = alpha;
+    WorkBlock.beta = beta;
+    WorkBlock.PackedB = (const float*)PackedB;
+
+    //
+    // Compute the number of target threads given the complexity of the SGEMM
+    // operation. Small requests should run using the single threaded path.
+    //
+
+    double Complexity = double(M) * double(N) * double(K);
+
+    if (Complexity < double(MLAS_SGEMM_THREAD_COMPLEXITY * MLAS_MAXIMUM_THREAD_COUNT)) {
+        TargetThreadCount = int32_t(Complexity / double(MLAS_SGEMM_THREAD_COMPLEXITY)) + 1;
+    } else {
+        TargetThreadCount = MLAS_MAXIMUM_THREAD_COUNT;
+    }
+
+    int32_t MaximumThreadCount = MlasGetMaximumThreadCount(ThreadPool);
+
+    if (TargetThreadCount >= MaximumThreadCount) {
+        TargetThreadCount = MaximumThreadCount;
+    }
+
+    if (TargetThreadCount == 1) {
+        MlasSgemmPackedOperation(TransA, M, 0, N, K, alpha, A, lda, WorkBlock.PackedB,
+            WorkBlock.AlignedN, beta, C, ldc);
+        return;
+    }
+
+    //
+    // Segment the operation across multiple threads. Segments along the N
+    // dimension start at a multiple of 16 columns, where the packed panels
+    // start.
+    //
+
+    int32_t Index = 0;
+
+    if (N > M) {
+
+        size_t StrideN = N / TargetThreadCount;
+
+        if ((StrideN * TargetThreadCount) != N) {
+            StrideN++;
+        }
+
+        StrideN =
+            (StrideN + MLAS_SGEMM_STRIDEN_THREAD_ALIGN - 1) & ~(MLAS_SGEMM_STRIDEN_THREAD_ALIGN - 1);
+
+        for (size_t CountN, n = 0; n < N; n += CountN) {
+
+            CountN = StrideN;
+
+            if (CountN > (N - n)) {
+                CountN = N - n;
+            }
+
+            WorkBlock.Segments[Index].M = M;
+            WorkBlock.Segments[Index].StartN = n;
+            WorkBlock.Segments[Index].CountN = CountN;
+            WorkBlock.Segments[Index].A = A;
+            WorkBlock.Segments[Index].C = C + n;
+
+            Index++;
+        }
+
+    } else {
+
+        size_t StrideM = M / TargetThreadCount;
+
+        if ((StrideM * TargetThreadCount) != M) {
+            StrideM++;
+        }
+
+        size_t plda = (TransA == CblasNoTrans) ? lda : 1;
+
+        for (size_t CountM, m = 0; m < M; m += CountM) {
+
+            CountM = StrideM;
+
+            if (CountM > (M - m)) {
+                CountM = M - m;
+            }
+
+            WorkBlock.Segments[Index].M = CountM;
+            WorkBlock.Segments[Index].StartN = 0;
+            WorkBlock.Segments[Index].CountN = N;
+            WorkBlock.Segments[Index].A = A + m * plda;
+            WorkBlock.Segments[Index].C = C + m * ldc;
+
+            Index++;
+        }
+    }
+
+    MlasExecuteThreaded(MlasSgemmPackedOperationThreaded, &WorkBlock, Index, ThreadPool);
+}
@@ -9,7 +9,7 @@ namespace concurrency {
 //
 // NumaAwareThreadPool
 //
-NumaAwareThreadPool::NumaAwareThreadPool(int num_numa_node, int num_thread_per_node)
+NumaAwareThreadPool::NumaAwareThreadPool(int num_numa_node, int num_thread_per_node, bool pin_threads)
     : m_num_numa_node(num_numa_node),
       m_num_thread_per_node(num_thread_per_node) {
   assert(m_num_numa_node > 0);
@@ -19,7 +19,7 @@ NumaAwareThreadPool::NumaAwareThreadPool(int num_numa_node, int num_thread_per_n
     if (m_num_thread_per_node == 0) {
       m_num_thread_per_node = std::thread::hardware_concurrency();
     }
-    std::unique_ptr<ThreadPool> threadpool(new ThreadPool(m_num_thread_per_node));
+    std::unique_ptr<ThreadPool> threadpool(new ThreadPool(m_num_thread_per_node, kNUMANoAffinity, pin_threads));
     m_threadpools.push_back(std::move(threadpool));
   }
   else {
@@ -13,9 +13,10 @@ namespace concurrency {
 class NumaAwareThreadPool {
  public:
   /*
-  Initializes thread pool(s) given the number of NUMA nodes.
+  Initializes thread pool(s) given the number of NUMA nodes. With pin_threads, the
+  workers of a single node are pinned to one core each.
   */
-  NumaAwareThreadPool(int num_numa_node=1, int num_thread_per_node=0);
+  NumaAwareThreadPool(int num_numa_node=1, int num_thread_per_node=0, bool pin_threads=false);
 
   /*
   Enqueue a unit of work.
@@ -3,6 +3,7 @@
 
 #include "threadpool.h"
 
+#include <atomic>
 #include <cassert>
 
 #if defined(__GNUC__)
@@ -22,16 +23,35 @@
 using Eigen::Barrier;
 
 namespace concurrency {
+namespace {
+// the first core not yet given to a pinned pool, so that pools in the same process pin their
+// workers to their own cores instead of all starting at core 0
+std::atomic<int> next_pinned_core(0);
+}
+
 //
 // ThreadPool
 //
-ThreadPool::ThreadPool(int num_threads, int numa_node)
-    : numa_node_(numa_node) {
-  impl_.reset(new Eigen::ThreadPoolTempl<NumaEnvironment>(num_threads, NumaEnvironment(numa_node)));
+ThreadPool::ThreadPool(int num_threads, int numa_node, bool pin_threads)
+    : parent_(nullptr), numa_node_(numa_node) {
+  int first_core = pin_threads ? next_pinned_core.fetch_add(num_threads) : 0;
+  impl_.reset(new Eigen::ThreadPoolTempl<NumaEnvironment>(
+      num_threads, NumaEnvironment(numa_node, pin_threads, first_core)));
   device_.reset(new Eigen::ThreadPoolDevice(impl_.get(), impl_->NumThreads()));
+  serial_view_.reset(new ThreadPool(this));
+}
+
+// Eigen runs the work inline on a device of one core
+ThreadPool::ThreadPool(ThreadPool* parent)
+    : parent_(parent), numa_node_(parent->numa_node_) {
+  device_.reset(new Eigen::ThreadPoolDevice(parent->impl_.get(), 1));
 }
 
 void ThreadPool::Schedule(std::function<void()> fn) { 
+  if (parent_ != nullptr) {
+    fn();
+    return;
+  }
   impl_->Schedule(fn);
 }
 
@@ -52,9 +72,10 @@ void ThreadPool::ParallelFor(int32_t total, std::function<void(int32_t)> fn) {
   if (total <= 0)
     return;
 
-  if (total == 1)
+  if (total == 1 || parent_ != nullptr)
   {
-    fn(0);
+    for (int32_t id = 0; id < total; ++id)
+      fn(id);
     return;
   }
 
@@ -79,6 +100,11 @@ void ThreadPool::ParallelForRange(int64_t first, int64_t last, std::function<voi
     fn(first, last);
     return;
   }
+  if (parent_ != nullptr) {
+    for (int64_t id = first; id < last; ++id)
+      fn(id, id + 1);
+    return;
+  }
 
   // TODO: Eigen supports a more efficient ThreadPoolDevice mechanism
   // We will simply rely on the work queue and stealing in the short term.
@@ -96,7 +122,9 @@ void ThreadPool::ParallelForRange(int64_t first, int64_t last, std::function<voi
   barrier.Wait();
 }
 
-int ThreadPool::NumThreads() const { return impl_->NumThreads(); }
+int ThreadPool::NumThreads() const { return parent_ != nullptr ? 1 : impl_->NumThreads(); }
 
-int ThreadPool::CurrentThreadId() const { return impl_->CurrentThreadId(); }
+int ThreadPool::CurrentThreadId() const {
+  return parent_ != nullptr ? parent_->CurrentThreadId() : impl_->CurrentThreadId();
+}
 }  // namespace concurrency
@@ -29,10 +29,15 @@ namespace concurrency {
 struct NumaEnvironment {
   int numa_node_;
   bool use_numa_;
+  bool pin_threads_;
+  int next_core_;
 
-  NumaEnvironment(int numa_node = kNUMANoAffinity)
+  NumaEnvironment(int numa_node = kNUMANoAffinity, bool pin_threads = false,
+                  int first_core = 0)
       : numa_node_(numa_node),
-        use_numa_(false)
+        use_numa_(false),
+        pin_threads_(pin_threads),
+        next_core_(first_core)
   {
     if (numa_node_ != kNUMANoAffinity)
     {
@@ -68,13 +73,19 @@ struct NumaEnvironment {
 
   EnvThread* CreateThread(std::function<void()> f)
   {
-
+    // the workers are created one by one, the i-th one is pinned to the i-th core of the
+    // range given to the pool
+    int core = pin_threads_ && !use_numa_ ? next_core_++ : -1;
     return StartThread([=]()
     {
       if (use_numa_)
       {
         NUMASetThreadNodeAffinity(numa_node_);
       }
+      else if (core >= 0)
+      {
+        SetThreadCoreAffinity(core);
+      }
       f();
     });
   }
@@ -92,7 +103,7 @@ class ThreadPool {
   /*
   Initializes a thread pool given the current environment.
   */
-  ThreadPool(int num_threads, int numa_node=kNUMANoAffinity);
+  ThreadPool(int num_threads, int numa_node=kNUMANoAffinity, bool pin_threads=false);
 
   /*
   Enqueue a unit of work.
@@ -125,9 +136,19 @@ class ThreadPool {
 
   Eigen::ThreadPoolDevice* GetDevice() { return device_.get(); }
 
+  /*
+  A view of this pool running all the work inline on the calling thread, for kernels
+  called from the workers of a parallel region.
+  */
+  ThreadPool* GetSerialView() { return serial_view_.get(); }
+
  private:
+  explicit ThreadPool(ThreadPool* parent);
+
   std::unique_ptr<Eigen::ThreadPoolTempl<NumaEnvironment>> impl_;
   std::shared_ptr<Eigen::ThreadPoolDevice> device_;
+  std::unique_ptr<ThreadPool> serial_view_;
+  ThreadPool* parent_;
   int numa_node_;
 };
 
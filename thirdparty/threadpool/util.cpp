@@ -58,6 +58,17 @@ void NUMASetThreadNodeAffinity(int node) {
   }
 }
 
+void SetThreadCoreAffinity(int core) {
+  if (!HaveHWLocTopology() || core < 0) return;
+  int num_cores = hwloc_get_nbobjs_by_type(hwloc_topology_handle, HWLOC_OBJ_CORE);
+  if (num_cores <= 0) return;
+  hwloc_obj_t obj =
+      hwloc_get_obj_by_type(hwloc_topology_handle, HWLOC_OBJ_CORE, core % num_cores);
+  if (obj) {
+    hwloc_set_cpubind(hwloc_topology_handle, obj->cpuset, HWLOC_CPUBIND_THREAD);
+  }
+}
+
 int NUMAGetThreadNodeAffinity() {
   int node_index = kNUMANoAffinity;
   if (HaveHWLocTopology()) {
@@ -19,4 +19,8 @@ namespace concurrency {
 
   // Returns NUMA node affinity of the current thread, kNUMANoAffinity if none.
   int NUMAGetThreadNodeAffinity();
+
+  // If possible binds the current thread to the core of the given index, wrapping
+  // around the number of cores.
+  void SetThreadCoreAffinity(int core);
 };